@@ -0,0 +1,108 @@
+// Email: origoldbsc@gmail.com
+
+/*
+ * The C interface of agent plugins: shared objects that decide for a seat in place of the console.
+ *
+ * A plugin exports a single function, catan_agent_api(), returning a table of function pointers tagged with
+ * the ABI version it was built against. The game passes plain fixed-size structs across the boundary and
+ * reads the command back from a buffer it owns, so no C++ type, allocation or exception crosses it and a
+ * plugin may be written in C, C++ or anything else that produces a C shared object.
+ *
+ * Any change to the structs or the table below increments CATAN_AGENT_ABI_VERSION; the game refuses
+ * plugins built against another version.
+ */
+
+#ifndef AGENTABI_H
+#define AGENTABI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CATAN_AGENT_ABI_VERSION 2
+#define CATAN_AGENT_ENTRY "catan_agent_api"     /* Name of the exported entry point */
+
+#define CATAN_MAX_SEATS 6
+#define CATAN_TILES 19
+#define CATAN_INTERSECTIONS 54
+#define CATAN_EDGES 72
+#define CATAN_COMMAND_CAPACITY 128              /* Size of the command buffer, with the terminating null */
+
+/* The decision asked for, in the order of ariel::DecisionType */
+enum CatanDecision
+{
+    CATAN_DECISION_PRE_ROLL,                    /* "roll" or "use <card>" */
+    CATAN_DECISION_ACTION,                      /* A build, buy, trade or card command, or "end" */
+    CATAN_DECISION_DISCARD,                     /* "discard <wood> <brick> <wool> <grain> <ore>" or "discard auto [balanced|build]" */
+    CATAN_DECISION_ROBBER,                      /* "robber [<x> <y> [<seat>]]" */
+    CATAN_DECISION_SPECIAL_BUILD                /* "road", "settle", "city" or "buy" between turns, or "end" */
+};
+
+/* The board, given once when an agent is created. Intersections are indexed by ID (1 to 54, 0 unused). */
+typedef struct CatanBoardView
+{
+    int8_t positions[CATAN_TILES][2];           /* Coordinates of each tile, row by row from the top */
+    int8_t resources[CATAN_TILES];              /* WOOD 0, BRICK 1, WOOL 2, GRAIN 3, ORE 4, 5 for the desert */
+    int8_t numbers[CATAN_TILES];                /* Number token of each tile, 0 for the desert */
+    uint8_t corners[CATAN_TILES][6];            /* Intersections around each tile, clockwise from the top */
+    uint8_t neighbors[CATAN_INTERSECTIONS + 1][3];  /* Adjacent intersections, 0 where there are only two */
+    uint8_t harbors[CATAN_INTERSECTIONS + 1];   /* Bit r for the 2:1 harbor of resource r, bit 5 for a 3:1 harbor */
+    uint8_t edges[CATAN_EDGES][2];              /* The intersections at the ends of each edge */
+} CatanBoardView;
+
+/* One seat as every agent sees it. Masks have one bit per intersection ID. */
+typedef struct CatanSeatView
+{
+    int32_t resources[5];                       /* WOOD, BRICK, WOOL, GRAIN, ORE */
+    int32_t points;                             /* Victory points, with the awards */
+    int32_t developmentCards;                   /* Development cards held */
+    int32_t knights;                            /* Knights played */
+    uint64_t settlements;
+    uint64_t cities;
+    uint64_t roadEnds;                          /* Intersections touched by the seat's roads */
+} CatanSeatView;
+
+/* The game when a decision is asked for. */
+typedef struct CatanStateView
+{
+    uint32_t decision;                          /* A CatanDecision */
+    uint32_t seat;                              /* The seat asked to decide */
+    int32_t amount;                             /* Resources to discard (CATAN_DECISION_DISCARD only) */
+    uint32_t seatCount;
+    uint32_t turn;                              /* Seat whose turn it is */
+    int32_t robberTile;                         /* Index of the robber's tile in CatanBoardView */
+    CatanSeatView seats[CATAN_MAX_SEATS];       /* The first seatCount are used */
+    int8_t roadOwners[CATAN_EDGES];             /* Seat of the road on each edge of CatanBoardView, -1 when free */
+} CatanStateView;
+
+/* The table a plugin returns from catan_agent_api(). */
+typedef struct CatanAgentApi
+{
+    uint32_t abiVersion;                        /* CATAN_AGENT_ABI_VERSION of the plugin's build */
+    const char* name;                           /* Shown in the game, e.g. "greedy-v3" */
+
+    /* Creates the agent of a seat, NULL on failure. config is the text given to the game, "" if none. */
+    void* (*create)(const CatanBoardView* board, uint32_t seat, const char* config);
+
+    /* Writes a null terminated command of at most capacity - 1 characters and returns its length,
+       or returns a negative number to give up (the game stops with an error). */
+    int32_t (*decide)(void* agent, const CatanStateView* state, char* command, size_t capacity);
+
+    /* Receives the reply to the last command, starting with "ok" or "err". May be NULL. */
+    void (*notify)(void* agent, const char* reply);
+
+    /* Frees an agent made by create. */
+    void (*destroy)(void* agent);
+} CatanAgentApi;
+
+/* The entry point every plugin defines. */
+const CatanAgentApi* catan_agent_api(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
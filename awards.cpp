@@ -0,0 +1,177 @@
+// Email: origoldbsc@gmail.com
+
+#include "awards.hpp"
+#include "player.hpp"
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    AwardTracker::AwardTracker() : members(), knights()
+    {
+        for (int& holder : holders)
+        {
+            holder = -1;
+        }
+    }
+
+
+    /**
+     * @brief Detaches the enrolled players, so they do not refer to a finished game.
+     */
+    AwardTracker::~AwardTracker()
+    {
+        for (Player* member : members)
+        {
+            if (member != nullptr && member->awards == this)
+            {
+                member->awards = nullptr;
+            }
+        }
+    }
+
+
+    /**
+     * @brief Enrolls a player at its seat, replacing any tracker the player was enrolled in.
+     * @return The seat of the player.
+     * @throws out_of_range if the player's ID is not a seat.
+     */
+    size_t AwardTracker::enroll(Player& player)
+    {
+        if (!PlayerRegistry::isSeat(player.getId()))
+        {
+            throw out_of_range("Player " + player.getName() + " is not seated");
+        }
+        size_t seat = static_cast<size_t>(player.getId());
+        if (members[seat] != &player)
+        {
+            members[seat] = &player;
+            knights[seat] = 0;
+        }
+        player.awards = this;
+        return seat;
+    }
+
+
+    /**
+     * @brief Counts knights gained (or lost, with a negative delta) by the player in a seat.
+     * Gaining knights takes the Largest Army with more knights than the holder and at least the minimum.
+     */
+    void AwardTracker::countKnights(size_t seat, int delta)
+    {
+        if (seat >= MAX_SEATS || members[seat] == nullptr || delta == 0)
+        {
+            return;
+        }
+        knights[seat] += delta;
+
+        int& holder = holders[static_cast<size_t>(Award::LARGEST_ARMY)];
+        if (delta < 0)
+        {
+            if (holder == static_cast<int>(seat))
+            {
+                reevaluateLargestArmy();    // Only the holder losing knights can pass the award on
+            }
+            return;
+        }
+        if (holder != static_cast<int>(seat) && knights[seat] >= LARGEST_ARMY_MINIMUM
+            && (holder < 0 || knights[seat] > knights[static_cast<size_t>(holder)]))
+        {
+            if (holder >= 0)
+            {
+                cout << members[static_cast<size_t>(holder)]->getName() << " has lost the Largest Army." << endl;
+            }
+            holder = static_cast<int>(seat);
+            cout << members[seat]->getName() << " now holds the Largest Army and gains " << AWARD_POINTS << " victory points." << endl;
+        }
+    }
+
+
+    /**
+     * @brief Gives the Largest Army to the player with the most knights (at least the minimum), or to nobody.
+     * On a tie the current holder keeps it.
+     */
+    void AwardTracker::reevaluateLargestArmy()
+    {
+        int& holder = holders[static_cast<size_t>(Award::LARGEST_ARMY)];
+        int best = holder >= 0 && knights[static_cast<size_t>(holder)] >= LARGEST_ARMY_MINIMUM ? holder : -1;
+        for (size_t seat = 0; seat < MAX_SEATS; ++seat)
+        {
+            if (knights[seat] >= LARGEST_ARMY_MINIMUM && (best < 0 || knights[seat] > knights[static_cast<size_t>(best)]))
+            {
+                best = static_cast<int>(seat);
+            }
+        }
+        if (best != holder && holder >= 0)
+        {
+            cout << members[static_cast<size_t>(holder)]->getName() << " has lost the Largest Army." << endl;
+        }
+        holder = best;
+    }
+
+
+    /**
+     * @brief Sets the knights of a seat, used when restoring a saved game.
+     */
+    void AwardTracker::restore(size_t seat, int knightCount)
+    {
+        if (seat < MAX_SEATS)
+        {
+            knights[seat] = knightCount;
+        }
+    }
+
+
+    /**
+     * @brief Sets the holder of an award directly, used when restoring a saved game.
+     */
+    void AwardTracker::setHolder(Award award, int seat)
+    {
+        holders[static_cast<size_t>(award)] = PlayerRegistry::isSeat(seat) && members[static_cast<size_t>(seat)] != nullptr ? seat : -1;
+    }
+
+
+    int AwardTracker::getKnights(size_t seat) const
+    {
+        return seat < MAX_SEATS ? knights[seat] : 0;
+    }
+
+
+    int AwardTracker::getHolder(Award award) const
+    {
+        return holders[static_cast<size_t>(award)];
+    }
+
+
+    Player* AwardTracker::getHolderPlayer(Award award) const
+    {
+        int holder = holders[static_cast<size_t>(award)];
+        return holder >= 0 ? members[static_cast<size_t>(holder)] : nullptr;
+    }
+
+
+    /**
+     * @brief Returns the victory points a seat gets from the awards it holds.
+     */
+    int AwardTracker::getPoints(size_t seat) const
+    {
+        int points = 0;
+        for (int holder : holders)
+        {
+            points += holder == static_cast<int>(seat) ? AWARD_POINTS : 0;
+        }
+        return points;
+    }
+
+
+    size_t AwardTracker::size() const
+    {
+        size_t enrolled = 0;
+        for (Player* member : members)
+        {
+            enrolled += member != nullptr ? 1 : 0;
+        }
+        return enrolled;
+    }
+}
@@ -0,0 +1,82 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef AWARDS_HPP
+#define AWARDS_HPP
+
+#include <cstddef>
+#include "registry.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Player;
+
+    /**
+     * @brief The awards that give victory points to a single player at a time.
+     */
+    enum class Award { LARGEST_ARMY };
+
+    constexpr size_t AWARD_TYPES = 1;
+
+
+    /**
+     * @brief Tracks the awards of one game: the knights counted for every player and the holder of each award.
+     *
+     * Players are enrolled at their seat (see PlayerRegistry) and the counts live in arrays indexed by seat. Counting a
+     * knight updates the holder with a single comparison; the seats are only rescanned when the holder loses knights.
+     * Award points are reported through getPoints() and added by Player::getPoints(), the players' own points are never changed.
+     */
+    class AwardTracker
+    {
+        private:
+
+            Player* members[MAX_SEATS];         // Enrolled players, by seat
+            int knights[MAX_SEATS];             // Knights counted for each seat
+            int holders[AWARD_TYPES];           // Seat holding each award (-1 if nobody)
+
+            void reevaluateLargestArmy();
+
+        public:
+
+            static constexpr int LARGEST_ARMY_MINIMUM = 3;   // Knights needed for the Largest Army
+            static constexpr int AWARD_POINTS = 2;           // Victory points of an award
+
+            AwardTracker();
+
+            /**
+             * @brief Detaches the enrolled players, so they do not refer to a finished game.
+             */
+            ~AwardTracker();
+
+            AwardTracker(const AwardTracker&) = delete;
+            AwardTracker& operator=(const AwardTracker&) = delete;
+
+            /**
+             * @brief Enrolls a player at its seat, replacing any tracker the player was enrolled in.
+             * @return The seat of the player.
+             * @throws out_of_range if the player's ID is not a seat.
+             */
+            size_t enroll(Player& player);
+
+            /**
+             * @brief Counts knights gained (or lost, with a negative delta) by the player in a seat.
+             * Gaining knights takes the Largest Army with more knights than the holder and at least the minimum.
+             */
+            void countKnights(size_t seat, int delta = 1);
+
+            /**
+             * @brief Sets the knights of a seat and the holder directly, used when restoring a saved game.
+             */
+            void restore(size_t seat, int knightCount);
+            void setHolder(Award award, int seat);
+
+            // Getters
+            int getKnights(size_t seat) const;
+            int getHolder(Award award) const;                   // Seat of the holder, -1 if nobody
+            Player* getHolderPlayer(Award award) const;         // nullptr if nobody
+            int getPoints(size_t seat) const;                   // Victory points from the awards held
+            size_t size() const;
+    };
+}
+
+#endif
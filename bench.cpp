@@ -0,0 +1,451 @@
+// Email: origoldbsc@gmail.com
+
+#include "catan.hpp"
+#include "board.hpp"
+#include "player.hpp"
+#include "turnengine.hpp"
+#include "boardgen.hpp"
+#include "bot.hpp"
+#include "plugin.hpp"
+#include "ladder.hpp"
+#include "roadplan.hpp"
+#include "opening.hpp"
+#include "perft.hpp"
+#include "exporter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ariel;
+using namespace std;
+
+#ifndef BENCH_CXXFLAGS
+#define BENCH_CXXFLAGS ""
+#endif
+
+/**
+ * @brief Keeps the compiler from dropping a computation whose result is otherwise unused.
+ */
+template <typename T>
+static void keep(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+
+/**
+ * @brief A stream buffer that discards everything, so the narration of the game does not time the terminal.
+ */
+class NullBuffer : public streambuf
+{
+    protected:
+        int overflow(int c) override { return c; }
+        streamsize xsputn(const char*, streamsize count) override { return count; }
+};
+
+
+/**
+ * @brief The summary of one benchmark, in nanoseconds per operation.
+ */
+struct BenchResult
+{
+    string name;
+    size_t iterations;      // Operations per sample
+    size_t samples;         // Timed repetitions
+    double mean, median, min, max, stddev;
+};
+
+
+/**
+ * @brief Times a body several times and summarizes the time per operation.
+ * @param name Name of the benchmark in the report.
+ * @param samples Number of timed repetitions.
+ * @param iterations Number of operations performed by one call of the body.
+ * @param body Runs the operations once.
+ * @param setup Runs before every sample, outside the timing.
+ */
+static BenchResult measure(const string& name, size_t samples, size_t iterations,
+                           const function<void()>& body, const function<void()>& setup = nullptr)
+{
+    using Clock = chrono::steady_clock;
+    if (setup)
+    {
+        setup();
+    }
+    body();         // Warm up caches and lazily built tables
+
+    vector<double> times;
+    times.reserve(samples);
+    for (size_t sample = 0; sample < samples; ++sample)
+    {
+        if (setup)
+        {
+            setup();
+        }
+        Clock::time_point start = Clock::now();
+        body();
+        Clock::time_point end = Clock::now();
+        times.push_back(chrono::duration<double, nano>(end - start).count() / static_cast<double>(iterations));
+    }
+
+    sort(times.begin(), times.end());
+    double sum = 0;
+    for (double time : times)
+    {
+        sum += time;
+    }
+    double mean = sum / static_cast<double>(samples);
+    double squares = 0;
+    for (double time : times)
+    {
+        squares += (time - mean) * (time - mean);
+    }
+    double median = samples % 2 ? times[samples / 2] : (times[samples / 2 - 1] + times[samples / 2]) / 2;
+    return {name, iterations, samples, mean, median, times.front(), times.back(), sqrt(squares / static_cast<double>(samples))};
+}
+
+
+/**
+ * @brief A seat that rolls, discards with the closest build policy and builds a city or buys a card when it can,
+ * ending the turn as soon as a command is rejected.
+ * It stops answering once the benchmark ran its number of turns, which leaves the engine suspended.
+ */
+class SimulatedAgent : public SeatAgent
+{
+    private:
+        Catan& game;
+        size_t& turnsLeft;
+        bool rejected = false;
+
+    public:
+        SimulatedAgent(Catan& game, size_t& turnsLeft) : game(game), turnsLeft(turnsLeft) {}
+
+        void notify(const string& reply) override
+        {
+            rejected = reply.rfind("err", 0) == 0;
+        }
+
+        bool decide(const DecisionRequest& request, string& command) override
+        {
+            Player* player = game.getPlayers()[request.seat];
+            if (request.type == DecisionType::PreRoll)
+            {
+                if (turnsLeft == 0)
+                {
+                    return false;
+                }
+                --turnsLeft;
+                rejected = false;
+                command = "roll";
+            }
+            else if (request.type == DecisionType::Discard)
+            {
+                command = "discard auto build";
+            }
+            else if (request.type == DecisionType::Robber)
+            {
+                command = "robber";
+            }
+            else if (rejected)
+            {
+                command = "end";
+            }
+            else if (player->canBuild(Structure::CITY) && !player->getSettlements().empty())
+            {
+                command = "city " + to_string(*player->getSettlements().begin());
+            }
+            else if (player->canBuild(Structure::DEVELOPMENT_CARD))
+            {
+                command = "buy";
+            }
+            else
+            {
+                command = "end";
+            }
+            return true;
+        }
+};
+
+
+/**
+ * @brief Writes the results as a JSON document.
+ */
+static void writeJson(ostream& out, const vector<BenchResult>& results)
+{
+    out << "{\n  \"compiler\": \"" << __VERSION__ << "\",\n  \"cxxflags\": \"" << BENCH_CXXFLAGS << "\",\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations << ", \"samples\": " << r.samples
+            << ", \"mean\": " << r.mean << ", \"median\": " << r.median << ", \"min\": " << r.min
+            << ", \"max\": " << r.max << ", \"stddev\": " << r.stddev << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+
+int main(int argc, char* argv[]) {
+
+    // Usage: ./bench [output.json] [samples]
+    string outputPath = argc > 1 ? argv[1] : "";
+    size_t samples = argc > 2 ? stoul(argv[2]) : 30;
+
+    // The game narrates every action; discard it so only the work itself is timed
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    vector<Player*>& players = game.getPlayers();
+
+    // Every edge and intersection of the board
+    vector<Edge> edges;
+    vector<Intersection> intersections;
+    for (int id1 = 1; id1 <= 54; ++id1)
+    {
+        intersections.push_back(Intersection::getIntersection(id1));
+        for (int id2 = id1 + 1; id2 <= 54; ++id2)
+        {
+            if (board.areIntersectionsAdjacent(id1, id2))
+            {
+                edges.emplace_back(Intersection::getIntersection(id1), Intersection::getIntersection(id2));
+            }
+        }
+    }
+    int playerID = players[0]->getId();
+
+    vector<BenchResult> results;
+
+    results.push_back(measure("canPlaceRoad", samples, edges.size(), [&]() {
+        int allowed = 0;
+        for (const Edge& edge : edges)
+        {
+            allowed += board.canPlaceRoad(edge, playerID);
+        }
+        keep(allowed);
+    }));
+
+    results.push_back(measure("canPlaceSettlement", samples, 54, [&]() {
+        int allowed = 0;
+        for (int id = 1; id <= 54; ++id)
+        {
+            allowed += board.canPlaceSettlement(id, playerID);
+        }
+        keep(allowed);
+    }));
+
+    // Resources grow with every roll, so every sample starts from the same hands
+    vector<int> rolls = {2, 3, 4, 5, 6, 8, 9, 10, 11, 12};
+    results.push_back(measure("distributeResourcesBasedOnDiceRoll", samples, rolls.size(), [&]() {
+        for (int roll : rolls)
+        {
+            board.distributeResourcesBasedOnDiceRoll(roll, players);
+        }
+    }, [&]() {
+        for (Player* player : players)
+        {
+            for (int type = WOOD; type <= ORE; ++type)
+            {
+                player->useResources(static_cast<ResourceType>(type), player->getResourceCount(static_cast<ResourceType>(type)));
+            }
+        }
+    }));
+
+    results.push_back(measure("getIntersectionID", samples, intersections.size(), [&]() {
+        int sum = 0;
+        for (const Intersection& intersection : intersections)
+        {
+            sum += board.getIntersectionID(intersection);
+        }
+        keep(sum);
+    }));
+
+    results.push_back(measure("Edge::operator<", samples, edges.size() * edges.size(), [&]() {
+        int less = 0;
+        for (const Edge& a : edges)
+        {
+            for (const Edge& b : edges)
+            {
+                less += a < b;
+            }
+        }
+        keep(less);
+    }));
+
+    results.push_back(measure("Player::canBuild", samples, 4 * players.size(), [&]() {
+        int affordable = 0;
+        for (const Player* player : players)
+        {
+            affordable += player->canBuild(Structure::ROAD) + player->canBuild(Structure::SETTLEMENT)
+                          + player->canBuild(Structure::CITY) + player->canBuild(Structure::DEVELOPMENT_CARD);
+        }
+        keep(affordable);
+    }));
+
+    results.push_back(measure("Player::getBankRate", samples, RESOURCE_TYPES * players.size(), [&]() {
+        int rates = 0;
+        for (const Player* player : players)
+        {
+            for (int type = WOOD; type <= ORE; ++type)
+            {
+                rates += player->getBankRate(static_cast<ResourceType>(type));
+            }
+        }
+        keep(rates);
+    }));
+
+    results.push_back(measure("printGameBoard", samples, 1, [&]() {
+        board.printGameBoard();
+    }));
+
+    Board scratch;
+    results.push_back(measure("resetBoard", samples, 1, [&]() {
+        scratch.resetBoard();
+    }));
+
+    const size_t boards = 10000;
+    BoardGenerator generator(1);
+    BoardLayout layout;
+    results.push_back(measure("BoardGenerator::generate+score", samples, boards, [&]() {
+        double total = 0;
+        for (size_t board = 0; board < boards; ++board)
+        {
+            generator.generate(layout);
+            total += BoardGenerator::score(layout).total;
+        }
+        keep(total);
+    }));
+
+    // A whole six-seat draft on the last generated board, on every core
+    Board drafted;
+    drafted.applyLayout(layout);
+    OpeningOptimizer opening(drafted, max<size_t>(thread::hardware_concurrency(), 1));
+    results.push_back(measure("OpeningOptimizer::optimize(6)", samples, 1, [&]() {
+        keep(opening.optimize(6).scores[0]);
+    }));
+
+    // Every settlement spot on the board, evaluated as a bot evaluates a move
+    BotEvaluator evaluator(board, BotWeights());
+    BotPosition position = {};
+    position.hand = players[0]->getResources();
+    results.push_back(measure("BotEvaluator::evaluate", samples, 54, [&]() {
+        double total = 0;
+        for (int id = 1; id <= 54; ++id)
+        {
+            BotPosition after = position;
+            evaluator.addProduction(after, id, 1);
+            total += evaluator.evaluate(after);
+        }
+        keep(total);
+    }));
+
+    // Decisions of the sample agent plugin: refreshing the state view and one call across the C boundary
+    PluginAgent pluginAgent(game, AgentPlugin::load("./libsampleagent.so"), 0);
+    results.push_back(measure("PluginAgent::decide", samples, 100, [&]() {
+        string command;
+        for (int decision = 0; decision < 100; ++decision)
+        {
+            pluginAgent.decide({DecisionType::Action, 0, 0}, command);
+        }
+        keep(command);
+    }));
+
+    // Four-seat results through the lock-free queue, then rated
+    RatingLadder ladder(1024);
+    uint32_t rated[4] = {ladder.addAgent("greedy"), ladder.addAgent("random"), ladder.addAgent("sample"), ladder.addAgent("cautious")};
+    results.push_back(measure("RatingLadder::submit+rate", samples, 1000, [&]() {
+        for (int32_t game = 0; game < 1000; ++game)
+        {
+            ladder.submit({4, {rated[0], rated[1], rated[2], rated[3]}, {10, game % 9, 7, 5}});
+            if ((game & 255) == 255)
+            {
+                ladder.drain();
+            }
+        }
+        keep(ladder.drain());
+    }));
+
+    // Road routes of the first seat: the all-targets search, then one route per intersection
+    RoadPlanner planner;
+    results.push_back(measure("RoadPlanner::update", samples, 100, [&]() {
+        for (int update = 0; update < 100; ++update)
+        {
+            planner.update(board, playerID);
+        }
+        keep(planner);
+    }));
+
+    results.push_back(measure("RoadPlanner::route", samples, 54, [&]() {
+        int roads = 0;
+        for (int id = 1; id <= 54; ++id)
+        {
+            roads += planner.route(id).roads;
+        }
+        keep(roads);
+    }));
+
+    // Move generation and state updates: every action sequence of two actions from the current position
+    PerftCounter perft(game);
+    PerftResult counted = perft.run(2);
+    results.push_back(measure("PerftCounter::run(2) per position", samples, counted.nodes + counted.rolls, [&]() {
+        keep(perft.run(2));
+    }));
+
+    // Whole games from the beginner setup, played by simulated seats for a fixed number of turns. The dice are
+    // seeded again for every sample, so the runs with and without the event exporter play the same rolls.
+    const size_t turns = 60;
+    unique_ptr<Board> simulatedBoard;
+    unique_ptr<Player> s1, s2, s3;
+    unique_ptr<Catan> simulated;
+    mt19937 dice;
+    auto simulate = [&]() {
+        size_t turnsLeft = turns;
+        SimulatedAgent agent(*simulated, turnsLeft);
+        TurnEngine engine(*simulated, {&agent, &agent, &agent});
+        engine.setDice([&dice]() { return uniform_int_distribution<int>(1, 6)(dice); });
+        engine.start();
+        keep(turnsLeft);
+    };
+    auto newGame = [&]() {
+        simulated.reset();
+        simulatedBoard = make_unique<Board>();
+        s1 = make_unique<Player>("Blue");
+        s2 = make_unique<Player>("Red");
+        s3 = make_unique<Player>("Green");
+        simulated = make_unique<Catan>(*s1, *s2, *s3, *simulatedBoard);
+        simulated->initializeGame();
+        dice.seed(2024);
+    };
+    results.push_back(measure("simulatedTurn", samples, turns, simulate, newGame));
+
+    // The same games while every event is streamed, to keep the cost of the exporter in view
+    EventExporter exporter("/dev/null");
+    results.push_back(measure("simulatedTurn+EventExporter", samples, turns, [&]() {
+        EventExporter::setActive(&exporter);
+        simulate();
+        EventExporter::setActive(nullptr);
+    }, newGame));
+
+    cout.rdbuf(console);
+    if (outputPath.empty())
+    {
+        writeJson(cout, results);
+    }
+    else
+    {
+        ofstream output(outputPath);
+        writeJson(output, results);
+        cerr << "Wrote " << results.size() << " benchmarks to " << outputPath << endl;
+    }
+    return 0;
+}
@@ -1,10 +1,16 @@
 // Email: origoldbsc@gmail.com
 
 #include "board.hpp"
+#include "exporter.hpp"
+#include "stats.hpp"
+#include "boardgen.hpp"
+#include "topology.hpp"
 #include <iostream>
 #include <cmath>
 #include <sstream>
 #include <algorithm>
+#include <array>
+#include <utility>
 
 //-------------------------------------------------------//
 //   The tiles represented by the coordinates below:     //
@@ -28,8 +34,8 @@ namespace ariel {
 
 
     /**
-     * @brief Returns the singleton instance of the Board.
-     * @return Reference to the singleton instance of the Board.
+     * @brief Returns the shared instance of the Board used by the interactive game.
+     * @return Reference to the shared instance of the Board.
      */
     Board& Board::getInstance() 
     {
@@ -40,12 +46,16 @@ namespace ariel {
     /**
      * @brief Constructs a new game board by initializing intersections, setting up tiles, and linking tiles with their respective intersections.
      */
-    Board::Board() 
+    Board::Board() : settlementsBySeat(), citiesBySeat(), roadEndsBySeat()
     { 
         Intersection::initialize();                  // Initiate intersections
         setupTiles();                                // Load tiles
         linkTilesAndIntersections();                 // Combine between each tile knows its intersections
-        initializeAdjacency();                       // Initialize the adjacency list for intersections
+        indexTiles();                                // Build the production masks and place the robber on the desert
+        if (adjacencyList.empty())
+        {
+            initializeAdjacency();                   // Initialize the adjacency list for intersections (shared by all boards)
+        }
     }
 
     /**
@@ -86,210 +96,92 @@ namespace ariel {
 
     /**
      * @brief Links tiles to their adjacent intersections to facilitate game mechanics like resource distribution.
+     * The corners of each tile come from the topology of the standard board (see HexTopology).
      */
     void Board::linkTilesAndIntersections() 
     {
-        // Row 1
-        tiles[{0, 2}].addIntersection(1);
-        tiles[{0, 2}].addIntersection(2);
-        tiles[{0, 2}].addIntersection(3);
-        tiles[{0, 2}].addIntersection(9);
-        tiles[{0, 2}].addIntersection(10);
-        tiles[{0, 2}].addIntersection(11);
-
-        tiles[{1, 2}].addIntersection(3);
-        tiles[{1, 2}].addIntersection(4);
-        tiles[{1, 2}].addIntersection(5);
-        tiles[{1, 2}].addIntersection(11);
-        tiles[{1, 2}].addIntersection(12);
-        tiles[{1, 2}].addIntersection(13);
-
-
-        tiles[{2, 2}].addIntersection(5);
-        tiles[{2, 2}].addIntersection(6);
-        tiles[{2, 2}].addIntersection(7);
-        tiles[{2, 2}].addIntersection(13);
-        tiles[{2, 2}].addIntersection(14);
-        tiles[{2, 2}].addIntersection(15);
+        const HexTopology& topology = HexTopology::standard();
+        for (size_t tile = 0; tile < topology.tileCount(); ++tile)
+        {
+            for (int intersectionID : topology.tileCorners(tile))
+            {
+                tiles[topology.tilePosition(tile)].addIntersection(intersectionID);
+            }
+        }
+    }
+    
 
-        // Row 2
-        tiles[{-1, 1}].addIntersection(8);
-        tiles[{-1, 1}].addIntersection(9);
-        tiles[{-1, 1}].addIntersection(10);
-        tiles[{-1, 1}].addIntersection(18);
-        tiles[{-1, 1}].addIntersection(19);
-        tiles[{-1, 1}].addIntersection(20);
-
-        tiles[{0, 1}].addIntersection(10);
-        tiles[{0, 1}].addIntersection(11);
-        tiles[{0, 1}].addIntersection(12);
-        tiles[{0, 1}].addIntersection(20);
-        tiles[{0, 1}].addIntersection(21);
-        tiles[{0, 1}].addIntersection(22);
-
-        tiles[{1, 1}].addIntersection(12);
-        tiles[{1, 1}].addIntersection(13);
-        tiles[{1, 1}].addIntersection(14);
-        tiles[{1, 1}].addIntersection(22);
-        tiles[{1, 1}].addIntersection(23);
-        tiles[{1, 1}].addIntersection(24);
-
-        tiles[{2, 1}].addIntersection(14);
-        tiles[{2, 1}].addIntersection(15);
-        tiles[{2, 1}].addIntersection(16);
-        tiles[{2, 1}].addIntersection(24);
-        tiles[{2, 1}].addIntersection(25);
-        tiles[{2, 1}].addIntersection(26);
+    /**
+     * @brief The nine harbors of the beginner layout, each on two neighbouring coastal intersections:
+     * four 3:1 harbors and one 2:1 harbor for every resource, placed clockwise from the top.
+     */
+    static constexpr uint8_t buildHarborMask(int intersectionID)
+    {
+        struct Harbor { int id1, id2; uint8_t access; };
+        constexpr Harbor harbors[] = {
+            {1, 2, GENERIC_HARBOR},
+            {4, 5, 1u << WOOL},
+            {15, 16, GENERIC_HARBOR},
+            {27, 38, GENERIC_HARBOR},
+            {46, 47, 1u << BRICK},
+            {52, 53, 1u << WOOD},
+            {48, 49, GENERIC_HARBOR},
+            {29, 39, 1u << GRAIN},
+            {8, 18, 1u << ORE}
+        };
+        uint8_t mask = 0;
+        for (const Harbor& harbor : harbors)
+        {
+            if (harbor.id1 == intersectionID || harbor.id2 == intersectionID)
+            {
+                mask = static_cast<uint8_t>(mask | harbor.access);
+            }
+        }
+        return mask;
+    }
 
-        // Row 4
-        tiles[{-2, 0}].addIntersection(17);
-        tiles[{-2, 0}].addIntersection(18);
-        tiles[{-2, 0}].addIntersection(19);
-        tiles[{-2, 0}].addIntersection(28);
-        tiles[{-2, 0}].addIntersection(29);
-        tiles[{-2, 0}].addIntersection(30);
-
-
-        tiles[{-1, 0}].addIntersection(19);
-        tiles[{-1, 0}].addIntersection(20);
-        tiles[{-1, 0}].addIntersection(21);
-        tiles[{-1, 0}].addIntersection(30);
-        tiles[{-1, 0}].addIntersection(31);
-        tiles[{-1, 0}].addIntersection(32);
-
-        tiles[{0, 0}].addIntersection(21);
-        tiles[{0, 0}].addIntersection(22);
-        tiles[{0, 0}].addIntersection(23);
-        tiles[{0, 0}].addIntersection(32);
-        tiles[{0, 0}].addIntersection(33);
-        tiles[{0, 0}].addIntersection(34);
-
-        tiles[{1, 0}].addIntersection(23);
-        tiles[{1, 0}].addIntersection(24);
-        tiles[{1, 0}].addIntersection(25);
-        tiles[{1, 0}].addIntersection(34);
-        tiles[{1, 0}].addIntersection(35);
-        tiles[{1, 0}].addIntersection(36);
-
-        tiles[{2, 0}].addIntersection(25);
-        tiles[{2, 0}].addIntersection(26);
-        tiles[{2, 0}].addIntersection(27);
-        tiles[{2, 0}].addIntersection(36);
-        tiles[{2, 0}].addIntersection(37);
-        tiles[{2, 0}].addIntersection(38);
+    template <size_t... ids>
+    static constexpr array<uint8_t, sizeof...(ids)> buildHarborMasks(index_sequence<ids...>)
+    {
+        return {buildHarborMask(static_cast<int>(ids))...};
+    }
 
-        // Row 5
-        tiles[{-2, -1}].addIntersection(29);
-        tiles[{-2, -1}].addIntersection(30);
-        tiles[{-2, -1}].addIntersection(31);
-        tiles[{-2, -1}].addIntersection(39);
-        tiles[{-2, -1}].addIntersection(40);
-        tiles[{-2, -1}].addIntersection(41);
-
-        tiles[{-1, -1}].addIntersection(31);
-        tiles[{-1, -1}].addIntersection(32);
-        tiles[{-1, -1}].addIntersection(33);
-        tiles[{-1, -1}].addIntersection(41);
-        tiles[{-1, -1}].addIntersection(42);
-        tiles[{-1, -1}].addIntersection(43);
-
-        tiles[{0, -1}].addIntersection(33);
-        tiles[{0, -1}].addIntersection(34);
-        tiles[{0, -1}].addIntersection(35);
-        tiles[{0, -1}].addIntersection(43);
-        tiles[{0, -1}].addIntersection(44);
-        tiles[{0, -1}].addIntersection(45);
-
-        tiles[{1, -1}].addIntersection(35);
-        tiles[{1, -1}].addIntersection(36);
-        tiles[{1, -1}].addIntersection(37);
-        tiles[{1, -1}].addIntersection(45);
-        tiles[{1, -1}].addIntersection(46);
-        tiles[{1, -1}].addIntersection(47);
-
-        // Row 6
-        tiles[{-2, -2}].addIntersection(40);
-        tiles[{-2, -2}].addIntersection(41);
-        tiles[{-2, -2}].addIntersection(42);
-        tiles[{-2, -2}].addIntersection(48);
-        tiles[{-2, -2}].addIntersection(49);
-        tiles[{-2, -2}].addIntersection(50);
-
-        tiles[{-1, -2}].addIntersection(42);
-        tiles[{-1, -2}].addIntersection(43);
-        tiles[{-1, -2}].addIntersection(44);
-        tiles[{-1, -2}].addIntersection(50);
-        tiles[{-1, -2}].addIntersection(51);
-        tiles[{-1, -2}].addIntersection(52);
-
-        tiles[{0, -2}].addIntersection(44);
-        tiles[{0, -2}].addIntersection(45);
-        tiles[{0, -2}].addIntersection(46);
-        tiles[{0, -2}].addIntersection(52);
-        tiles[{0, -2}].addIntersection(53);
-        tiles[{0, -2}].addIntersection(54);
+    // Computed at compile time, so a lookup is a single load
+    static constexpr array<uint8_t, 55> HARBOR_MASKS = buildHarborMasks(make_index_sequence<55>());
+
+
+    /**
+     * @brief Returns the harbor access bits of an intersection, 0 for inland intersections.
+     * @param intersectionID The intersection ID (1-54).
+     * @return Bit r for the 2:1 harbor of resource r, GENERIC_HARBOR for a 3:1 harbor.
+     */
+    uint8_t Board::harborAt(int intersectionID)
+    {
+        if (intersectionID < 0 || static_cast<size_t>(intersectionID) >= HARBOR_MASKS.size())
+        {
+            return 0;
+        }
+        return HARBOR_MASKS[static_cast<size_t>(intersectionID)];
     }
-    
+
 
     /**
-     * @brief Initializes the adjacency list used to check the connectivity between intersections.
+     * @brief Initializes the adjacency list used to check the connectivity between intersections, from the
+     * edges of the standard board's topology.
      */
     void Board::initializeAdjacency() 
     {
-        adjacencyList[1] = {2, 9};
-        adjacencyList[2] = {1, 3};
-        adjacencyList[3] = {2, 4, 11};
-        adjacencyList[4] = {3, 5};
-        adjacencyList[5] = {4, 6, 13};
-        adjacencyList[6] = {5, 7};
-        adjacencyList[7] = {6, 15};
-        adjacencyList[8] = {9, 18};
-        adjacencyList[9] = {1, 8, 10};
-        adjacencyList[10] = {9, 11, 20};
-        adjacencyList[11] = {3, 10, 12};
-        adjacencyList[12] = {11, 13, 22};
-        adjacencyList[13] = {5, 12, 14};
-        adjacencyList[14] = {13, 15, 24};
-        adjacencyList[15] = {7, 14, 16};
-        adjacencyList[16] = {15, 26};
-        adjacencyList[17] = {18, 28};
-        adjacencyList[18] = {8, 17, 19};
-        adjacencyList[19] = {18, 20, 30};
-        adjacencyList[20] = {10, 19, 21};
-        adjacencyList[21] = {20, 22, 32};
-        adjacencyList[22] = {12, 21, 23};
-        adjacencyList[23] = {22, 24, 34};
-        adjacencyList[24] = {14, 23, 25};
-        adjacencyList[25] = {24, 26, 36};
-        adjacencyList[26] = {16, 25, 27};
-        adjacencyList[27] = {26, 38};
-        adjacencyList[28] = {17, 29};
-        adjacencyList[29] = {28, 30, 39};
-        adjacencyList[30] = {19, 29, 31};
-        adjacencyList[31] = {30, 32, 41};
-        adjacencyList[32] = {21, 31, 33};
-        adjacencyList[33] = {32, 34, 43};
-        adjacencyList[34] = {23, 33, 35};
-        adjacencyList[35] = {34, 36, 45};
-        adjacencyList[36] = {25, 35, 37};
-        adjacencyList[37] = {36, 38, 47};
-        adjacencyList[38] = {27, 37};
-        adjacencyList[39] = {29, 40};
-        adjacencyList[40] = {39, 41, 48};
-        adjacencyList[41] = {31, 40, 42};
-        adjacencyList[42] = {41, 43, 50};
-        adjacencyList[43] = {33, 42, 44};
-        adjacencyList[44] = {43, 45, 52};
-        adjacencyList[45] = {35, 44, 46};
-        adjacencyList[46] = {45, 47, 54};
-        adjacencyList[47] = {37, 46};
-        adjacencyList[48] = {40, 49};
-        adjacencyList[49] = {48, 50};
-        adjacencyList[50] = {42, 49, 51};
-        adjacencyList[51] = {50, 52};
-        adjacencyList[52] = {44, 51, 53};
-        adjacencyList[53] = {52, 54};
-        adjacencyList[54] = {46, 53};
+        const HexTopology& topology = HexTopology::standard();
+        for (int id = 1; id <= static_cast<int>(topology.intersectionCount()); ++id)
+        {
+            for (int neighbor : topology.neighbors(id))
+            {
+                if (neighbor != 0)
+                {
+                    adjacencyList[id].insert(neighbor);
+                }
+            }
+        }
     }
 
 
@@ -531,31 +423,40 @@ namespace ariel {
         // Mapping from ResourceType to players who should receive that resource this turn
         map<Player*, map<ResourceType, int>> resourcesToDistribute;
 
-        // Find all tiles that match the dice roll number and are not "NONE"
-        for (auto& [position, tile] : tiles) 
+        // The tiles that produce for this roll, without the robber's tile; one bit per tile
+        uint32_t producing = diceRoll >= 0 && diceRoll < 13 ? tilesByNumber[diceRoll] & ~blockedTiles : 0;
+        StatBlock* stats = StatBlock::local();
+        for (; producing != 0; producing &= producing - 1)
         {
-            if (tile.getNumber() == diceRoll && tile.getResourceType() != ResourceType::NONE) 
+            size_t tileIndex = static_cast<size_t>(__builtin_ctz(producing));
+            const Tile& tile = tiles.at(tilePositions[tileIndex]);
+            int produced = 0;
+
+            // Get all intersections around this tile
+            const auto& intersectionIDs = tile.getIntersectionIDs();
+            for (int intersectionID : intersectionIDs) 
             {
-                // Get all intersections around this tile
-                const auto& intersectionIDs = tile.getIntersectionIDs();
-                for (int intersectionID : intersectionIDs) 
+                // Check each player if they have a settlement or city on this intersection
+                for (auto* player : players) 
                 {
-                    // Check each player if they have a settlement or city on this intersection
-                    for (auto* player : players) 
+                    if (player->getSettlements().find(intersectionID) != player->getSettlements().end()) 
                     {
-                        if (player->getSettlements().find(intersectionID) != player->getSettlements().end()) 
-                        {
-                            // If the player has a settlement here, they should receive resources from this tile
-                            resourcesToDistribute[player][tile.getResourceType()] += 1;
-                        }
-                        if (player->getCities().find(intersectionID) != player->getCities().end()) 
-                        {
-                            // If the player has a city here, they should receive double resources from this tile
-                            resourcesToDistribute[player][tile.getResourceType()] += 2;  // Double the resources for cities
-                        }
+                        // If the player has a settlement here, they should receive resources from this tile
+                        resourcesToDistribute[player][tile.getResourceType()] += 1;
+                        produced += 1;
+                    }
+                    if (player->getCities().find(intersectionID) != player->getCities().end()) 
+                    {
+                        // If the player has a city here, they should receive double resources from this tile
+                        resourcesToDistribute[player][tile.getResourceType()] += 2;  // Double the resources for cities
+                        produced += 2;
                     }
                 }
             }
+            if (stats)
+            {
+                stats->produced(tileIndex, produced);
+            }
         }
 
         // Distribute the resources to players
@@ -564,6 +465,14 @@ namespace ariel {
             for (auto& [resourceType, quantity] : resources) 
             {
                 player->addResource(resourceType, quantity);  // Distribute the calculated resource quantity
+                if (EventExporter* exporter = EventExporter::getActive())
+                {
+                    exporter->resourceDelta(player->getId(), resourceType, quantity, "roll");
+                }
+                if (stats)
+                {
+                    stats->gain(GainSource::ROLL, resourceType, quantity);
+                }
                 cout << "Player " << player->getName() << " received " << quantity << " " << resourceTypeToString(resourceType) << "." << endl;
             }
         }
@@ -651,6 +560,14 @@ namespace ariel {
     {
         // Simply place the settlement without any checks for resources or surrounding settlements
         settlements[intersectionID].insert(playerID);
+        if (PlayerRegistry::isSeat(playerID))
+        {
+            settlementsBySeat[static_cast<size_t>(playerID)] |= bitOf(intersectionID);
+        }
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->settlementPlaced(playerID, intersectionID, true);
+        }
         cout << "Player " << playerID << " placed an initial settlement at intersection " << intersectionID << "." << endl;
     }
 
@@ -664,7 +581,14 @@ namespace ariel {
     void Board::placeInitialRoad(const Edge& edge, int playerID) 
     {
         // Place the road without checking for resources or connectivity to other roads
-        roads.insert({edge, playerID});
+        if (roads.insert({edge, playerID}).second && PlayerRegistry::isSeat(playerID))
+        {
+            roadEndsBySeat[static_cast<size_t>(playerID)] |= bitOf(edge.getId1()) | bitOf(edge.getId2());
+        }
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->roadPlaced(playerID, edge.getId1(), edge.getId2(), true);
+        }
         cout << "Player " << playerID << " placed an initial road between intersections " 
         << getIntersectionID(edge.getIntersection1()) << " and " << getIntersectionID(edge.getIntersection2()) << "." << endl;
     }
@@ -672,7 +596,8 @@ namespace ariel {
 
     /**
      * @brief Checks if a settlement can be legally placed at a given intersection by a player.
-     * This function checks if the intersection exists, is connected to a player's road, and is not adjacent to other settlements.
+     * This function checks if the intersection exists, is connected to a player's road, and that no settlement or city
+     * stands on it or next to it.
      * @param intersectionID The intersection ID where the settlement is to be placed.
      * @param playerID The identifier of the player attempting to place the settlement.
      * @return true If the settlement can be legally placed, false otherwise.
@@ -687,14 +612,11 @@ namespace ariel {
             return false;
         }
 
-        // Check for settlements too close to the desired location
-        for (int neighbor : adjacencyList[intersectionID])
+        // Check for buildings on the desired location or too close to it
+        if (!isOpenForSettlement(intersectionID))
         {
-            if (hasSettlement(neighbor)) 
-            {
-                cout << "Cannot place settlement: too close to another settlement." << endl;
-                return false;
-            }
+            cout << "Cannot place settlement: too close to another settlement." << endl;
+            return false;
         }
 
         return true; // Placement is valid
@@ -710,14 +632,7 @@ namespace ariel {
      */
     bool Board::isIntersectionConnectedToPlayerRoad(int intersectionID, int playerID) 
     {
-        for (const auto& [edge, ownerID] : roads) 
-        {
-            if (ownerID == playerID && (edge.getId1() == intersectionID || edge.getId2() == intersectionID)) 
-            {
-                return true;
-            }
-        }
-        return false;
+        return PlayerRegistry::isSeat(playerID) && (roadEndsBySeat[static_cast<size_t>(playerID)] & bitOf(intersectionID)) != 0;
     }
 
 
@@ -733,6 +648,11 @@ namespace ariel {
         if (canPlaceSettlement(intersectionID, playerID)) 
         {
             settlements[intersectionID].insert(playerID);
+            settlementsBySeat[static_cast<size_t>(playerID)] |= bitOf(intersectionID);
+            if (EventExporter* exporter = EventExporter::getActive())
+            {
+                exporter->settlementPlaced(playerID, intersectionID, false);
+            }
             cout << "Player " << playerID << " placed a settlement at intersection " << intersectionID << "." << endl;
         } 
         else 
@@ -756,23 +676,20 @@ namespace ariel {
             return false;
         }
 
-        // Check for connection to the player's settlements or existing roads
-        bool isConnected = false;
-        if ((settlements.find(newRoad.getId1()) != settlements.end() && settlements[newRoad.getId1()].count(playerID)) ||
-        (settlements.find(newRoad.getId2()) != settlements.end() && settlements[newRoad.getId2()].count(playerID))) 
+        // Check for connection to the player's settlements, cities or existing roads
+        if (!PlayerRegistry::isSeat(playerID))
         {
-            isConnected = true;
+            return false;
         }
-        
-        for (const auto& [existingEdge, existingPlayerID] : roads) 
+        // A road continues from the seat's buildings, or from its roads where no other seat has built
+        size_t seat = static_cast<size_t>(playerID);
+        uint64_t others = 0;
+        for (size_t other = 0; other < MAX_SEATS; ++other)
         {
-            if (existingPlayerID == playerID && (existingEdge.involvesIntersection(newRoad.getId1()) || existingEdge.involvesIntersection(newRoad.getId2()))) 
-            {
-                isConnected = true;
-                break;
-            }
+            others |= other != seat ? settlementsBySeat[other] | citiesBySeat[other] : 0;
         }
-        return isConnected;
+        uint64_t owned = settlementsBySeat[seat] | citiesBySeat[seat] | (roadEndsBySeat[seat] & ~others);
+        return (owned & (bitOf(newRoad.getId1()) | bitOf(newRoad.getId2()))) != 0;
     }
 
 
@@ -788,6 +705,11 @@ namespace ariel {
         if (canPlaceRoad(edge, playerID)) 
         {
             roads[edge] = playerID;     // Assign the road to the player
+            roadEndsBySeat[static_cast<size_t>(playerID)] |= bitOf(edge.getId1()) | bitOf(edge.getId2());
+            if (EventExporter* exporter = EventExporter::getActive())
+            {
+                exporter->roadPlaced(playerID, edge.getId1(), edge.getId2(), false);
+            }
             // cout << "Player " << playerID << " placed a road between intersections "
             // << getIntersectionID(edge.getIntersection1()) << " and " << getIntersectionID(edge.getIntersection2()) << "." << endl;
         } 
@@ -808,8 +730,7 @@ namespace ariel {
     bool Board::canUpgradeSettlementToCity(int intersectionID, int playerID) 
     {
         // Check if there's a settlement belonging to the player at the specified intersection
-        auto it = settlements.find(intersectionID);
-        if (it != settlements.end() && it->second.count(playerID) > 0) 
+        if (PlayerRegistry::isSeat(playerID) && (settlementsBySeat[static_cast<size_t>(playerID)] & bitOf(intersectionID)) != 0) 
         {
             // Check if the player has enough resources to upgrade (handled in Player class)
             return true;
@@ -837,6 +758,12 @@ namespace ariel {
 
             // Add to cities
             cities[intersectionID] = playerID;
+            settlementsBySeat[static_cast<size_t>(playerID)] &= ~bitOf(intersectionID);
+            citiesBySeat[static_cast<size_t>(playerID)] |= bitOf(intersectionID);
+            if (EventExporter* exporter = EventExporter::getActive())
+            {
+                exporter->cityUpgraded(playerID, intersectionID);
+            }
 
             cout << "Player " << playerID << " upgraded a settlement to a city at intersection " << intersectionID << "." << endl;
         } 
@@ -858,6 +785,27 @@ namespace ariel {
     }
 
 
+    /**
+     * @brief Checks the distance rule without printing: no settlement or city on the intersection or next to it.
+     * @param intersectionID The intersection ID to check.
+     * @return true If a settlement could be built there by a player whose roads reach it.
+     */
+    bool Board::isOpenForSettlement(int intersectionID) const
+    {
+        uint64_t occupied = 0;
+        for (size_t seat = 0; seat < MAX_SEATS; ++seat)
+        {
+            occupied |= settlementsBySeat[seat] | citiesBySeat[seat];
+        }
+        uint64_t spot = bitOf(intersectionID);
+        for (int neighbor : HexTopology::standard().neighbors(intersectionID))
+        {
+            spot |= bitOf(neighbor);
+        }
+        return bitOf(intersectionID) != 0 && (occupied & spot) == 0;
+    }
+
+
     /**
      * @brief Returns a map of cities and their respective owners.
      * @return map linking intersections with player IDs who own cities there.
@@ -868,6 +816,36 @@ namespace ariel {
     }
 
 
+    /**
+     * @brief Returns every road on the board with the ID of its owner.
+     */
+    const map<Edge, int>& Board::getRoads() const
+    {
+        return roads;
+    }
+
+
+    /**
+     * @brief Returns the settlements of a seat, one bit per intersection ID (0 for a player that is not seated).
+     */
+    uint64_t Board::getSettlementMask(int playerID) const
+    {
+        return PlayerRegistry::isSeat(playerID) ? settlementsBySeat[static_cast<size_t>(playerID)] : 0;
+    }
+
+
+    uint64_t Board::getCityMask(int playerID) const
+    {
+        return PlayerRegistry::isSeat(playerID) ? citiesBySeat[static_cast<size_t>(playerID)] : 0;
+    }
+
+
+    uint64_t Board::getRoadEndMask(int playerID) const
+    {
+        return PlayerRegistry::isSeat(playerID) ? roadEndsBySeat[static_cast<size_t>(playerID)] : 0;
+    }
+
+
      /**
      * @brief Checks if there is a road between two intersections for testing purposes.
      * @param intersectionID1 The first intersection ID.
@@ -889,11 +867,10 @@ namespace ariel {
         map<int, string> IL;                  // To hold settlement's player by ID (IL = Intersecntion Location)
         map<pair<int, int>, string> RL;  // To hold road's player by IDs(RL = Road Location)
 
-        // ANSI escape codes for colors
-        const string colorBlue = "\033[34m";    // Blue for Player 1
-        const string colorYellow = "\033[33m";  // Yellow for Player 2
-        const string colorGreen = "\033[32m";   // Green for Player 3 
+        // ANSI escape codes for colors, by seat: blue, yellow, green, red, magenta, cyan
+        static const string seatColors[MAX_SEATS] = {"\033[34m", "\033[33m", "\033[32m", "\033[31m", "\033[35m", "\033[36m"};
         const string colorReset = "\033[0m";    // Reset to default
+        auto colorOf = [&](int playerID) { return PlayerRegistry::isSeat(playerID) ? seatColors[static_cast<size_t>(playerID)] : colorReset; };
 
         
         // Initialize intersection labels with spaces or player IDs if a settlement/city is present
@@ -902,13 +879,13 @@ namespace ariel {
             if (settlements.find(i) != settlements.end() && !settlements.at(i).empty()) 
             {
                 int player = *settlements.at(i).begin();
-                string color = (player == 1 ? colorBlue : (player == 2 ? colorYellow : colorGreen));
+                string color = colorOf(player);
                 IL[i] = "|" + color + "S" + to_string(player) + colorReset + "|";
             } 
             else if (cities.find(i) != cities.end()) 
             {
                 int player = cities.at(i);
-                string color = (player == 1 ? colorBlue : (player == 2 ? colorYellow : colorGreen));
+                string color = colorOf(player);
                 IL[i] = "|" + color + "C" + to_string(player) + colorReset + "|";
             } 
             else 
@@ -940,7 +917,7 @@ namespace ariel {
         {
             int startID = getIntersectionID(edge.getIntersection1());
             int endID = getIntersectionID(edge.getIntersection2());
-            string color = (playerID == 1 ? colorBlue : (playerID == 2 ? colorYellow : colorGreen));
+            string color = colorOf(playerID);
             RL[{startID, endID}] = "{" + color + "R" + to_string(playerID) + colorReset + "}";
             RL[{endID, startID}] = "{" + color + "R" + to_string(playerID) + colorReset + "}";  // To ensure both directions are updated
         }
@@ -990,6 +967,160 @@ namespace ariel {
     }
 
 
+    /**
+     * @brief Numbers the tiles in board order and builds the mask of producing tiles of every dice number.
+     * The robber starts on the desert.
+     */
+    void Board::indexTiles()
+    {
+        tilePositions.clear();
+        fill(begin(tilesByNumber), end(tilesByNumber), 0u);
+        for (const auto& [position, tile] : tiles)
+        {
+            uint32_t bit = 1u << tilePositions.size();
+            tilePositions.push_back(position);
+            if (tile.getResourceType() != ResourceType::NONE && tile.getNumber() >= 0 && tile.getNumber() < 13)
+            {
+                tilesByNumber[tile.getNumber()] |= bit;
+            }
+            else
+            {
+                robber = position;
+            }
+        }
+        blockedTiles = 0;
+    }
+
+
+    /**
+     * @brief Moves the robber to a tile, which stops producing until the robber moves again.
+     * @param position The tile to move to.
+     * @return False if there is no tile there or the robber is already on it.
+     */
+    bool Board::moveRobber(const pair<int, int>& position)
+    {
+        auto index = find(tilePositions.begin(), tilePositions.end(), position);
+        if (index == tilePositions.end() || position == robber)
+        {
+            return false;
+        }
+        robber = position;
+        blockedTiles = 1u << (index - tilePositions.begin());
+        cout << "The robber moved to tile (" << position.first << "," << position.second << ")." << endl;
+        return true;
+    }
+
+
+    const pair<int, int>& Board::getRobberPosition() const
+    {
+        return robber;
+    }
+
+
+    uint32_t Board::getBlockedTiles() const
+    {
+        return blockedTiles;
+    }
+
+
+    /**
+     * @brief Returns the IDs of the players with a settlement or a city on the corners of a tile.
+     * @param position The tile.
+     */
+    set<int> Board::getPlayersAroundTile(const pair<int, int>& position) const
+    {
+        set<int> owners;
+        auto tile = tiles.find(position);
+        if (tile == tiles.end())
+        {
+            return owners;
+        }
+        for (int intersectionID : tile->second.getIntersectionIDs())
+        {
+            auto settlement = settlements.find(intersectionID);
+            if (settlement != settlements.end())
+            {
+                owners.insert(settlement->second.begin(), settlement->second.end());
+            }
+            auto city = cities.find(intersectionID);
+            if (city != cities.end())
+            {
+                owners.insert(city->second);
+            }
+        }
+        return owners;
+    }
+
+
+    /**
+     * @brief Suggests where a player should move the robber: the tile that takes the most production
+     * from the opponents (by the chance of its number, doubled for cities) and none from the player.
+     * @param playerID The player moving the robber.
+     * @return A tile other than the robber's current one.
+     */
+    pair<int, int> Board::suggestRobberPosition(int playerID) const
+    {
+        pair<int, int> best = robber;
+        int bestScore = -1;
+        for (const auto& [position, tile] : tiles)
+        {
+            if (position == robber)
+            {
+                continue;
+            }
+            int pips = tile.getResourceType() == ResourceType::NONE ? 0 : 6 - abs(7 - tile.getNumber());
+            int score = 0;
+            uint64_t own = PlayerRegistry::isSeat(playerID) ? settlementsBySeat[static_cast<size_t>(playerID)] | citiesBySeat[static_cast<size_t>(playerID)] : 0;
+            for (int intersectionID : tile.getIntersectionIDs())
+            {
+                if (own & bitOf(intersectionID))
+                {
+                    score = -1;         // Never block the player's own production
+                    break;
+                }
+                auto settlement = settlements.find(intersectionID);
+                auto city = cities.find(intersectionID);
+                score += (settlement != settlements.end() ? pips * static_cast<int>(settlement->second.size()) : 0) + (city != cities.end() ? 2 * pips : 0);
+            }
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = position;
+            }
+        }
+        if (best == robber)
+        {
+            // Every other tile touches the player; fall back to the first one
+            for (const auto& entry : tiles)
+            {
+                if (entry.first != robber)
+                {
+                    return entry.first;
+                }
+            }
+        }
+        return best;
+    }
+
+
+    /**
+     * @brief Returns how likely each resource is produced by a roll, as the sum over its tiles
+     * of the number of ways to roll the tile's number (1 for 2 and 12, up to 5 for 6 and 8).
+     */
+    void Board::getProductionWeights(ResourceVector& weights) const
+    {
+        weights = ResourceVector{};
+        for (const auto& [position, tile] : tiles)
+        {
+            ResourceType type = tile.getResourceType();
+            if (type >= WOOD && type <= ORE)
+            {
+                weights[type] += 6 - abs(7 - tile.getNumber());
+            }
+        }
+    }
+
+
     /**
      * @brief Reset the board for tests purposes.
      */
@@ -999,7 +1130,85 @@ namespace ariel {
     settlements.clear();
     cities.clear();
     roads.clear();
+    indexOccupancy();
     setupTiles();         
     linkTilesAndIntersections();
+    indexTiles();
+    }
+
+
+    /**
+     * @brief Replaces the resources and numbers of the tiles with a layout, and puts the robber on its desert.
+     * Buildings stay where they are, so the layout is meant to be applied before the game starts.
+     * @param layout The layout to apply, e.g. one from BoardGenerator.
+     */
+    void Board::applyLayout(const BoardLayout& layout)
+    {
+        tiles.clear();
+        for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+        {
+            addTile(BoardLayout::POSITIONS[tile], Tile(layout.resources[tile], layout.numbers[tile]));
+        }
+        linkTilesAndIntersections();
+        indexTiles();
+    }
+
+
+    /**
+     * @brief Reads the resources and numbers of the tiles into a layout, e.g. to score the board.
+     */
+    void Board::getLayout(BoardLayout& layout) const
+    {
+        for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+        {
+            const Tile& current = getTile(BoardLayout::POSITIONS[tile]);
+            layout.resources[tile] = current.getResourceType();
+            layout.numbers[tile] = static_cast<int8_t>(current.getNumber());
+        }
+    }
+
+
+    /**
+     * @brief Returns the bit of an intersection in the per-seat masks (0 for an ID outside the board).
+     */
+    uint64_t Board::bitOf(int intersectionID)
+    {
+        return intersectionID > 0 && intersectionID < 64 ? uint64_t{1} << intersectionID : 0;
+    }
+
+
+    /**
+     * @brief Rebuilds the per-seat masks from the occupancy maps, after they were cleared or restored.
+     */
+    void Board::indexOccupancy()
+    {
+        for (size_t seat = 0; seat < MAX_SEATS; ++seat)
+        {
+            settlementsBySeat[seat] = citiesBySeat[seat] = roadEndsBySeat[seat] = 0;
+        }
+        for (const auto& [intersectionID, owners] : settlements)
+        {
+            for (int owner : owners)
+            {
+                if (PlayerRegistry::isSeat(owner))
+                {
+                    settlementsBySeat[static_cast<size_t>(owner)] |= bitOf(intersectionID);
+                }
+            }
+        }
+        for (const auto& [intersectionID, owner] : cities)
+        {
+            if (PlayerRegistry::isSeat(owner))
+            {
+                citiesBySeat[static_cast<size_t>(owner)] |= bitOf(intersectionID);
+            }
+        }
+        for (const auto& [edge, owner] : roads)
+        {
+            if (PlayerRegistry::isSeat(owner))
+            {
+                roadEndsBySeat[static_cast<size_t>(owner)] |= bitOf(edge.getId1()) | bitOf(edge.getId2());
+            }
+        }
     }
 }
\ No newline at end of file
@@ -6,15 +6,25 @@
 #include <map>
 #include <set>
 #include <utility>
+#include <cstdint>
 #include "tile.hpp"
 #include "intersection.hpp"
 #include "edge.hpp"
 #include "player.hpp"
+#include "registry.hpp"
 
 
 namespace ariel {
+
+    /**
+     * @brief Harbor access bits: bit r (WOOD to ORE) for the 2:1 harbor of resource r, and one bit for the 3:1 harbors.
+     */
+    constexpr uint8_t GENERIC_HARBOR = 1u << RESOURCE_TYPES;
+
     class Player;
     class Tile;
+    class GameCheckpoint;
+    struct BoardLayout;
     
     
     /**
@@ -24,24 +34,39 @@ namespace ariel {
     {
         private:
 
-            // Private constructors since board is singelton
-            Board();
-
             map<pair<int, int>, Tile> tiles;                // Maps tiles by their grid coordinates
             map<int, std::set<int>> settlements;            // Tracks which player has settlements at each vertex
             std::map<int, int> cities;                      // Maps intersection IDs to player IDs for cities
             map<Edge, int> roads;                           // Maps edges (roads) to player IDs
             static map<int, std::set<int>> adjacencyList;   // Adjacency list for all intersections for placing a valid road
+            vector<pair<int, int>> tilePositions;           // Position of each tile by its index (bit) in the tile masks
+            uint32_t tilesByNumber[13];                     // Mask of the producing tiles of each dice number
+            uint32_t blockedTiles;                          // Mask of the tiles that do not produce (the robber's tile)
+            pair<int, int> robber;                          // Position of the robber, starts on the desert
+            uint64_t settlementsBySeat[MAX_SEATS];          // Settlements of each seat, one bit per intersection ID
+            uint64_t citiesBySeat[MAX_SEATS];               // Cities of each seat, as above
+            uint64_t roadEndsBySeat[MAX_SEATS];             // Intersections touched by the roads of each seat, as above
+
+            void indexTiles();
+            void indexOccupancy();                          // Rebuilds the per-seat masks from the maps above
+            static uint64_t bitOf(int intersectionID);
+
+            friend class GameCheckpoint;                    // Saves and restores the occupancy
 
         public:
 
-            // Static method to access the singleton instance
+            // Constructs a standalone board (one per game when several games share a process)
+            Board();
+
+            // Static method to access the shared instance used by the interactive game
             static Board& getInstance();
 
             // Game board setup methods
             void setupTiles();
             void linkTilesAndIntersections(); 
             static void initializeAdjacency();
+            void applyLayout(const BoardLayout& layout);    // Replaces the tiles, e.g. with a generated board (see boardgen.hpp)
+            void getLayout(BoardLayout& layout) const;
 
             // Tile and board display methods
             const Tile& getTile(const pair<int, int>& position) const;
@@ -70,8 +95,24 @@ namespace ariel {
             bool areIntersectionsAdjacent(int id1, int id2);
             void distributeResourcesBasedOnDiceRoll(int diceRoll, const std::vector<Player*>& players);
             bool hasSettlement(int intersectionID);
+            bool isOpenForSettlement(int intersectionID) const;     // No building on it or next to it (quiet, for bots)
             vector<Tile> getTilesAroundIntersection(int intersectionID) const;
             const map<int, int>& getCities() const;
+            const map<Edge, int>& getRoads() const;            // Every road with the ID of its owner
+            uint64_t getSettlementMask(int playerID) const;     // Settlements of a seat, one bit per intersection ID (0 if not seated)
+            uint64_t getCityMask(int playerID) const;           // Cities of a seat, as above
+            uint64_t getRoadEndMask(int playerID) const;        // Intersections touched by the roads of a seat, as above
+            static uint8_t harborAt(int intersectionID);    // Harbor access bits of a coastal intersection (0 inland)
+
+            // Robber methods
+            bool moveRobber(const pair<int, int>& position);
+            const pair<int, int>& getRobberPosition() const;
+            uint32_t getBlockedTiles() const;
+            set<int> getPlayersAroundTile(const pair<int, int>& position) const;
+            pair<int, int> suggestRobberPosition(int playerID) const;
+
+            // Chances of production of every resource (sum over its tiles of the ways to roll their numbers)
+            void getProductionWeights(ResourceVector& weights) const;
 
             // Functions for tests
             bool isRoadPresent(int intersectionID1, int intersectionID2) const;
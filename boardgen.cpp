@@ -0,0 +1,335 @@
+// Email: origoldbsc@gmail.com
+
+#include "boardgen.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        /**
+         * @brief Neighbor masks of the tiles, from the positions: tiles touch at (±1,0), (0,±1), (1,1) and (-1,-1).
+         */
+        constexpr array<uint32_t, BOARD_TILES> makeNeighbors()
+        {
+            array<uint32_t, BOARD_TILES> masks{};
+            for (size_t i = 0; i < BOARD_TILES; ++i)
+            {
+                for (size_t j = 0; j < BOARD_TILES; ++j)
+                {
+                    int dx = BoardLayout::POSITIONS[j].first - BoardLayout::POSITIONS[i].first;
+                    int dy = BoardLayout::POSITIONS[j].second - BoardLayout::POSITIONS[i].second;
+                    bool touching = (dx == 0 && (dy == 1 || dy == -1)) || (dy == 0 && (dx == 1 || dx == -1))
+                                    || (dx == 1 && dy == 1) || (dx == -1 && dy == -1);
+                    if (touching)
+                    {
+                        masks[i] |= 1u << j;
+                    }
+                }
+            }
+            return masks;
+        }
+
+        constexpr array<uint32_t, BOARD_TILES> NEIGHBORS = makeNeighbors();
+
+        /**
+         * @brief The inland intersections, as the three tiles around each (three tiles that all touch each other).
+         */
+        constexpr size_t INLAND_INTERSECTIONS = 24;
+
+        constexpr size_t countCorners()
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < BOARD_TILES; ++i)
+            {
+                for (size_t j = i + 1; j < BOARD_TILES; ++j)
+                {
+                    for (size_t k = j + 1; k < BOARD_TILES; ++k)
+                    {
+                        count += (NEIGHBORS[i] >> j & 1u) && (NEIGHBORS[i] >> k & 1u) && (NEIGHBORS[j] >> k & 1u);
+                    }
+                }
+            }
+            return count;
+        }
+
+        static_assert(countCorners() == INLAND_INTERSECTIONS, "The board has 24 inland intersections");
+
+        constexpr array<array<uint8_t, 3>, INLAND_INTERSECTIONS> makeCorners()
+        {
+            array<array<uint8_t, 3>, INLAND_INTERSECTIONS> corners{};
+            size_t count = 0;
+            for (size_t i = 0; i < BOARD_TILES; ++i)
+            {
+                for (size_t j = i + 1; j < BOARD_TILES; ++j)
+                {
+                    for (size_t k = j + 1; k < BOARD_TILES; ++k)
+                    {
+                        if ((NEIGHBORS[i] >> j & 1u) && (NEIGHBORS[i] >> k & 1u) && (NEIGHBORS[j] >> k & 1u))
+                        {
+                            corners[count++] = {static_cast<uint8_t>(i), static_cast<uint8_t>(j), static_cast<uint8_t>(k)};
+                        }
+                    }
+                }
+            }
+            return corners;
+        }
+
+        constexpr array<array<uint8_t, 3>, INLAND_INTERSECTIONS> CORNERS = makeCorners();
+
+        constexpr array<ResourceType, BOARD_TILES> RESOURCE_TILES = {
+            WOOD, WOOD, WOOD, WOOD, BRICK, BRICK, BRICK, WOOL, WOOL, WOOL, WOOL,
+            GRAIN, GRAIN, GRAIN, GRAIN, ORE, ORE, ORE, NONE
+        };
+
+        constexpr array<int8_t, BOARD_TILES - 1> NUMBER_TOKENS = {2, 3, 3, 4, 4, 5, 5, 6, 6, 8, 8, 9, 9, 10, 10, 11, 11, 12};
+
+        constexpr int TOTAL_PIPS = 58;      // Pips of all the number tokens
+
+        /**
+         * @brief Ways to roll a number with two dice (0 for the desert).
+         */
+        constexpr int pips(int number)
+        {
+            return number >= 2 && number <= 12 ? 6 - abs(7 - number) : 0;
+        }
+
+        constexpr bool isRed(int number)
+        {
+            return number == 6 || number == 8;
+        }
+
+        /**
+         * @brief splitmix64, spreads a seed over all the bits of the state.
+         */
+        uint64_t mix(uint64_t value)
+        {
+            value += 0x9E3779B97F4A7C15ull;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+    }
+
+
+    /**
+     * @brief Returns a mask of the tiles sharing a side with a tile, one bit per tile index.
+     */
+    uint32_t BoardLayout::neighbors(size_t tile)
+    {
+        return tile < BOARD_TILES ? NEIGHBORS[tile] : 0;
+    }
+
+
+    /**
+     * @brief Returns true if the layout has the standard resources and tokens and no 6 or 8 is next to another 6 or 8.
+     */
+    bool BoardLayout::isLegal() const
+    {
+        int resourceCounts[NONE + 1] = {};
+        int tokenCounts[13] = {};
+        uint32_t red = 0;
+        for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+        {
+            if (resources[tile] < WOOD || resources[tile] > NONE || numbers[tile] < 0 || numbers[tile] > 12
+                || (resources[tile] == NONE) != (numbers[tile] == 0))
+            {
+                return false;
+            }
+            ++resourceCounts[resources[tile]];
+            ++tokenCounts[numbers[tile]];
+            red |= isRed(numbers[tile]) ? 1u << tile : 0;
+        }
+
+        int expectedResources[NONE + 1] = {};
+        int expectedTokens[13] = {};
+        for (ResourceType resource : RESOURCE_TILES)
+        {
+            ++expectedResources[resource];
+        }
+        ++expectedTokens[0];
+        for (int8_t token : NUMBER_TOKENS)
+        {
+            ++expectedTokens[token];
+        }
+        if (!equal(begin(resourceCounts), end(resourceCounts), begin(expectedResources))
+            || !equal(begin(tokenCounts), end(tokenCounts), begin(expectedTokens)))
+        {
+            return false;
+        }
+
+        for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+        {
+            if ((red >> tile & 1u) && (NEIGHBORS[tile] & red))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    BoardGenerator::BoardGenerator(uint64_t seed) : state(mix(seed))
+    {
+        if (state == 0)
+        {
+            state = 1;
+        }
+    }
+
+
+    /**
+     * @brief Returns a number in [0, bound) from the high bits of a xorshift64* step.
+     */
+    uint32_t BoardGenerator::below(uint32_t bound)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        uint64_t high = (state * 0x2545F4914F6CDD1Dull) >> 32;
+        return static_cast<uint32_t>((high * bound) >> 32);
+    }
+
+
+    /**
+     * @brief Fills a layout with a random legal board.
+     */
+    void BoardGenerator::generate(BoardLayout& layout)
+    {
+        copy(RESOURCE_TILES.begin(), RESOURCE_TILES.end(), layout.resources);
+        for (uint32_t last = BOARD_TILES - 1; last > 0; --last)
+        {
+            swap(layout.resources[last], layout.resources[below(last + 1)]);
+        }
+
+        // Shuffle the tokens until the 6s and 8s land apart; about one shuffle in seven is legal
+        array<int8_t, BOARD_TILES - 1> tokens = NUMBER_TOKENS;
+        while (true)
+        {
+            for (uint32_t last = BOARD_TILES - 2; last > 0; --last)
+            {
+                swap(tokens[last], tokens[below(last + 1)]);
+            }
+
+            uint32_t red = 0;
+            size_t next = 0;
+            for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+            {
+                layout.numbers[tile] = layout.resources[tile] == NONE ? 0 : tokens[next++];
+                red |= isRed(layout.numbers[tile]) ? 1u << tile : 0;
+            }
+
+            bool apart = true;
+            for (uint32_t rest = red; rest != 0 && apart; rest &= rest - 1)
+            {
+                apart = (NEIGHBORS[static_cast<size_t>(__builtin_ctz(rest))] & red) == 0;
+            }
+            if (apart)
+            {
+                return;
+            }
+        }
+    }
+
+
+    /**
+     * @brief Scores a layout for fairness: pip imbalance, plus CLUSTER_WEIGHT per clustered pair, plus
+     * HOT_SPOT_WEIGHT per pip that the richest intersection has above HOT_SPOT_PIPS.
+     */
+    BoardScore BoardGenerator::score(const BoardLayout& layout)
+    {
+        BoardScore result{};
+        int tilePips[BOARD_TILES];
+        int resourcePips[RESOURCE_TYPES] = {};
+        int resourceTiles[RESOURCE_TYPES] = {};
+        for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+        {
+            tilePips[tile] = pips(layout.numbers[tile]);
+            if (layout.resources[tile] == NONE)
+            {
+                continue;
+            }
+            resourcePips[layout.resources[tile]] += tilePips[tile];
+            ++resourceTiles[layout.resources[tile]];
+
+            // Count each pair once, from its lower tile
+            for (uint32_t rest = NEIGHBORS[tile] & ~((2u << tile) - 1); rest != 0; rest &= rest - 1)
+            {
+                result.clusteredPairs += layout.resources[__builtin_ctz(rest)] == layout.resources[tile];
+            }
+        }
+
+        // An even share gives every resource tile the average pips of a token
+        for (size_t resource = 0; resource < RESOURCE_TYPES; ++resource)
+        {
+            double share = static_cast<double>(resourceTiles[resource] * TOTAL_PIPS) / static_cast<double>(BOARD_TILES - 1);
+            result.pipImbalance += fabs(resourcePips[resource] - share);
+        }
+
+        for (const array<uint8_t, 3>& corner : CORNERS)
+        {
+            result.maxIntersectionPips = max(result.maxIntersectionPips, tilePips[corner[0]] + tilePips[corner[1]] + tilePips[corner[2]]);
+        }
+
+        result.total = result.pipImbalance + CLUSTER_WEIGHT * result.clusteredPairs
+                       + HOT_SPOT_WEIGHT * max(0, result.maxIntersectionPips - HOT_SPOT_PIPS);
+        return result;
+    }
+
+
+    /**
+     * @brief Rejection sampling: generates boards on several threads until one scores at most maxScore.
+     * Thread i draws from a generator seeded with seed and i, so one thread always returns the same board
+     * for a seed; with more threads the board returned is whichever is found first.
+     * @param maxScore The highest score accepted.
+     * @param threads Threads to run (at least 1).
+     * @param budget The most boards to generate in total before giving up.
+     */
+    BoardGenerator::Sample BoardGenerator::findBalanced(uint64_t seed, double maxScore, size_t threads, size_t budget)
+    {
+        threads = max<size_t>(threads, 1);
+        Sample sample{};
+        atomic<bool> found(false);
+        atomic<size_t> generated(0);
+
+        auto search = [&](size_t index) {
+            BoardGenerator generator(seed ^ mix(index));
+            BoardLayout layout;
+            size_t share = budget / threads + (index < budget % threads ? 1 : 0);
+            size_t count = 0;
+            while (count < share && !found.load(memory_order_relaxed))
+            {
+                generator.generate(layout);
+                ++count;
+                BoardScore boardScore = score(layout);
+                bool expected = false;
+                if (boardScore.total <= maxScore && found.compare_exchange_strong(expected, true))
+                {
+                    sample.layout = layout;     // Only the first thread to find a board writes it
+                    sample.score = boardScore;
+                }
+            }
+            generated.fetch_add(count, memory_order_relaxed);
+        };
+
+        vector<thread> workers;
+        for (size_t index = 1; index < threads; ++index)
+        {
+            workers.emplace_back(search, index);
+        }
+        search(0);
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        sample.found = found.load();
+        sample.generated = generated.load();
+        return sample;
+    }
+}
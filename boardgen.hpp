@@ -0,0 +1,120 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef BOARDGEN_HPP
+#define BOARDGEN_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Board;
+
+    constexpr size_t BOARD_TILES = 19;
+
+
+    /**
+     * @brief The resources and number tokens of a board, one entry per tile.
+     * Tiles are listed row by row from the top, in the order of Board::setupTiles (see POSITIONS).
+     */
+    struct BoardLayout
+    {
+        static constexpr array<pair<int, int>, BOARD_TILES> POSITIONS = {{
+            {0, 2}, {1, 2}, {2, 2},
+            {-1, 1}, {0, 1}, {1, 1}, {2, 1},
+            {-2, 0}, {-1, 0}, {0, 0}, {1, 0}, {2, 0},
+            {-2, -1}, {-1, -1}, {0, -1}, {1, -1},
+            {-2, -2}, {-1, -2}, {0, -2}
+        }};
+
+        ResourceType resources[BOARD_TILES];    // Resource of each tile (NONE for the desert)
+        int8_t numbers[BOARD_TILES];            // Number token of each tile (0 for the desert)
+
+        /**
+         * @brief Returns a mask of the tiles sharing a side with a tile, one bit per tile index.
+         */
+        static uint32_t neighbors(size_t tile);
+
+        /**
+         * @brief Returns true if the layout has the standard resources and tokens and no 6 or 8 is next to another 6 or 8.
+         */
+        bool isLegal() const;
+    };
+
+
+    /**
+     * @brief How fair a board is: lower is fairer, 0 cannot be reached by a legal board.
+     */
+    struct BoardScore
+    {
+        double pipImbalance;        // Sum over the resources of how far their pips are from an even share per tile
+        int clusteredPairs;         // Neighboring tiles of the same resource
+        int maxIntersectionPips;    // Pips of the richest inland intersection
+        double total;               // The three above combined (see BoardGenerator::score)
+    };
+
+
+    /**
+     * @brief Generates random legal boards and scores them for fairness.
+     *
+     * Each generator owns a small xorshift random source, so one generator per thread runs without any
+     * shared state. A board is a shuffle of the 18 resource tiles and the desert, and a shuffle of the
+     * 18 number tokens which is drawn again until no 6 or 8 touches another (every legal token placement
+     * is equally likely). Tiles and neighbors are kept as 19-bit masks, so a board costs about a microsecond
+     * to generate and score in an optimized build (BoardGenerator::generate+score in the benchmarks).
+     */
+    class BoardGenerator
+    {
+        private:
+
+            uint64_t state;     // xorshift64* state, never 0
+
+            uint32_t below(uint32_t bound);     // Uniform in [0, bound)
+
+        public:
+
+            static constexpr double CLUSTER_WEIGHT = 1.0;           // Score per pair of neighboring tiles of the same resource
+            static constexpr int HOT_SPOT_PIPS = 11;                // Intersection pips above this add to the score
+            static constexpr double HOT_SPOT_WEIGHT = 1.0;          // Score per pip above HOT_SPOT_PIPS
+
+            explicit BoardGenerator(uint64_t seed);
+
+            /**
+             * @brief Fills a layout with a random legal board.
+             */
+            void generate(BoardLayout& layout);
+
+            /**
+             * @brief Scores a layout for fairness: pip imbalance, plus CLUSTER_WEIGHT per clustered pair, plus
+             * HOT_SPOT_WEIGHT per pip that the richest intersection has above HOT_SPOT_PIPS.
+             */
+            static BoardScore score(const BoardLayout& layout);
+
+            /**
+             * @brief The outcome of a search for a balanced board.
+             */
+            struct Sample
+            {
+                BoardLayout layout;     // The board found (undefined if none was found)
+                BoardScore score;
+                size_t generated;       // Boards generated by all threads
+                bool found;
+            };
+
+            /**
+             * @brief Rejection sampling: generates boards on several threads until one scores at most maxScore.
+             * Thread i draws from a generator seeded with seed and i, so one thread always returns the same board
+             * for a seed; with more threads the board returned is whichever is found first.
+             * @param maxScore The highest score accepted.
+             * @param threads Threads to run (at least 1).
+             * @param budget The most boards to generate in total before giving up.
+             */
+            static Sample findBalanced(uint64_t seed, double maxScore, size_t threads, size_t budget);
+    };
+}
+
+#endif
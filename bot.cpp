@@ -0,0 +1,388 @@
+// Email: origoldbsc@gmail.com
+
+#include "bot.hpp"
+#include "board.hpp"
+#include "player.hpp"
+#include "cards.hpp"
+#include "topology.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    //-------------------------------------//
+    //             BotWeights              //
+    //-------------------------------------//
+
+    /**
+     * @brief Reads weights from a stream.
+     * @throws invalid_argument on an unknown name or a value that is not a number.
+     */
+    BotWeights BotWeights::fromStream(istream& in)
+    {
+        BotWeights weights;
+        pair<const char*, double*> fields[] = {
+            {"income", &weights.income}, {"diversity", &weights.diversity}, {"distance", &weights.distance},
+            {"points", &weights.points}, {"cards", &weights.cards}, {"expansion", &weights.expansion}
+        };
+
+        string line;
+        while (getline(in, line))
+        {
+            istringstream words(line.substr(0, line.find('#')));
+            string name;
+            if (!(words >> name))
+            {
+                continue;       // Blank or comment line
+            }
+            auto field = find_if(begin(fields), end(fields), [&](const pair<const char*, double*>& entry) { return name == entry.first; });
+            if (field == end(fields))
+            {
+                throw invalid_argument("Unknown bot weight: " + name);
+            }
+            if (!(words >> *field->second))
+            {
+                throw invalid_argument("Bot weight " + name + " needs a number");
+            }
+        }
+        return weights;
+    }
+
+
+    /**
+     * @brief Reads weights from a config file.
+     * @throws runtime_error if the file cannot be opened, invalid_argument as fromStream().
+     */
+    BotWeights BotWeights::fromFile(const string& path)
+    {
+        ifstream in(path);
+        if (!in)
+        {
+            throw runtime_error("Cannot open bot weights file: " + path);
+        }
+        return fromStream(in);
+    }
+
+
+    //-------------------------------------//
+    //            BotEvaluator             //
+    //-------------------------------------//
+
+    BotEvaluator::BotEvaluator(const Board& board, const BotWeights& weights) : weights(weights), production()
+    {
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            for (const Tile& tile : board.getTilesAroundIntersection(id))
+            {
+                int number = tile.getNumber();
+                if (tile.getResourceType() != ResourceType::NONE && number >= 2 && number <= 12)
+                {
+                    production[id][tile.getResourceType()] += static_cast<float>(6 - abs(7 - number)) / 36.0f;
+                }
+            }
+        }
+    }
+
+
+    /**
+     * @brief Returns the score of a position, higher is better.
+     */
+    double BotEvaluator::evaluate(const BotPosition& position) const
+    {
+        double income = 0;
+        int produced = 0;
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            income += position.income[type];
+            produced += position.income[type] > 0 ? 1 : 0;
+        }
+        return weights.income * income + weights.diversity * produced - weights.distance * distanceToBuild(position.hand)
+               + weights.points * position.points + weights.cards * position.cards + weights.expansion * position.frontier;
+    }
+
+
+    /**
+     * @brief Adds the production of a building to a position (multiplier 1 for a settlement, 2 for a city,
+     * and 1 again when a settlement becomes a city).
+     */
+    void BotEvaluator::addProduction(BotPosition& position, int intersectionID, int multiplier) const
+    {
+        if (intersectionID < 1 || intersectionID > INTERSECTIONS)
+        {
+            return;
+        }
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            position.income[type] += static_cast<float>(multiplier) * production[intersectionID][type];
+        }
+    }
+
+
+    /**
+     * @brief Returns the resources expected per roll from a settlement at an intersection.
+     */
+    float BotEvaluator::siteValue(int intersectionID) const
+    {
+        if (intersectionID < 1 || intersectionID > INTERSECTIONS)
+        {
+            return 0;
+        }
+        float value = 0;
+        for (float income : production[intersectionID])
+        {
+            value += income;
+        }
+        return value;
+    }
+
+
+    /**
+     * @brief Returns the fewest resources the hand is missing for a settlement, a city or a development card.
+     */
+    int BotEvaluator::distanceToBuild(const ResourceVector& hand)
+    {
+        int closest = 0;
+        bool first = true;
+        for (Structure structure : {Structure::SETTLEMENT, Structure::CITY, Structure::DEVELOPMENT_CARD})
+        {
+            ResourceVector missing = Player::costOf(structure) - hand;
+            missing &= missing > 0;         // Lanes already covered count as 0
+            int total = totalResources(missing);
+            closest = first ? total : min(closest, total);
+            first = false;
+        }
+        return closest;
+    }
+
+
+    const BotWeights& BotEvaluator::getWeights() const
+    {
+        return weights;
+    }
+
+
+    //-------------------------------------//
+    //              BotAgent               //
+    //-------------------------------------//
+
+    BotAgent::BotAgent(Catan& game, const BotWeights& weights)
+        : game(game), evaluator(game.getBoard(), weights), rejected(false)
+    {
+        const HexTopology& topology = HexTopology::standard();
+        for (size_t index = 0; index < topology.edgeCount(); ++index)
+        {
+            edges.emplace_back(Intersection::getIntersection(topology.edge(index).first), Intersection::getIntersection(topology.edge(index).second));
+        }
+    }
+
+
+    /**
+     * @brief Reads the hand, production and progress of a player (the frontier is left at 0).
+     */
+    void BotAgent::readPosition(const Player& player, BotPosition& position) const
+    {
+        position.hand = player.getResources();
+        fill(begin(position.income), end(position.income), 0.0f);
+        for (int settlement : player.getSettlements())
+        {
+            evaluator.addProduction(position, settlement, 1);
+        }
+        for (int city : player.getCities())
+        {
+            evaluator.addProduction(position, city, 2);
+        }
+        position.frontier = 0;
+        position.points = player.getPoints();
+        position.cards = 0;
+        for (const auto& [type, count] : player.getDevelopmentCards())
+        {
+            position.cards += count;
+        }
+    }
+
+
+    /**
+     * @brief Returns the command of the best scoring move, or "end" if no move scores better than ending the turn.
+     * @param canTrade True if bank trades are allowed (not in the special build phase).
+     */
+    string BotAgent::chooseAction(const Player& player, bool canTrade)
+    {
+        Board& board = game.getBoard();
+        int playerID = player.getId();
+        BotPosition current;
+        readPosition(player, current);
+        planner.update(board, playerID);
+
+        // The open spots the roads reach: the best is the frontier, the second best remains after settling the best
+        int bestSpot = 0;
+        float secondFrontier = 0;
+        for (int id = 1; id <= BotEvaluator::INTERSECTIONS; ++id)
+        {
+            if (planner.roadsTo(id) == 0)
+            {
+                float value = evaluator.siteValue(id);
+                if (value > current.frontier)
+                {
+                    secondFrontier = current.frontier;
+                    current.frontier = value;
+                    bestSpot = id;
+                }
+                else
+                {
+                    secondFrontier = max(secondFrontier, value);
+                }
+            }
+        }
+
+        double best = evaluator.evaluate(current);
+        string command = "end";
+        auto consider = [&](const BotPosition& after, const auto& describe) {
+            double score = evaluator.evaluate(after);
+            if (score > best)
+            {
+                best = score;
+                command = describe();
+            }
+        };
+
+        if (player.canBuild(Structure::CITY))
+        {
+            for (int settlement : player.getSettlements())
+            {
+                BotPosition after = current;
+                after.hand -= Player::costOf(Structure::CITY);
+                evaluator.addProduction(after, settlement, 1);
+                ++after.points;
+                consider(after, [&]() { return "city " + to_string(settlement); });
+            }
+        }
+
+        if (player.canBuild(Structure::SETTLEMENT) && current.frontier > 0)
+        {
+            for (int id = 1; id <= BotEvaluator::INTERSECTIONS; ++id)
+            {
+                if (planner.roadsTo(id) == 0)
+                {
+                    BotPosition after = current;
+                    after.hand -= Player::costOf(Structure::SETTLEMENT);
+                    evaluator.addProduction(after, id, 1);
+                    ++after.points;
+                    after.frontier = id == bestSpot ? secondFrontier : current.frontier;
+                    consider(after, [&]() { return "settle " + to_string(id); });
+                }
+            }
+        }
+
+        if (player.canBuild(Structure::ROAD))
+        {
+            for (const Edge& edge : edges)
+            {
+                if (!board.canPlaceRoad(edge, playerID))
+                {
+                    continue;
+                }
+                BotPosition after = current;
+                after.hand -= Player::costOf(Structure::ROAD);
+                for (int tip : {edge.getId1(), edge.getId2()})
+                {
+                    if (planner.roadsTo(tip) == 1)
+                    {
+                        after.frontier = max(after.frontier, evaluator.siteValue(tip));
+                    }
+                }
+                consider(after, [&]() { return "road " + to_string(edge.getId1()) + " " + to_string(edge.getId2()); });
+            }
+        }
+
+        if (player.canBuild(Structure::DEVELOPMENT_CARD))
+        {
+            BotPosition after = current;
+            after.hand -= Player::costOf(Structure::DEVELOPMENT_CARD);
+            ++after.cards;
+            consider(after, []() { return string("buy"); });
+        }
+
+        if (canTrade)
+        {
+            for (int give = WOOD; give <= ORE; ++give)
+            {
+                int rate = player.getBankRate(static_cast<ResourceType>(give));
+                if (current.hand[give] < rate)
+                {
+                    continue;
+                }
+                for (int get = WOOD; get <= ORE; ++get)
+                {
+                    if (get == give)
+                    {
+                        continue;
+                    }
+                    BotPosition after = current;
+                    after.hand[give] -= rate;
+                    after.hand[get] += 1;
+                    consider(after, [&]() {
+                        return "bank " + resourceTypeToString(static_cast<ResourceType>(give)) + " " + resourceTypeToString(static_cast<ResourceType>(get));
+                    });
+                }
+            }
+        }
+        return command;
+    }
+
+
+    bool BotAgent::decide(const DecisionRequest& request, string& command)
+    {
+        const Player& player = *game.getPlayers()[request.seat];
+        switch (request.type)
+        {
+            case DecisionType::PreRoll:
+            {
+                rejected = false;
+                auto held = player.getDevelopmentCards().find(DevCardType::VICTORY_POINT);
+                bool winningCard = held != player.getDevelopmentCards().end() && held->second > 0 && player.getPoints() + 1 >= EndgameSolver::WIN_POINTS;
+                command = winningCard ? "use vp" : "roll";
+                break;
+            }
+            case DecisionType::Discard:
+                command = "discard auto build";
+                break;
+            case DecisionType::Robber:
+                command = "robber";
+                break;
+            case DecisionType::Action:
+                if (!rejected && EndgameSolver::isEndgame(game, request.seat))
+                {
+                    EndgameMove move = endgame.bestMove(game, request.seat);
+                    if (move.probability > 0)
+                    {
+                        command = move.command;
+                        break;
+                    }
+                }
+                command = rejected ? "end" : chooseAction(player, true);
+                break;
+            case DecisionType::SpecialBuild:
+                command = rejected ? "end" : chooseAction(player, false);
+                break;
+        }
+        return true;
+    }
+
+
+    /**
+     * @brief Remembers a rejected command, so the bot ends its turn instead of sending it again.
+     */
+    void BotAgent::notify(const string& reply)
+    {
+        rejected = reply.rfind("err", 0) == 0;
+    }
+
+
+    const BotEvaluator& BotAgent::getEvaluator() const
+    {
+        return evaluator;
+    }
+}
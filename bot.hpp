@@ -0,0 +1,137 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef BOT_HPP
+#define BOT_HPP
+
+#include <istream>
+#include <string>
+#include <vector>
+#include "endgame.hpp"
+#include "roadplan.hpp"
+#include "turnengine.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief Weights of the bots' evaluation. Read from a config file of "<name> <value>" lines, where
+     * '#' starts a comment and names that are left out keep their defaults.
+     */
+    struct BotWeights
+    {
+        double income = 12.0;       // Per resource expected per roll from the player's buildings
+        double diversity = 0.6;     // Per resource type the player produces
+        double distance = 0.4;      // Per resource missing for the closest settlement, city or card (subtracted)
+        double points = 3.0;        // Per victory point
+        double cards = 0.7;         // Per development card held
+        double expansion = 4.0;     // Per resource expected per roll from the best settlement spot the roads reach
+
+        /**
+         * @brief Reads weights from a stream.
+         * @throws invalid_argument on an unknown name or a value that is not a number.
+         */
+        static BotWeights fromStream(istream& in);
+
+        /**
+         * @brief Reads weights from a config file.
+         * @throws runtime_error if the file cannot be opened, invalid_argument as fromStream().
+         */
+        static BotWeights fromFile(const string& path);
+    };
+
+
+    /**
+     * @brief What a bot evaluates: a player's hand, production and progress, before or after a move.
+     */
+    struct BotPosition
+    {
+        ResourceVector hand;                    // Resources held
+        float income[RESOURCE_TYPES];           // Resources expected per roll from the buildings
+        float frontier;                         // Resources expected per roll from the best open spot the roads reach
+        int points;                             // Victory points
+        int cards;                              // Development cards held
+    };
+
+
+    /**
+     * @brief Scores positions with a weighted sum of their features.
+     *
+     * The production of every intersection is read from the board once, when the evaluator is created, so
+     * evaluating a position or applying a building to it only touches fixed-size arrays and never allocates.
+     * The robber is not taken into account.
+     */
+    class BotEvaluator
+    {
+        public:
+
+            static constexpr int INTERSECTIONS = 54;
+
+        private:
+
+            BotWeights weights;
+            float production[INTERSECTIONS + 1][RESOURCE_TYPES];   // Resources expected per roll at each intersection
+
+        public:
+
+            BotEvaluator(const Board& board, const BotWeights& weights);
+
+            /**
+             * @brief Returns the score of a position, higher is better.
+             */
+            double evaluate(const BotPosition& position) const;
+
+            /**
+             * @brief Adds the production of a building to a position (multiplier 1 for a settlement, 2 for a city,
+             * and 1 again when a settlement becomes a city).
+             */
+            void addProduction(BotPosition& position, int intersectionID, int multiplier) const;
+
+            /**
+             * @brief Returns the resources expected per roll from a settlement at an intersection.
+             */
+            float siteValue(int intersectionID) const;
+
+            /**
+             * @brief Returns the fewest resources the hand is missing for a settlement, a city or a development card.
+             */
+            static int distanceToBuild(const ResourceVector& hand);
+
+            const BotWeights& getWeights() const;
+    };
+
+
+    /**
+     * @brief A bot seat: rolls, discards with the closest-build policy, places the robber on the suggested tile,
+     * and in its actions tries every legal build, card purchase and bank trade, keeping the one that scores best.
+     * The turn ends when no move scores better than ending it. Moves are checked with the board's placement rules,
+     * and a move the engine rejects ends the turn.
+     *
+     * In the endgame (see EndgameSolver::isEndgame) the actions are searched instead, and the move with the best
+     * chance to win within the next turns is played; the evaluation takes over again when no line wins in time.
+     * A victory point card that wins is played before the roll.
+     */
+    class BotAgent : public SeatAgent
+    {
+        private:
+
+            Catan& game;
+            BotEvaluator evaluator;
+            EndgameSolver endgame;
+            RoadPlanner planner;        // Routes of the seat's roads, updated at every action
+            vector<Edge> edges;         // Every edge of the board, the candidate roads
+            bool rejected;              // The engine rejected the last command
+
+            void readPosition(const Player& player, BotPosition& position) const;
+            string chooseAction(const Player& player, bool canTrade);
+
+        public:
+
+            BotAgent(Catan& game, const BotWeights& weights = BotWeights());
+
+            bool decide(const DecisionRequest& request, string& command) override;
+            void notify(const string& reply) override;
+            const BotEvaluator& getEvaluator() const;
+    };
+}
+
+#endif
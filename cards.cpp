@@ -6,37 +6,6 @@
 using namespace std;
 namespace ariel {
 
-    // Initialize static quantities for each card type
-    int KnightCard::quantity = 14;
-    int VictoryPointCard::quantity = 4;
-    int MonopolyCard::quantity = 2;
-    int RoadBuildingCard::quantity = 2;
-    int YearOfPlentyCard::quantity = 2;
-
-    //-------------------------------------//
-    //  DevelopmentCard - Abstract Class   //
-    //-------------------------------------//
-
-    /**
-     * @brief Returns the total quantity available for a specified type of development card.
-     * @param type The type of development card.
-     * @return The quantity of the specified card type.
-     */
-    int DevelopmentCard::getCardQuantity(DevCardType type) 
-    {
-        switch (type) 
-        {
-            case DevCardType::KNIGHT:
-                return KnightCard::getQuantity();
-            case DevCardType::VICTORY_POINT:
-                return VictoryPointCard::getQuantity();
-            case DevCardType::PROMOTION:
-                return MonopolyCard::getQuantity() + RoadBuildingCard::getQuantity() + YearOfPlentyCard::getQuantity();
-            default:
-                return 0;
-        }
-    }
-
     //-------------------------------------//
     //             KnightCard              //
     //-------------------------------------//
@@ -51,33 +20,16 @@ namespace ariel {
     }
 
 
-    /**
-     * @brief Returns the current quantity of Knight cards.
-     * @return The quantity of Knight cards.
-     */
-    int KnightCard::getQuantity() 
-    {
-        return quantity;
-    }
-
-
-    /**
-     * @brief Decreases the quantity of Knight cards by one.
-     */
-    void KnightCard::decreaseQuantity() 
-    {
-        if (quantity > 0) 
-        {
-            quantity--;
-        }
-    }
-
     /* @brief Activates the effect of a Knight card.
-    *         Additional handling if it's a Knight card (not in the game's rule).
+    *         Moves the robber to the tile that hurts the opponents most and robs the richest player there.
     */
     CardUseError KnightCard::activateCard(Player& player, vector<Player*>& allPlayers, Board& board, bool& endTurn) 
     {
-        // Optional for future
+        endTurn = false;
+        if (!player.placeRobber(board.suggestRobberPosition(player.getId()), allPlayers, board))
+        {
+            return CardUseError::Failure;
+        }
         return CardUseError::Success;
     }
 
@@ -95,26 +47,6 @@ namespace ariel {
         return "Victory Point";
     }
 
-    /**
-     * @brief Returns the current quantity of Victory Point cards.
-     * @return The quantity of Victory Point cards.
-     */
-    int VictoryPointCard::getQuantity()
-    {
-        return quantity;
-    }
-
-    /**
-     * @brief Decreases the quantity of Victory Point cards by one.
-     */
-    void VictoryPointCard::decreaseQuantity() 
-    {
-        if (quantity > 0) 
-        {
-            quantity--;
-        }
-    }
-
    /*@brief Activates the effect of a Victory Point card.
     * @param player Reference to the player using the card.
     * @param allPlayers Reference to a vector containing pointers to all players in the game.
@@ -146,28 +78,6 @@ namespace ariel {
     }
 
 
-    /**
-     * @brief Returns the current quantity of Monopoly cards.
-     * @return The quantity of Monopoly cards.
-     */
-    int MonopolyCard::getQuantity() 
-    {
-        return quantity;
-    }
-
-
-    /**
-     * @brief Decreases the quantity of Monopoly cards by one.
-     */
-    void MonopolyCard::decreaseQuantity() 
-    {
-        if (quantity > 0) 
-        {
-            quantity--;
-        }
-    }
-    
-
     /**
      * @brief Executes the Monopoly card's effect by allowing the current player to monopolize a chosen resource.
      * This function first checks if the player has a Monopoly card available. If so, it guide the player to
@@ -197,7 +107,7 @@ namespace ariel {
         for (auto& otherPlayer : allPlayers) 
         {
             // Ensure the current player is not taking resources from themselves
-            if (otherPlayer->getId() != player.getId()) 
+            if (otherPlayer != &player) 
             { 
                 int resourceAmount = otherPlayer->getResourceCount(chosenResource);
                 if (resourceAmount > 0) 
@@ -229,27 +139,6 @@ namespace ariel {
     }
 
 
-    /**
-     * @brief Returns the current quantity of Road Building cards.
-     * @return The quantity of Road Building cards.
-     */
-    int RoadBuildingCard::getQuantity() 
-    {
-        return quantity;
-    }
-
-
-    /**
-     * @brief Decreases the quantity of Road Building cards by one.
-     */
-    void RoadBuildingCard::decreaseQuantity() 
-    {
-        if (quantity > 0) 
-        {
-            quantity--;
-        }
-    }
-
     /**
      * @brief Activates the effect of a Road Building card.
      * @param player Reference to the player using the card.
@@ -321,27 +210,6 @@ namespace ariel {
     }
 
     
-    /**
-     * @brief Returns the current quantity of Year of Plenty cards.
-     * @return The quantity of Year of Plenty cards.
-     */
-    int YearOfPlentyCard::getQuantity()
-    {
-        return quantity;
-    }
-
-
-    /**
-     * @brief Decreases the quantity of Year of Plenty cards by one.
-     */
-    void YearOfPlentyCard::decreaseQuantity() 
-    {
-        if (quantity > 0) 
-        {
-            quantity--;
-        }
-    }
-
     /**
      * @brief Allows the player to make additional actions granted by the 'Year of Plenty' card.
      * @param player Reference to the player using the card.
@@ -472,7 +340,7 @@ namespace ariel {
         int intersectionID1, intersectionID2;
         cin >> intersectionID1 >> intersectionID2;
         Edge edge(Intersection::getIntersection(intersectionID1), Intersection::getIntersection(intersectionID2));
-        if (player.canBuild("road") && board.canPlaceRoad(edge, player.getId())) 
+        if (player.canBuild(Structure::ROAD) && board.canPlaceRoad(edge, player.getId())) 
         {
             player.buildRoad(edge, board);
             cout << "Road built successfully." << endl;
@@ -493,7 +361,7 @@ namespace ariel {
         cout << "Enter the intersection ID to place a settlement: ";
         int intersectionID;
         cin >> intersectionID;
-        if (player.canBuild("settlement") && board.canPlaceSettlement(intersectionID, player.getId())) 
+        if (player.canBuild(Structure::SETTLEMENT) && board.canPlaceSettlement(intersectionID, player.getId())) 
         {
             player.buildSettlement(intersectionID, board);
             cout << "Settlement built successfully." << endl;
@@ -514,7 +382,7 @@ namespace ariel {
         cout << "Enter the intersection ID to upgrade to a city: ";
         int intersectionID;
         cin >> intersectionID;
-        if (player.canBuild("city") && board.canUpgradeSettlementToCity(intersectionID, player.getId())) 
+        if (player.canBuild(Structure::CITY) && board.canUpgradeSettlementToCity(intersectionID, player.getId())) 
         {
             player.upgradeToCity(intersectionID, board);
             cout << "City upgraded successfully." << endl;
@@ -45,7 +45,6 @@ namespace ariel {
     class DevelopmentCard {
         public:
             virtual string getType() const = 0;
-            static int getCardQuantity(DevCardType type);
     };
 
 
@@ -57,12 +56,8 @@ namespace ariel {
      * @brief Represents a Knight Card in the game.
      */
     class KnightCard : public DevelopmentCard {
-        private:
-            static int quantity;
         public:
             string getType() const override;
-            static int getQuantity();
-            static void decreaseQuantity();
             CardUseError activateCard(Player& player, vector<Player*>& allPlayers, Board& board, bool& endTurn);
     };
 
@@ -75,12 +70,8 @@ namespace ariel {
      * @brief Represents a Victory Point Card in the game.
      */
     class VictoryPointCard : public DevelopmentCard {
-        private:
-            static int quantity;
         public:
             string getType() const override;
-            static int getQuantity();
-            static void decreaseQuantity();
             CardUseError activateCard(Player& player, vector<Player*>& allPlayers, Board& board, bool& endTurn);
 
     };
@@ -106,12 +97,8 @@ namespace ariel {
      * @brief Represents a Monopoly Card in the game.
      */
     class MonopolyCard : public PromotionCard {
-        private:
-            static int quantity;
         public:
             string getType() const override;
-            static int getQuantity();
-            static void decreaseQuantity();
             CardUseError activateCard(Player& player, vector<Player*>& allPlayers, Board& board, bool& endTurn);
     };
 
@@ -124,12 +111,8 @@ namespace ariel {
      * @brief Represents a Road Building Card in the game.
      */
     class RoadBuildingCard : public PromotionCard {
-        private:
-            static int quantity;
         public:
             string getType() const override;
-            static int getQuantity();
-            static void decreaseQuantity();
             CardUseError activateCard(Player& player, Board& board, bool& endTurn);
     };
 
@@ -142,12 +125,8 @@ namespace ariel {
      * @brief Represents a Year of Plenty Card in the game.
      */
     class YearOfPlentyCard : public PromotionCard {
-        private:
-            static int quantity;
         public:
             string getType() const override;
-            static int getQuantity();
-            static void decreaseQuantity();
             CardUseError activateCard(Player& player, Board& board, bool& endTurn);
             static ResourceType chooseResource(const Player& player, const string& prompt);
             static int promptActionChoice(const Player& player);
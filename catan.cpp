@@ -3,6 +3,12 @@
 #include "catan.hpp"
 #include "intersection.hpp"
 #include "edge.hpp"
+#include "exporter.hpp"
+#include "stats.hpp"
+#include "turnengine.hpp"
+#include "bot.hpp"
+#include "opening.hpp"
+#include "plugin.hpp"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>    
@@ -19,7 +25,40 @@ namespace ariel {
      * @param p2 Reference to the second player.
      * @param p3 Reference to the third player.
      */
-    Catan::Catan(Player& p1, Player& p2, Player& p3) : players({&p1, &p2, &p3}), currentPlayerIndex(0){}
+    Catan::Catan(Player& p1, Player& p2, Player& p3) : Catan(p1, p2, p3, Board::getInstance()) {}
+
+
+     /**
+     * @brief Constructor that initializes the game with three players on a board owned by the caller.
+     * Used when several games run in the same process, each on its own board.
+     * @param p1 Reference to the first player.
+     * @param p2 Reference to the second player.
+     * @param p3 Reference to the third player.
+     * @param board Reference to the board this game is played on.
+     */
+    Catan::Catan(Player& p1, Player& p2, Player& p3, Board& board) : Catan(vector<Player*>{&p1, &p2, &p3}, board) {}
+
+
+    /**
+     * @brief Constructor that initializes the game with 3 to 6 players on a board owned by the caller.
+     * Prefer the constructor taking an array, which checks the number of players at compile time.
+     * @param seated The players, in seat order.
+     * @param board Reference to the board this game is played on.
+     * @throws invalid_argument if there are fewer than MIN_SEATS or more than MAX_SEATS players.
+     */
+    Catan::Catan(const vector<Player*>& seated, Board& board) : players(seated), currentPlayerIndex(0), board(board)
+    {
+        if (players.size() < MIN_SEATS || players.size() > MAX_SEATS)
+        {
+            throw invalid_argument("A game has " + to_string(MIN_SEATS) + " to " + to_string(MAX_SEATS) + " players");
+        }
+        for (Player* player : players)
+        {
+            registry.add(*player);      // Seats 0..N-1 in the order given, before any reordering of the turns
+            awards.enroll(*player);
+            deck.enroll(*player);
+        }
+    }
 
 
     /**
@@ -29,17 +68,31 @@ namespace ariel {
     {   
         cout << "Processing initialization due to Catan beginner setup...\n" << endl;
 
-        Board& board = Board::getInstance();
         board.setupTiles();  
         board.linkTilesAndIntersections();
+        initializeGame(OpeningPlan::beginner(players.size()));
+    }
+
+
+    /**
+     * @brief Sets up the game from a plan of starting settlements and roads, on the tiles the board already has
+     * (e.g. a generated layout), and distributes the initial resources.
+     * @param plan The settlements and roads of every seat, e.g. from OpeningOptimizer.
+     * @throws invalid_argument if the plan is for another number of seats.
+     */
+    void Catan::initializeGame(const OpeningPlan& plan) 
+    {
+        if (plan.seats != players.size())
+        {
+            throw invalid_argument("The opening plan is for " + to_string(plan.seats) + " players, not " + to_string(players.size()));
+        }
 
         // Setup each player's initial resources and settlements
-        players[0]->placeInitialSettlement(41, board);     // Intersection 41 touches Wood(8), Ore(3), Brick(5)
-        players[0]->placeInitialSettlement(45, board);     // Intersection 45 touches Grain(4), Wool(5), Wool(11)
-        players[1]->placeInitialSettlement(14, board);     // Road between Wool(4) and Wood(9)
-        players[1]->placeInitialSettlement(43, board);     // Road between Grain(4) and Grain(6)
-        players[2]->placeInitialSettlement(20, board);     // Road between Grain(12) and Wood(11)
-        players[2]->placeInitialSettlement(36, board);     // Road between Wood(3) and Ore(8)
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            players[seat]->placeInitialSettlement(plan.settlements[seat][0], board);
+            players[seat]->placeInitialSettlement(plan.settlements[seat][1], board);
+        }
 
         // Distribute resources after all settlements are placed
         for (auto* player : players) 
@@ -48,15 +101,16 @@ namespace ariel {
         }
         
         // Place initial roads
-        players[0]->placeInitialRoad(Edge(Intersection::getIntersection(41), Intersection::getIntersection(42)), board);   // Road between Ore(3) and Brick(5)
-        players[0]->placeInitialRoad(Edge(Intersection::getIntersection(35), Intersection::getIntersection(45)), board);   // Road between Grain(4) and Wool(5)
-        players[1]->placeInitialRoad(Edge(Intersection::getIntersection(13), Intersection::getIntersection(14)), board);   // Road between Wool(4) and Wood(9)
-        players[1]->placeInitialRoad(Edge(Intersection::getIntersection(43), Intersection::getIntersection(44)), board);   // Road between Grain(4) and Grain(6)
-        players[2]->placeInitialRoad(Edge(Intersection::getIntersection(19), Intersection::getIntersection(20)), board);     // Road between Grain(12) and Wood(11)
-        players[2]->placeInitialRoad(Edge(Intersection::getIntersection(25), Intersection::getIntersection(36)), board);     // Road between Wood(3) and Ore(8)
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            for (const auto& road : plan.roads[seat])
+            {
+                players[seat]->placeInitialRoad(Edge(Intersection::getIntersection(road[0]), Intersection::getIntersection(road[1])), board);
+            }
+        }
         
         cout << "\nInitial resources were distributed to the players." << endl;
-        cout << "Settlements & roads places by the game's instructions for beginners.\n" << endl;
+        cout << "Settlements & roads were placed by the opening plan.\n" << endl;
 
         ChooseStartingPlayer();
     }
@@ -68,7 +122,6 @@ namespace ariel {
      */
     void Catan::distributeResources(Player* player) 
     {
-        Board& board = Board::getInstance();
         set<ResourceType> uniqueResources;
         cout << "Player " << player->getName() << " has settlements at: ";
         for (int settlement : player->getSettlements()) 
@@ -83,6 +136,14 @@ namespace ariel {
         for (auto resource : uniqueResources) 
         {
             player->addResource(resource, 1);       // Add one resource card of each type
+            if (EventExporter* exporter = EventExporter::getActive())
+            {
+                exporter->resourceDelta(player->getId(), resource, 1, "setup");
+            }
+            if (StatBlock* stats = StatBlock::local())
+            {
+                stats->gain(GainSource::SETUP, resource, 1);
+            }
         }
     }
 
@@ -123,155 +184,55 @@ namespace ariel {
 
     /**
      * @brief Main game loop that controls the flow of the game until a player wins.
+     * Every seat is played at the console, the turns themselves are run by the TurnEngine.
+     * @param checkpointPath Where the game is saved at every turn boundary (empty to disable).
      */
-    void Catan::playGame() 
+    void Catan::playGame(const string& checkpointPath) 
     {
-        Board& board = Board::getInstance();
-        bool gameRunning = true;
-        while (gameRunning) 
-        {   
-            // Iterate through each player for their turn.
-            for (Player* currentPlayer : players) 
-            {
-                cout << "\nIt's " << currentPlayer->getName() << "'s turn." << endl;
-                
-                int preChoice = 0;
-                while (preChoice != 1 && preChoice != 2) 
-                {
-                    cout << "Do you want to (1) Roll Dice or (2) Use Development Card? ";
-                    cin >> preChoice;
-                    if (cin.fail() || (preChoice != 1 && preChoice != 2)) 
-                    {
-                        cout << "\nERROR: Invalid input. Please enter '1' for Roll Dice or '2' for Use Development Card!\n\n";
-                        cin.clear();                                            // Clear error flag
-                        cin.ignore(numeric_limits<streamsize>::max(), '\n');    // Ignore incorrect input
-                    }
-                }
-
-                if (preChoice == 2) 
-                {
-                    bool shouldEndTurn = false;
-                    handleDevelopmentCardUsage(currentPlayer, shouldEndTurn);
-                    if (shouldEndTurn) 
-                    {
-                        currentPlayer->endTurn();
-                        nextTurn();
-                        continue;       // Skip to next player immediately
-                    }
-                }
-             
-                else 
-                {
-                    // Proceed with dice roll
-                    int dice1 = Player::rollDice();
-                    int dice2 = Player::rollDice();
-                    int total = dice1 + dice2;
-                    cout << "\nPlayer " << currentPlayer->getName() << " rolls " << dice1 << " + " << dice2 << " = " << total << "." << endl;
-
-                    if (total == 7) 
-                    {
-                        handleSevenRoll();
-                    } 
-                    else 
-                    {
-                        board.distributeResourcesBasedOnDiceRoll(total, players);
-                        cout << "\nSTATUS: Resources distributed based on dice roll." << endl;
-                    }
-                }
-
-                cout << "\nProceeding to action selection..." << endl;
-
-                // Action selection
-                bool endTurn = false;
-                while (!endTurn) 
-                {
-                    int choice = -1; // Initialize outside valid range
-                    while (choice < 0 || choice > 8) 
-                    {
-                        cout << "\nChoose an action:\n";
-                        cout << "0. View game state\n";
-                        cout << "1. View your full player details\n";
-                        cout << "2. Trade resources or cards\n";
-                        cout << "3. Build a road\n";
-                        cout << "4. Build a settlement\n";
-                        cout << "5. Upgrade to city\n";
-                        cout << "6. Buy development card\n";
-                        cout << "7. Use development card\n";
-                        cout << "8. End turn\n";
-                        cout << "Enter your choice: ";
-                        cin >> choice;
-                        clearInputBuffer();  // Clear buffer after reading
-
-                        if (choice < 0 || choice > 8) 
-                        {
-                            cout << "\nERROR: Invalid choice, please choose a number between 0 and 8!\n";
-                        }
-                    }
-
-                    switch(choice) 
-                    {
-                        case 0:
-                            printGameState();
-                            break;
-                        case 1:
-                            cout << currentPlayer->printPlayer();
-                            break;
-                        case 2:
-                            currentPlayer->trade(players);
-                            break;
-                        case 3:
-                            handleBuildRoad(currentPlayer);
-                            // endTurn = true;
-                            break;
-                        case 4:
-                            handleBuildSettlement(currentPlayer);
-                            // endTurn = true;
-                            break;
-                        case 5:
-                            handleUpgradeToCity(currentPlayer);
-                            // endTurn = true;
-                            break;
-                        case 6: 
-                        {
-                            handleBuyDevelopmentCard(currentPlayer);
-                            // endTurn = true;
-                            break;
-                        }
-
-                        case 7:
-                        {
-                            bool shouldEndTurn = false;
-                            handleDevelopmentCardUsage(currentPlayer, shouldEndTurn);
-                            if (shouldEndTurn) 
-                            {
-                                // cout << "Proceeding to additional actions after using the card..." << endl;
-                                endTurn = true; // End turn if the card used should end the turn
-                            }
-                            break;
-                        }
-                        case 8:
-                            currentPlayer->endTurn();
-                            nextTurn();
-                            endTurn = true;
-                            // cout << "Turn ended for " << currentPlayer->getName() << "." << endl;
-                            break;
-                        default:
-                            cout << "Invalid choice, please choose again.\n";
-                            break;
-
-                    }
-                }
-
-
-                // Check victory conditions
-                if (currentPlayer->getPoints() >= 10) 
-                {
-                    cout << "Player " << currentPlayer->getName() << " wins with " << currentPlayer->getPoints() << " points!" << endl;
-                    gameRunning = false;
-                    break;
-                }
-            }
+        ConsoleAgent console(*this);
+        vector<SeatAgent*> agents(players.size(), &console);
+        TurnEngine engine(*this, agents);
+        engine.setCheckpointPath(checkpointPath);
+        engine.start();
+    }
+
+    /**
+     * @brief Main game loop with a single human: the first seat is played at the console and every other seat by a bot.
+     * @param checkpointPath Where the game is saved at every turn boundary (empty to disable).
+     * @param bots The evaluation weights of the bots.
+     */
+    void Catan::playGame(const string& checkpointPath, const BotWeights& bots)
+    {
+        ConsoleAgent console(*this);
+        BotAgent bot(*this, bots);
+        vector<SeatAgent*> agents(players.size(), &bot);
+        agents[0] = &console;
+        TurnEngine engine(*this, agents);
+        engine.setCheckpointPath(checkpointPath);
+        engine.start();
+    }
+
+    /**
+     * @brief Main game loop with a single human: the first seat is played at the console and every other seat by an
+     * agent of a loaded plugin.
+     * @param checkpointPath Where the game is saved at every turn boundary (empty to disable).
+     * @param agents The plugin the other seats' agents are created from.
+     * @throws runtime_error if the plugin cannot create an agent or gives up on a decision.
+     */
+    void Catan::playGame(const string& checkpointPath, const shared_ptr<AgentPlugin>& agents)
+    {
+        ConsoleAgent console(*this);
+        vector<unique_ptr<PluginAgent>> plugged;
+        vector<SeatAgent*> seats(1, &console);
+        for (size_t seat = 1; seat < players.size(); ++seat)
+        {
+            plugged.push_back(make_unique<PluginAgent>(*this, agents, seat));
+            seats.push_back(plugged.back().get());
         }
+        cout << "Seats 2 to " << players.size() << " are played by the " << agents->getName() << " agent plugin." << endl;
+        TurnEngine engine(*this, seats);
+        engine.setCheckpointPath(checkpointPath);
+        engine.start();
     }
 
     /**
@@ -280,14 +241,12 @@ namespace ariel {
      */
     void Catan::handleBuildRoad(Player* currentPlayer) 
     {
-        Board& board = Board::getInstance();
-
         cout << "Enter the intersection IDs to place a road (e.g., 4 5): ";
         int id1, id2;
         cin >> id1 >> id2;
         try {
             Edge edge(Intersection::getIntersection(id1), Intersection::getIntersection(id2));
-            if (currentPlayer->canBuild("road") && board.canPlaceRoad(edge, currentPlayer->getId())) 
+            if (currentPlayer->canBuild(Structure::ROAD) && board.canPlaceRoad(edge, currentPlayer->getId())) 
             {
                 currentPlayer->buildRoad(edge, board);
                 cout << "\nRoad successfully built for "  << currentPlayer->getName() << " between " << id1 << " and " << id2 << "." << endl;
@@ -308,12 +267,10 @@ namespace ariel {
      */
     void Catan::handleBuildSettlement(Player* currentPlayer) 
     {
-        Board& board = Board::getInstance();
-
         cout << "Enter the intersection ID to place a settlement: ";
         int intersectionID;
         cin >> intersectionID;
-        if (currentPlayer->canBuild("settlement") && board.canPlaceSettlement(intersectionID, currentPlayer->getId())) 
+        if (currentPlayer->canBuild(Structure::SETTLEMENT) && board.canPlaceSettlement(intersectionID, currentPlayer->getId())) 
         {
             currentPlayer->buildSettlement(intersectionID, board);
             cout << "Settlement successfully built at intersection " << intersectionID << "." << endl;
@@ -331,12 +288,10 @@ namespace ariel {
      */
     void Catan::handleUpgradeToCity(Player* currentPlayer) 
     {
-        Board& board = Board::getInstance();
-
         cout << "\nEnter the intersection ID to upgrade to a city: ";
         int intersectionID;
         cin >> intersectionID;
-        if (currentPlayer->canBuild("city") && board.canUpgradeSettlementToCity(intersectionID, currentPlayer->getId())) 
+        if (currentPlayer->canBuild(Structure::CITY) && board.canUpgradeSettlementToCity(intersectionID, currentPlayer->getId())) 
         {
             currentPlayer->upgradeToCity(intersectionID, board);
             cout << "\nSTATUS: Settlement at intersection " << intersectionID << " has been upgraded to a city." << endl;
@@ -380,8 +335,6 @@ namespace ariel {
      */
     void Catan::handleDevelopmentCardUsage(Player* currentPlayer, bool& shouldEndTurn) 
     {
-        Board& board = Board::getInstance();
-
         cout << "\nSelect the type of Development Card to use:\n1. Victory Point\n2. Promotion\nEnter your choice: ";
         int devCardChoice;
         cin >> devCardChoice;
@@ -400,7 +353,7 @@ namespace ariel {
                 break;
             default:
                 cout << "\nSTATUS:Invalid card type selected!\n";
-                break;
+                return;
         }
         
         CardUseError useResult = currentPlayer->useDevelopmentCard(cardType, currentPlayer, players, board, shouldEndTurn);
@@ -421,28 +374,6 @@ namespace ariel {
     }
 
 
-    /**
-     * @brief Handles the event when a player rolls a seven, enforcing the discarding of resources.
-     */
-    void Catan::handleSevenRoll() 
-    {
-        cout << "\nA 7 was rolled. Players with more than 7 resources must discard half of them." << endl;
-        size_t currentPlayerPosition = currentPlayerIndex; // Remember the current player index
-        do {
-            Player* currentPlayer = players[currentPlayerIndex];
-            int totalResources = currentPlayer->countTotalResources();
-            if (totalResources > 7) 
-            {
-                int toDiscard = totalResources / 2; // Calculate half to discard, rounded down
-                currentPlayer->discardResources(toDiscard);
-            }
-            nextTurn(); // Proceed to next player in a circular manner
-        } while (currentPlayerIndex != currentPlayerPosition); // Go until we reach the starting player again
-
-        cout << "\nIt is now " << players[currentPlayerIndex]->getName() << "'s turn to continue their turn." << endl;
-    }
-
-
     /**
      * @brief Clears the input buffer to handle potential input errors.
      */
@@ -462,13 +393,30 @@ namespace ariel {
     }
 
 
+    /**
+     * @brief Returns the index of the player whose turn it is.
+     */
+    size_t Catan::getCurrentPlayerIndex() const
+    {
+        return currentPlayerIndex;
+    }
+
+
+    /**
+     * @brief Sets the player whose turn it is.
+     * @param index The index of the player in the players vector.
+     */
+    void Catan::setCurrentPlayerIndex(size_t index)
+    {
+        currentPlayerIndex = index % players.size();
+    }
+
+
     /**
      * @brief Prints the current state of the game, including player points and board status.
      */
     void Catan::printGameState() const 
     {
-        Board& board = Board::getInstance();
-
         cout << "\n";
         cout << "**********************************************************************\n";
         cout << "*                                                                    *\n";
@@ -499,7 +447,6 @@ namespace ariel {
      */
     Board& Catan::getBoard() 
     {
-        Board& board = Board::getInstance();
         return board;
     }
 
@@ -535,6 +482,50 @@ namespace ariel {
         return players;
     }
 
+    /**
+     * @brief Returns the order book of trade offers posted during the current turn.
+     */
+    TradeBook& Catan::getTradeBook()
+    {
+        return tradeBook;
+    }
+
+
+    /**
+     * @brief Returns the award tracker of the game, which holds the knights of every player and the Largest Army.
+     */
+    AwardTracker& Catan::getAwards()
+    {
+        return awards;
+    }
+
+
+    /**
+     * @brief Returns the development cards left in the game's stock, which the players of this game buy from.
+     */
+    DevelopmentDeck& Catan::getDeck()
+    {
+        return deck;
+    }
+
+
+    /**
+     * @brief Returns the seats of the players. A player's ID is its seat, whatever the turn order.
+     */
+    const PlayerRegistry& Catan::getRegistry() const
+    {
+        return registry;
+    }
+
+
+    /**
+     * @brief Returns true for games of 5 and 6 players, where every seat may build between the turns of the others.
+     */
+    bool Catan::hasSpecialBuildPhase() const
+    {
+        return players.size() >= SPECIAL_BUILD_SEATS;
+    }
+
     /**
      * @brief Initializes the game board for testing purposes without placing any settlements or distributing resources.
      * 
@@ -542,7 +533,6 @@ namespace ariel {
      */
     void Catan::testInitialize() 
     {
-        Board& board = Board::getInstance();
         board.setupTiles();
         board.linkTilesAndIntersections();
     }
@@ -5,10 +5,18 @@
 
 #include "player.hpp"
 #include "board.hpp"
+#include "trade.hpp"
+#include "registry.hpp"
 #include <vector>
+#include <array>
+#include <memory>
 
 using namespace std;
 namespace ariel {
+
+    struct BotWeights;
+    struct OpeningPlan;
+    class AgentPlugin;
     
     class Catan 
     {
@@ -16,6 +24,11 @@ namespace ariel {
         
             vector<Player*> players;    // Stores pointers to the players participating in the game
             size_t currentPlayerIndex;  // Index to track the current player's turn
+            Board& board;               // The board this game is played on
+            TradeBook tradeBook;        // Open trade offers of the current turn
+            PlayerRegistry registry;    // Seats of the players, which are their IDs in this game
+            AwardTracker awards;        // Knights and award holders of this game
+            DevelopmentDeck deck;       // Development cards left in this game's stock
 
             // Related to the the main game loop which controlling the flow of turns (void playGame())
             void handleBuildSettlement(Player* currentPlayer);
@@ -24,20 +37,33 @@ namespace ariel {
             // Related to initializing the game (void initializeGame())
             void ChooseStartingPlayer();
 
-            // Handles the game logic when a player rolls a 7
-            void handleSevenRoll();
-
         public:
 
             // Constructor that initializes the game with three player references
             Catan(Player& p1, Player& p2, Player& p3);
 
+            // Constructor for a game played on its own board (several games in one process)
+            Catan(Player& p1, Player& p2, Player& p3, Board& board);
+
+            // Constructor for 3 to 6 players; throws invalid_argument for any other number
+            Catan(const vector<Player*>& seated, Board& board);
+
+            // Constructor for a number of players fixed at compile time, e.g. array<Player*, 4>
+            template <size_t Seats>
+            Catan(const array<Player*, Seats>& seated, Board& board) : Catan(vector<Player*>(seated.begin(), seated.end()), board)
+            {
+                static_assert(Seats >= MIN_SEATS && Seats <= MAX_SEATS, "A game has 3 to 6 players");
+            }
+
             // Initializes the game, setting up the board, distribute resources and choosing the starting player
             void initializeGame();
+            void initializeGame(const OpeningPlan& plan);      // Starting buildings of the plan, on the board's current tiles
 
             // Manages the main game loop, controlling the flow of turns and checking for the game end condition
             // TO-DO: change to private method after presentions (should be public for testing purpose)
-            void playGame();        
+            void playGame(const string& checkpointPath = "");
+            void playGame(const string& checkpointPath, const BotWeights& bots);   // The first seat at the console, bots for the others
+            void playGame(const string& checkpointPath, const shared_ptr<AgentPlugin>& agents);    // The first seat at the console, plugin agents for the others
             void distributeResources(Player* player);   
             void handleBuyDevelopmentCard(Player* currentPlayer);
             void handleBuildRoad(Player* currentPlayer);
@@ -45,6 +71,8 @@ namespace ariel {
 
             // Advances the game to the next player's turn
             void nextTurn();                            // TO-DO: change to private method after presentions
+            size_t getCurrentPlayerIndex() const;
+            void setCurrentPlayerIndex(size_t index);   // Used when restoring a saved game
 
             // Displays the current state of the game, including players' statuses and the board state
             void printGameState() const;
@@ -52,6 +80,11 @@ namespace ariel {
             // Provides access to the game board and players
             Board& getBoard();
             vector<Player*>& getPlayers();
+            TradeBook& getTradeBook();
+            AwardTracker& getAwards();
+            DevelopmentDeck& getDeck();
+            const PlayerRegistry& getRegistry() const;
+            bool hasSpecialBuildPhase() const;
 
             // Prints the winner of the game
             void printWinner();
@@ -3,21 +3,78 @@
 #include "catan.hpp"
 #include "player.hpp"
 #include "board.hpp"
+#include "exporter.hpp"
+#include "checkpoint.hpp"
+#include "bot.hpp"
+#include "plugin.hpp"
+#include "stats.hpp"
 #include <iostream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <csignal>
 
 using namespace ariel;
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+
+    // Optional flags: ./Catan [--events <file or fifo>] [--checkpoint <file>] [--bots <weights file or "default">] [--agent <plugin .so>] [--stats <file>]
+    unique_ptr<EventExporter> exporter;
+    string checkpointPath;
+    unique_ptr<BotWeights> bots;
+    shared_ptr<AgentPlugin> agents;
+    string statsPath;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        string flag = argv[i];
+        if (flag == "--events")
+        {
+            // NDJSON feed of every state change; a closed FIFO fails the write with EPIPE instead of ending the game
+            signal(SIGPIPE, SIG_IGN);
+            exporter = make_unique<EventExporter>(string(argv[i + 1]));
+            EventExporter::setActive(exporter.get());
+        }
+        else if (flag == "--checkpoint")
+        {
+            // Saved at every turn boundary, and resumed from if it already exists
+            checkpointPath = argv[i + 1];
+        }
+        else if (flag == "--bots")
+        {
+            // Red and Green are played by bots with these evaluation weights
+            string weights = argv[i + 1];
+            bots = make_unique<BotWeights>(weights == "default" ? BotWeights() : BotWeights::fromFile(weights));
+        }
+        else if (flag == "--agent")
+        {
+            // Red and Green are played by agents of a plugin (see agentabi.h)
+            agents = AgentPlugin::load(argv[i + 1]);
+        }
+        else if (flag == "--stats")
+        {
+            // The game's statistics as one JSON object, written when the game ends
+            statsPath = argv[i + 1];
+        }
+    }
     
     // Create player instances for the game
     Player player1("Blue");
     Player player2("Red");
     Player player3("Green");
 
-    // Initialize the game with these players
+    // Initialize the game with these players, or resume it from the checkpoint
     Catan game(player1, player2, player3);
-    game.initializeGame();
+    if (!checkpointPath.empty() && ifstream(checkpointPath).good())
+    {
+        game.testInitialize();
+        GameCheckpoint::load(game, checkpointPath);
+        cout << "Resumed the game saved in " << checkpointPath << "." << endl;
+    }
+    else
+    {
+        game.initializeGame();
+    }
 
     // Print players
     cout << "\nInitial status... " << endl;
@@ -25,7 +82,36 @@ int main() {
     cout << player2.printPlayer() << endl;
     cout << player3.printPlayer() << endl;
 
-    game.playGame();
+    StatsCollector stats;
+    if (!statsPath.empty())
+    {
+        stats.attach();
+    }
+
+    try {
+        if (agents)
+        {
+            game.playGame(checkpointPath, agents);
+        }
+        else if (bots)
+        {
+            game.playGame(checkpointPath, *bots);
+        }
+        else
+        {
+            game.playGame(checkpointPath);
+        }
+    } catch (const exception& e) {
+        cout << "\nGame stopped: " << e.what() << endl;
+    }
+
+    if (!statsPath.empty())
+    {
+        StatsCollector::detach();
+        ofstream out(statsPath);
+        stats.merge().writeJson(out);
+        out << '\n';
+    }
 
     return 0;
 }
\ No newline at end of file
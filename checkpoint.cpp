@@ -0,0 +1,411 @@
+// Email: origoldbsc@gmail.com
+
+#include "checkpoint.hpp"
+#include "cards.hpp"
+#include "topology.hpp"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+namespace ariel {
+
+    static const char MAGIC[4] = {'C', 'T', 'N', 'S'};
+
+
+    /**
+     * @brief Returns the seat of a player ID, or -1 if no seat has it.
+     */
+    static int seatOf(const vector<Player*>& players, int playerID)
+    {
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            if (players[seat]->getId() == playerID)
+            {
+                return static_cast<int>(seat);
+            }
+        }
+        return -1;
+    }
+
+
+    /**
+     * @brief Checks that a checkpoint describes a legal position of a game with the given number of seats:
+     * the header, the turn, the tiles and the robber, the owner of every building and road, the distance rule,
+     * that every road lies on an edge of the board, and that no count is negative.
+     * @throws runtime_error naming the first problem found.
+     */
+    static void validate(const CheckpointData& data, size_t seats)
+    {
+        if (memcmp(data.magic, MAGIC, sizeof(MAGIC)) != 0 || data.version != GameCheckpoint::VERSION || data.size != sizeof(CheckpointData))
+        {
+            throw runtime_error("Not a checkpoint of this version");
+        }
+        if (data.seatCount != seats || data.turn >= data.seatCount || data.roadCount > CheckpointData::MAX_ROADS)
+        {
+            throw runtime_error("Checkpoint does not match the game");
+        }
+        if (data.largestArmySeat < -1 || data.largestArmySeat >= static_cast<int32_t>(seats))
+        {
+            throw runtime_error("Checkpoint has an invalid Largest Army holder");
+        }
+
+        const HexTopology& topology = HexTopology::standard();
+        for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+        {
+            int resource = static_cast<int>(data.layout.resources[tile]);
+            int number = data.layout.numbers[tile];
+            if (resource < WOOD || resource > NONE || number < 0 || number == 1 || number == 7 || number > 12)
+            {
+                throw runtime_error("Checkpoint has an invalid tile");
+            }
+        }
+        if (topology.tileIndex({data.robber[0], data.robber[1]}) == HexTopology::NO_INDEX)
+        {
+            throw runtime_error("Checkpoint has the robber off the board");
+        }
+
+        for (size_t kind = 0; kind < DevelopmentDeck::KINDS; ++kind)
+        {
+            if (data.deck[kind] < 0 || data.deck[kind] > DevelopmentDeck::FULL[kind])
+            {
+                throw runtime_error("Checkpoint has an invalid development card stock");
+            }
+        }
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            const CheckpointPlayer& record = data.players[seat];
+            bool negative = record.points < 0 || record.knightCards < 0;
+            for (int32_t count : record.resources)
+            {
+                negative = negative || count < 0;
+            }
+            for (int32_t count : record.developmentCards)
+            {
+                negative = negative || count < 0;
+            }
+            for (int32_t count : record.promotionCards)
+            {
+                negative = negative || count < 0;
+            }
+            if (negative)
+            {
+                throw runtime_error("Checkpoint has a negative count");
+            }
+        }
+
+        // One building per intersection, owned by a seat, and none next to another
+        for (int intersectionID = 1; intersectionID < static_cast<int>(CheckpointData::INTERSECTIONS); ++intersectionID)
+        {
+            size_t index = static_cast<size_t>(intersectionID);
+            int8_t settlement = data.settlementSeat[index], city = data.citySeat[index];
+            if (settlement < -1 || city < -1 || settlement >= static_cast<int>(seats) || city >= static_cast<int>(seats))
+            {
+                throw runtime_error("Checkpoint building without an owner");
+            }
+            if (settlement < 0 && city < 0)
+            {
+                continue;
+            }
+            if (settlement >= 0 && city >= 0)
+            {
+                throw runtime_error("Checkpoint has a settlement and a city on intersection " + to_string(intersectionID));
+            }
+            for (int neighbor : topology.neighbors(intersectionID))
+            {
+                size_t next = static_cast<size_t>(neighbor);
+                if (neighbor != 0 && (data.settlementSeat[next] >= 0 || data.citySeat[next] >= 0))
+                {
+                    throw runtime_error("Checkpoint breaks the distance rule at intersection " + to_string(intersectionID));
+                }
+            }
+        }
+
+        // Every road on its own edge of the board, owned by a seat
+        bool taken[CheckpointData::MAX_ROADS] = {};
+        for (uint32_t i = 0; i < data.roadCount; ++i)
+        {
+            const CheckpointRoad& record = data.roads[i];
+            if (record.seat < 0 || static_cast<size_t>(record.seat) >= seats)
+            {
+                throw runtime_error("Checkpoint road without an owner");
+            }
+            int edge = topology.edgeIndex(record.id1, record.id2);
+            if (edge == HexTopology::NO_INDEX || static_cast<size_t>(edge) >= CheckpointData::MAX_ROADS || taken[static_cast<size_t>(edge)])
+            {
+                throw runtime_error("Checkpoint road " + to_string(record.id1) + "-" + to_string(record.id2) + " is not a free edge");
+            }
+            taken[static_cast<size_t>(edge)] = true;
+        }
+    }
+
+
+    /**
+     * @brief Captures the state of a game.
+     * @param game The game to capture.
+     * @param data Filled with the state of the game.
+     */
+    void GameCheckpoint::capture(Catan& game, CheckpointData& data)
+    {
+        vector<Player*>& players = game.getPlayers();
+        Board& board = game.getBoard();
+        if (players.size() > CheckpointData::SEATS)
+        {
+            throw runtime_error("Checkpoints hold games of up to " + to_string(CheckpointData::SEATS) + " players");
+        }
+        const size_t seats = players.size();
+
+        memset(&data, 0, sizeof(data));
+        memcpy(data.magic, MAGIC, sizeof(MAGIC));
+        data.version = VERSION;
+        data.size = sizeof(CheckpointData);
+        data.seatCount = static_cast<uint32_t>(seats);
+        data.turn = static_cast<uint32_t>(game.getCurrentPlayerIndex());
+        Player* armyHolder = game.getAwards().getHolderPlayer(Award::LARGEST_ARMY);
+        data.largestArmySeat = armyHolder ? seatOf(players, armyHolder->getId()) : -1;
+        data.robber[0] = board.getRobberPosition().first;
+        data.robber[1] = board.getRobberPosition().second;
+
+        for (size_t kind = 0; kind < DevelopmentDeck::KINDS; ++kind)
+        {
+            data.deck[kind] = game.getDeck().getStock(kind);
+        }
+        board.getLayout(data.layout);
+
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            const Player& player = *players[seat];
+            CheckpointPlayer& record = data.players[seat];
+            strncpy(record.name, player.name.c_str(), sizeof(record.name) - 1);
+            for (int type = WOOD; type <= ORE; ++type)
+            {
+                record.resources[type] = player.getResourceCount(static_cast<ResourceType>(type));
+            }
+            for (const auto& card : player.developmentCards)
+            {
+                record.developmentCards[static_cast<int>(card.first)] = card.second;
+            }
+            for (const auto& card : player.promotionCards)
+            {
+                record.promotionCards[static_cast<int>(card.first)] = card.second;
+            }
+            record.points = static_cast<int32_t>(player.getPoints());     // With the award points, as the format always stored
+            record.knightCards = game.getAwards().getKnights(static_cast<size_t>(player.id));
+        }
+
+        memset(data.settlementSeat, -1, sizeof(data.settlementSeat));
+        memset(data.citySeat, -1, sizeof(data.citySeat));
+        for (const auto& settlement : board.settlements)
+        {
+            if (!settlement.second.empty() && settlement.first > 0 && static_cast<size_t>(settlement.first) < CheckpointData::INTERSECTIONS)
+            {
+                data.settlementSeat[settlement.first] = static_cast<int8_t>(seatOf(players, *settlement.second.begin()));
+            }
+        }
+        for (const auto& city : board.cities)
+        {
+            if (city.first > 0 && static_cast<size_t>(city.first) < CheckpointData::INTERSECTIONS)
+            {
+                data.citySeat[city.first] = static_cast<int8_t>(seatOf(players, city.second));
+            }
+        }
+        for (const auto& road : board.roads)
+        {
+            if (data.roadCount == CheckpointData::MAX_ROADS)
+            {
+                break;
+            }
+            CheckpointRoad& record = data.roads[data.roadCount++];
+            record.id1 = static_cast<int16_t>(road.first.getId1());
+            record.id2 = static_cast<int16_t>(road.first.getId2());
+            record.seat = seatOf(players, road.second);
+        }
+    }
+
+
+    /**
+     * @brief Restores a captured state into a game with the same number of players.
+     * The players keep their IDs and names and are seated in the saved order when the names match;
+     * everything else is replaced. The whole checkpoint is validated first, so on an error the game is unchanged.
+     * @param game The game to restore into.
+     * @param data The captured state.
+     * @throws runtime_error if the data does not describe a valid game.
+     */
+    void GameCheckpoint::restore(Catan& game, const CheckpointData& data)
+    {
+        vector<Player*>& players = game.getPlayers();
+        Board& board = game.getBoard();
+        validate(data, players.size());     // Before anything changes, so a rejected checkpoint leaves the game as it was
+        const size_t seats = players.size();
+
+        // Seat the players in the saved order when their names match, since the starting roll reorders them
+        vector<Player*> seated;
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            string name(data.players[seat].name, strnlen(data.players[seat].name, sizeof(data.players[seat].name)));
+            for (Player* player : players)
+            {
+                if (player->name == name && find(seated.begin(), seated.end(), player) == seated.end())
+                {
+                    seated.push_back(player);
+                    break;
+                }
+            }
+        }
+        if (seated.size() == seats)
+        {
+            players = seated;
+        }
+
+        // Empty occupancy on the saved tiles, only rebuilt when they differ from the board's
+        board.settlements.clear();
+        board.cities.clear();
+        board.roads.clear();
+        BoardLayout current;
+        board.getLayout(current);
+        if (!equal(begin(current.resources), end(current.resources), begin(data.layout.resources)) ||
+            !equal(begin(current.numbers), end(current.numbers), begin(data.layout.numbers)))
+        {
+            board.applyLayout(data.layout);
+        }
+        board.moveRobber({data.robber[0], data.robber[1]});
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            Player& player = *players[seat];
+            const CheckpointPlayer& record = data.players[seat];
+            for (int type = WOOD; type <= ORE; ++type)
+            {
+                player.resources[static_cast<ResourceType>(type)] = record.resources[type];
+            }
+            player.developmentCards[DevCardType::PROMOTION] = record.developmentCards[static_cast<int>(DevCardType::PROMOTION)];
+            player.developmentCards[DevCardType::KNIGHT] = record.developmentCards[static_cast<int>(DevCardType::KNIGHT)];
+            player.developmentCards[DevCardType::VICTORY_POINT] = record.developmentCards[static_cast<int>(DevCardType::VICTORY_POINT)];
+            player.promotionCards[PromotionType::MONOPOLY] = record.promotionCards[static_cast<int>(PromotionType::MONOPOLY)];
+            player.promotionCards[PromotionType::ROAD_BUILDING] = record.promotionCards[static_cast<int>(PromotionType::ROAD_BUILDING)];
+            player.promotionCards[PromotionType::YEAR_OF_PLENTY] = record.promotionCards[static_cast<int>(PromotionType::YEAR_OF_PLENTY)];
+            player.points = record.points > 0 ? static_cast<size_t>(record.points) : 0;
+            game.getAwards().restore(static_cast<size_t>(player.id), record.knightCards);
+            player.settlements.clear();
+            player.cities.clear();
+            player.roads.clear();
+            player.harbors = 0;
+            player.addHarborAccess(0);
+        }
+
+        for (int intersectionID = 1; intersectionID < static_cast<int>(CheckpointData::INTERSECTIONS); ++intersectionID)
+        {
+            size_t index = static_cast<size_t>(intersectionID);
+            if (data.settlementSeat[index] >= 0)
+            {
+                Player& owner = *players[static_cast<size_t>(data.settlementSeat[index])];
+                board.settlements[intersectionID].insert(owner.getId());
+                owner.settlements.insert(intersectionID);
+                owner.addHarborAccess(Board::harborAt(intersectionID));
+            }
+            if (data.citySeat[index] >= 0)
+            {
+                Player& owner = *players[static_cast<size_t>(data.citySeat[index])];
+                board.cities[intersectionID] = owner.getId();
+                owner.cities.insert(intersectionID);
+                owner.addHarborAccess(Board::harborAt(intersectionID));
+            }
+        }
+        for (uint32_t i = 0; i < data.roadCount; ++i)
+        {
+            const CheckpointRoad& record = data.roads[i];
+            Player& owner = *players[static_cast<size_t>(record.seat)];
+            Edge edge(Intersection::getIntersection(record.id1), Intersection::getIntersection(record.id2));
+            board.roads[edge] = owner.getId();
+            owner.roads.insert(edge);
+        }
+        board.indexOccupancy();
+
+        for (size_t kind = 0; kind < DevelopmentDeck::KINDS; ++kind)
+        {
+            game.getDeck().setStock(kind, data.deck[kind]);
+        }
+
+        // The saved points include the award, which the tracker now adds back
+        Player* armyHolder = data.largestArmySeat >= 0 ? players[static_cast<size_t>(data.largestArmySeat)] : nullptr;
+        game.getAwards().setHolder(Award::LARGEST_ARMY, armyHolder ? armyHolder->id : -1);
+        if (armyHolder)
+        {
+            const size_t awardPoints = static_cast<size_t>(AwardTracker::AWARD_POINTS);
+            armyHolder->points = armyHolder->points > awardPoints ? armyHolder->points - awardPoints : 0;
+        }
+        game.setCurrentPlayerIndex(data.turn);
+    }
+
+
+    /**
+     * @brief Writes a checkpoint of the game. The file is replaced atomically.
+     * @param game The game to save.
+     * @param path Path of the checkpoint file.
+     * @throws runtime_error if the file cannot be written.
+     */
+    void GameCheckpoint::save(Catan& game, const string& path)
+    {
+        CheckpointData data;
+        capture(game, data);
+
+        // Write next to the target and rename, so a crash never leaves a half written checkpoint
+        string temporary = path + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw runtime_error("Cannot open checkpoint file: " + temporary);
+        }
+        const char* bytes = reinterpret_cast<const char*>(&data);
+        size_t written = 0;
+        while (written < sizeof(data))
+        {
+            ssize_t result = ::write(fd, bytes + written, sizeof(data) - written);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                ::close(fd);
+                ::unlink(temporary.c_str());
+                throw runtime_error("Cannot write checkpoint file: " + temporary);
+            }
+            written += static_cast<size_t>(result);
+        }
+        if (::fsync(fd) != 0 || ::close(fd) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            ::unlink(temporary.c_str());
+            throw runtime_error("Cannot save checkpoint file: " + path);
+        }
+    }
+
+
+    /**
+     * @brief Reads a checkpoint file with a single read and restores it into the game.
+     * @param game The game to restore into.
+     * @param path Path of the checkpoint file.
+     * @throws runtime_error if the file cannot be read or was written by another version.
+     */
+    void GameCheckpoint::load(Catan& game, const string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw runtime_error("Cannot open checkpoint file: " + path);
+        }
+        CheckpointData data;
+        ssize_t result;
+        do {
+            result = ::read(fd, &data, sizeof(data));
+        } while (result < 0 && errno == EINTR);
+        ::close(fd);
+        if (result != static_cast<ssize_t>(sizeof(data)))
+        {
+            throw runtime_error("Truncated checkpoint file: " + path);
+        }
+        restore(game, data);
+    }
+}
@@ -0,0 +1,117 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "catan.hpp"
+#include "boardgen.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief One player as stored in a checkpoint. Owners on the board refer to the seat, not the player ID.
+     */
+    struct CheckpointPlayer
+    {
+        char name[32];                  // Null terminated, truncated if longer
+        int32_t resources[5];           // WOOD, BRICK, WOOL, GRAIN, ORE
+        int32_t developmentCards[3];    // PROMOTION, KNIGHT, VICTORY_POINT
+        int32_t promotionCards[3];      // MONOPOLY, ROAD_BUILDING, YEAR_OF_PLENTY
+        int32_t points;
+        int32_t knightCards;
+    };
+
+
+    /**
+     * @brief One road as stored in a checkpoint.
+     */
+    struct CheckpointRoad
+    {
+        int16_t id1, id2;               // The intersections of the road
+        int32_t seat;                   // The owner
+    };
+
+
+    /**
+     * @brief The complete checkpoint file: a fixed size plain struct written and read with a single call.
+     * The layout is the native one of the host; the version and size fields reject files from other builds.
+     */
+    struct CheckpointData
+    {
+        static const size_t SEATS = MAX_SEATS;      // Records for the largest game
+        static const size_t INTERSECTIONS = 55;     // Indexed by intersection ID (1-54)
+        static const size_t MAX_ROADS = 72;         // Number of edges on the board
+
+        char magic[4];                              // "CTNS"
+        uint32_t version;
+        uint32_t size;                              // sizeof(CheckpointData) of the writer
+        uint32_t seatCount;                         // Number of players in the game
+        uint32_t turn;                              // Seat whose turn it is
+        int32_t largestArmySeat;                    // -1 if nobody holds the Largest Army
+        int32_t robber[2];                          // Tile coordinates of the robber
+        int32_t deck[5];                            // KNIGHT, VICTORY_POINT, MONOPOLY, ROAD_BUILDING, YEAR_OF_PLENTY left
+        BoardLayout layout;                         // Resource and number token of every tile
+        CheckpointPlayer players[SEATS];            // In seat order, the first seatCount are used
+        int8_t settlementSeat[INTERSECTIONS];       // Owner of each settlement (-1 if none)
+        int8_t citySeat[INTERSECTIONS];             // Owner of each city (-1 if none)
+        uint32_t roadCount;
+        CheckpointRoad roads[MAX_ROADS];
+    };
+
+    static_assert(is_trivially_copyable<CheckpointData>::value, "Checkpoints are copied as raw bytes");
+
+
+    /**
+     * @brief This class saves an in-progress game to a compact versioned binary file and restores it.
+     *
+     * A checkpoint holds the tiles, the board occupancy, every player's resources, cards, points and knights, the
+     * robber, the development card stock, the Largest Army holder and the current turn. The harbors are not stored
+     * since every board has them at the same places; harbor access is recomputed from the settlements.
+     */
+    class GameCheckpoint
+    {
+        public:
+
+            static const uint32_t VERSION = 4;
+
+            /**
+             * @brief Captures the state of a game.
+             * @param game The game to capture.
+             * @param data Filled with the state of the game.
+             */
+            static void capture(Catan& game, CheckpointData& data);
+
+            /**
+             * @brief Restores a captured state into a game with the same number of players.
+             * The players keep their IDs and names and are seated in the saved order when the names match;
+             * everything else is replaced. The whole checkpoint is validated first (tiles, robber, owners, the
+             * distance rule and road edges), so on an error the game is unchanged.
+             * @param game The game to restore into.
+             * @param data The captured state.
+             * @throws runtime_error if the data does not describe a valid game.
+             */
+            static void restore(Catan& game, const CheckpointData& data);
+
+            /**
+             * @brief Writes a checkpoint of the game. The file is replaced atomically.
+             * @param game The game to save.
+             * @param path Path of the checkpoint file.
+             * @throws runtime_error if the file cannot be written.
+             */
+            static void save(Catan& game, const string& path);
+
+            /**
+             * @brief Reads a checkpoint file with a single read and restores it into the game.
+             * @param game The game to restore into.
+             * @param path Path of the checkpoint file.
+             * @throws runtime_error if the file cannot be read or was written by another version.
+             */
+            static void load(Catan& game, const string& path);
+    };
+}
+
+#endif
@@ -0,0 +1,169 @@
+// Email: origoldbsc@gmail.com
+
+#include "deck.hpp"
+#include "player.hpp"
+#include "cards.hpp"
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        // Index of the first promotion card kind; the promotions follow in PromotionType order
+        constexpr size_t FIRST_PROMOTION = 2;
+
+        size_t kindOf(PromotionType type)
+        {
+            return FIRST_PROMOTION + static_cast<size_t>(type);
+        }
+    }
+
+
+    DevelopmentDeck::DevelopmentDeck() : members()
+    {
+        for (size_t kind = 0; kind < KINDS; ++kind)
+        {
+            stock[kind] = FULL[kind];
+        }
+    }
+
+
+    /**
+     * @brief Detaches the enrolled players, so they do not refer to a finished game.
+     */
+    DevelopmentDeck::~DevelopmentDeck()
+    {
+        for (Player* member : members)
+        {
+            if (member != nullptr && member->deck == this)
+            {
+                member->deck = nullptr;
+            }
+        }
+    }
+
+
+    /**
+     * @brief Enrolls a player at its seat, so it draws its cards from this deck.
+     * @throws out_of_range if the player's ID is not a seat.
+     */
+    void DevelopmentDeck::enroll(Player& player)
+    {
+        if (!PlayerRegistry::isSeat(player.getId()))
+        {
+            throw out_of_range("Player " + player.getName() + " is not seated");
+        }
+        members[static_cast<size_t>(player.getId())] = &player;
+        player.deck = this;
+    }
+
+
+    /**
+     * @brief Returns the cards left of a type (the three promotion cards together).
+     */
+    int DevelopmentDeck::getQuantity(DevCardType type) const
+    {
+        switch (type)
+        {
+            case DevCardType::KNIGHT:
+                return stock[0];
+            case DevCardType::VICTORY_POINT:
+                return stock[1];
+            case DevCardType::PROMOTION:
+                return stock[2] + stock[3] + stock[4];
+            default:
+                return 0;
+        }
+    }
+
+
+    int DevelopmentDeck::getQuantity(PromotionType type) const
+    {
+        return stock[kindOf(type)];
+    }
+
+
+    /**
+     * @brief Takes one card of a type from the stock.
+     * @return False if none is left.
+     */
+    bool DevelopmentDeck::draw(DevCardType type)
+    {
+        if (type == DevCardType::PROMOTION)
+        {
+            // The first promotion card left, in PromotionType order
+            for (size_t kind = FIRST_PROMOTION; kind < KINDS; ++kind)
+            {
+                if (stock[kind] > 0)
+                {
+                    stock[kind]--;
+                    return true;
+                }
+            }
+            return false;
+        }
+        int& left = stock[type == DevCardType::KNIGHT ? 0 : 1];
+        if (left <= 0)
+        {
+            return false;
+        }
+        left--;
+        return true;
+    }
+
+
+    bool DevelopmentDeck::draw(PromotionType type)
+    {
+        int& left = stock[kindOf(type)];
+        if (left <= 0)
+        {
+            return false;
+        }
+        left--;
+        return true;
+    }
+
+
+    /**
+     * @brief Reads or sets the cards left of a kind by index, used by checkpoints.
+     */
+    int DevelopmentDeck::getStock(size_t kind) const
+    {
+        return kind < KINDS ? stock[kind] : 0;
+    }
+
+
+    void DevelopmentDeck::setStock(size_t kind, int count)
+    {
+        if (kind < KINDS)
+        {
+            stock[kind] = count;
+        }
+    }
+
+
+    /**
+     * @brief Returns the cards left of a type in a new game, what a player outside a game can draw.
+     */
+    int DevelopmentDeck::fullQuantity(DevCardType type)
+    {
+        switch (type)
+        {
+            case DevCardType::KNIGHT:
+                return FULL[0];
+            case DevCardType::VICTORY_POINT:
+                return FULL[1];
+            case DevCardType::PROMOTION:
+                return FULL[2] + FULL[3] + FULL[4];
+            default:
+                return 0;
+        }
+    }
+
+
+    int DevelopmentDeck::fullQuantity(PromotionType type)
+    {
+        return FULL[kindOf(type)];
+    }
+}
@@ -0,0 +1,81 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef DECK_HPP
+#define DECK_HPP
+
+#include <cstddef>
+#include "registry.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Player;
+    enum class DevCardType;
+    enum class PromotionType;
+
+    /**
+     * @brief The development cards left in the stock of one game.
+     *
+     * Every game draws from its own deck, so games hosted in the same process never share a stock. Players are
+     * enrolled at their seat like in AwardTracker; a player outside a game has no deck and finds every card available.
+     * The stock is kept per card kind, in the order KNIGHT, VICTORY_POINT, MONOPOLY, ROAD_BUILDING, YEAR_OF_PLENTY,
+     * which is also the order of CheckpointData::deck.
+     */
+    class DevelopmentDeck
+    {
+        public:
+
+            static constexpr size_t KINDS = 5;
+            static constexpr int FULL[KINDS] = {14, 4, 2, 2, 2};    // The stock of a new game
+
+        private:
+
+            Player* members[MAX_SEATS];         // Enrolled players, by seat
+            int stock[KINDS];                   // Cards left of each kind
+
+        public:
+
+            DevelopmentDeck();
+
+            /**
+             * @brief Detaches the enrolled players, so they do not refer to a finished game.
+             */
+            ~DevelopmentDeck();
+
+            DevelopmentDeck(const DevelopmentDeck&) = delete;
+            DevelopmentDeck& operator=(const DevelopmentDeck&) = delete;
+
+            /**
+             * @brief Enrolls a player at its seat, so it draws its cards from this deck.
+             * @throws out_of_range if the player's ID is not a seat.
+             */
+            void enroll(Player& player);
+
+            /**
+             * @brief Returns the cards left of a type (the three promotion cards together).
+             */
+            int getQuantity(DevCardType type) const;
+            int getQuantity(PromotionType type) const;
+
+            /**
+             * @brief Takes one card of a type from the stock.
+             * @return False if none is left.
+             */
+            bool draw(DevCardType type);
+            bool draw(PromotionType type);
+
+            /**
+             * @brief Reads or sets the cards left of a kind by index, used by checkpoints.
+             */
+            int getStock(size_t kind) const;
+            void setStock(size_t kind, int count);
+
+            /**
+             * @brief Returns the cards left of a type in a new game, what a player outside a game can draw.
+             */
+            static int fullQuantity(DevCardType type);
+            static int fullQuantity(PromotionType type);
+    };
+}
+
+#endif
@@ -0,0 +1,193 @@
+// Email: origoldbsc@gmail.com
+
+#include "discard.hpp"
+#include "board.hpp"
+#include "player.hpp"
+#include <algorithm>
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief Returns the built-in policy with the given name, or nullptr.
+     */
+    const DiscardPolicy* DiscardPolicy::byName(const string& name)
+    {
+        static const KeepBalancedPolicy balanced;
+        static const KeepClosestBuildPolicy closestBuild;
+        if (name.empty() || name == balanced.getName())
+        {
+            return &balanced;
+        }
+        if (name == closestBuild.getName())
+        {
+            return &closestBuild;
+        }
+        return nullptr;
+    }
+
+
+    /**
+     * @brief Returns the built-in policy with the given name, including "rarest" for the given board, or nullptr.
+     */
+    const DiscardPolicy* DiscardPolicy::byName(const string& name, const Board& board)
+    {
+        if (name == "rarest")
+        {
+            thread_local KeepRarestPolicy rarest(board);
+            rarest = KeepRarestPolicy(board);
+            return &rarest;
+        }
+        return byName(name);
+    }
+
+
+    //-------------------------------------//
+    //         KeepBalancedPolicy          //
+    //-------------------------------------//
+
+    /**
+     * @brief Lowers the largest piles to a common level, like water poured out of the tallest glasses.
+     * The five lanes are sorted once and the level is found in one pass, instead of discarding card by card.
+     */
+    void KeepBalancedPolicy::choose(const ResourceVector& hand, int amount, ResourceVector& discard) const
+    {
+        discard = ResourceVector{};
+        size_t lanes[RESOURCE_TYPES] = {WOOD, BRICK, WOOL, GRAIN, ORE};
+        stable_sort(lanes, lanes + RESOURCE_TYPES, [&hand](size_t a, size_t b) { return hand[a] > hand[b]; });
+        amount = min(amount, totalResources(hand));
+        if (amount <= 0)
+        {
+            return;
+        }
+
+        // Find how many of the largest piles (k) are lowered: the first k whose excess over the next pile covers the amount
+        int sum = 0;
+        size_t k = 0;
+        while (k < RESOURCE_TYPES)
+        {
+            sum += hand[lanes[k]];
+            ++k;
+            int next = k < RESOURCE_TYPES ? hand[lanes[k]] : 0;
+            if (sum - static_cast<int>(k) * next >= amount)
+            {
+                break;
+            }
+        }
+
+        // Lower the k piles to the level (rounded up), then take one more from the first piles for the remainder
+        int groups = static_cast<int>(k);
+        int level = (sum - amount + groups - 1) / groups;
+        int left = amount;
+        for (size_t i = 0; i < k; ++i)
+        {
+            discard[lanes[i]] = max(hand[lanes[i]] - level, 0);
+            left -= discard[lanes[i]];
+        }
+        for (size_t i = 0; i < k && left > 0; ++i)
+        {
+            if (discard[lanes[i]] < hand[lanes[i]])
+            {
+                discard[lanes[i]]++;
+                left--;
+            }
+        }
+    }
+
+
+    string KeepBalancedPolicy::getName() const
+    {
+        return "balanced";
+    }
+
+
+    //-------------------------------------//
+    //       KeepClosestBuildPolicy        //
+    //-------------------------------------//
+
+    /**
+     * @brief Keeps what the closest structure needs and discards evenly from the rest.
+     * The structures are compared from the most to the least valuable, so a city wins a tie with a road.
+     */
+    void KeepClosestBuildPolicy::choose(const ResourceVector& hand, int amount, ResourceVector& discard) const
+    {
+        static const Structure byValue[STRUCTURE_TYPES] = {Structure::CITY, Structure::SETTLEMENT, Structure::DEVELOPMENT_CARD, Structure::ROAD};
+        const ResourceVector none = {};
+        amount = min(amount, totalResources(hand));
+
+        // The structure missing the fewest resources
+        ResourceVector kept = {};
+        int fewestMissing = -1;
+        for (Structure structure : byValue)
+        {
+            const ResourceVector& cost = Player::costOf(structure);
+            ResourceVector missing = cost - hand;
+            missing = missing > none ? missing : none;          // Lane-wise max(cost - hand, 0)
+            int count = totalResources(missing);
+            if (fewestMissing < 0 || count < fewestMissing)
+            {
+                fewestMissing = count;
+                kept = cost < hand ? cost : hand;                   // Lane-wise min(cost, hand)
+            }
+        }
+
+        // A hand of 8 or 9 keeps only 4 resources, one less than a city
+        int excess = totalResources(kept) - (totalResources(hand) - amount);
+        for (size_t type = ORE + 1; type-- > WOOD && excess > 0;)
+        {
+            int removed = min(kept[type], excess);
+            kept[type] -= removed;
+            excess -= removed;
+        }
+
+        static const KeepBalancedPolicy balanced;
+        ResourceVector rest = hand - kept;
+        balanced.choose(rest, amount, discard);
+    }
+
+
+    string KeepClosestBuildPolicy::getName() const
+    {
+        return "build";
+    }
+
+
+    //-------------------------------------//
+    //          KeepRarestPolicy           //
+    //-------------------------------------//
+
+    /**
+     * @brief Orders the resources by how much the board produces of them (the chances of their numbers).
+     */
+    KeepRarestPolicy::KeepRarestPolicy(const Board& board)
+    {
+        ResourceVector production;
+        board.getProductionWeights(production);
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            order[type] = static_cast<ResourceType>(type);
+        }
+        stable_sort(order, order + RESOURCE_TYPES, [&production](ResourceType a, ResourceType b) { return production[a] > production[b]; });
+    }
+
+
+    /**
+     * @brief Discards whole piles of the most produced resources first.
+     */
+    void KeepRarestPolicy::choose(const ResourceVector& hand, int amount, ResourceVector& discard) const
+    {
+        discard = ResourceVector{};
+        for (ResourceType type : order)
+        {
+            int taken = min(hand[type], max(amount, 0));
+            discard[type] = taken;
+            amount -= taken;
+        }
+    }
+
+
+    string KeepRarestPolicy::getName() const
+    {
+        return "rarest";
+    }
+}
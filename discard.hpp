@@ -0,0 +1,97 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef DISCARD_HPP
+#define DISCARD_HPP
+
+#include <string>
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Board;
+
+    //-------------------------------------//
+    //       DiscardPolicy - Interface     //
+    //-------------------------------------//
+
+    /**
+     * @brief Decides which resources a player gives up when a 7 is rolled.
+     * Every policy works on the five resource lanes only, so a choice takes the same time for any hand.
+     */
+    class DiscardPolicy
+    {
+        public:
+
+            virtual ~DiscardPolicy() = default;
+
+            /**
+             * @brief Chooses the resources to discard.
+             * @param hand The resources held.
+             * @param amount How many resources to discard (at most the size of the hand).
+             * @param discard Set to the resources to discard: never more of a type than held, adding up to amount.
+             */
+            virtual void choose(const ResourceVector& hand, int amount, ResourceVector& discard) const = 0;
+
+            /**
+             * @brief Returns the name of the policy, as used by "discard auto <name>".
+             */
+            virtual string getName() const = 0;
+
+            /**
+             * @brief Returns the built-in policy with the given name, or nullptr. "rarest" depends on the board
+             * and is only available from the overload below.
+             */
+            static const DiscardPolicy* byName(const string& name);
+
+            /**
+             * @brief Returns the built-in policy with the given name, including "rarest" for the given board, or nullptr.
+             * The "rarest" policy reads the board now and is rebuilt by the next call on the same thread,
+             * so it is meant to be used right away (as "discard auto rarest" does).
+             */
+            static const DiscardPolicy* byName(const string& name, const Board& board);
+    };
+
+
+    /**
+     * @brief Discards from the largest piles first, leaving the hand as even as possible.
+     */
+    class KeepBalancedPolicy : public DiscardPolicy
+    {
+        public:
+            void choose(const ResourceVector& hand, int amount, ResourceVector& discard) const override;
+            string getName() const override;
+    };
+
+
+    /**
+     * @brief Keeps the cost of the structure that is closest to affordable (the most valuable on ties)
+     * and discards evenly from the rest.
+     */
+    class KeepClosestBuildPolicy : public DiscardPolicy
+    {
+        public:
+            void choose(const ResourceVector& hand, int amount, ResourceVector& discard) const override;
+            string getName() const override;
+    };
+
+
+    /**
+     * @brief Keeps the resources the board produces least and discards the common ones first.
+     * The production of each resource is read from the board once, when the policy is created.
+     */
+    class KeepRarestPolicy : public DiscardPolicy
+    {
+        private:
+
+            ResourceType order[RESOURCE_TYPES];     // Resources from the most produced to the least produced
+
+        public:
+
+            explicit KeepRarestPolicy(const Board& board);
+            void choose(const ResourceVector& hand, int amount, ResourceVector& discard) const override;
+            string getName() const override;
+    };
+}
+
+#endif
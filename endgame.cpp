@@ -0,0 +1,748 @@
+// Email: origoldbsc@gmail.com
+
+#include "endgame.hpp"
+#include "catan.hpp"
+#include "cards.hpp"
+#include "checkpoint.hpp"
+#include "topology.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        constexpr int MAX_SETTLEMENTS = 5;
+        constexpr int MAX_CITIES = 4;
+        constexpr int MAX_ROADS = 15;
+        constexpr int MAX_MOVES = 128;
+        constexpr int MAX_HAND = 100;           // Income past this is dropped, keeps the hand in an int8_t
+
+        uint64_t bitOf(int intersectionID)
+        {
+            return uint64_t{1} << intersectionID;
+        }
+
+        /**
+         * @brief splitmix64, mixes one word of a position into its cache key.
+         */
+        uint64_t mix(uint64_t value)
+        {
+            value += 0x9E3779B97F4A7C15ull;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+        /**
+         * @brief One branch of a chance node: a hand the rolls may leave, and its chance.
+         */
+        struct Outcome
+        {
+            double probability;
+            int8_t hand[RESOURCE_TYPES];
+
+            uint64_t packed() const
+            {
+                uint64_t value = 0;
+                memcpy(&value, hand, RESOURCE_TYPES);
+                return value;
+            }
+        };
+    }
+
+
+    /**
+     * @brief The seat's side of a position, all the search changes. Plain data, copied once per move.
+     */
+    struct EndgameSolver::State
+    {
+        uint64_t settlements;                   // The seat's settlements, by intersection ID
+        uint64_t cities;
+        uint64_t roadEnds;                      // Intersections the seat's roads touch
+        uint64_t closed;                        // Intersections with a building or next to one
+        int8_t hand[RESOURCE_TYPES];
+        int8_t points;                          // Victory points, without the cards not played yet
+        int8_t pointCards;                      // Victory point cards held
+        int8_t cardsLeft;                       // Development cards in the stock
+        int8_t pointCardsLeft;                  // Victory point cards among them
+        int8_t settlementsLeft;                 // Pieces the seat may still place
+        int8_t citiesLeft;
+        int8_t roadsLeft;
+
+        /**
+         * @brief Returns the cache key of the position at a node (the tag tells the kind and depth of the node).
+         */
+        uint64_t key(uint64_t tag) const
+        {
+            uint64_t counts = 0, pieces = 0;
+            memcpy(&counts, hand, RESOURCE_TYPES);
+            counts |= static_cast<uint64_t>(static_cast<uint8_t>(points)) << 40 | static_cast<uint64_t>(static_cast<uint8_t>(pointCards)) << 48
+                      | static_cast<uint64_t>(static_cast<uint8_t>(cardsLeft)) << 56;
+            pieces = static_cast<uint64_t>(static_cast<uint8_t>(pointCardsLeft)) | static_cast<uint64_t>(static_cast<uint8_t>(roadsLeft)) << 8 | tag << 16;
+            uint64_t value = mix(settlements);
+            value = mix(value ^ cities);
+            value = mix(value ^ roadEnds);
+            value = mix(value ^ counts);
+            return mix(value ^ pieces);
+        }
+    };
+
+
+    /**
+     * @brief A move of a decision node.
+     */
+    struct EndgameSolver::Move
+    {
+        enum Kind : uint8_t { CITY, SETTLEMENT, POINT_CARD, BUY, ROAD, TRADE, END };
+
+        Kind kind;
+        int first;                              // Intersection built on, the road's start, or the resource given
+        int second;                             // The road's end, or the resource taken
+    };
+
+
+    /**
+     * @brief A cached value. An upper bound if the node was cut off, the exact value otherwise.
+     */
+    struct EndgameSolver::Entry
+    {
+        uint64_t key;
+        double value;
+        uint32_t generation;
+        bool upper;
+    };
+
+
+    EndgameSolver::EndgameSolver(const EndgameOptions& options) : options(options), generation(0), nodes(0), cacheHits(0), exhausted(false)
+    {
+        size_t size = 2;
+        while (size < options.cacheEntries)
+        {
+            size <<= 1;
+        }
+        cache.assign(size, Entry{0, 0, 0, false});
+        mask = size - 1;
+    }
+
+
+    EndgameSolver::~EndgameSolver() = default;
+
+
+    /**
+     * @brief Returns true if a seat is at most MARGIN points short of winning, counting its victory point cards.
+     */
+    bool EndgameSolver::isEndgame(Catan& game, size_t seat)
+    {
+        const Player& player = *game.getPlayers()[seat];
+        const map<DevCardType, int>& cards = player.getDevelopmentCards();
+        auto held = cards.find(DevCardType::VICTORY_POINT);
+        int points = player.getPoints() + (held == cards.end() ? 0 : held->second);
+        return points >= WIN_POINTS - MARGIN;
+    }
+
+
+    /**
+     * @brief Reads the seat's side of the game into a state, and the rest of the game (the tiles, the robber and the
+     * other seats' buildings and roads, which the search does not change) into the solver.
+     */
+    void EndgameSolver::prepare(Catan& game, size_t seat, State& state)
+    {
+        CheckpointData data;
+        GameCheckpoint::capture(game, data);
+        const HexTopology& topology = HexTopology::standard();
+        const Player& player = *game.getPlayers()[seat];
+        const CheckpointPlayer& record = data.players[seat];
+
+        state = State{};
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            state.hand[type] = static_cast<int8_t>(min<int>(record.resources[type], MAX_HAND));
+            bankRates[type] = player.getBankRate(static_cast<ResourceType>(type));
+        }
+        for (size_t structure = 0; structure < STRUCTURE_TYPES; ++structure)
+        {
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                costs[structure][type] = Player::costOf(static_cast<Structure>(structure))[type];
+            }
+        }
+        state.points = static_cast<int8_t>(record.points);
+        state.pointCards = static_cast<int8_t>(record.developmentCards[static_cast<int>(DevCardType::VICTORY_POINT)]);
+        int cardsLeft = 0;
+        for (int count : data.deck)
+        {
+            cardsLeft += count;
+        }
+        state.cardsLeft = static_cast<int8_t>(cardsLeft);
+        state.pointCardsLeft = static_cast<int8_t>(data.deck[1]);
+
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            closes[id] = bitOf(id);
+            for (size_t index = 0; index < 3; ++index)
+            {
+                neighbors[id][index] = topology.neighbors(id)[index];
+                closes[id] |= neighbors[id][index] != 0 ? bitOf(neighbors[id][index]) : 0;
+            }
+        }
+        blocked = 0;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            int8_t owner = data.citySeat[id] >= 0 ? data.citySeat[id] : data.settlementSeat[id];
+            if (owner < 0)
+            {
+                continue;
+            }
+            state.closed |= closes[id];
+            if (static_cast<size_t>(owner) != seat)
+            {
+                blocked |= bitOf(id);
+            }
+            else if (data.citySeat[id] >= 0)
+            {
+                state.cities |= bitOf(id);
+            }
+            else
+            {
+                state.settlements |= bitOf(id);
+            }
+        }
+        state.settlementsLeft = static_cast<int8_t>(MAX_SETTLEMENTS - popcount(state.settlements));
+        state.citiesLeft = static_cast<int8_t>(MAX_CITIES - popcount(state.cities));
+
+        int roads = 0;
+        takenEdges[0] = takenEdges[1] = 0;
+        for (uint32_t index = 0; index < data.roadCount; ++index)
+        {
+            const CheckpointRoad& road = data.roads[index];
+            int edge = topology.edgeIndex(road.id1, road.id2);
+            if (edge >= 0)
+            {
+                takenEdges[edge / 64] |= uint64_t{1} << (edge % 64);
+            }
+            if (road.seat >= 0 && static_cast<size_t>(road.seat) == seat)
+            {
+                state.roadEnds |= bitOf(road.id1) | bitOf(road.id2);
+                ++roads;
+            }
+        }
+        state.roadsLeft = static_cast<int8_t>(MAX_ROADS - roads);
+
+        Board& board = game.getBoard();
+        pair<int, int> robber(data.robber[0], data.robber[1]);
+        fill(begin(yieldCount), end(yieldCount), 0);
+        for (size_t tile = 0; tile < topology.tileCount(); ++tile)
+        {
+            const Tile& placed = board.getTile(topology.tilePosition(tile));
+            int number = placed.getNumber();
+            if (placed.getResourceType() == ResourceType::NONE || number < 2 || number > 12 || number == 7 || topology.tilePosition(tile) == robber)
+            {
+                continue;
+            }
+            size_t roll = static_cast<size_t>(number);
+            for (int corner : topology.tileCorners(tile))
+            {
+                yieldAt[roll][yieldCount[roll]] = corner;
+                yieldType[roll][yieldCount[roll]++] = static_cast<size_t>(placed.getResourceType());
+            }
+        }
+        rollsPerRound = options.otherRolls ? static_cast<int>(data.seatCount) : 1;
+    }
+
+
+    /**
+     * @brief Returns true if a road from an intersection the seat reaches leads somewhere new: to an open spot,
+     * or next to one.
+     */
+    bool EndgameSolver::usefulRoad(const State& state, int from, int to) const
+    {
+        if (to == 0 || (state.roadEnds & bitOf(to)) != 0 || (blocked & bitOf(to)) != 0)
+        {
+            return false;
+        }
+        int edge = HexTopology::standard().edgeIndex(from, to);
+        if (edge < 0 || (takenEdges[edge / 64] >> (edge % 64) & 1) != 0)
+        {
+            return false;
+        }
+        if ((state.closed & bitOf(to)) == 0)
+        {
+            return true;
+        }
+        for (int beyond : neighbors[to])
+        {
+            if (beyond != 0 && beyond != from && (state.closed & bitOf(beyond)) == 0 && (state.roadEnds & bitOf(beyond)) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    /**
+     * @brief Lists the moves of a decision node, the likeliest to win first.
+     * @param last True on the last searched turn, where ending the turn cannot win any more and is left out.
+     * @return The number of moves.
+     */
+    int EndgameSolver::listMoves(const State& state, bool last, Move* moves) const
+    {
+        int count = 0;
+        auto affords = [&](Structure structure) {
+            const int* cost = costs[static_cast<size_t>(structure)];
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                if (state.hand[type] < cost[type])
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        bool canUpgrade = state.settlements != 0 && state.citiesLeft > 0;
+        uint64_t open = state.settlementsLeft > 0 ? state.roadEnds & ~state.closed & ~uint64_t{1} : 0;
+        if (canUpgrade && affords(Structure::CITY))
+        {
+            for (uint64_t built = state.settlements; built != 0; built &= built - 1)
+            {
+                moves[count++] = {Move::CITY, countr_zero(built), 0};
+            }
+        }
+        if (affords(Structure::SETTLEMENT))
+        {
+            for (uint64_t spots = open; spots != 0; spots &= spots - 1)
+            {
+                moves[count++] = {Move::SETTLEMENT, countr_zero(spots), 0};
+            }
+        }
+        if (state.pointCards > 0)
+        {
+            moves[count++] = {Move::POINT_CARD, 0, 0};
+        }
+        if (state.cardsLeft > 0 && affords(Structure::DEVELOPMENT_CARD))
+        {
+            moves[count++] = {Move::BUY, 0, 0};
+        }
+
+        // One road to each new intersection, the start does not change what the road leads to
+        bool anyRoad = false;
+        if (state.roadsLeft > 0)
+        {
+            bool payable = affords(Structure::ROAD);
+            uint64_t reached = 0;
+            for (uint64_t starts = (state.roadEnds | state.settlements | state.cities) & ~blocked; starts != 0; starts &= starts - 1)
+            {
+                int from = countr_zero(starts);
+                for (int to : neighbors[from])
+                {
+                    if ((reached & bitOf(to)) == 0 && usefulRoad(state, from, to))
+                    {
+                        reached |= bitOf(to);
+                        anyRoad = true;
+                        if (payable && count < MAX_MOVES - 1)
+                        {
+                            moves[count++] = {Move::ROAD, from, to};
+                        }
+                    }
+                }
+            }
+        }
+
+        // Bank trades that bring a resource some build is missing, paid from a surplus over that build
+        bool goals[STRUCTURE_TYPES] = {};
+        goals[static_cast<size_t>(Structure::ROAD)] = anyRoad;
+        goals[static_cast<size_t>(Structure::SETTLEMENT)] = open != 0;
+        goals[static_cast<size_t>(Structure::CITY)] = canUpgrade;
+        goals[static_cast<size_t>(Structure::DEVELOPMENT_CARD)] = state.cardsLeft > 0;
+        for (int give = WOOD; give <= ORE; ++give)
+        {
+            if (state.hand[give] < bankRates[give])
+            {
+                continue;
+            }
+            for (int get = WOOD; get <= ORE; ++get)
+            {
+                bool helps = false;
+                for (size_t structure = 0; structure < STRUCTURE_TYPES && get != give && !helps; ++structure)
+                {
+                    helps = goals[structure] && state.hand[get] < costs[structure][get] && state.hand[give] - bankRates[give] >= costs[structure][give];
+                }
+                if (helps && count < MAX_MOVES - 1)
+                {
+                    moves[count++] = {Move::TRADE, give, get};
+                }
+            }
+        }
+
+        if (!last)
+        {
+            moves[count++] = {Move::END, 0, 0};
+        }
+        return count;
+    }
+
+
+    /**
+     * @brief Returns the value of a move: the chance to win after it, with the best play from there on.
+     * @param turns Own turns left, counting the current one.
+     * @param alpha The best value of the move's siblings so far, values at or below it are only upper bounds.
+     */
+    double EndgameSolver::apply(const State& state, const Move& move, int turns, double alpha)
+    {
+        State after = state;
+        auto pay = [&](Structure structure) {
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                after.hand[type] = static_cast<int8_t>(after.hand[type] - costs[static_cast<size_t>(structure)][type]);
+            }
+        };
+        auto endTurn = [&]() {
+            return turns <= 1 ? 0.0 : chance(after, turns - 1, rollsPerRound, alpha);
+        };
+
+        switch (move.kind)
+        {
+            case Move::CITY:
+                pay(Structure::CITY);
+                after.settlements &= ~bitOf(move.first);
+                after.cities |= bitOf(move.first);
+                ++after.settlementsLeft;
+                --after.citiesLeft;
+                ++after.points;
+                break;
+            case Move::SETTLEMENT:
+                pay(Structure::SETTLEMENT);
+                after.settlements |= bitOf(move.first);
+                after.closed |= closes[move.first];
+                --after.settlementsLeft;
+                ++after.points;
+                break;
+            case Move::ROAD:
+                pay(Structure::ROAD);
+                after.roadEnds |= bitOf(move.first) | bitOf(move.second);
+                --after.roadsLeft;
+                break;
+            case Move::TRADE:
+                after.hand[move.first] = static_cast<int8_t>(after.hand[move.first] - bankRates[move.first]);
+                ++after.hand[move.second];
+                break;
+            case Move::POINT_CARD:
+                ++after.points;
+                --after.pointCards;
+                return after.points >= WIN_POINTS ? 1.0 : endTurn();
+            case Move::END:
+                return endTurn();
+            case Move::BUY:
+            {
+                // A chance node over the card drawn: a victory point card, or one the search does not play
+                pay(Structure::DEVELOPMENT_CARD);
+                double pointChance = static_cast<double>(after.pointCardsLeft) / static_cast<double>(after.cardsLeft);
+                --after.cardsLeft;
+                State other = after;
+                double value = 0;
+                if (pointChance < 1)
+                {
+                    double weight = 1 - pointChance;
+                    value += weight * act(other, turns, (alpha - pointChance) / weight);
+                    if (value + pointChance <= alpha)
+                    {
+                        return value + pointChance;
+                    }
+                }
+                if (pointChance > 0)
+                {
+                    ++after.pointCards;
+                    --after.pointCardsLeft;
+                    value += pointChance * act(after, turns, (alpha - value) / pointChance);
+                }
+                return value;
+            }
+        }
+        return after.points >= WIN_POINTS ? 1.0 : act(after, turns, alpha);
+    }
+
+
+    /**
+     * @brief A decision node: the best of the seat's moves.
+     */
+    double EndgameSolver::act(const State& state, int turns, double alpha)
+    {
+        if (!spend(1))
+        {
+            return 0;
+        }
+        uint64_t key = state.key(static_cast<uint64_t>(turns) << 4);
+        double best = 0;
+        if (lookup(key, alpha, best))
+        {
+            return best;
+        }
+
+        Move moves[MAX_MOVES];
+        int count = listMoves(state, turns <= 1, moves);
+        for (int index = 0; index < count && best < 1 && !exhausted; ++index)
+        {
+            best = max(best, apply(state, moves[index], turns, max(alpha, best)));
+        }
+        store(key, alpha, best);
+        return best;
+    }
+
+
+    /**
+     * @brief A chance node: the dice rolls until the seat's next action phase. No decision is made between them, so
+     * they are played out into one distribution over the hands they can leave, and the seat acts on each of them.
+     * @param rolls Rolls before the action phase, the seat's own roll being the last.
+     */
+    double EndgameSolver::chance(const State& state, int turns, int rolls, double alpha)
+    {
+        if (!spend(1))
+        {
+            return 0;
+        }
+        uint64_t key = state.key(static_cast<uint64_t>(turns) << 4 | static_cast<uint64_t>(rolls));
+        double value = 0;
+        if (lookup(key, alpha, value))
+        {
+            return value;
+        }
+
+        // What each sum gives, with the buildings of the state
+        int income[13][RESOURCE_TYPES] = {};
+        for (int sum = 2; sum <= 12; ++sum)
+        {
+            for (size_t index = 0; index < yieldCount[sum]; ++index)
+            {
+                uint64_t corner = bitOf(yieldAt[sum][index]);
+                income[sum][yieldType[sum][index]] += (state.settlements & corner) != 0 ? 1 : (state.cities & corner) != 0 ? 2 : 0;
+            }
+        }
+
+        // The hands after each roll, with their chances; equal hands are merged after every roll
+        vector<Outcome> hands = {{1.0, {}}}, next;
+        copy(begin(state.hand), end(state.hand), hands[0].hand);
+        for (int roll = 0; roll < rolls; ++roll)
+        {
+            next.clear();
+            for (const Outcome& outcome : hands)
+            {
+                int held = 0;
+                for (int8_t count : outcome.hand)
+                {
+                    held += count;
+                }
+                for (int sum = 2; sum <= 12; ++sum)
+                {
+                    Outcome after = {outcome.probability * static_cast<double>(6 - abs(7 - sum)) / 36.0, {}};
+                    for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+                    {
+                        after.hand[type] = static_cast<int8_t>(min(outcome.hand[type] + income[sum][type], MAX_HAND));
+                    }
+                    for (int discard = sum == 7 && held > 7 ? held / 2 : 0; discard > 0; --discard)
+                    {
+                        --*max_element(after.hand, after.hand + RESOURCE_TYPES);
+                    }
+                    next.push_back(after);
+                }
+            }
+            sort(next.begin(), next.end(), [](const Outcome& a, const Outcome& b) { return a.packed() < b.packed(); });
+            hands.clear();
+            for (const Outcome& outcome : next)
+            {
+                if (!hands.empty() && hands.back().packed() == outcome.packed())
+                {
+                    hands.back().probability += outcome.probability;
+                }
+                else
+                {
+                    hands.push_back(outcome);
+                }
+            }
+        }
+        sort(hands.begin(), hands.end(), [](const Outcome& a, const Outcome& b) { return a.probability > b.probability; });
+        if (!spend(hands.size()))
+        {
+            return 0;
+        }
+
+        double remaining = 1;
+        for (const Outcome& outcome : hands)
+        {
+            State after = state;
+            copy(begin(outcome.hand), end(outcome.hand), after.hand);
+
+            // Star1: the branch only matters if it can lift the node above alpha with every later branch won
+            remaining -= outcome.probability;
+            double childAlpha = (alpha - value - remaining) / outcome.probability;
+            value += outcome.probability * act(after, turns, childAlpha);
+            if (exhausted)
+            {
+                return 0;
+            }
+            if (value + remaining <= alpha)
+            {
+                value += max(remaining, 0.0);
+                break;
+            }
+        }
+        store(key, alpha, value);
+        return value;
+    }
+
+
+    /**
+     * @brief Counts work against the node budget. Once it runs out every node returns at once and nothing more is cached.
+     */
+    bool EndgameSolver::spend(size_t amount)
+    {
+        nodes += amount;
+        exhausted = exhausted || (options.maxNodes > 0 && nodes > options.maxNodes);
+        return !exhausted;
+    }
+
+
+    bool EndgameSolver::lookup(uint64_t key, double alpha, double& value)
+    {
+        const Entry& entry = cache[key & mask];
+        if (entry.generation != generation || entry.key != key || (entry.upper && entry.value > alpha))
+        {
+            return false;
+        }
+        value = entry.value;
+        ++cacheHits;
+        return true;
+    }
+
+
+    /**
+     * @brief Caches a value; a value at or below the node's alpha may come from cut off branches and is only an upper bound.
+     */
+    void EndgameSolver::store(uint64_t key, double alpha, double value)
+    {
+        if (exhausted)
+        {
+            return;
+        }
+        cache[key & mask] = {key, value, generation, value <= alpha};
+    }
+
+
+    string EndgameSolver::describe(const Move& move) const
+    {
+        switch (move.kind)
+        {
+            case Move::CITY:
+                return "city " + to_string(move.first);
+            case Move::SETTLEMENT:
+                return "settle " + to_string(move.first);
+            case Move::ROAD:
+                return "road " + to_string(move.first) + " " + to_string(move.second);
+            case Move::TRADE:
+                return "bank " + resourceTypeToString(static_cast<ResourceType>(move.first)) + " " + resourceTypeToString(static_cast<ResourceType>(move.second));
+            case Move::POINT_CARD:
+                return "use vp";
+            case Move::BUY:
+                return "buy";
+            case Move::END:
+                break;
+        }
+        return "end";
+    }
+
+
+    /**
+     * @brief Finds the best move of a seat in its action phase (after its roll). The moves of the first node are
+     * checked with the board's placement rules, the search below them follows the simplified rules of its state.
+     * @param seat Index of the seat in Catan::getPlayers().
+     */
+    EndgameMove EndgameSolver::bestMove(Catan& game, size_t seat)
+    {
+        State state;
+        prepare(game, seat, state);
+        ++generation;
+        nodes = cacheHits = 0;
+        exhausted = false;
+
+        Board& board = game.getBoard();
+        int playerID = game.getPlayers()[seat]->getId();
+        Move moves[MAX_MOVES];
+        int count = listMoves(state, false, moves);
+        bool legal[MAX_MOVES];
+        for (int index = 0; index < count; ++index)
+        {
+            const Move& move = moves[index];
+            legal[index] = true;
+            if (move.kind == Move::SETTLEMENT)
+            {
+                legal[index] = board.isOpenForSettlement(move.first) && board.isIntersectionConnectedToPlayerRoad(move.first, playerID);
+            }
+            else if (move.kind == Move::ROAD)
+            {
+                legal[index] = board.canPlaceRoad(Edge(Intersection::getIntersection(move.first), Intersection::getIntersection(move.second)), playerID);
+            }
+        }
+
+        EndgameMove result = {"end", 0, 0, 0, 0};
+        for (int turns = 1; turns <= max(options.turns, 1) && result.probability < 1; ++turns)
+        {
+            string command = "end";
+            double best = -1;
+            for (int index = 0; index < count && best < 1 && !exhausted; ++index)
+            {
+                double value = legal[index] ? apply(state, moves[index], turns, best) : -1;
+                if (value > best)
+                {
+                    best = value;
+                    command = describe(moves[index]);
+                }
+            }
+            if (exhausted)
+            {
+                break;
+            }
+            result.command = command;
+            result.probability = max(best, 0.0);
+            result.turns = turns;
+        }
+        result.nodes = nodes;
+        result.cacheHits = cacheHits;
+        return result;
+    }
+
+
+    /**
+     * @brief Returns the chance of a seat to win within the searched turns, starting with its roll. Past the node
+     * budget, the chance within the most turns that fit it.
+     */
+    double EndgameSolver::winChance(Catan& game, size_t seat)
+    {
+        State state;
+        prepare(game, seat, state);
+        ++generation;
+        nodes = cacheHits = 0;
+        exhausted = false;
+
+        double probability = 0;
+        for (int turns = 1; turns <= max(options.turns, 1); ++turns)
+        {
+            double value = chance(state, turns, 1, 0);
+            if (exhausted)
+            {
+                break;
+            }
+            probability = value;
+        }
+        return probability;
+    }
+
+
+    const EndgameOptions& EndgameSolver::getOptions() const
+    {
+        return options;
+    }
+}
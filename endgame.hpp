@@ -0,0 +1,138 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef ENDGAME_HPP
+#define ENDGAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Catan;
+
+    /**
+     * @brief How far EndgameSolver searches.
+     */
+    struct EndgameOptions
+    {
+        int turns = 2;                      // Own turns searched, counting the current one
+        bool otherRolls = true;             // The other seats' rolls between two own turns produce for the seat too
+        size_t cacheEntries = 1 << 16;      // Entries of the transposition cache, rounded up to a power of two
+        size_t maxNodes = 20000;            // Nodes a search may visit, 0 for no limit
+    };
+
+
+    /**
+     * @brief The answer of a search: the best first move and its chance to win.
+     */
+    struct EndgameMove
+    {
+        string command;                     // "city <i>", "settle <i>", "road <a> <b>", "buy", "bank <give> <get>", "use vp" or "end"
+        double probability;                 // Chance to reach the winning points within the searched turns, playing the best line
+        size_t nodes;                       // Nodes searched
+        size_t cacheHits;                   // Nodes answered by the transposition cache
+        int turns;                          // Own turns searched to, 0 if not even the current turn fit the node budget
+    };
+
+
+    /**
+     * @brief Searches the last turns of a seat close to winning with a depth-limited expectimax.
+     *
+     * The search maximizes the seat's chance to reach WIN_POINTS within the given number of its own turns.
+     * Chance nodes branch over the dice sums 2 to 12 with their exact probabilities, a 7 making a hand of more
+     * than 7 cards drop half of it from its largest piles. The rolls between two action phases of the seat (the
+     * other seats' rolls, then its own) have no decision between them, so a chance node plays them all out into
+     * one distribution over the hands they can leave, merging equal hands, and branches once per hand. Decision nodes branch over every legal city, settlement, useful road, card
+     * purchase (itself a chance node over the victory point cards left in the stock), victory point card play
+     * (which ends the turn, as in the game), bank trade toward a build, and ending the turn. The other seats'
+     * rolls produce for the seat, but the other seats do not build, and the robber stays where it is.
+     *
+     * Values are probabilities, so a decision node stops at the first move that wins for sure, and a chance node
+     * stops as soon as its remaining branches could not lift it above the best move already found for its parent
+     * (Star1 pruning). Values are kept in a fixed-size transposition cache, as exact values or as upper bounds
+     * for the nodes that were cut off, so the same position reached through builds in another order, or through
+     * different dice, is searched once.
+     *
+     * A search deepens one turn at a time, up to the given turns, while it fits the node budget; the answer is the
+     * one of the deepest search that finished. The cache is kept between the depths, its keys counting the turns left.
+     */
+    class EndgameSolver
+    {
+        public:
+
+            static constexpr int WIN_POINTS = 10;
+            static constexpr int MARGIN = 2;                // isEndgame(): points still missing at most
+            static constexpr int INTERSECTIONS = 54;
+
+        private:
+
+            struct State;
+            struct Move;
+            struct Entry;
+
+            EndgameOptions options;
+            vector<Entry> cache;
+            size_t mask;                                    // Entries - 1
+            uint32_t generation;                            // Entries of older searches are ignored
+
+            // The position of the search, read from the game by prepare()
+            int costs[STRUCTURE_TYPES][RESOURCE_TYPES];     // Player::costOf, as plain integers
+            int bankRates[RESOURCE_TYPES];
+            int yieldAt[13][12];                            // Intersections next to a tile of each dice number
+            size_t yieldType[13][12];                       // Resource of that tile
+            size_t yieldCount[13];
+            int neighbors[INTERSECTIONS + 1][3];            // 0 where there is no neighbor
+            uint64_t closes[INTERSECTIONS + 1];             // An intersection and its neighbors
+            uint64_t blocked;                               // The other seats' buildings, roads do not pass them
+            uint64_t takenEdges[2];                         // Edges with a road, by HexTopology::edgeIndex
+            int rollsPerRound;                              // Dice rolls from the end of a turn to the next action phase
+
+            size_t nodes;                                   // Visited, with the hands of the chance nodes
+            size_t cacheHits;
+            bool exhausted;                                 // The node budget ran out, values are no longer exact
+
+            bool spend(size_t amount);
+
+            void prepare(Catan& game, size_t seat, State& state);
+            int listMoves(const State& state, bool last, Move* moves) const;
+            bool usefulRoad(const State& state, int from, int to) const;
+            double apply(const State& state, const Move& move, int turns, double alpha);
+            double act(const State& state, int turns, double alpha);
+            double chance(const State& state, int turns, int rolls, double alpha);
+            bool lookup(uint64_t key, double alpha, double& value);
+            void store(uint64_t key, double alpha, double value);
+            string describe(const Move& move) const;
+
+        public:
+
+            explicit EndgameSolver(const EndgameOptions& options = EndgameOptions());
+            ~EndgameSolver();
+
+            EndgameSolver(const EndgameSolver&) = delete;
+            EndgameSolver& operator=(const EndgameSolver&) = delete;
+
+            /**
+             * @brief Returns true if a seat is at most MARGIN points short of winning, counting its victory point cards.
+             */
+            static bool isEndgame(Catan& game, size_t seat);
+
+            /**
+             * @brief Finds the best move of a seat in its action phase (after its roll).
+             * @param seat Index of the seat in Catan::getPlayers().
+             */
+            EndgameMove bestMove(Catan& game, size_t seat);
+
+            /**
+             * @brief Returns the chance of a seat to win within the searched turns, starting with its roll.
+             */
+            double winChance(Catan& game, size_t seat);
+
+            const EndgameOptions& getOptions() const;
+    };
+}
+
+#endif
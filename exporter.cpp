@@ -0,0 +1,452 @@
+// Email: origoldbsc@gmail.com
+
+#include "exporter.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief Static pointer to the exporter that receives game events (nullptr while exporting is disabled).
+     */
+    EventExporter* EventExporter::active = nullptr;
+
+
+    /**
+     * @brief Opens (or creates) the file or named pipe at the given path for appending.
+     * @param path Path of the output file or FIFO.
+     * @throws runtime_error if the path cannot be opened.
+     */
+    EventExporter::EventExporter(const string& path) : fd(-1), ownsFd(true), length(0), sequence(0), game(-1)
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+        {
+            throw runtime_error("Cannot open event export file: " + path);
+        }
+    }
+
+
+    /**
+     * @brief Writes to an already open file descriptor. The descriptor stays owned by the caller.
+     * @param fd The file descriptor to write to.
+     */
+    EventExporter::EventExporter(int fd) : fd(fd), ownsFd(false), length(0), sequence(0), game(-1) {}
+
+
+    /**
+     * @brief Flushes pending lines, detaches the exporter if it is active and closes an owned descriptor.
+     */
+    EventExporter::~EventExporter()
+    {
+        flush();
+        if (active == this)
+        {
+            active = nullptr;
+        }
+        if (ownsFd && fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+
+
+    /**
+     * @brief Sets the exporter that receives game events.
+     * @param exporter The exporter to activate, or nullptr to disable exporting.
+     */
+    void EventExporter::setActive(EventExporter* exporter)
+    {
+        active = exporter;
+    }
+
+
+    /**
+     * @brief Returns the active exporter.
+     * @return Pointer to the active exporter, or nullptr when exporting is disabled.
+     */
+    EventExporter* EventExporter::getActive()
+    {
+        return active;
+    }
+
+
+    /**
+     * @brief Tags the following events with a game ID, for exporters shared by several games.
+     * @param gameID The game that emits the next events, or -1 to stop tagging.
+     */
+    void EventExporter::setGame(int gameID)
+    {
+        game = gameID;
+    }
+
+
+    //-------------------------------------//
+    //        Line formatting helpers      //
+    //-------------------------------------//
+
+    /**
+     * @brief Starts a new line with its sequence number and event name.
+     * Flushes first if the buffer could not hold a full line.
+     * @param eventName The name of the event.
+     */
+    void EventExporter::beginEvent(const char* eventName)
+    {
+        if (BUFFER_SIZE - length < MAX_LINE)
+        {
+            flush();
+        }
+        appendLiteral("{\"seq\":");
+        appendNumber(static_cast<long long>(sequence++));
+        if (game >= 0)
+        {
+            appendField("g", game);
+        }
+        appendLiteral(",\"ev\":\"");
+        appendLiteral(eventName);
+        buffer[length++] = '"';
+    }
+
+
+    /**
+     * @brief Closes the current line.
+     */
+    void EventExporter::endEvent()
+    {
+        buffer[length++] = '}';
+        buffer[length++] = '\n';
+    }
+
+
+    /**
+     * @brief Appends raw bytes to the buffer, truncating if the line limit would be exceeded.
+     */
+    void EventExporter::appendRaw(const char* text, size_t size)
+    {
+        size_t room = BUFFER_SIZE - length - 2;     // Keep room for the closing "}\n"
+        if (size > room)
+        {
+            size = room;
+        }
+        memcpy(buffer + length, text, size);
+        length += size;
+    }
+
+
+    /**
+     * @brief Appends a null terminated literal to the buffer.
+     */
+    void EventExporter::appendLiteral(const char* text)
+    {
+        appendRaw(text, strlen(text));
+    }
+
+
+    /**
+     * @brief Appends a decimal number without going through iostreams or printf.
+     * @param value The number to append.
+     */
+    void EventExporter::appendNumber(long long value)
+    {
+        char digits[24];
+        size_t count = 0;
+        unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        do {
+            digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (value < 0)
+        {
+            digits[sizeof(digits) - 1 - count++] = '-';
+        }
+        appendRaw(digits + sizeof(digits) - count, count);
+    }
+
+
+    /**
+     * @brief Appends a quoted JSON string, escaping quotes, backslashes and control characters.
+     * @param text The text to append.
+     */
+    void EventExporter::appendString(const string& text)
+    {
+        static const char hex[] = "0123456789abcdef";
+        buffer[length++] = '"';
+        for (char c : text)
+        {
+            if (length > BUFFER_SIZE - 16)
+            {
+                break;      // Name too long for the line limit
+            }
+            unsigned char u = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\')
+            {
+                buffer[length++] = '\\';
+                buffer[length++] = c;
+            }
+            else if (u < 0x20)
+            {
+                const char escape[6] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF]};
+                appendRaw(escape, sizeof(escape));
+            }
+            else
+            {
+                buffer[length++] = c;
+            }
+        }
+        buffer[length++] = '"';
+    }
+
+
+    /**
+     * @brief Appends a ,"key":number pair.
+     */
+    void EventExporter::appendField(const char* key, long long value)
+    {
+        buffer[length++] = ',';
+        buffer[length++] = '"';
+        appendLiteral(key);
+        buffer[length++] = '"';
+        buffer[length++] = ':';
+        appendNumber(value);
+    }
+
+
+    /**
+     * @brief Appends a ,"key":"value" pair. The value must not need escaping.
+     */
+    void EventExporter::appendField(const char* key, const char* value)
+    {
+        buffer[length++] = ',';
+        buffer[length++] = '"';
+        appendLiteral(key);
+        appendLiteral("\":\"");
+        appendLiteral(value);
+        buffer[length++] = '"';
+    }
+
+
+    /**
+     * @brief Appends a ,"key":[wood,brick,wool,grain,ore] array.
+     */
+    void EventExporter::appendResources(const char* key, const int amounts[5])
+    {
+        buffer[length++] = ',';
+        buffer[length++] = '"';
+        appendLiteral(key);
+        appendLiteral("\":[");
+        for (int i = 0; i < 5; ++i)
+        {
+            if (i > 0)
+            {
+                buffer[length++] = ',';
+            }
+            appendNumber(amounts[i]);
+        }
+        buffer[length++] = ']';
+    }
+
+
+    //-------------------------------------//
+    //               Events                //
+    //-------------------------------------//
+
+    /**
+     * @brief Records a settlement placed on the board.
+     * @param playerID The owner of the settlement.
+     * @param intersectionID The intersection of the settlement.
+     * @param initial True for settlements placed during the setup phase.
+     */
+    void EventExporter::settlementPlaced(int playerID, int intersectionID, bool initial)
+    {
+        beginEvent("settlement");
+        appendField("p", playerID);
+        appendField("i", intersectionID);
+        if (initial)
+        {
+            appendLiteral(",\"init\":1");
+        }
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records a road placed on the board.
+     * @param playerID The owner of the road.
+     * @param id1 The first intersection of the road.
+     * @param id2 The second intersection of the road.
+     * @param initial True for roads placed during the setup phase.
+     */
+    void EventExporter::roadPlaced(int playerID, int id1, int id2, bool initial)
+    {
+        beginEvent("road");
+        appendField("p", playerID);
+        appendField("a", id1);
+        appendField("b", id2);
+        if (initial)
+        {
+            appendLiteral(",\"init\":1");
+        }
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records a settlement upgraded to a city.
+     * @param playerID The owner of the city.
+     * @param intersectionID The intersection of the city.
+     */
+    void EventExporter::cityUpgraded(int playerID, int intersectionID)
+    {
+        beginEvent("city");
+        appendField("p", playerID);
+        appendField("i", intersectionID);
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records the total of a dice roll.
+     * @param playerID The player who rolled.
+     * @param total The sum of both dice.
+     */
+    void EventExporter::diceRolled(int playerID, int total)
+    {
+        beginEvent("roll");
+        appendField("p", playerID);
+        appendField("t", total);
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records a change in a player's resources.
+     * @param playerID The player whose resources changed.
+     * @param type The resource that changed.
+     * @param delta The signed change.
+     * @param source What caused the change (e.g. "roll", "setup", "discard").
+     */
+    void EventExporter::resourceDelta(int playerID, ResourceType type, int delta, const char* source)
+    {
+        static const char* const names[] = {"WOOD", "BRICK", "WOOL", "GRAIN", "ORE", "NONE"};
+        beginEvent("res");
+        appendField("p", playerID);
+        appendField("r", names[type <= NONE ? type : NONE]);
+        appendField("d", delta);
+        appendField("src", source);
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records an executed resource trade. Amounts are ordered WOOD, BRICK, WOOL, GRAIN, ORE.
+     * @param offererID The player who offered the trade.
+     * @param recipientID The player who accepted the trade.
+     * @param offer The resources given by the offerer.
+     * @param request The resources given by the recipient.
+     */
+    void EventExporter::resourceTrade(int offererID, int recipientID, const int offer[5], const int request[5])
+    {
+        beginEvent("trade");
+        appendField("from", offererID);
+        appendField("to", recipientID);
+        appendResources("give", offer);
+        appendResources("get", request);
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records an executed card trade. Amounts are ordered PROMOTION, KNIGHT, VICTORY_POINT.
+     * @param offererID The player who offered the trade.
+     * @param recipientID The player who accepted the trade.
+     * @param offer The cards given by the offerer.
+     * @param request The cards given by the recipient.
+     */
+    void EventExporter::cardTrade(int offererID, int recipientID, const int offer[3], const int request[3])
+    {
+        beginEvent("card_trade");
+        appendField("from", offererID);
+        appendField("to", recipientID);
+        appendLiteral(",\"give\":[");
+        appendNumber(offer[0]);
+        buffer[length++] = ',';
+        appendNumber(offer[1]);
+        buffer[length++] = ',';
+        appendNumber(offer[2]);
+        appendLiteral("],\"get\":[");
+        appendNumber(request[0]);
+        buffer[length++] = ',';
+        appendNumber(request[1]);
+        buffer[length++] = ',';
+        appendNumber(request[2]);
+        buffer[length++] = ']';
+        endEvent();
+    }
+
+
+    /**
+     * @brief Records a development card being bought or used.
+     * @param playerID The player holding the card.
+     * @param action Either "buy" or "use".
+     * @param card The card name.
+     */
+    void EventExporter::cardEvent(int playerID, const char* action, const char* card)
+    {
+        beginEvent("card");
+        appendField("p", playerID);
+        appendField("act", action);
+        buffer[length++] = ',';
+        appendLiteral("\"card\":");
+        appendString(card);
+        endEvent();
+    }
+
+
+    /**
+     * @brief Writes all pending lines to the descriptor, retrying on partial writes and interrupts.
+     * If the write fails (e.g. EPIPE once the reader of a pipe exits), the batch is dropped and the exporter
+     * detaches: it stops writing, closes an owned descriptor and no longer receives game events.
+     * Callers writing to a pipe must ignore SIGPIPE for the error to be reported instead of ending the process.
+     */
+    void EventExporter::flush()
+    {
+        size_t written = 0;
+        while (written < length && fd >= 0)
+        {
+            ssize_t result = ::write(fd, buffer + written, length - written);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // The reader went away; drop the output rather than stalling the game
+                if (active == this)
+                {
+                    active = nullptr;
+                }
+                if (ownsFd)
+                {
+                    ::close(fd);
+                }
+                fd = -1;
+                break;
+            }
+            written += static_cast<size_t>(result);
+        }
+        length = 0;
+    }
+
+
+    /**
+     * @brief Returns the number of events formatted so far.
+     */
+    unsigned long long EventExporter::getEventCount() const
+    {
+        return sequence;
+    }
+}
@@ -0,0 +1,119 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef EXPORTER_HPP
+#define EXPORTER_HPP
+
+#include <string>
+#include <cstddef>
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief This class streams every state change of the game as one compact NDJSON line.
+     *
+     * Lines are formatted by hand into a preallocated buffer and written to the file descriptor
+     * in batches, so an attached exporter costs a few stores per event and one write() per batch.
+     * The batch is written when the buffer fills up and whenever a turn passes, so a live reader
+     * is never more than a turn behind. The exporter is optional: the game only emits events while
+     * an exporter is set as active.
+     *
+     * Every line carries a sequence number ("seq") and an event name ("ev"), for example:
+     *   {"seq":3,"ev":"road","p":1,"a":41,"b":42}
+     *   {"seq":4,"ev":"res","p":2,"r":"ORE","d":1,"src":"roll"}
+     * When several games share the exporter (see setGame), each line also names its game:
+     *   {"seq":5,"g":12,"ev":"roll","p":0,"t":8}
+     */
+    class EventExporter
+    {
+        private:
+
+            static const size_t BUFFER_SIZE = 64 * 1024;    // Size of the preallocated line buffer
+            static const size_t MAX_LINE = 512;             // Upper bound of a single formatted line
+            static EventExporter* active;                   // The exporter that currently receives game events
+
+            int fd;                                         // File descriptor the lines are written to
+            bool ownsFd;                                    // True if the exporter opened the descriptor itself
+            char buffer[BUFFER_SIZE];                       // Pending lines not yet written
+            size_t length;                                  // Number of pending bytes in the buffer
+            unsigned long long sequence;                    // Sequence number of the next event
+            int game;                                       // Game the next events belong to (-1 if not tagged)
+
+            // Line formatting helpers
+            void beginEvent(const char* eventName);
+            void endEvent();
+            void appendRaw(const char* text, size_t size);
+            void appendLiteral(const char* text);
+            void appendNumber(long long value);
+            void appendString(const string& text);
+            void appendField(const char* key, long long value);
+            void appendField(const char* key, const char* value);
+            void appendResources(const char* key, const int amounts[5]);
+
+        public:
+
+            /**
+             * @brief Opens (or creates) the file or named pipe at the given path for appending.
+             * @param path Path of the output file or FIFO.
+             * @throws runtime_error if the path cannot be opened.
+             */
+            explicit EventExporter(const string& path);
+
+            /**
+             * @brief Writes to an already open file descriptor (e.g. a pipe or STDOUT). The descriptor is not closed.
+             * @param fd The file descriptor to write to.
+             */
+            explicit EventExporter(int fd);
+
+            /**
+             * @brief Flushes pending lines, detaches the exporter if active and closes an owned descriptor.
+             */
+            ~EventExporter();
+
+            EventExporter(const EventExporter&) = delete;
+            EventExporter& operator=(const EventExporter&) = delete;
+
+            /**
+             * @brief Sets the exporter that receives game events (nullptr disables exporting).
+             * @param exporter The exporter to activate.
+             */
+            static void setActive(EventExporter* exporter);
+
+            /**
+             * @brief Returns the active exporter, or nullptr when exporting is disabled.
+             */
+            static EventExporter* getActive();
+
+            /**
+             * @brief Tags the following events with a game ID ("g"), for exporters shared by several games.
+             * @param gameID The game that emits the next events, or -1 to stop tagging.
+             */
+            void setGame(int gameID);
+
+            // Board placements
+            void settlementPlaced(int playerID, int intersectionID, bool initial);
+            void roadPlaced(int playerID, int id1, int id2, bool initial);
+            void cityUpgraded(int playerID, int intersectionID);
+
+            // Resource, trade and card events
+            void diceRolled(int playerID, int total);
+            void resourceDelta(int playerID, ResourceType type, int delta, const char* source);
+            void resourceTrade(int offererID, int recipientID, const int offer[5], const int request[5]);
+            void cardTrade(int offererID, int recipientID, const int offer[3], const int request[3]);
+            void cardEvent(int playerID, const char* action, const char* card);
+
+            /**
+             * @brief Writes all pending lines to the descriptor. On a write error (such as EPIPE) the exporter
+             * drops the batch and detaches itself. Ignore SIGPIPE when writing to a pipe.
+             */
+            void flush();
+
+            /**
+             * @brief Returns the number of events formatted so far.
+             */
+            unsigned long long getEventCount() const;
+    };
+}
+
+#endif
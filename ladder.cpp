@@ -0,0 +1,386 @@
+// Email: origoldbsc@gmail.com
+
+#include "ladder.hpp"
+#include "catan.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief Reads the final points of a finished game.
+     * @param agents Ladder ID of the agent of each seat, in the order of Catan::getPlayers().
+     * @throws invalid_argument if there is not one agent per seat.
+     */
+    GameResult GameResult::fromGame(Catan& game, const vector<uint32_t>& agents)
+    {
+        const vector<Player*>& players = game.getPlayers();
+        if (agents.size() != players.size() || players.size() > MAX_SEATS)
+        {
+            throw invalid_argument("A game result needs one agent per seat");
+        }
+        GameResult result = {};
+        result.seats = static_cast<uint32_t>(players.size());
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            result.agents[seat] = agents[seat];
+            result.points[seat] = players[seat]->getPoints();
+        }
+        return result;
+    }
+
+
+    //-------------------------------------//
+    //             ResultQueue             //
+    //-------------------------------------//
+
+    /**
+     * @brief Creates an empty queue.
+     * @param capacity Rounded up to a power of two (at least 2).
+     */
+    ResultQueue::ResultQueue(size_t capacity) : head(0), tail(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots = make_unique<Slot[]>(size);
+        mask = size - 1;
+        for (size_t index = 0; index < size; ++index)
+        {
+            slots[index].sequence.store(index, memory_order_relaxed);
+        }
+    }
+
+
+    /**
+     * @brief Claims the slot of the next push, or returns false if the slot still holds a value of the last lap.
+     */
+    bool ResultQueue::tryPush(const GameResult& result)
+    {
+        size_t position = head.load(memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = slots[position & mask];
+            size_t sequence = slot.sequence.load(memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence - position);
+            if (lag == 0)
+            {
+                if (head.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    slot.result = result;
+                    slot.sequence.store(position + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = head.load(memory_order_relaxed);
+            }
+        }
+    }
+
+
+    /**
+     * @brief Claims the slot of the next pop, or returns false if nothing was pushed there yet.
+     */
+    bool ResultQueue::tryPop(GameResult& result)
+    {
+        size_t position = tail.load(memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = slots[position & mask];
+            size_t sequence = slot.sequence.load(memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence - (position + 1));
+            if (lag == 0)
+            {
+                if (tail.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    result = slot.result;
+                    slot.sequence.store(position + mask + 1, memory_order_release);      // Free for the next lap
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = tail.load(memory_order_relaxed);
+            }
+        }
+    }
+
+
+    size_t ResultQueue::getCapacity() const
+    {
+        return mask + 1;
+    }
+
+
+    //-------------------------------------//
+    //            RatingLadder             //
+    //-------------------------------------//
+
+    /**
+     * @brief Creates an empty ladder.
+     * @param queueCapacity Results that may wait for the rating thread.
+     * @param snapshotPath File the ladder is written to (replaced atomically), empty for none.
+     * @param snapshotInterval Time between two snapshots while the rating thread runs.
+     * @param k Elo K factor.
+     */
+    RatingLadder::RatingLadder(size_t queueCapacity, const string& snapshotPath, chrono::milliseconds snapshotInterval, double k)
+        : queue(queueCapacity), k(k), snapshotPath(snapshotPath), snapshotInterval(snapshotInterval), processed(0), rejected(0), running(false)
+    {
+    }
+
+
+    RatingLadder::~RatingLadder()
+    {
+        running.store(false);
+        if (rater.joinable())
+        {
+            rater.join();
+        }
+    }
+
+
+    /**
+     * @brief Returns the ladder ID of an agent, adding it at INITIAL_RATING if it is new.
+     */
+    uint32_t RatingLadder::addAgent(const string& name)
+    {
+        lock_guard<mutex> guard(agentsLock);
+        auto found = find_if(agents.begin(), agents.end(), [&](const LadderEntry& entry) { return entry.name == name; });
+        if (found != agents.end())
+        {
+            return static_cast<uint32_t>(found - agents.begin());
+        }
+        agents.push_back({name, INITIAL_RATING, 0, 0});
+        return static_cast<uint32_t>(agents.size() - 1);
+    }
+
+
+    bool RatingLadder::trySubmit(const GameResult& result)
+    {
+        return queue.tryPush(result);
+    }
+
+
+    void RatingLadder::submit(const GameResult& result)
+    {
+        while (!queue.tryPush(result))
+        {
+            this_thread::yield();
+        }
+    }
+
+
+    /**
+     * @brief Rates one game: every pair of seats is a duel decided by the points, and the changes of all the duels
+     * are added at once, from the ratings before the game.
+     */
+    void RatingLadder::apply(const GameResult& result)
+    {
+        size_t seats = result.seats;
+        bool known = seats >= 2 && seats <= MAX_SEATS;
+        for (size_t seat = 0; seat < seats && known; ++seat)
+        {
+            known = result.agents[seat] < agents.size();
+        }
+        if (!known)
+        {
+            rejected.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+
+        double change[MAX_SEATS] = {};
+        double scale = k / static_cast<double>(seats - 1);
+        for (size_t first = 0; first < seats; ++first)
+        {
+            for (size_t second = first + 1; second < seats; ++second)
+            {
+                const LadderEntry& a = agents[result.agents[first]];
+                const LadderEntry& b = agents[result.agents[second]];
+                if (&a == &b)
+                {
+                    continue;
+                }
+                double expected = 1.0 / (1.0 + pow(10.0, (b.rating - a.rating) / 400.0));
+                double score = result.points[first] > result.points[second] ? 1.0 : result.points[first] == result.points[second] ? 0.5 : 0.0;
+                change[first] += scale * (score - expected);
+                change[second] -= scale * (score - expected);
+            }
+        }
+
+        int32_t best = *max_element(result.points, result.points + seats);
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            LadderEntry& entry = agents[result.agents[seat]];
+            entry.rating += change[seat];
+            ++entry.games;
+            entry.wins += result.points[seat] == best ? 1 : 0;
+        }
+        processed.fetch_add(1, memory_order_relaxed);
+    }
+
+
+    /**
+     * @brief Rates what is queued on the calling thread.
+     * @return The number of results taken from the queue.
+     */
+    size_t RatingLadder::drain()
+    {
+        lock_guard<mutex> guard(agentsLock);
+        size_t count = 0;
+        GameResult result;
+        while (queue.tryPop(result))
+        {
+            apply(result);
+            ++count;
+        }
+        return count;
+    }
+
+
+    /**
+     * @brief The rating thread: rates the queued results in batches, sleeps briefly when there are none,
+     * and writes a snapshot every snapshot interval.
+     */
+    void RatingLadder::rate()
+    {
+        static const size_t BATCH = 4096;
+        auto nextSnapshot = chrono::steady_clock::now() + snapshotInterval;
+        while (running.load(memory_order_relaxed))
+        {
+            size_t count = 0;
+            {
+                lock_guard<mutex> guard(agentsLock);
+                GameResult result;
+                while (count < BATCH && queue.tryPop(result))
+                {
+                    apply(result);
+                    ++count;
+                }
+            }
+            if (count == 0)
+            {
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+            if (!snapshotPath.empty() && chrono::steady_clock::now() >= nextSnapshot)
+            {
+                try {
+                    saveSnapshot();
+                } catch (const exception& e) {
+                    cerr << e.what() << endl;       // The ratings go on, the next snapshot tries again
+                }
+                nextSnapshot = chrono::steady_clock::now() + snapshotInterval;
+            }
+        }
+    }
+
+
+    void RatingLadder::start()
+    {
+        if (!running.exchange(true))
+        {
+            rater = thread(&RatingLadder::rate, this);
+        }
+    }
+
+
+    /**
+     * @brief Stops the rating thread, rates what is still queued and writes a last snapshot.
+     * @throws runtime_error if the last snapshot cannot be written.
+     */
+    void RatingLadder::stop()
+    {
+        running.store(false);
+        if (rater.joinable())
+        {
+            rater.join();
+        }
+        drain();
+        if (!snapshotPath.empty())
+        {
+            saveSnapshot();
+        }
+    }
+
+
+    /**
+     * @brief Returns the agents from the highest rating to the lowest.
+     */
+    vector<LadderEntry> RatingLadder::standings() const
+    {
+        vector<LadderEntry> sorted;
+        {
+            lock_guard<mutex> guard(agentsLock);
+            sorted = agents;
+        }
+        stable_sort(sorted.begin(), sorted.end(), [](const LadderEntry& a, const LadderEntry& b) { return a.rating > b.rating; });
+        return sorted;
+    }
+
+
+    /**
+     * @brief Writes the standings as tab separated lines: rank, name, rating, games, wins.
+     */
+    void RatingLadder::writeSnapshot(ostream& out) const
+    {
+        vector<LadderEntry> sorted = standings();
+        out << "# rank\tname\trating\tgames\twins (" << getProcessed() << " results)\n";
+        for (size_t rank = 0; rank < sorted.size(); ++rank)
+        {
+            const LadderEntry& entry = sorted[rank];
+            out << rank + 1 << '\t' << entry.name << '\t' << lround(entry.rating) << '\t' << entry.games << '\t' << entry.wins << '\n';
+        }
+    }
+
+
+    /**
+     * @brief Writes the standings to the snapshot path, replacing the file atomically.
+     * @throws runtime_error if the file cannot be written.
+     */
+    void RatingLadder::saveSnapshot() const
+    {
+        // Write next to the target and rename, so readers never see a half written ladder
+        string temporary = snapshotPath + ".tmp";
+        {
+            ofstream out(temporary);
+            writeSnapshot(out);
+            if (!out.flush())
+            {
+                throw runtime_error("Cannot write ladder snapshot: " + temporary);
+            }
+        }
+        if (rename(temporary.c_str(), snapshotPath.c_str()) != 0)
+        {
+            remove(temporary.c_str());
+            throw runtime_error("Cannot save ladder snapshot: " + snapshotPath);
+        }
+    }
+
+
+    uint64_t RatingLadder::getProcessed() const
+    {
+        return processed.load(memory_order_relaxed);
+    }
+
+
+    uint64_t RatingLadder::getRejected() const
+    {
+        return rejected.load(memory_order_relaxed);
+    }
+}
@@ -0,0 +1,171 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef LADDER_HPP
+#define LADDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "registry.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Catan;
+
+    /**
+     * @brief The outcome of one game: the agent of each seat and its final points. Plain data, so it is
+     * copied through the result queue without allocating.
+     */
+    struct GameResult
+    {
+        uint32_t seats;                     // Seats of the game
+        uint32_t agents[MAX_SEATS];         // Ladder ID of the agent of each seat (see RatingLadder::addAgent)
+        int32_t points[MAX_SEATS];          // Final points of each seat
+
+        /**
+         * @brief Reads the final points of a finished game.
+         * @param agents Ladder ID of the agent of each seat, in the order of Catan::getPlayers().
+         * @throws invalid_argument if there is not one agent per seat.
+         */
+        static GameResult fromGame(Catan& game, const vector<uint32_t>& agents);
+    };
+
+
+    /**
+     * @brief A bounded lock-free queue of results for any number of producers and consumers.
+     *
+     * Each slot carries a sequence number telling whether it is free for the push of a lap or holds the value
+     * for the pop of that lap, so a push or a pop is one compare-and-swap on its cursor plus a copy. The two
+     * cursors sit on separate cache lines.
+     */
+    class ResultQueue
+    {
+        private:
+
+            struct Slot
+            {
+                atomic<size_t> sequence;
+                GameResult result;
+            };
+
+            unique_ptr<Slot[]> slots;
+            size_t mask;                            // Capacity - 1
+            alignas(64) atomic<size_t> head;        // Next position to push
+            alignas(64) atomic<size_t> tail;        // Next position to pop
+
+        public:
+
+            /**
+             * @brief Creates an empty queue.
+             * @param capacity Rounded up to a power of two (at least 2).
+             */
+            explicit ResultQueue(size_t capacity);
+
+            bool tryPush(const GameResult& result);     // False if the queue is full
+            bool tryPop(GameResult& result);            // False if the queue is empty
+            size_t getCapacity() const;
+    };
+
+
+    /**
+     * @brief One row of the ladder.
+     */
+    struct LadderEntry
+    {
+        string name;
+        double rating;
+        uint64_t games;
+        uint64_t wins;                      // Games where the agent had the most points (ties count for every seat tied)
+    };
+
+
+    /**
+     * @brief Rates the agents of bot tournaments from results streamed by parallel workers.
+     *
+     * Workers submit results to a lock-free queue; a single rating thread pops them and updates the ratings
+     * one game at a time, and writes a snapshot of the ladder every snapshot interval. A game of N seats counts
+     * as the N(N-1)/2 duels between its seats, decided by their final points (equal points are a draw), and
+     * each seat's Elo change is the sum of its duels scaled by K/(N-1), so a game moves a rating about as much
+     * as a single two-player game. Two seats played by the same agent do not rate each other.
+     */
+    class RatingLadder
+    {
+        public:
+
+            static constexpr double INITIAL_RATING = 1500.0;
+
+        private:
+
+            ResultQueue queue;
+            double k;                               // Elo K factor
+            string snapshotPath;                    // Empty for no snapshots
+            chrono::milliseconds snapshotInterval;
+
+            mutable mutex agentsLock;               // Guards the agents, taken once per batch of results
+            vector<LadderEntry> agents;             // Indexed by ladder ID
+
+            atomic<uint64_t> processed;             // Results applied
+            atomic<uint64_t> rejected;              // Results with an unknown agent or a bad seat count
+            atomic<bool> running;
+            thread rater;
+
+            void apply(const GameResult& result);   // Called with agentsLock held
+            void rate();                            // The rating thread
+
+        public:
+
+            /**
+             * @brief Creates an empty ladder.
+             * @param queueCapacity Results that may wait for the rating thread.
+             * @param snapshotPath File the ladder is written to (replaced atomically), empty for none.
+             * @param snapshotInterval Time between two snapshots while the rating thread runs.
+             * @param k Elo K factor.
+             */
+            RatingLadder(size_t queueCapacity = 1 << 16, const string& snapshotPath = "",
+                         chrono::milliseconds snapshotInterval = chrono::seconds(10), double k = 24.0);
+            ~RatingLadder();
+
+            RatingLadder(const RatingLadder&) = delete;
+            RatingLadder& operator=(const RatingLadder&) = delete;
+
+            /**
+             * @brief Returns the ladder ID of an agent, adding it at INITIAL_RATING if it is new.
+             */
+            uint32_t addAgent(const string& name);
+
+            bool trySubmit(const GameResult& result);       // Lock-free, false if the queue is full
+            void submit(const GameResult& result);          // Yields while the queue is full
+
+            void start();                                   // Starts the rating thread
+            void stop();                                    // Rates what is queued, writes a last snapshot and stops
+            size_t drain();                                 // Rates what is queued on the calling thread
+
+            /**
+             * @brief Returns the agents from the highest rating to the lowest.
+             */
+            vector<LadderEntry> standings() const;
+
+            /**
+             * @brief Writes the standings as tab separated lines: rank, name, rating, games, wins.
+             */
+            void writeSnapshot(ostream& out) const;
+
+            /**
+             * @brief Writes the standings to the snapshot path, replacing the file atomically.
+             * @throws runtime_error if the file cannot be written.
+             */
+            void saveSnapshot() const;
+
+            uint64_t getProcessed() const;
+            uint64_t getRejected() const;
+    };
+}
+
+#endif
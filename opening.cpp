@@ -0,0 +1,564 @@
+// Email: origoldbsc@gmail.com
+
+#include "opening.hpp"
+#include "board.hpp"
+#include "topology.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        uint64_t bitOf(int intersectionID)
+        {
+            return uint64_t{1} << intersectionID;
+        }
+
+        /**
+         * @brief Returns the seat making a pick of the snake draft: 0..N-1, then N-1..0.
+         */
+        size_t seatOf(size_t pick, size_t seats)
+        {
+            return pick < seats ? pick : 2 * seats - 1 - pick;
+        }
+
+        /**
+         * @brief Returns the 12 rotations and reflections of the standard board as maps of the intersection IDs,
+         * the identity first. A symmetry turns the tiles about the center tile and each tile's corners with them;
+         * the corner map of each tile turn is the one that sends every shared corner to one place.
+         */
+        const vector<array<uint8_t, OpeningOptimizer::INTERSECTIONS + 1>>& boardSymmetries()
+        {
+            static const vector<array<uint8_t, OpeningOptimizer::INTERSECTIONS + 1>> symmetries = []() {
+                const HexTopology& topology = HexTopology::standard();
+                vector<array<uint8_t, OpeningOptimizer::INTERSECTIONS + 1>> found;
+                for (int mirror = 0; mirror < 2; ++mirror)
+                {
+                    for (int turns = 0; turns < 6; ++turns)
+                    {
+                        // (x, y) -> (x - y, x) is a sixth of a turn in the board's coordinates; (x, y) -> (y, x) a reflection
+                        vector<size_t> tileImage(topology.tileCount());
+                        for (size_t tile = 0; tile < topology.tileCount(); ++tile)
+                        {
+                            auto [x, y] = topology.tilePosition(tile);
+                            if (mirror)
+                            {
+                                swap(x, y);
+                            }
+                            for (int turn = 0; turn < turns; ++turn)
+                            {
+                                tie(x, y) = make_pair(x - y, x);
+                            }
+                            tileImage[tile] = static_cast<size_t>(topology.tileIndex({x, y}));
+                        }
+                        for (int shift = 0; shift < 6; ++shift)
+                        {
+                            array<uint8_t, OpeningOptimizer::INTERSECTIONS + 1> image{};
+                            bool consistent = true;
+                            for (size_t tile = 0; tile < topology.tileCount() && consistent; ++tile)
+                            {
+                                for (size_t corner = 0; corner < 6 && consistent; ++corner)
+                                {
+                                    size_t mapped = mirror ? (6 + static_cast<size_t>(shift) - corner) % 6 : (corner + static_cast<size_t>(shift)) % 6;
+                                    int from = topology.tileCorners(tile)[corner];
+                                    uint8_t to = static_cast<uint8_t>(topology.tileCorners(tileImage[tile])[mapped]);
+                                    consistent = image[static_cast<size_t>(from)] == 0 || image[static_cast<size_t>(from)] == to;
+                                    image[static_cast<size_t>(from)] = to;
+                                }
+                            }
+                            for (int id = 1; id <= OpeningOptimizer::INTERSECTIONS && consistent; ++id)
+                            {
+                                for (int neighbor : topology.neighbors(id))
+                                {
+                                    consistent = consistent && (neighbor == 0 || topology.edgeIndex(image[static_cast<size_t>(id)], image[static_cast<size_t>(neighbor)]) != HexTopology::NO_INDEX);
+                                }
+                            }
+                            if (consistent)
+                            {
+                                found.push_back(image);
+                                break;
+                            }
+                        }
+                    }
+                }
+                return found;
+            }();
+            return symmetries;
+        }
+    }
+
+
+    /**
+     * @brief Returns the beginner setup of the standard board (scores left at 0).
+     */
+    OpeningPlan OpeningPlan::beginner(size_t seats)
+    {
+        // Beginner settlements of each seat, two apart from every other one, and the road leaving each settlement
+        static const int settlementsBySeat[MAX_SEATS][2] = {
+            {41, 45},       // 41 touches Wood(8), Ore(3), Brick(5); 45 touches Grain(4), Wool(5), Wool(11)
+            {14, 43},       // Between Wool(4) and Wood(9); between Grain(4) and Grain(6)
+            {20, 36},       // Between Grain(12) and Wood(11); between Wood(3) and Ore(8)
+            {11, 30},       // Seats 4 to 6 use free coastal and inland spots of the same board
+            {23, 50},
+            {26, 5}
+        };
+        static const int roadsBySeat[MAX_SEATS][2][2] = {
+            {{41, 42}, {35, 45}},
+            {{13, 14}, {43, 44}},
+            {{19, 20}, {25, 36}},
+            {{11, 12}, {30, 31}},
+            {{22, 23}, {50, 51}},
+            {{26, 27}, {4, 5}}
+        };
+
+        OpeningPlan plan{};
+        plan.seats = min(seats, MAX_SEATS);
+        copy(&settlementsBySeat[0][0], &settlementsBySeat[0][0] + 2 * MAX_SEATS, &plan.settlements[0][0]);
+        copy(&roadsBySeat[0][0][0], &roadsBySeat[0][0][0] + 4 * MAX_SEATS, &plan.roads[0][0][0]);
+        return plan;
+    }
+
+
+    /**
+     * @brief The candidates of one pick, shared by the workers, and the scores they write.
+     */
+    struct OpeningOptimizer::Job
+    {
+        const int* first;                       // First settlement of each seat so far
+        const int* second;                      // Second settlement of each seat so far
+        size_t pick, seats, seat;               // The pick being searched, the number of seats and the picking seat
+        uint64_t closed;                        // Intersections taken or next to a settlement
+        const int* spots;                       // Settlements to play out
+        size_t count;
+        double* scores;                         // Score of the seat's final pair, by spot
+        uint64_t* finalClosed;                  // Intersections closed at the end of each playout, by spot
+        atomic<size_t> next{0};                 // Next spot to play out
+    };
+
+
+    /**
+     * @brief Reads the production of every intersection from the tiles of a board, finds the board's
+     * symmetries and starts the pool.
+     * @param threads Threads to run the playouts on, including the calling thread (at least 1).
+     */
+    OpeningOptimizer::OpeningOptimizer(const Board& board, size_t threads)
+        : production(), closes(), playouts(0), pairs(0), mirrored(0), job(nullptr), generation(0), busy(0), stopping(false)
+    {
+        const HexTopology& topology = HexTopology::standard();
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            for (int tileIndex : topology.intersectionTiles(id))
+            {
+                if (tileIndex == HexTopology::NO_INDEX)
+                {
+                    continue;
+                }
+                const Tile& tile = board.getTile(topology.tilePosition(static_cast<size_t>(tileIndex)));
+                int number = tile.getNumber();
+                if (tile.getResourceType() != ResourceType::NONE && number >= 2 && number <= 12)
+                {
+                    production[id][tile.getResourceType()] += static_cast<float>(6 - abs(7 - number)) / 36.0f;
+                }
+            }
+            closes[id] = bitOf(id);
+            for (int neighbor : topology.neighbors(id))
+            {
+                closes[id] |= neighbor != 0 ? bitOf(neighbor) : 0;
+            }
+        }
+
+        // A symmetry of the board must give every intersection the production of its image
+        for (const Symmetry& symmetry : boardSymmetries())
+        {
+            bool kept = true;
+            for (int id = 1; id <= INTERSECTIONS && kept; ++id)
+            {
+                for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+                {
+                    kept = kept && fabs(production[id][type] - production[symmetry[static_cast<size_t>(id)]][type]) < 1e-6f;
+                }
+            }
+            if (kept)
+            {
+                symmetries.push_back(symmetry);
+            }
+        }
+
+        for (size_t worker = 1; worker < max<size_t>(threads, 1); ++worker)
+        {
+            workers.emplace_back(&OpeningOptimizer::work, this);
+        }
+    }
+
+
+    OpeningOptimizer::~OpeningOptimizer()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+
+    /**
+     * @brief The loop of a pool thread: plays out the spots of every pick posted until the optimizer is destroyed.
+     */
+    void OpeningOptimizer::work()
+    {
+        uint64_t seen = 0;
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            Job* current = job;
+            guard.unlock();
+            run(*current);
+            guard.lock();
+            if (--busy == 0)
+            {
+                finished.notify_all();
+            }
+        }
+    }
+
+
+    /**
+     * @brief Plays out spots of a pick until none is left.
+     */
+    void OpeningOptimizer::run(Job& current) const
+    {
+        for (size_t index = current.next.fetch_add(1); index < current.count; index = current.next.fetch_add(1))
+        {
+            int tryFirst[MAX_SEATS], trySecond[MAX_SEATS];
+            copy(current.first, current.first + MAX_SEATS, tryFirst);
+            copy(current.second, current.second + MAX_SEATS, trySecond);
+            int spot = current.spots[index];
+            (current.pick < current.seats ? tryFirst : trySecond)[current.seat] = spot;
+            current.scores[index] = playout(tryFirst, trySecond, current.pick + 1, current.seats, current.closed | closes[spot], current.seat, current.finalClosed[index]);
+        }
+    }
+
+
+    float OpeningOptimizer::spotValue(int intersectionID) const
+    {
+        float value = 0;
+        for (float income : production[intersectionID])
+        {
+            value += income;
+        }
+        return value;
+    }
+
+
+    /**
+     * @brief Returns the value of the best open spot one step beyond a road, the spot the road can be extended to.
+     */
+    float OpeningOptimizer::roadReach(int settlement, int toward, uint64_t closed) const
+    {
+        float reach = 0;
+        for (int beyond : HexTopology::standard().neighbors(toward))
+        {
+            if (beyond != 0 && beyond != settlement && (closed & bitOf(beyond)) == 0)
+            {
+                reach = max(reach, spotValue(beyond));
+            }
+        }
+        return reach;
+    }
+    /**
+     * @brief Returns the score of a seat's pair of settlements: the resources expected per roll plus
+     * DIVERSITY_WEIGHT for each resource type they produce. A missing second settlement is 0.
+     */
+    double OpeningOptimizer::pairScore(int first, int second) const
+    {
+        double score = 0;
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            float income = (first > 0 ? production[first][type] : 0) + (second > 0 ? production[second][type] : 0);
+            score += income + (income > 0 ? DIVERSITY_WEIGHT : 0);
+        }
+        return score;
+    }
+
+
+    /**
+     * @brief Returns the open spot that adds the most to a seat's first pick (0 if none is open).
+     */
+    int OpeningOptimizer::greedyPick(const int* firstPicks, size_t seat, uint64_t closed) const
+    {
+        int best = 0;
+        double bestScore = -1;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            if ((closed & bitOf(id)) == 0)
+            {
+                double score = pairScore(firstPicks[seat], id);
+                if (score > bestScore)
+                {
+                    best = id;
+                    bestScore = score;
+                }
+            }
+        }
+        return best;
+    }
+
+
+    /**
+     * @brief Plays the rest of the draft greedily from a pick and returns the score of one seat's final pair.
+     * @param finalClosed Set to the intersections closed once the draft is over.
+     */
+    double OpeningOptimizer::playout(const int* firstPicks, const int* secondPicks, size_t pick, size_t seats, uint64_t closed, size_t seat, uint64_t& finalClosed) const
+    {
+        int first[MAX_SEATS], second[MAX_SEATS];
+        copy(firstPicks, firstPicks + MAX_SEATS, first);
+        copy(secondPicks, secondPicks + MAX_SEATS, second);
+        for (; pick < 2 * seats; ++pick)
+        {
+            size_t picker = seatOf(pick, seats);
+            int spot = greedyPick(first, picker, closed);
+            (pick < seats ? first : second)[picker] = spot;
+            closed |= spot != 0 ? closes[spot] : 0;
+        }
+        finalClosed = closed;
+        return pairScore(first[seat], second[seat]);
+    }
+
+
+    /**
+     * @brief Lists the open spots worth trying, in increasing ID: spots that produce something and that no other
+     * open spot matches or beats on every resource (of two equal spots the lower ID is kept).
+     */
+    void OpeningOptimizer::candidates(uint64_t closed, int* spots, size_t& count) const
+    {
+        count = 0;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            if ((closed & bitOf(id)) != 0 || spotValue(id) == 0)
+            {
+                continue;
+            }
+            bool dominated = false;
+            for (int other = 1; other <= INTERSECTIONS && !dominated; ++other)
+            {
+                if (other == id || (closed & bitOf(other)) != 0)
+                {
+                    continue;
+                }
+                bool atLeast = true, better = false;
+                for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+                {
+                    atLeast = atLeast && production[other][type] >= production[id][type];
+                    better = better || production[other][type] > production[id][type];
+                }
+                dominated = atLeast && (better || other < id);
+            }
+            if (!dominated)
+            {
+                spots[count++] = id;
+            }
+        }
+    }
+
+
+    /**
+     * @brief Searches the draft for a number of seats. Calls from several threads are run one after the other.
+     * @param seats Number of seats (MIN_SEATS to MAX_SEATS).
+     * @throws invalid_argument for a number of seats outside MIN_SEATS to MAX_SEATS.
+     */
+    OpeningPlan OpeningOptimizer::optimize(size_t seats)
+    {
+        if (seats < MIN_SEATS || seats > MAX_SEATS)
+        {
+            throw invalid_argument("A game has " + to_string(MIN_SEATS) + " to " + to_string(MAX_SEATS) + " players");
+        }
+        lock_guard<mutex> serial(calls);
+        playouts = 0;
+        pairs = 0;
+        mirrored = 0;
+
+        const HexTopology& topology = HexTopology::standard();
+        OpeningPlan plan{};
+        plan.seats = seats;
+        int first[MAX_SEATS] = {}, second[MAX_SEATS] = {};
+        uint64_t closed = 0;
+        for (size_t pick = 0; pick < 2 * seats; ++pick)
+        {
+            size_t seat = seatOf(pick, seats);
+
+            // The symmetries that keep every settlement placed so far where it is
+            vector<const Symmetry*> keeping;
+            for (const Symmetry& symmetry : symmetries)
+            {
+                bool keeps = true;
+                for (size_t other = 0; other < seats && keeps; ++other)
+                {
+                    keeps = symmetry[static_cast<size_t>(first[other])] == first[other] && symmetry[static_cast<size_t>(second[other])] == second[other];
+                }
+                if (keeps)
+                {
+                    keeping.push_back(&symmetry);
+                }
+            }
+
+            // Spots that such a symmetry maps to a lower ID score like that spot and are not played out
+            int spots[INTERSECTIONS];
+            size_t count = 0, kept = 0;
+            candidates(closed, spots, count);
+            for (size_t index = 0; index < count; ++index)
+            {
+                bool earlier = false;
+                for (size_t at = 1; at < keeping.size() && !earlier; ++at)
+                {
+                    earlier = (*keeping[at])[static_cast<size_t>(spots[index])] < spots[index];
+                }
+                if (!earlier)
+                {
+                    spots[kept++] = spots[index];
+                }
+                else
+                {
+                    mirrored += static_cast<size_t>(topology.degree(spots[index]));
+                }
+            }
+            count = kept;
+
+            // Post the playouts to the pool and work on them from this thread too
+            double scores[INTERSECTIONS];
+            uint64_t finalClosed[INTERSECTIONS];
+            Job current;
+            current.first = first;
+            current.second = second;
+            current.pick = pick;
+            current.seats = seats;
+            current.seat = seat;
+            current.closed = closed;
+            current.spots = spots;
+            current.count = count;
+            current.scores = scores;
+            current.finalClosed = finalClosed;
+            if (count > 1 && !workers.empty())
+            {
+                {
+                    lock_guard<mutex> guard(lock);
+                    job = &current;
+                    busy = workers.size();
+                    ++generation;
+                }
+                wake.notify_all();
+                run(current);
+                unique_lock<mutex> guard(lock);
+                finished.wait(guard, [&]() { return busy == 0; });
+                job = nullptr;
+            }
+            else
+            {
+                run(current);
+            }
+            playouts += count;
+
+            // Each spot is tried with every road leaving it, except roads that a symmetry keeping the spot maps to a lower ID
+            int chosen = 0, toward = 0;
+            double bestScore = -1;
+            for (size_t index = 0; index < count; ++index)
+            {
+                int spot = spots[index];
+                for (int neighbor : topology.neighbors(spot))
+                {
+                    if (neighbor == 0)
+                    {
+                        continue;
+                    }
+                    bool earlier = false;
+                    for (size_t at = 1; at < keeping.size() && !earlier; ++at)
+                    {
+                        const Symmetry& symmetry = *keeping[at];
+                        earlier = symmetry[static_cast<size_t>(spot)] == spot && symmetry[static_cast<size_t>(neighbor)] < neighbor;
+                    }
+                    if (earlier)
+                    {
+                        ++mirrored;
+                        continue;
+                    }
+                    ++pairs;
+                    double score = scores[index] + ROAD_WEIGHT * roadReach(spot, neighbor, finalClosed[index]);
+                    if (score > bestScore)
+                    {
+                        chosen = spot;
+                        toward = neighbor;
+                        bestScore = score;
+                    }
+                }
+            }
+
+            if (count == 0)     // Only if every open spot produces nothing
+            {
+                chosen = greedyPick(first, seat, closed);
+                for (int neighbor : topology.neighbors(chosen))
+                {
+                    if (neighbor != 0 && (toward == 0 || roadReach(chosen, neighbor, closed) > roadReach(chosen, toward, closed)))
+                    {
+                        toward = neighbor;
+                    }
+                }
+            }
+            (pick < seats ? first : second)[seat] = chosen;
+            plan.roads[seat][pick < seats ? 0 : 1][0] = chosen;
+            plan.roads[seat][pick < seats ? 0 : 1][1] = toward;
+            closed |= chosen != 0 ? closes[chosen] : 0;
+        }
+
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            plan.settlements[seat][0] = first[seat];
+            plan.settlements[seat][1] = second[seat];
+            plan.scores[seat] = pairScore(first[seat], second[seat]);
+        }
+        return plan;
+    }
+
+
+    size_t OpeningOptimizer::getPlayouts() const
+    {
+        return playouts;
+    }
+
+
+    size_t OpeningOptimizer::getCandidates() const
+    {
+        return pairs;
+    }
+
+
+    size_t OpeningOptimizer::getSymmetricCandidates() const
+    {
+        return mirrored;
+    }
+
+
+    size_t OpeningOptimizer::getSymmetries() const
+    {
+        return symmetries.size();
+    }
+
+
+    size_t OpeningOptimizer::getThreads() const
+    {
+        return workers.size() + 1;
+    }
+}
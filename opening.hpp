@@ -0,0 +1,127 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef OPENING_HPP
+#define OPENING_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "registry.hpp"
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Board;
+
+    /**
+     * @brief The starting settlements and roads of every seat, as placed by Catan::initializeGame().
+     */
+    struct OpeningPlan
+    {
+        size_t seats;                       // Number of seats planned
+        int settlements[MAX_SEATS][2];      // First and second settlement of each seat
+        int roads[MAX_SEATS][2][2];         // The road leaving each of the settlements above
+        double scores[MAX_SEATS];           // Score of each seat's two settlements (see OpeningOptimizer::pairScore)
+
+        /**
+         * @brief Returns the beginner setup of the standard board (scores left at 0).
+         */
+        static OpeningPlan beginner(size_t seats);
+    };
+
+
+    /**
+     * @brief Chooses the starting settlements and roads of a board by searching the snake draft.
+     *
+     * Seats pick in the order 1..N, N..1. A candidate of a pick is a settlement and the road leaving it. Each
+     * candidate is scored by playing the rest of the draft out greedily: the production and diversity of the
+     * seat's final pair, plus ROAD_WEIGHT times the best spot still open at the far end of the road once the
+     * draft is over. Roads never block a settlement, so the candidates of one spot share its playout.
+     *
+     * Two prunings run before the playouts. Candidates that a symmetry of the board maps to an earlier candidate
+     * are dropped: a rotation or reflection that keeps every tile and every settlement placed so far in place
+     * makes them score the same (up to ties, which go to the lower ID). Spots that produce nothing, and spots
+     * that another open spot matches or beats on every resource, are dropped too; this one is a heuristic, since
+     * the spots block different neighbors.
+     *
+     * The playouts of a pick are shared out between a pool of threads kept for the life of the optimizer, like
+     * WinEstimator's. Each playout writes only its own score, so the plan does not depend on the threads.
+     */
+    class OpeningOptimizer
+    {
+        public:
+
+            static constexpr int INTERSECTIONS = 54;
+            static constexpr double DIVERSITY_WEIGHT = 0.05;    // Score per resource type produced by the pair
+            static constexpr double ROAD_WEIGHT = 0.25;         // Score per resource expected at the best spot a road leads to
+
+        private:
+
+            struct Job;
+            typedef array<uint8_t, INTERSECTIONS + 1> Symmetry;    // Image of each intersection ID (entry 0 unused)
+
+            float production[INTERSECTIONS + 1][RESOURCE_TYPES];    // Resources expected per roll at each intersection
+            uint64_t closes[INTERSECTIONS + 1];                     // An intersection and its neighbors, as bits
+            vector<Symmetry> symmetries;                            // Rotations and reflections that keep the tiles, identity first
+            size_t playouts;                                        // Playouts run by the last optimize()
+            size_t pairs;                                           // Settlement-and-road candidates scored by the last optimize()
+            size_t mirrored;                                        // Candidates the last optimize() skipped as symmetric
+
+            vector<thread> workers;                 // The pool, the calling thread is one more worker
+            mutex calls;                            // Lets one optimize() run at a time
+            mutex lock;                             // Guards the fields below
+            condition_variable wake;                // Signals a new job (or stopping) to the workers
+            condition_variable finished;            // Signals that the last worker left the job
+            Job* job;                               // The job being run
+            uint64_t generation;                    // Number of jobs posted so far
+            size_t busy;                            // Workers still on the current job
+            bool stopping;                          // Set by the destructor
+
+            float spotValue(int intersectionID) const;
+            float roadReach(int settlement, int toward, uint64_t closed) const;
+            int greedyPick(const int* firstPicks, size_t seat, uint64_t closed) const;
+            double playout(const int* firstPicks, const int* secondPicks, size_t pick, size_t seats, uint64_t closed, size_t seat, uint64_t& finalClosed) const;
+            void candidates(uint64_t closed, int* spots, size_t& count) const;
+            void work();
+            void run(Job& current) const;
+
+        public:
+
+            /**
+             * @brief Reads the production of every intersection from the tiles of a board, finds the board's
+             * symmetries and starts the pool.
+             * @param threads Threads to run the playouts on, including the calling thread (at least 1).
+             */
+            explicit OpeningOptimizer(const Board& board, size_t threads = 1);
+            ~OpeningOptimizer();
+
+            OpeningOptimizer(const OpeningOptimizer&) = delete;
+            OpeningOptimizer& operator=(const OpeningOptimizer&) = delete;
+
+            /**
+             * @brief Returns the score of a seat's pair of settlements: the resources expected per roll plus
+             * DIVERSITY_WEIGHT for each resource type they produce. A missing second settlement is 0.
+             */
+            double pairScore(int first, int second) const;
+
+            /**
+             * @brief Searches the draft for a number of seats. Calls from several threads are run one after the other.
+             * @param seats Number of seats (MIN_SEATS to MAX_SEATS).
+             * @throws invalid_argument for a number of seats outside MIN_SEATS to MAX_SEATS.
+             */
+            OpeningPlan optimize(size_t seats);
+
+            size_t getPlayouts() const;
+            size_t getCandidates() const;
+            size_t getSymmetricCandidates() const;
+            size_t getSymmetries() const;       // 1 for a board that only the identity keeps, up to 12
+            size_t getThreads() const;
+    };
+}
+
+#endif
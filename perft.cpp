@@ -0,0 +1,318 @@
+// Email: origoldbsc@gmail.com
+
+#include "perft.hpp"
+#include "catan.hpp"
+#include "checkpoint.hpp"
+#include "topology.hpp"
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief Returns the action as a command of the turn engine ("road <a> <b>", "settle <i>", "city <i>",
+     * "bank <give> <get>" or "end").
+     */
+    string PerftAction::describe() const
+    {
+        switch (kind)
+        {
+            case ROAD:
+                return "road " + to_string(first) + " " + to_string(second);
+            case SETTLEMENT:
+                return "settle " + to_string(first);
+            case CITY:
+                return "city " + to_string(first);
+            case TRADE:
+                return "bank " + resourceTypeToString(static_cast<ResourceType>(first)) + " " + resourceTypeToString(static_cast<ResourceType>(second));
+            case END:
+                break;
+        }
+        return "end";
+    }
+
+
+    PerftCounter::PerftCounter(Catan& game, const PerftOptions& options) : game(game), options(options)
+    {
+        const HexTopology& topology = HexTopology::standard();
+        for (size_t index = 0; index < topology.edgeCount(); ++index)
+        {
+            edges.emplace_back(Intersection::getIntersection(topology.edge(index).first), Intersection::getIntersection(topology.edge(index).second));
+        }
+    }
+
+
+    PerftCounter::~PerftCounter() = default;
+
+
+    /**
+     * @brief Counts the action sequences of a depth from the current position.
+     * @throws invalid_argument if the depth is negative.
+     */
+    PerftResult PerftCounter::run(int depth)
+    {
+        if (depth < 0)
+        {
+            throw invalid_argument("Perft depth must not be negative");
+        }
+        prepare(depth);
+        result = PerftResult();
+        result.leaves = search(depth);
+        return result;
+    }
+
+
+    /**
+     * @brief Counts the sequences under each action of the current position ("perft divide").
+     * @return Each action, as a command, with the count of depth - 1 below it, in generation order.
+     * @throws invalid_argument if the depth is less than 1.
+     */
+    vector<pair<string, uint64_t>> PerftCounter::divide(int depth)
+    {
+        if (depth < 1)
+        {
+            throw invalid_argument("Perft divide needs a depth of at least 1");
+        }
+        prepare(depth);
+        result = PerftResult();
+        size_t level = static_cast<size_t>(depth);
+        GameCheckpoint::capture(game, saved[level]);
+        listActions(actions[level]);
+
+        vector<pair<string, uint64_t>> counts;
+        for (const PerftAction& action : actions[level])
+        {
+            uint64_t count = 0;
+            if (action.kind == PerftAction::END)
+            {
+                count = roll(depth);
+            }
+            else
+            {
+                apply(action);
+                count = search(depth - 1);
+                GameCheckpoint::restore(game, saved[level]);
+            }
+            counts.emplace_back(action.describe(), count);
+        }
+        return counts;
+    }
+
+
+    /**
+     * @brief Makes room for a checkpoint and a list of actions per depth.
+     */
+    void PerftCounter::prepare(int depth)
+    {
+        size_t levels = static_cast<size_t>(depth) + 1;
+        if (saved.size() < levels)
+        {
+            saved.resize(levels);
+            actions.resize(levels);
+        }
+    }
+
+
+    /**
+     * @brief Counts the sequences of a depth from the current position, which is left as it was.
+     */
+    uint64_t PerftCounter::search(int depth)
+    {
+        if (depth == 0)
+        {
+            return 1;
+        }
+        size_t level = static_cast<size_t>(depth);
+        vector<Player*>& players = game.getPlayers();
+        if (players[game.getCurrentPlayerIndex()]->getPoints() >= WIN_POINTS)
+        {
+            return 0;
+        }
+
+        ++result.nodes;
+        GameCheckpoint::capture(game, saved[level]);
+        if (options.verify)
+        {
+            verify(game.getCurrentPlayerIndex());
+        }
+        listActions(actions[level]);
+
+        uint64_t leaves = 0;
+        for (const PerftAction& action : actions[level])
+        {
+            if (action.kind == PerftAction::END)
+            {
+                leaves += roll(depth);
+                continue;
+            }
+            apply(action);
+            leaves += search(depth - 1);
+            GameCheckpoint::restore(game, saved[level]);
+        }
+        return leaves;
+    }
+
+
+    /**
+     * @brief Ends the turn of the position saved for a depth and plays every sum of the next seat's roll.
+     */
+    uint64_t PerftCounter::roll(int depth)
+    {
+        size_t level = static_cast<size_t>(depth);
+        vector<Player*>& players = game.getPlayers();
+        uint64_t leaves = 0;
+        for (int sum = 2; sum <= 12; ++sum)
+        {
+            apply({PerftAction::END, 0, 0});
+            if (sum != 7)
+            {
+                game.getBoard().distributeResourcesBasedOnDiceRoll(sum, players);
+            }
+            ++result.rolls;
+            leaves += search(depth - 1);
+            GameCheckpoint::restore(game, saved[level]);
+        }
+        return leaves;
+    }
+
+
+    /**
+     * @brief Lists the actions of the current seat: the placements the board allows and the seat can pay for, its
+     * bank trades, and ending the turn.
+     */
+    void PerftCounter::listActions(vector<PerftAction>& list)
+    {
+        list.clear();
+        Board& board = game.getBoard();
+        Player& player = *game.getPlayers()[game.getCurrentPlayerIndex()];
+        int playerID = player.getId();
+
+        if (player.canBuild(Structure::ROAD))
+        {
+            for (const Edge& edge : edges)
+            {
+                if (board.canPlaceRoad(edge, playerID))
+                {
+                    list.push_back({PerftAction::ROAD, edge.getId1(), edge.getId2()});
+                }
+            }
+        }
+        if (player.canBuild(Structure::SETTLEMENT))
+        {
+            for (int id = 1; id <= static_cast<int>(HexTopology::standard().intersectionCount()); ++id)
+            {
+                // The connection is canPlaceSettlement's own first check, made here so spots off the roads stay quiet
+                if (board.isIntersectionConnectedToPlayerRoad(id, playerID) && board.canPlaceSettlement(id, playerID))
+                {
+                    list.push_back({PerftAction::SETTLEMENT, id, 0});
+                }
+            }
+        }
+        if (player.canBuild(Structure::CITY))
+        {
+            for (int settlement : player.getSettlements())
+            {
+                if (board.canUpgradeSettlementToCity(settlement, playerID))
+                {
+                    list.push_back({PerftAction::CITY, settlement, 0});
+                }
+            }
+        }
+        if (options.trades)
+        {
+            for (int give = WOOD; give <= ORE; ++give)
+            {
+                if (player.getResourceCount(static_cast<ResourceType>(give)) < player.getBankRate(static_cast<ResourceType>(give)))
+                {
+                    continue;
+                }
+                for (int get = WOOD; get <= ORE; ++get)
+                {
+                    if (get != give)
+                    {
+                        list.push_back({PerftAction::TRADE, give, get});
+                    }
+                }
+            }
+        }
+        list.push_back({PerftAction::END, 0, 0});
+    }
+
+
+    /**
+     * @brief Plays an action with the Player methods the game uses. Ending the turn passes it to the next seat.
+     */
+    void PerftCounter::apply(const PerftAction& action)
+    {
+        Board& board = game.getBoard();
+        vector<Player*>& players = game.getPlayers();
+        size_t seat = game.getCurrentPlayerIndex();
+        Player& player = *players[seat];
+        switch (action.kind)
+        {
+            case PerftAction::ROAD:
+                player.buildRoad(Edge(Intersection::getIntersection(action.first), Intersection::getIntersection(action.second)), board);
+                break;
+            case PerftAction::SETTLEMENT:
+                player.buildSettlement(action.first, board);
+                break;
+            case PerftAction::CITY:
+                player.upgradeToCity(action.first, board);
+                break;
+            case PerftAction::TRADE:
+                player.tradeWithBank(static_cast<ResourceType>(action.first), static_cast<ResourceType>(action.second));
+                break;
+            case PerftAction::END:
+                player.endTurn();
+                game.setCurrentPlayerIndex((seat + 1) % players.size());
+                break;
+        }
+    }
+
+
+    /**
+     * @brief Compares the placements the board allows a seat with the ones read from the occupancy masks: a road on
+     * a free edge that touches the seat's buildings, or its roads where no other seat has built; a settlement on a
+     * road end with no building on it or next to it. Each disagreement counts as a mismatch.
+     */
+    void PerftCounter::verify(size_t seat)
+    {
+        Board& board = game.getBoard();
+        const HexTopology& topology = HexTopology::standard();
+        int playerID = game.getPlayers()[seat]->getId();
+
+        uint64_t buildings = 0, others = 0;
+        for (size_t other = 0; other < MAX_SEATS; ++other)
+        {
+            uint64_t built = board.getSettlementMask(static_cast<int>(other)) | board.getCityMask(static_cast<int>(other));
+            buildings |= built;
+            others |= static_cast<int>(other) != playerID ? built : 0;
+        }
+        uint64_t roadEnds = board.getRoadEndMask(playerID);
+        uint64_t reach = board.getSettlementMask(playerID) | board.getCityMask(playerID) | (roadEnds & ~others);
+
+        for (const Edge& edge : edges)
+        {
+            int id1 = edge.getId1(), id2 = edge.getId2();
+            bool expected = !board.isRoadPresent(id1, id2) && (reach & (uint64_t{1} << id1 | uint64_t{1} << id2)) != 0;
+            if (board.canPlaceRoad(edge, playerID) != expected)
+            {
+                ++result.mismatches;
+            }
+        }
+        for (int id = 1; id <= static_cast<int>(topology.intersectionCount()); ++id)
+        {
+            uint64_t spot = uint64_t{1} << id;
+            for (int neighbor : topology.neighbors(id))
+            {
+                spot |= neighbor != 0 ? uint64_t{1} << neighbor : 0;
+            }
+            bool expected = (roadEnds & uint64_t{1} << id) != 0 && (buildings & spot) == 0;
+            bool allowed = board.isIntersectionConnectedToPlayerRoad(id, playerID) && board.canPlaceSettlement(id, playerID);
+            if (allowed != expected)
+            {
+                ++result.mismatches;
+            }
+        }
+    }
+}
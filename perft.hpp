@@ -0,0 +1,119 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "edge.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Catan;
+    struct CheckpointData;
+
+    /**
+     * @brief Which actions PerftCounter generates.
+     */
+    struct PerftOptions
+    {
+        bool trades = true;             // Bank trades at the seat's rates
+        bool verify = false;            // Check the placement rules of every node against an independent generator
+    };
+
+
+    /**
+     * @brief One action of a position.
+     */
+    struct PerftAction
+    {
+        enum Kind { ROAD, SETTLEMENT, CITY, TRADE, END };
+
+        Kind kind;
+        int first, second;              // Road ends, the intersection of a building, or the resources given and received
+
+        /**
+         * @brief Returns the action as a command of the turn engine ("road <a> <b>", "settle <i>", "city <i>",
+         * "bank <give> <get>" or "end").
+         */
+        string describe() const;
+    };
+
+
+    /**
+     * @brief The totals of a count.
+     */
+    struct PerftResult
+    {
+        uint64_t leaves = 0;            // Action sequences of the given depth
+        uint64_t nodes = 0;             // Positions whose actions were generated
+        uint64_t rolls = 0;             // Dice outcomes played
+        uint64_t mismatches = 0;        // Placements where the board's rules and the independent generator disagree (verify)
+    };
+
+
+    /**
+     * @brief Counts the legal action sequences of a game to a given depth, as perft does for chess engines.
+     *
+     * A position is the action phase of the current seat. Its actions are every road Board::canPlaceRoad allows,
+     * every settlement Board::canPlaceSettlement allows, every city, every bank trade and ending the turn, each only
+     * when the seat can pay for it. Ending the turn is followed by the next seat's roll, a chance node that branches
+     * over the dice sums 2 to 12 (one branch per sum, unweighted) without using up depth; a 7 produces nothing, and
+     * the robber and the discards are not enumerated. Development cards are not bought or played, and a seat with
+     * 10 points has no actions.
+     *
+     * The actions are applied with the same Player methods the game uses and undone by restoring a checkpoint of
+     * the position, so the count also measures move generation and state updates. In verify mode the placements
+     * the board allows at every node are compared with a generator that reads the occupancy masks directly.
+     * The game is left as it was.
+     */
+    class PerftCounter
+    {
+        public:
+
+            static constexpr int WIN_POINTS = 10;
+
+        private:
+
+            Catan& game;
+            PerftOptions options;
+            vector<Edge> edges;                     // Every edge of the board
+            vector<CheckpointData> saved;           // One checkpoint per depth, reused between the calls
+            vector<vector<PerftAction>> actions;    // One list per depth, as above
+            PerftResult result;
+
+            void prepare(int depth);
+            uint64_t search(int depth);
+            uint64_t roll(int depth);
+            void listActions(vector<PerftAction>& list);
+            void apply(const PerftAction& action);
+            void verify(size_t seat);
+
+        public:
+
+            explicit PerftCounter(Catan& game, const PerftOptions& options = PerftOptions());
+            ~PerftCounter();
+
+            PerftCounter(const PerftCounter&) = delete;
+            PerftCounter& operator=(const PerftCounter&) = delete;
+
+            /**
+             * @brief Counts the action sequences of a depth from the current position.
+             * @throws invalid_argument if the depth is negative.
+             */
+            PerftResult run(int depth);
+
+            /**
+             * @brief Counts the sequences under each action of the current position ("perft divide").
+             * @return Each action, as a command, with the count of depth - 1 below it, in generation order.
+             * @throws invalid_argument if the depth is less than 1.
+             */
+            vector<pair<string, uint64_t>> divide(int depth);
+    };
+}
+
+#endif
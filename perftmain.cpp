@@ -0,0 +1,84 @@
+// Email: origoldbsc@gmail.com
+
+#include "perft.hpp"
+#include "catan.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace ariel;
+using namespace std;
+
+int main(int argc, char* argv[]) {
+
+    // Usage: ./perft [depth] [--divide] [--verify] [--no-trades]
+    int depth = 3;
+    bool divide = false;
+    PerftOptions options;
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        string option = argv[arg];
+        if (option == "--divide")
+        {
+            divide = true;
+        }
+        else if (option == "--verify")
+        {
+            options.verify = true;
+        }
+        else if (option == "--no-trades")
+        {
+            options.trades = false;
+        }
+        else
+        {
+            depth = stoi(option);
+        }
+    }
+
+    // The game narrates every action on cout; the counts go to cerr
+    streambuf* console = cout.rdbuf(nullptr);
+
+    // The beginner setup, with the turns in seating order instead of the rolled one, so the counts are reproducible
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    vector<Player*>& players = game.getPlayers();
+    sort(players.begin(), players.end(), [](const Player* a, const Player* b) { return a->getId() < b->getId(); });
+    game.setCurrentPlayerIndex(0);
+    PerftCounter counter(game, options);
+
+    uint64_t mismatches = 0;
+    try {
+        for (int level = 1; level <= depth; ++level)
+        {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            PerftResult result = counter.run(level);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cerr << "perft(" << level << ") = " << result.leaves << "  nodes " << result.nodes << "  rolls " << result.rolls
+                 << "  " << seconds * 1000 << " ms  " << static_cast<double>(result.nodes + result.rolls) / seconds << " positions/s";
+            if (options.verify)
+            {
+                cerr << "  mismatches " << result.mismatches;
+            }
+            cerr << endl;
+            mismatches += result.mismatches;
+        }
+        if (divide && depth > 0)
+        {
+            for (const auto& [action, count] : counter.divide(depth))
+            {
+                cerr << action << ": " << count << endl;
+            }
+        }
+    } catch (const exception& e) {
+        cout.rdbuf(console);
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    cout.rdbuf(console);
+    return mismatches == 0 ? 0 : 1;
+}
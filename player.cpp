@@ -1,14 +1,15 @@
 // Email: origoldbsc@gmail.com
 
 #include "player.hpp"
+#include "exporter.hpp"
+#include "stats.hpp"
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 namespace ariel {
 
-    int Player::nextID = 1;                             // Initialize the static member to 1
-    Player* Player::largestArmyHolder = nullptr;        // Initialize the static member to nulll pointer
 
     /**
      * @brief Constructs a new player with the specified name.
@@ -16,13 +17,15 @@ namespace ariel {
      * All resources and cards are initialized to zero.
      * @param name The name of the player, which is used to identify the player in the game.
      */
-    Player::Player(const string& name) : name(name), id(nextID++), resources(), developmentCards(), points(0) { 
+    Player::Player(const string& name) : name(name), id(0), resources(), developmentCards(), points(0), awards(nullptr), deck(nullptr), harbors(0) { 
         
-        // Initialize all resource types to zero
-        for (auto& resource : {ResourceType::WOOD, ResourceType::BRICK, ResourceType::WOOL, ResourceType::GRAIN, ResourceType::ORE}) 
+        // Without a harbor the bank takes 4 of a kind for any resource
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
         {
-            resources[resource] = 0;
+            bankRates[type] = 4;
         }
+        
+        // All resource lanes start at zero (value initialization of the resource vector)
 
         // Initialize promotion card types to zero
         promotionCards[PromotionType::MONOPOLY] = 0;
@@ -36,61 +39,95 @@ namespace ariel {
 
 
     /**
-     * @brief A map that defining the resource costs for building different structures in the game.
-     * Each type of structure (road, settlement, city) requires a combination of specific resources.
-     * This map is utilized to check and deduct the required resources from a player's inventory when they attempt to build.
+     * @brief Returns the resources needed to pay for a structure or a development card.
+     * The costs are defined in Player::structureCosts:
      *
      * - Roads require 1 brick and 1 wood.
      * - Settlements require 1 of each: brick, wood, wool, and grain.
      * - Cities require 3 ore and 2 grain.
+     * - Development cards require 1 ore, 1 wool, and 1 grain.
+     * @param structure The structure to pay for.
+     * @return The cost as a resource vector.
      */
-    const map<string, map<ResourceType, int>> Player::buildingCosts = 
+    const ResourceVector& Player::costOf(Structure structure)
     {
-        {"road", {{ResourceType::BRICK, 1}, {ResourceType::WOOD, 1}}},
-        {"settlement", {{ResourceType::BRICK, 1}, {ResourceType::WOOD, 1}, {ResourceType::WOOL, 1}, {ResourceType::GRAIN, 1}}},
-        {"city", {{ResourceType::ORE, 3}, {ResourceType::GRAIN, 2}}}
-    };
+        return structureCosts[static_cast<size_t>(structure)];
+    }
 
 
     /**
-     *  @brief A map that defining the resource costs for purchasing development cards.
-     * Each development card requires a combination of ore, wool, and grain.
-     *
-     * - Each development card requires 1 ore, 1 wool, and 1 grain.
+     * @brief Determines whether the player has sufficient resources to pay for a structure.
+     * The held resources are compared with the cost in a single vector compare.
+     * @param structure The structure to check.
+     * @return True if the player has all necessary resources; False otherwise.
      */
-    const map<ResourceType, int> Player::devCardCosts = 
+    bool Player::canBuild(Structure structure) const
     {
-        {ResourceType::ORE, 1},
-        {ResourceType::WOOL, 1},
-        {ResourceType::GRAIN, 1}
-    };
+        return canAfford(resources, costOf(structure));
+    }
+
 
-    
     /**
      * @brief Determines whether the player has sufficient resources to build a specified type of structure.
-     * This function checks if the player's available resources meet or exceed the required amounts 
-     * for the structure as defined in the `buildingCosts` map.
      * @param structureType A string representing the type of structure to be built. This can be "road", "settlement", or "city".
      * @return True if the player has all necessary resources to build the specified structure; False otherwise.
+     * @throws out_of_range for an unknown structure type.
      *
      * Example Usage:
-     * - canBuild("road") checks if the player has at least 1 brick and 1 wood.
-     * - canBuild("settlement") checks if the player has at least 1 brick, 1 wood, 1 wool, and 1 grain.
-     * - canBuild("city") checks if the player has at least 3 ore and 2 grain.
+     * - canBuild(Structure::ROAD) checks if the player has at least 1 brick and 1 wood.
+     * - canBuild(Structure::SETTLEMENT) checks if the player has at least 1 brick, 1 wood, 1 wool, and 1 grain.
+     * - canBuild(Structure::CITY) checks if the player has at least 3 ore and 2 grain.
      */    
-    bool Player::canBuild(const string& structureType) 
+    bool Player::canBuild(const string& structureType) const
     {
-        const auto& cost = buildingCosts.at(structureType);         // Return the cost of building the specified structure from map
-        
-        // Loop through each resource and quantity pair needed to build the specified structure
-        for (const auto& resource : cost) 
+        if (structureType == "road")
         {
-            // Check if the player's current resource counts for each required resource type is less than the required amount.
-            // The `first` of the pair represents the ResourceType (enum), and the `second` of the pair represents the required quantity (int).
-            if (resources[resource.first] < resource.second)
-                return false;
-            }
-        return true;
+            return canBuild(Structure::ROAD);
+        }
+        if (structureType == "settlement")
+        {
+            return canBuild(Structure::SETTLEMENT);
+        }
+        if (structureType == "city")
+        {
+            return canBuild(Structure::CITY);
+        }
+        throw out_of_range("Unknown structure type: " + structureType);
+    }
+
+
+    namespace {
+
+        // Every cost row side by side (ROAD, SETTLEMENT, CITY, DEVELOPMENT_CARD), eight lanes each
+        typedef int32_t CostRows __attribute__((vector_size(sizeof(ResourceVector) * STRUCTURE_TYPES)));
+
+        const CostRows packedCosts = [] {
+            CostRows rows;
+            memcpy(&rows, Player::structureCosts, sizeof(rows));
+            return rows;
+        }();
+    }
+
+
+    /**
+     * @brief Checks every structure and the development card at once: the hand is broadcast into every cost
+     * row and compared against the whole cost table with one packed compare.
+     * @return A mask with bit (1 << Structure) set for everything the player can pay for.
+     */
+    unsigned Player::affordableStructures() const
+    {
+        CostRows held = __builtin_shufflevector(resources, resources, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7,
+                                                0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7);
+        CostRows missing = held < packedCosts;      // All bits set in every lane that falls short
+        uint64_t words[sizeof(CostRows) / sizeof(uint64_t)];
+        memcpy(words, &missing, sizeof(words));
+        unsigned mask = 0;
+        for (size_t structure = 0; structure < STRUCTURE_TYPES; ++structure)
+        {
+            const uint64_t* row = words + 4 * structure;
+            mask |= static_cast<unsigned>((row[0] | row[1] | row[2] | row[3]) == 0) << structure;
+        }
+        return mask;
     }
 
     /**
@@ -125,6 +162,7 @@ namespace ariel {
     {
         board.placeInitialSettlement(intersectionID, this->id);         // "forward" the settlement to the Board class, which handles the game board
         settlements.insert(intersectionID);                             // Update the player's record of settlements
+        addHarborAccess(Board::harborAt(intersectionID));               // Coastal settlements may open a harbor
         addPoints(1);                                                   // Increases the player's score by 1
     }
 
@@ -155,16 +193,14 @@ namespace ariel {
     void Player::buildSettlement(int intersectionID, Board& board)
     {
         // Check if the player can build a settlement based on their resources and if the board rules allow placing a settlement at this location.
-        if (canBuild("settlement") && board.canPlaceSettlement(intersectionID, this->id)) 
+        if (canBuild(Structure::SETTLEMENT) && board.canPlaceSettlement(intersectionID, this->id)) 
         {
             // Deduct the required resources for building a settlement
-            resources[ResourceType::BRICK] -= 1;
-            resources[ResourceType::WOOD] -= 1;
-            resources[ResourceType::WOOL] -= 1;
-            resources[ResourceType::GRAIN] -= 1;
+            resources -= costOf(Structure::SETTLEMENT);
             
             settlements.insert(intersectionID);                     // Record the new settlement
             board.placeSettlement(intersectionID, this->id);        // Place the settlement on the board
+            addHarborAccess(Board::harborAt(intersectionID));       // Coastal settlements may open a harbor
             addPoints(1);                                           // Increment the player's points by 1
         }
     }
@@ -181,11 +217,10 @@ namespace ariel {
     void Player::buildRoad(const Edge& edge, Board& board) 
     {
         // Check if the player can build a road based on their resources and if the board rules allow placing the road
-        if (canBuild("road") && board.canPlaceRoad(edge, this->id)) 
+        if (canBuild(Structure::ROAD) && board.canPlaceRoad(edge, this->id)) 
         {
             // Deduct the required resources for building a road.
-            resources[ResourceType::BRICK] -= 1;
-            resources[ResourceType::WOOD] -= 1;
+            resources -= costOf(Structure::ROAD);
             
             roads.insert(edge);                 // Record the new road
             board.placeRoad(edge, this->id);    // place the road on the board
@@ -204,7 +239,7 @@ namespace ariel {
     void Player::upgradeToCity(int intersectionID, Board& board) 
     {
         // Check if there is a settlement at the specified intersection and if the player can build a city
-        if (settlements.count(intersectionID) && canBuild("city")) 
+        if (settlements.count(intersectionID) && canBuild(Structure::CITY)) 
         {
             // Check if there are enough resources for the player
             if (useResources(ResourceType::ORE, 3) && useResources(ResourceType::GRAIN, 2)) 
@@ -239,6 +274,10 @@ namespace ariel {
      */
     void Player::addResource(ResourceType type, int quantity) 
     {
+        if (type < WOOD || type > ORE)
+        {
+            return;             // The desert produces nothing
+        }
         resources[type] += quantity;
         
         // cout << "Added " << quantity << " " << resourceTypeToString(type) << " to Player " << id         // printings for debuging
@@ -258,7 +297,7 @@ namespace ariel {
      */
     bool Player::useResources(ResourceType type, int quantity) 
     {
-        if (resources[type] >= quantity) 
+        if (type >= WOOD && type <= ORE && resources[type] >= quantity) 
         {
             resources[type] -= quantity;
             return true;
@@ -269,24 +308,25 @@ namespace ariel {
 
     /**
      * @brief Returns the current count of a specified resource in the player's inventory.
-     * This method searches the player's resources map for the given type of resource. If the resource
-     * type is found, it returns the associated count. If the resource type is not found (which might
-     * happen if no transactions involving that resource have occurred yet), it returns 0, indicating
-     * that the player has none of that resource.
      * @param type The type of resource to query, as defined by the ResourceType enumeration.
-     * @return The count of the specified resource type; returns 0 if the resource is not found.
+     * @return The count of the specified resource type; returns 0 for a type that is not a resource.
      */
     int Player::getResourceCount(ResourceType type) const 
     {
-        // Use the find method (iterator) to locate the resource type in the resources map
-        auto it = resources.find(type);
-        
-        // If the iterator does not equal the end iterator, it means the resource type was found in the map
-        if (it != resources.end()) 
+        if (type < WOOD || type > ORE)
         {
-            return it->second;          // Return the quantity of the resource found
+            return 0;           // Not a resource a player can hold (e.g. the desert)
         }
-        return 0;
+        return resources[type];
+    }
+
+
+    /**
+     * @brief Returns all the resources of the player as one vector indexed by ResourceType.
+     */
+    const ResourceVector& Player::getResources() const
+    {
+        return resources;
     }
 
 
@@ -300,10 +340,10 @@ namespace ariel {
     {
         cout << name << "'s resources: ";
         
-        // Iterate through each pair in the resources map
-        for (const auto& [resourceType, amount] : resources) 
+        // Iterate through each resource lane
+        for (int type = WOOD; type <= ORE; ++type) 
         {
-            cout << resourceTypeToString(resourceType) << ": " << amount << "  ";
+            cout << resourceTypeToString(static_cast<ResourceType>(type)) << ": " << resources[type] << "  ";
         }
         cout << endl;
     }
@@ -325,27 +365,27 @@ namespace ariel {
         vector<DevCardType> availableCards;         // List to hold the types of cards that are currently available for purchase
 
         // Check and add available knight cards
-        if (KnightCard::getQuantity() > 0) 
+        if (cardsLeft(DevCardType::KNIGHT) > 0) 
         {
             availableCards.push_back(DevCardType::KNIGHT);
         }
 
         // Check and add available victory point cards
-        if (VictoryPointCard::getQuantity() > 0) 
+        if (cardsLeft(DevCardType::VICTORY_POINT) > 0) 
         {
             availableCards.push_back(DevCardType::VICTORY_POINT);
         }
 
         // Check and add available promotion cards, depending on specific types available
-        if (MonopolyCard::getQuantity() > 0) 
+        if (cardsLeft(PromotionType::MONOPOLY) > 0) 
         {
             availableCards.push_back(DevCardType::PROMOTION);
         }
-        if (RoadBuildingCard::getQuantity() > 0) 
+        if (cardsLeft(PromotionType::ROAD_BUILDING) > 0) 
         {
             availableCards.push_back(DevCardType::PROMOTION);
         }
-        if (YearOfPlentyCard::getQuantity() > 0) 
+        if (cardsLeft(PromotionType::YEAR_OF_PLENTY) > 0) 
         {
             availableCards.push_back(DevCardType::PROMOTION);
         }
@@ -363,11 +403,17 @@ namespace ariel {
 
         // Execute the purchase for the selected card type
         purchaseSelectedCard(selectedType, allPlayers);
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->cardEvent(id, "buy", devCardTypeToString(selectedType).c_str());
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->cardBought(selectedType);
+        }
 
         // Deduct resources used to buy the card
-        resources[ResourceType::ORE] -= 1;
-        resources[ResourceType::WOOL] -= 1;
-        resources[ResourceType::GRAIN] -= 1;
+        resources -= costOf(Structure::DEVELOPMENT_CARD);
 
         return CardPurchaseError::Success;
     }
@@ -385,17 +431,16 @@ namespace ariel {
         switch (cardType) {
             case DevCardType::KNIGHT:
             {
-                KnightCard::decreaseQuantity();                 // Decrease the stock of knight cards 
+                takeCard(DevCardType::KNIGHT);                  // Decrease the stock of knight cards 
                 developmentCards[DevCardType::KNIGHT]++;        // Increment player's count
-                knightCards++;                                  // Add to knightCards' variable
-                checkForLargestArmy(allPlayers);                // Check if the largest army should move to this player
+                countKnights(1);                                // Check if the largest army should move to this player
                 cout << "\nSTATUS: Knight card purchased successfully!\n";
                 break;
             }
 
             case DevCardType::VICTORY_POINT:
             {
-                VictoryPointCard::decreaseQuantity();                   // Decrease the stock of victory point cards
+                takeCard(DevCardType::VICTORY_POINT);                   // Decrease the stock of victory point cards
                 developmentCards[DevCardType::VICTORY_POINT]++;         // Increment player's count
                 cout << "\nSTATUS: Victory Point card purchased successfully!\n";
                 break;
@@ -403,21 +448,21 @@ namespace ariel {
             case DevCardType::PROMOTION:
             {
                 // Handle promotion card purchase by checking each specific type
-                if (MonopolyCard::getQuantity() > 0)
+                if (cardsLeft(PromotionType::MONOPOLY) > 0)
                 {
-                    MonopolyCard::decreaseQuantity();                   // Decrease the stock of that card
+                    takeCard(PromotionType::MONOPOLY);                  // Decrease the stock of that card
                     promotionCards[PromotionType::MONOPOLY]++;          // Increment player's count
                     cout << "\nSTATUS: Monopoly card purchased successfully!\n";
                 } 
-                else if (RoadBuildingCard::getQuantity() > 0) 
+                else if (cardsLeft(PromotionType::ROAD_BUILDING) > 0) 
                 {
-                    RoadBuildingCard::decreaseQuantity();               // Decrease the stock of that card
+                    takeCard(PromotionType::ROAD_BUILDING);             // Decrease the stock of that card
                     promotionCards[PromotionType::ROAD_BUILDING]++;     // Increment player's count
                     cout << "\nSTATUS: Road Building card purchased successfully!\n";
                 } 
-                else if (YearOfPlentyCard::getQuantity() > 0) 
+                else if (cardsLeft(PromotionType::YEAR_OF_PLENTY) > 0) 
                 {
-                    YearOfPlentyCard::decreaseQuantity();               // Decrease the stock of that card
+                    takeCard(PromotionType::YEAR_OF_PLENTY);            // Decrease the stock of that card
                     promotionCards[PromotionType::YEAR_OF_PLENTY]++;    // Increment player's count
                     cout << "\nSTATUS: Year of Plenty card purchased successfully!\n";
                 }
@@ -438,13 +483,42 @@ namespace ariel {
      */
     bool Player::hasEnoughResourcesForCard() const 
     {
-        try {
-            // Check if there are enough of each resource type 
-            return resources.at(ResourceType::ORE) >= 1 && resources.at(ResourceType::WOOL) >= 1 && resources.at(ResourceType::GRAIN) >= 1;
-        } 
-        catch (const out_of_range& e) 
+        return canBuild(Structure::DEVELOPMENT_CARD);
+    }
+
+
+    /**
+     * @brief Returns the cards of a type left in the deck of the player's game, or in a full deck outside a game.
+     */
+    int Player::cardsLeft(DevCardType type) const
+    {
+        return deck != nullptr ? deck->getQuantity(type) : DevelopmentDeck::fullQuantity(type);
+    }
+
+
+    int Player::cardsLeft(PromotionType type) const
+    {
+        return deck != nullptr ? deck->getQuantity(type) : DevelopmentDeck::fullQuantity(type);
+    }
+
+
+    /**
+     * @brief Takes a card of a type from the deck of the player's game. Outside a game there is no stock to update.
+     */
+    void Player::takeCard(DevCardType type)
+    {
+        if (deck != nullptr)
         {
-            return false;
+            deck->draw(type);
+        }
+    }
+
+
+    void Player::takeCard(PromotionType type)
+    {
+        if (deck != nullptr)
+        {
+            deck->draw(type);
         }
     }
 
@@ -468,13 +542,28 @@ namespace ariel {
             return CardUseError::InsufficientCards;
         }
 
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->cardEvent(id, "use", devCardTypeToString(cardType).c_str());
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->cardUsed(cardType);
+        }
+
         // Check card type and handle accordingly
         switch (cardType) {
             case DevCardType::PROMOTION:
                 return handlePromotionCardUsage(currentPlayer, allPlayers, board, endTurn);
             case DevCardType::KNIGHT:
-                // Additional handling if it's a Knight card (not in the game's rule)
+            {
+                KnightCard knightCard;
+                if (knightCard.activateCard(*this, allPlayers, board, endTurn) != CardUseError::Success)
+                {
+                    return CardUseError::Failure;
+                }
                 break;
+            }
             case DevCardType::VICTORY_POINT:
             {
                 VictoryPointCard vpCard;
@@ -557,84 +646,30 @@ namespace ariel {
 
 
     /**
-     * @brief Evaluates if this player should hold the Largest Army card or not.
-     *
-     * This function checks if this player meets the conditions to claim the Largest Army card (holding 3 knights).
-     * If another player has more knight cards, or this player no longer meets the criteria, the award may be revoked or reassigned.
-     *
-     * @param allPlayers A reference to a vector of all players in the game, used to reevaluate who should hold the award if it is revoked from this player.
+     * @brief Counts knights gained (or lost, with a negative delta) in the award tracker of the player's game.
+     * The tracker moves the Largest Army when needed; outside a game the knights are not counted.
      */
-    void Player::checkForLargestArmy(vector<Player*>& allPlayers) 
+    void Player::countKnights(int delta)
     {
-        // Check if this player has the Largest Army
-        if (knightCards >= 3) 
-        {
-            if (largestArmyHolder == nullptr || largestArmyHolder->knightCards < knightCards) 
-            {
-                if (largestArmyHolder != nullptr && largestArmyHolder != this) 
-                {
-                    largestArmyHolder->points -= 2;         // Subtract points from the previous holder
-                    cout << largestArmyHolder->name << " has lost the Largest Army." << endl;
-                }
-                largestArmyHolder = this;
-                points += 2;  // Award new points to this player
-                cout << name << " now holds the Largest Army and gains 2 victory points." << endl;
-            }
-        } 
-        else 
+        if (awards != nullptr)
         {
-            // Check if this player is currently holding the Largest Army but no longer qualifies
-            if (largestArmyHolder == this) 
-            {
-                largestArmyHolder = nullptr;
-                points -= 2;
-                cout << name << " has lost the Largest Army." << endl;
-                // Re-evaluate the largest army holder among all players
-                reevaluateLargestArmy(allPlayers);
-            }
+            awards->countKnights(static_cast<size_t>(id), delta);
         }
     }
 
+
     /**
-     * @brief Reevaluates which player, if any, should hold the Largest Army card.
-     * This function iterates over all players to determine which one meets the conditions to hold the Largest Army card.
-     * @param allPlayers A vector containing pointers to all players, used to assess each player's qualifications for the award.
+     * @brief Returns true if the player holds the award in its game.
      */
-    void Player::reevaluateLargestArmy(vector<Player*>& allPlayers) 
+    bool Player::holdsAward(Award award) const
     {
-        Player* currentHolder = Player::largestArmyHolder;
-        int maxKnights = 0;
-        Player* newHolder = nullptr;
+        return awards != nullptr && awards->getHolder(award) == id;
+    }
 
-        // Identify the player with the highest number of knight cards
-        for (Player* player : allPlayers) 
-        {
-            if (player->developmentCards[DevCardType::KNIGHT] > maxKnights)
-            {
-                maxKnights = player->developmentCards[DevCardType::KNIGHT];
-                newHolder = player;
-            }
-        }
 
-        // Give the Largest Army card to the new holder if conditions are met
-        if (newHolder && maxKnights >= 3 && newHolder != currentHolder) 
-        {
-            if (currentHolder) 
-            {
-                currentHolder->points -= 2;     // Subtract points from the previous holder
-            }
-            Player::largestArmyHolder = newHolder;
-            newHolder->points += 2;
-            cout << newHolder->getName() << " now holds the Largest Army." << endl;
-        } 
-        else if (!newHolder || maxKnights < 3) 
-        {
-            Player::largestArmyHolder = nullptr;    // No player qualifies for largest army
-            if (currentHolder) 
-            {
-                currentHolder->points -= 2;         // Subtract the previous holder loses the points
-            }
-        }
+    AwardTracker* Player::getAwardTracker() const
+    {
+        return awards;
     }
 
 
@@ -665,12 +700,27 @@ namespace ariel {
                 resources[GRAIN] -= grain;
                 resources[ORE] -= ore;
                 totalDiscarded += wood + brick + wool + grain + ore;
+                if (EventExporter* exporter = EventExporter::getActive())
+                {
+                    const int discarded[5] = {wood, brick, wool, grain, ore};
+                    for (int type = WOOD; type <= ORE; ++type)
+                    {
+                        if (discarded[type] > 0)
+                        {
+                            exporter->resourceDelta(id, static_cast<ResourceType>(type), -discarded[type], "discard");
+                        }
+                    }
+                }
             } 
             else 
             {
                 cout << "Invalid input. Please ensure the numbers are correct and total the amount you need to discard." << endl;
             }
         }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->discard(totalDiscarded);
+        }
         cout << "Discarding complete. " << name << " now has:" << endl;
         printResources();
 
@@ -678,6 +728,186 @@ namespace ariel {
 
 
 
+    /**
+     * @brief Discards resources chosen by a policy instead of asking the player.
+     * @param toDiscard The total number of resources that the player must discard.
+     * @param policy Chooses which resources to give up.
+     */
+    void Player::discardResources(int toDiscard, const DiscardPolicy& policy)
+    {
+        ResourceVector discarded;
+        policy.choose(resources, toDiscard, discarded);
+        resources -= discarded;
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            for (int type = WOOD; type <= ORE; ++type)
+            {
+                if (discarded[type] > 0)
+                {
+                    exporter->resourceDelta(id, static_cast<ResourceType>(type), -discarded[type], "discard");
+                }
+            }
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->discard(totalResources(discarded));
+        }
+        cout << name << " discarded " << totalResources(discarded) << " resources (" << policy.getName() << " policy)." << endl;
+    }
+
+
+    /**
+     * @brief Moves the robber and steals a random resource from an opponent with a building on the new tile.
+     * @param position The tile the robber moves to.
+     * @param allPlayers All players of the game.
+     * @param board The board of the game.
+     * @param victim The opponent to steal from, or nullptr to rob the one holding the most resources.
+     * @return False if the robber cannot move there or the victim has no building on the tile.
+     */
+    bool Player::placeRobber(const pair<int, int>& position, vector<Player*>& allPlayers, Board& board, Player* victim,
+                             const function<int(int)>& draw)
+    {
+        set<int> owners = board.getPlayersAroundTile(position);
+        if (victim && (victim == this || !owners.count(victim->getId())))
+        {
+            return false;
+        }
+        if (!board.moveRobber(position))
+        {
+            return false;
+        }
+        if (!victim)
+        {
+            for (Player* player : allPlayers)
+            {
+                if (player != this && owners.count(player->getId()) && player->countTotalResources() > 0
+                    && (!victim || player->countTotalResources() > victim->countTotalResources()))
+                {
+                    victim = player;
+                }
+            }
+        }
+        if (victim)
+        {
+            ResourceType stolen = stealRandomResource(*victim, draw);
+            if (stolen != NONE)
+            {
+                cout << "\nSTATUS: " << name << " stole a resource from " << victim->getName() << "." << endl;
+            }
+        }
+        return true;
+    }
+
+
+    /**
+     * @brief Takes one resource at random from another player, each card being equally likely.
+     * @param victim The player to steal from.
+     * @param draw Returns the index of the stolen card among the victim's cards, below the count it is given.
+     * @return The stolen resource, or NONE if the victim has no resources.
+     * @throws out_of_range if draw returns an index outside the victim's hand.
+     */
+    ResourceType Player::stealRandomResource(Player& victim, const function<int(int)>& draw)
+    {
+        int total = victim.countTotalResources();
+        if (total <= 0)
+        {
+            return NONE;
+        }
+        int card = draw(total);
+        if (card < 0 || card >= total)
+        {
+            throw out_of_range("The drawn card is not in the victim's hand");
+        }
+        size_t type = WOOD;
+        while (card >= victim.resources[type])
+        {
+            card -= victim.resources[type];
+            ++type;
+        }
+        ResourceType stolen = static_cast<ResourceType>(type);
+        victim.resources[type]--;
+        resources[type]++;
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->resourceDelta(victim.id, stolen, -1, "robber");
+            exporter->resourceDelta(id, stolen, 1, "robber");
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->gain(GainSource::ROBBER, stolen, 1);
+        }
+        return stolen;
+    }
+
+
+    /**
+     * @brief Opens harbors for the player and recomputes the best bank rate of every resource.
+     * The rates are kept in a table so that getBankRate() is a single lookup.
+     * @param access Harbor access bits of the new settlement (0 if inland).
+     */
+    void Player::addHarborAccess(uint8_t access)
+    {
+        harbors = static_cast<uint8_t>(harbors | access);
+        int generic = (harbors & GENERIC_HARBOR) ? 3 : 4;
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            bankRates[type] = (harbors & (1u << type)) ? 2 : generic;
+        }
+    }
+
+
+    /**
+     * @brief Returns how many of a resource the bank takes for one resource of any other type.
+     * @param type The resource given to the bank.
+     * @return 2 with the harbor of the resource, 3 with a 3:1 harbor, 4 otherwise (0 for non-resources).
+     */
+    int Player::getBankRate(ResourceType type) const
+    {
+        return type >= WOOD && type <= ORE ? bankRates[type] : 0;
+    }
+
+
+    uint8_t Player::getHarbors() const
+    {
+        return harbors;
+    }
+
+
+    /**
+     * @brief Trades resources with the bank (or a harbor) at the player's best rate.
+     * @param give The resource paid to the bank.
+     * @param get The resource received.
+     * @param quantity Number of resources received.
+     * @return True if the trade was made, false if the player cannot pay or the resources are invalid.
+     */
+    bool Player::tradeWithBank(ResourceType give, ResourceType get, int quantity)
+    {
+        if (give < WOOD || give > ORE || get < WOOD || get > ORE || give == get || quantity <= 0)
+        {
+            return false;
+        }
+        // Compared by division, so a huge quantity cannot overflow the price
+        if (quantity > resources[give] / bankRates[give])
+        {
+            return false;
+        }
+        int price = bankRates[give] * quantity;
+        resources[give] -= price;
+        resources[get] += quantity;
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->resourceDelta(id, give, -price, "bank");
+            exporter->resourceDelta(id, get, quantity, "bank");
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->bankTrade();
+            stats->gain(GainSource::BANK, get, quantity);
+        }
+        return true;
+    }
+
+
     /**
      * @brief Preforms trading between players, either for resources or cards.
      *
@@ -764,7 +994,7 @@ namespace ariel {
     {
         cout << "\nChoose a player to trade with: " << endl;
         for (size_t i = 0; i < allPlayers.size(); ++i) {
-            if (allPlayers[i]->getId() != this->getId()) {
+            if (allPlayers[i] != this) {
                 cout << i + 1 << ". " << allPlayers[i]->getName() << endl;
             }
         }
@@ -772,7 +1002,7 @@ namespace ariel {
         size_t playerIndex;
         cin >> playerIndex;
         playerIndex--;  // Adjust for zero-indexing
-        if (playerIndex < 0 || playerIndex >= allPlayers.size() || allPlayers[playerIndex]->getId() == this->getId()) {
+        if (playerIndex < 0 || playerIndex >= allPlayers.size() || allPlayers[playerIndex] == this) {
             cout << "\nERROR: Invalid player selection! Try again..." << endl;
             return nullptr;
         }
@@ -868,6 +1098,33 @@ namespace ariel {
             recipient.resources[item.first] -= item.second;
             offerer.resources[item.first] += item.second;
         }
+
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            int offer[5] = {0, 0, 0, 0, 0};
+            int request[5] = {0, 0, 0, 0, 0};
+            for (const auto& [type, quantity] : offerResources)
+            {
+                offer[type] = quantity;
+            }
+            for (const auto& [type, quantity] : requestResources)
+            {
+                request[type] = quantity;
+            }
+            exporter->resourceTrade(offerer.id, recipient.id, offer, request);
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->playerTrade();
+            for (const auto& [type, quantity] : offerResources)
+            {
+                stats->gain(GainSource::TRADE, type, quantity);
+            }
+            for (const auto& [type, quantity] : requestResources)
+            {
+                stats->gain(GainSource::TRADE, type, quantity);
+            }
+        }
     }
 
 
@@ -1022,7 +1279,7 @@ namespace ariel {
      */
     void Player::executeCardTrade(Player& offerer, Player& recipient, const map<DevCardType, int>& offerCards, const map<DevCardType, int>& requestCards, vector<Player*>& allPlayers) 
     {
-        bool knightCardTraded = false;
+        int knightsOffered = 0;         // Knight cards moving from the offerer to the recipient
 
         for (const auto& [type, quantity] : offerCards) 
         {
@@ -1030,7 +1287,7 @@ namespace ariel {
             recipient.developmentCards[type] += quantity;
             if (type == DevCardType::KNIGHT) 
             {
-                knightCardTraded = true;        // Track if Knight cards are trade
+                knightsOffered += quantity;     // Track if Knight cards are traded
             }
         }
 
@@ -1040,16 +1297,41 @@ namespace ariel {
             offerer.developmentCards[type] += quantity;
             if (type == DevCardType::KNIGHT) 
             {
-                knightCardTraded = true;
+                knightsOffered -= quantity;
             }
         }
 
         cout << "Trade executed successfully." << endl;
 
-        // Reevaluate the largest army if Knight cards were traded
-        if (knightCardTraded) 
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            int offer[3] = {0, 0, 0};
+            int request[3] = {0, 0, 0};
+            for (const auto& [type, quantity] : offerCards)
+            {
+                offer[static_cast<int>(type)] = quantity;
+            }
+            for (const auto& [type, quantity] : requestCards)
+            {
+                request[static_cast<int>(type)] = quantity;
+            }
+            exporter->cardTrade(offerer.id, recipient.id, offer, request);
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->cardTrade();
+        }
+
+        // Move the knights in the award tracker; the loss is counted first, so the award moves at most once
+        if (knightsOffered > 0)
+        {
+            offerer.countKnights(-knightsOffered);
+            recipient.countKnights(knightsOffered);
+        }
+        else if (knightsOffered < 0)
         {
-            reevaluateLargestArmy(allPlayers); 
+            recipient.countKnights(knightsOffered);
+            offerer.countKnights(-knightsOffered);
         }
     }
 
@@ -1069,10 +1351,21 @@ namespace ariel {
      */
     int Player::rollDice() 
     {
-        static random_device rd;
-        static mt19937 gen(rd());
-        static uniform_int_distribution<> dis(1, 6);
-        return dis(gen);
+        thread_local mt19937 gen(random_device{}());
+        return uniform_int_distribution<>(1, 6)(gen);
+    }
+
+
+    /**
+     * @brief Draws a card at random, each one being equally likely.
+     * Every thread has its own generator, so games played on several threads never share one.
+     * @param count The number of cards to draw from (at least 1).
+     * @return The index of the drawn card, between 0 and count - 1.
+     */
+    int Player::drawCard(int count)
+    {
+        thread_local mt19937 gen(random_device{}());
+        return uniform_int_distribution<>(0, count - 1)(gen);
     }
 
 
@@ -1117,11 +1410,12 @@ namespace ariel {
 
     /**
      * @brief Returns the player's current score in terms of victory points.
-     * @return int The total number of victory points the player has accumulated.
+     * @return int The total number of victory points the player has accumulated, with the points of the awards held.
      */
     int Player::getPoints() const 
     {
-        return this->points;
+        int awardPoints = awards != nullptr ? awards->getPoints(static_cast<size_t>(id)) : 0;
+        return static_cast<int>(this->points) + awardPoints;
     }
 
 
@@ -1171,12 +1465,7 @@ namespace ariel {
      */
     int Player::countTotalResources() const 
     {
-        int sum = 0;
-        for (const auto& resource : resources) 
-        {
-            sum += resource.second;
-        }
-        return sum;
+        return totalResources(resources);
     }
 
     
@@ -1224,9 +1513,9 @@ namespace ariel {
         ss << "++  Name: " << name << " (ID " << id << ") \n";
         ss << "++                                       ++\n";
         ss << "===========================================\n";
-        ss << "++  Points: " << points << "\n";
+        ss << "++  Points: " << getPoints() << "\n";
         ss << "===========================================\n";
-        if (largestArmyHolder == this) 
+        if (holdsAward(Award::LARGEST_ARMY)) 
         {
             ss << "++  Largest Army Card: V\n";
             ss << "-------------------------------------------\n";
@@ -1251,9 +1540,9 @@ namespace ariel {
         ss << "\n===========================================\n";  
         ss << "++  Resources:\n";
         string resources_str;
-        for (const auto& [resourceType, amount] : resources) 
+        for (int type = WOOD; type <= ORE; ++type) 
         {
-            resources_str += "++    " + resourceTypeToString(resourceType) + ": [" + to_string(amount) + "]\n";
+            resources_str += "++    " + resourceTypeToString(static_cast<ResourceType>(type)) + ": [" + to_string(resources[type]) + "]\n";
         }
         ss << resources_str;
         ss << "===========================================\n";
@@ -1296,7 +1585,7 @@ namespace ariel {
      */
     void Player::printPoints() const 
     {
-        cout << name << " has " << points << " points." << endl;
+        cout << name << " has " << getPoints() << " points." << endl;
     }
 
     
@@ -1313,20 +1602,18 @@ namespace ariel {
     void Player::buildSettlementForTesting(int intersectionID, Board& board) 
     {
         cout << "Trying to build settlement at intersection (Testing) " << intersectionID << endl;
-        cout << "Resource check (can build 'settlement'): " << canBuild("settlement") << endl;
+        cout << "Resource check (can build 'settlement'): " << canBuild(Structure::SETTLEMENT) << endl;
 
         // This function will ignore the road connection requirement
-        if (canBuild("settlement")) 
+        if (canBuild(Structure::SETTLEMENT)) 
         {
             // Deduct resources
-            resources[ResourceType::BRICK] -= 1;
-            resources[ResourceType::WOOD] -= 1;
-            resources[ResourceType::WOOL] -= 1;
-            resources[ResourceType::GRAIN] -= 1;
+            resources -= costOf(Structure::SETTLEMENT);
             
             // Add settlement
             settlements.insert(intersectionID);
             board.placeSettlement(intersectionID, this->id);
+            addHarborAccess(Board::harborAt(intersectionID));
             addPoints(1);  
 
             cout << "Settlement built successfully at intersection (Testing) " << intersectionID << endl;
@@ -1369,15 +1656,13 @@ namespace ariel {
         }
 
         // Second, check if cards left in catch
-        if (DevelopmentCard::getCardQuantity(cardType) <= 0) 
+        if (cardsLeft(cardType) <= 0) 
         {
             return CardPurchaseError::CardUnavailable;
         }
         
         // Deduct resources
-        resources[ResourceType::ORE] -= 1;
-        resources[ResourceType::WOOL] -= 1;
-        resources[ResourceType::GRAIN] -= 1;
+        resources -= costOf(Structure::DEVELOPMENT_CARD);
 
         return handleCardPurchaseTEST(cardType, allPlayers);
     }
@@ -1389,14 +1674,7 @@ namespace ariel {
      */
     bool Player::hasEnoughResourcesForCardTEST() const 
     {
-        try {
-            // Check if there are enough of each resource type 
-            return resources.at(ResourceType::ORE) >= 1 && resources.at(ResourceType::WOOL) >= 1 && resources.at(ResourceType::GRAIN) >= 1;
-        } 
-        catch (const out_of_range& e) 
-        {
-            return false;
-        }
+        return canBuild(Structure::DEVELOPMENT_CARD);
     }
 
     /**
@@ -1409,14 +1687,13 @@ namespace ariel {
     {
         if (cardType == DevCardType::KNIGHT) 
         {
-            KnightCard::decreaseQuantity();
+            takeCard(DevCardType::KNIGHT);
             developmentCards[DevCardType::KNIGHT]++;
-            knightCards++;
-            checkForLargestArmy(allPlayers);
+            countKnights(1);
         } 
         else if (cardType == DevCardType::VICTORY_POINT) 
         {
-            VictoryPointCard::decreaseQuantity();
+            takeCard(DevCardType::VICTORY_POINT);
             developmentCards[DevCardType::VICTORY_POINT]++;
         } 
         else if (cardType == DevCardType::PROMOTION) 
@@ -1446,11 +1723,14 @@ namespace ariel {
         switch (choice) 
         {
             case 1:
-                return buySpecificPromotionCardTEST(MonopolyCard::getQuantity, MonopolyCard::decreaseQuantity, PromotionType::MONOPOLY);
+                return buySpecificPromotionCardTEST([this] { return cardsLeft(PromotionType::MONOPOLY); },
+                                                    [this] { takeCard(PromotionType::MONOPOLY); }, PromotionType::MONOPOLY);
             case 2:
-                return buySpecificPromotionCardTEST(RoadBuildingCard::getQuantity, RoadBuildingCard::decreaseQuantity, PromotionType::ROAD_BUILDING);
+                return buySpecificPromotionCardTEST([this] { return cardsLeft(PromotionType::ROAD_BUILDING); },
+                                                    [this] { takeCard(PromotionType::ROAD_BUILDING); }, PromotionType::ROAD_BUILDING);
             case 3:
-                return buySpecificPromotionCardTEST(YearOfPlentyCard::getQuantity, YearOfPlentyCard::decreaseQuantity, PromotionType::YEAR_OF_PLENTY);
+                return buySpecificPromotionCardTEST([this] { return cardsLeft(PromotionType::YEAR_OF_PLENTY); },
+                                                    [this] { takeCard(PromotionType::YEAR_OF_PLENTY); }, PromotionType::YEAR_OF_PLENTY);
             default:
                 cout << "Invalid choice, no card added." << endl;
                 return CardPurchaseError::CardUnavailable;
@@ -11,6 +11,10 @@
 #include <sstream>
 #include <functional>
 #include <ctime>
+#include "resources.hpp"
+#include "discard.hpp"
+#include "awards.hpp"
+#include "deck.hpp"
 #include "board.hpp"
 #include "intersection.hpp"
 #include "cards.hpp"
@@ -21,6 +25,9 @@ using namespace std;
 namespace ariel {
 
     class Board;
+    class GameCheckpoint;
+    class TradeBook;
+    class PlayerRegistry;
     enum class DevCardType;
     enum class PromotionType;
 
@@ -38,21 +45,36 @@ namespace ariel {
     {
         private:
 
-            static int nextID;                            // Static counter to assign unique IDs to players
             string name;                                  // Player's name
-            int id;                                       // Unique player ID
-            map<ResourceType, int> resources;             // Resources owned by the player
+            int id;                                       // Seat of the player in its game (0 until seated, see PlayerRegistry)
+            ResourceVector resources;                     // Resources owned by the player, indexed by ResourceType
             map<DevCardType, int> developmentCards;       // Development cards owned by the player
             map<PromotionType, int> promotionCards;       // Promotional cards owned by the player
             set<int> settlements;                         // Intersection IDs where the player has settlements
             set<int> cities;                              // Intersection IDs where the player has cities
             set<Edge> roads;                              // Edges where the player has built roads
-            size_t points;                                // Player's victory points
-            int knightCards;   
+            size_t points;                                // Player's victory points, without the awards (see getPoints)
+            AwardTracker* awards;                         // Awards of the player's game (nullptr outside a game)
+            DevelopmentDeck* deck;                        // Card stock of the player's game (nullptr outside a game)
+            uint8_t harbors;                              // Harbor access bits of the player's settlements (see GENERIC_HARBOR)
+            int bankRates[RESOURCE_TYPES];                // Best number of each resource the bank takes for one resource
+
+            friend class GameCheckpoint;                  // Saves and restores the private state
+            friend class TradeBook;                       // Executes matched trades on the hands
+            friend class AwardTracker;                    // Enrolls the player and detaches it when the game ends
+            friend class DevelopmentDeck;                 // as above
+            friend class PlayerRegistry;                  // Seats the player, setting its ID
+
+            // Updates the harbor access and the bank rates, called when a settlement is placed
+            void addHarborAccess(uint8_t access);
 
             // Methods to buy development cards (*)
             void purchaseSelectedCard(DevCardType cardType, vector<Player*>& allPlayers);   // Related to buyDevelopmentCard()
             bool hasEnoughResourcesForCard() const;                                         // as above
+            int cardsLeft(DevCardType type) const;                                          // In the game's deck, or a full deck outside a game
+            int cardsLeft(PromotionType type) const;                                        // as above
+            void takeCard(DevCardType type);                                                // Draws from the game's deck, if any
+            void takeCard(PromotionType type);                                              // as above
 
             // Methods to use development cards (!)
             CardUseError handlePromotionCardUsage(Player* currentPlayer, vector<Player*>& allPlayers, Board& board, bool& endTurn);  // Related to useDevelopmentCard()
@@ -73,17 +95,22 @@ namespace ariel {
         
         public:
 
-            static Player* largestArmyHolder;             // Static pointer to the player holding the largest army
-
             // Constructor 
             Player(const string& name);
            
-            // Building and cards costs' maps
-            static const map<string, map<ResourceType, int>> buildingCosts;
-            static const map<ResourceType, int> devCardCosts;
+            // Building and development card costs, indexed by Structure
+            static constexpr ResourceVector structureCosts[STRUCTURE_TYPES] = {
+                {1, 1, 0, 0, 0, 0, 0, 0},       // ROAD: 1 wood, 1 brick
+                {1, 1, 1, 1, 0, 0, 0, 0},       // SETTLEMENT: 1 wood, 1 brick, 1 wool, 1 grain
+                {0, 0, 0, 2, 3, 0, 0, 0},       // CITY: 2 grain, 3 ore
+                {0, 0, 1, 1, 1, 0, 0, 0}        // DEVELOPMENT_CARD: 1 wool, 1 grain, 1 ore
+            };
+            static const ResourceVector& costOf(Structure structure);
 
             // Checking methods
-            bool canBuild(const string& structureType);           // Called from catan.cpp
+            bool canBuild(Structure structure) const;             // Called on every move generation path
+            bool canBuild(const string& structureType) const;     // Called from catan.cpp ("road", "settlement" or "city")
+            unsigned affordableStructures() const;                // Bit (1 << Structure) set for everything the player can pay for
             bool isRoadContinuation(int id1, int id2);            // Called from card.cpp
 
             // Building methods
@@ -97,6 +124,7 @@ namespace ariel {
             void addResource(ResourceType type, int quantity);          // TO-DO: move to private section after presentation
             bool useResources(ResourceType type, int quantity);         // as above
             int getResourceCount(ResourceType type) const;
+            const ResourceVector& getResources() const;
             void printResources() const;
 
             // Methods to buy development cards (*)
@@ -105,19 +133,31 @@ namespace ariel {
             // Methods to use development cards (!)
             CardUseError useDevelopmentCard(DevCardType cardType, Player* currentPlayer, vector<Player*>& allPlayers, Board& board, bool& endTurn);  // Called from catan.cpp
 
+            // Moving the robber after a 7 or a Knight, and stealing from a player on its new tile
+            // The stolen card is chosen by "draw", which returns an index below its argument (Player::drawCard by default)
+            bool placeRobber(const pair<int, int>& position, vector<Player*>& allPlayers, Board& board, Player* victim = nullptr,
+                             const function<int(int)>& draw = drawCard);
+            ResourceType stealRandomResource(Player& victim, const function<int(int)>& draw = drawCard);
+
             // Handling resource discard after a dice roll of 7
             void discardResources(int toDiscard);                       // Called from catan.cpp
+            void discardResources(int toDiscard, const DiscardPolicy& policy);  // Chosen by the policy, without prompts
 
-            // Methods to handle the Largest Army award ($)
-            void checkForLargestArmy(vector<Player*>& allPlayers);      // Called from test.cpp
-            void reevaluateLargestArmy(vector<Player*>& allPlayers);    // Called from test.cpp  
+            // Awards of the player's game, such as the Largest Army ($)
+            void countKnights(int delta);                               // Counts knights in the award tracker, if any
+            bool holdsAward(Award award) const;
+            AwardTracker* getAwardTracker() const;
 
             // Trading method (&)
             void trade(vector<Player*>& allPlayers);
+            int getBankRate(ResourceType type) const;                               // 4, 3 with a 3:1 harbor, 2 with the harbor of the resource
+            uint8_t getHarbors() const;
+            bool tradeWithBank(ResourceType give, ResourceType get, int quantity = 1);  // Pays the rate for each resource received
             void printTradeCardsDetails(const map<DevCardType, int>& offer, const map<DevCardType, int>& request);
 
             // Rolls a single six-sided die and end turn
             static int rollDice();      // Called from catan.cpp
+            static int drawCard(int count);     // A card index below count, from a generator of the calling thread
             void endTurn();             // Called from catan.cpp
 
             // Getters & Setters 
@@ -0,0 +1,225 @@
+// Email: origoldbsc@gmail.com
+
+#include "plugin.hpp"
+#include "topology.hpp"
+#include <algorithm>
+#include <cstring>
+#include <dlfcn.h>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    static_assert(CATAN_MAX_SEATS == MAX_SEATS, "The plugin views hold every seat");
+    static_assert(CATAN_DECISION_SPECIAL_BUILD == static_cast<int>(DecisionType::SpecialBuild), "CatanDecision follows DecisionType");
+    static_assert(CATAN_DECISION_DISCARD == static_cast<int>(DecisionType::Discard), "CatanDecision follows DecisionType");
+
+
+    //-------------------------------------//
+    //             AgentPlugin             //
+    //-------------------------------------//
+
+    AgentPlugin::AgentPlugin(void* handle, const CatanAgentApi* api, const string& path) : handle(handle), api(api), path(path)
+    {
+    }
+
+
+    /**
+     * @brief Loads a plugin.
+     * @param path Path of the shared object (a path without a '/' is searched like any library).
+     * @throws runtime_error if the library cannot be loaded, has no entry point, was built against
+     * another ABI version or leaves a required function out.
+     */
+    shared_ptr<AgentPlugin> AgentPlugin::load(const string& path)
+    {
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle)
+        {
+            throw runtime_error("Cannot load agent plugin: " + string(dlerror()));
+        }
+
+        // From here on the handle is closed by the plugin, or right away if the plugin is rejected
+        shared_ptr<AgentPlugin> plugin(new AgentPlugin(handle, nullptr, path));
+        auto entry = reinterpret_cast<const CatanAgentApi* (*)()>(dlsym(handle, CATAN_AGENT_ENTRY));
+        if (!entry)
+        {
+            throw runtime_error("Agent plugin " + path + " has no " + CATAN_AGENT_ENTRY + " function");
+        }
+        plugin->api = entry();
+        if (!plugin->api || plugin->api->abiVersion != CATAN_AGENT_ABI_VERSION)
+        {
+            throw runtime_error("Agent plugin " + path + " was built against another ABI version (expected " + to_string(CATAN_AGENT_ABI_VERSION) + ")");
+        }
+        if (!plugin->api->create || !plugin->api->decide || !plugin->api->destroy)
+        {
+            throw runtime_error("Agent plugin " + path + " leaves create, decide or destroy out");
+        }
+        return plugin;
+    }
+
+
+    AgentPlugin::~AgentPlugin()
+    {
+        dlclose(handle);
+    }
+
+
+    const CatanAgentApi& AgentPlugin::getApi() const
+    {
+        return *api;
+    }
+
+
+    string AgentPlugin::getName() const
+    {
+        return api->name ? api->name : path;
+    }
+
+
+    const string& AgentPlugin::getPath() const
+    {
+        return path;
+    }
+
+
+    //-------------------------------------//
+    //             PluginAgent             //
+    //-------------------------------------//
+
+    /**
+     * @brief Creates the plugin's agent for a seat.
+     * @param config Text passed to the plugin's create function.
+     * @throws runtime_error if the plugin fails to create the agent.
+     */
+    PluginAgent::PluginAgent(Catan& game, shared_ptr<AgentPlugin> plugin, size_t seat, const string& config)
+        : game(game), plugin(std::move(plugin)), agent(nullptr), view(), buffer()
+    {
+        const Board& board = game.getBoard();
+        const HexTopology& topology = HexTopology::standard();
+        CatanBoardView boardView = {};
+        for (size_t tile = 0; tile < topology.tileCount() && tile < CATAN_TILES; ++tile)
+        {
+            const pair<int, int>& position = topology.tilePosition(tile);
+            const Tile& placed = board.getTile(position);
+            boardView.positions[tile][0] = static_cast<int8_t>(position.first);
+            boardView.positions[tile][1] = static_cast<int8_t>(position.second);
+            boardView.resources[tile] = static_cast<int8_t>(placed.getResourceType());
+            boardView.numbers[tile] = static_cast<int8_t>(placed.getResourceType() == ResourceType::NONE ? 0 : placed.getNumber());
+            for (size_t corner = 0; corner < 6; ++corner)
+            {
+                boardView.corners[tile][corner] = static_cast<uint8_t>(topology.tileCorners(tile)[corner]);
+            }
+        }
+        for (int id = 1; id <= CATAN_INTERSECTIONS; ++id)
+        {
+            for (size_t index = 0; index < 3; ++index)
+            {
+                boardView.neighbors[id][index] = static_cast<uint8_t>(topology.neighbors(id)[index]);
+            }
+            boardView.harbors[id] = Board::harborAt(id);
+        }
+        for (size_t edge = 0; edge < topology.edgeCount() && edge < CATAN_EDGES; ++edge)
+        {
+            boardView.edges[edge][0] = static_cast<uint8_t>(topology.edge(edge).first);
+            boardView.edges[edge][1] = static_cast<uint8_t>(topology.edge(edge).second);
+        }
+
+        agent = this->plugin->getApi().create(&boardView, static_cast<uint32_t>(seat), config.c_str());
+        if (!agent)
+        {
+            throw runtime_error("Agent plugin " + this->plugin->getName() + " could not create an agent for seat " + to_string(seat));
+        }
+    }
+
+
+    PluginAgent::~PluginAgent()
+    {
+        plugin->getApi().destroy(agent);
+    }
+
+
+    /**
+     * @brief Fills the state view of a decision.
+     */
+    void PluginAgent::refreshView(const DecisionRequest& request)
+    {
+        vector<Player*>& players = game.getPlayers();
+        Board& board = game.getBoard();
+        AwardTracker& awards = game.getAwards();
+        view.decision = static_cast<uint32_t>(request.type);
+        view.seat = static_cast<uint32_t>(request.seat);
+        view.amount = request.amount;
+        view.seatCount = static_cast<uint32_t>(players.size());
+        view.turn = static_cast<uint32_t>(game.getCurrentPlayerIndex());
+        view.robberTile = HexTopology::standard().tileIndex(board.getRobberPosition());
+        for (size_t seat = 0; seat < players.size() && seat < CATAN_MAX_SEATS; ++seat)
+        {
+            const Player& player = *players[seat];
+            CatanSeatView& seatView = view.seats[seat];
+            const ResourceVector& hand = player.getResources();
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                seatView.resources[type] = hand[type];
+            }
+            seatView.points = player.getPoints();
+            seatView.developmentCards = 0;
+            for (const auto& [type, count] : player.getDevelopmentCards())
+            {
+                seatView.developmentCards += count;
+            }
+            int id = player.getId();
+            seatView.knights = awards.getKnights(static_cast<size_t>(id));
+            seatView.settlements = board.getSettlementMask(id);
+            seatView.cities = board.getCityMask(id);
+            seatView.roadEnds = board.getRoadEndMask(id);
+        }
+
+        // Roads are stored by player ID, the view lists them by seat
+        const HexTopology& topology = HexTopology::standard();
+        fill(begin(view.roadOwners), end(view.roadOwners), static_cast<int8_t>(-1));
+        for (const auto& [edge, owner] : board.getRoads())
+        {
+            int index = topology.edgeIndex(edge.getId1(), edge.getId2());
+            for (size_t seat = 0; seat < players.size() && index >= 0 && index < CATAN_EDGES; ++seat)
+            {
+                if (players[seat]->getId() == owner)
+                {
+                    view.roadOwners[index] = static_cast<int8_t>(seat);
+                }
+            }
+        }
+    }
+
+
+    /**
+     * @brief Asks the plugin for a decision.
+     * @throws runtime_error if the plugin gives up or writes no command.
+     */
+    bool PluginAgent::decide(const DecisionRequest& request, string& command)
+    {
+        refreshView(request);
+        buffer[0] = '\0';
+        int32_t length = plugin->getApi().decide(agent, &view, buffer, sizeof(buffer));
+        if (length <= 0 || static_cast<size_t>(length) >= sizeof(buffer))
+        {
+            throw runtime_error("Agent plugin " + plugin->getName() + " gave no command for seat " + to_string(request.seat));
+        }
+        command.assign(buffer, static_cast<size_t>(length));
+        return true;
+    }
+
+
+    void PluginAgent::notify(const string& reply)
+    {
+        if (plugin->getApi().notify)
+        {
+            plugin->getApi().notify(agent, reply.c_str());
+        }
+    }
+
+
+    const CatanStateView& PluginAgent::getView() const
+    {
+        return view;
+    }
+}
@@ -0,0 +1,98 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef PLUGIN_HPP
+#define PLUGIN_HPP
+
+#include <memory>
+#include <string>
+#include "agentabi.h"
+#include "turnengine.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief An agent plugin loaded with dlopen (see agentabi.h). The library stays loaded as long as the plugin
+     * or one of its agents is alive, and is closed with the last of them.
+     *
+     * To swap a plugin between tournaments, load the new build once the agents of the old one are gone. dlopen
+     * returns the library already loaded for a path, so a new build should be installed under a new path or
+     * moved over the old file only after the old plugin is released.
+     */
+    class AgentPlugin
+    {
+        private:
+
+            void* handle;                   // From dlopen
+            const CatanAgentApi* api;       // The plugin's table
+            string path;
+
+            AgentPlugin(void* handle, const CatanAgentApi* api, const string& path);
+
+        public:
+
+            /**
+             * @brief Loads a plugin.
+             * @param path Path of the shared object (a path without a '/' is searched like any library).
+             * @throws runtime_error if the library cannot be loaded, has no entry point, was built against
+             * another ABI version or leaves a required function out.
+             */
+            static shared_ptr<AgentPlugin> load(const string& path);
+
+            ~AgentPlugin();
+
+            AgentPlugin(const AgentPlugin&) = delete;
+            AgentPlugin& operator=(const AgentPlugin&) = delete;
+
+            const CatanAgentApi& getApi() const;
+            string getName() const;
+            const string& getPath() const;
+    };
+
+
+    /**
+     * @brief A seat played by an agent plugin.
+     *
+     * The board view is built once, when the agent is created. Before each decision the state view is refreshed in
+     * place from the players' hands and the board's per-seat masks, so a decision costs a few hundred bytes of copies
+     * and one indirect call, with no allocation on either side of the boundary.
+     */
+    class PluginAgent : public SeatAgent
+    {
+        private:
+
+            Catan& game;
+            shared_ptr<AgentPlugin> plugin;                 // Keeps the library loaded while the agent lives
+            void* agent;                                    // The plugin's agent
+            CatanStateView view;                            // Refreshed before each decision
+            char buffer[CATAN_COMMAND_CAPACITY];            // The command written by the plugin
+
+        public:
+
+            /**
+             * @brief Creates the plugin's agent for a seat.
+             * @param config Text passed to the plugin's create function.
+             * @throws runtime_error if the plugin fails to create the agent.
+             */
+            PluginAgent(Catan& game, shared_ptr<AgentPlugin> plugin, size_t seat, const string& config = "");
+            ~PluginAgent() override;
+
+            PluginAgent(const PluginAgent&) = delete;
+            PluginAgent& operator=(const PluginAgent&) = delete;
+
+            /**
+             * @brief Fills the state view of a decision.
+             */
+            void refreshView(const DecisionRequest& request);
+
+            /**
+             * @brief Asks the plugin for a decision.
+             * @throws runtime_error if the plugin gives up or writes no command.
+             */
+            bool decide(const DecisionRequest& request, string& command) override;
+            void notify(const string& reply) override;
+            const CatanStateView& getView() const;
+    };
+}
+
+#endif
@@ -0,0 +1,59 @@
+// Email: origoldbsc@gmail.com
+
+#include "registry.hpp"
+#include "player.hpp"
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    PlayerRegistry::PlayerRegistry() : seats(), count(0) {}
+
+
+    /**
+     * @brief Seats a player at the next free seat and sets the player's ID to it.
+     * @return The seat of the player (the same seat if the player is already seated).
+     * @throws length_error if all seats are taken.
+     */
+    int PlayerRegistry::add(Player& player)
+    {
+        for (size_t seat = 0; seat < count; ++seat)
+        {
+            if (seats[seat] == &player)
+            {
+                return static_cast<int>(seat);
+            }
+        }
+        if (count == MAX_SEATS)
+        {
+            throw length_error("A game has at most " + to_string(MAX_SEATS) + " players");
+        }
+        seats[count] = &player;
+        player.id = static_cast<int>(count);
+        return static_cast<int>(count++);
+    }
+
+
+    /**
+     * @brief Returns the player at a seat, or nullptr for a free seat.
+     */
+    Player* PlayerRegistry::at(size_t seat) const
+    {
+        return seat < count ? seats[seat] : nullptr;
+    }
+
+
+    size_t PlayerRegistry::size() const
+    {
+        return count;
+    }
+
+
+    /**
+     * @brief Returns true if the ID can index per-seat tables.
+     */
+    bool PlayerRegistry::isSeat(int playerID)
+    {
+        return playerID >= 0 && static_cast<size_t>(playerID) < MAX_SEATS;
+    }
+}
@@ -0,0 +1,66 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef REGISTRY_HPP
+#define REGISTRY_HPP
+
+#include <cstddef>
+
+using namespace std;
+namespace ariel {
+
+    class Player;
+
+    /**
+     * @brief Fewest and most players in one game. Per-seat tables are fixed arrays of MAX_SEATS entries.
+     */
+    constexpr size_t MIN_SEATS = 3;
+    constexpr size_t MAX_SEATS = 6;
+
+    /**
+     * @brief Fewest players of a game with a special build phase after every turn (see Catan::hasSpecialBuildPhase).
+     */
+    constexpr size_t SPECIAL_BUILD_SEATS = 5;
+
+
+    /**
+     * @brief Seats the players of one game: each player gets a dense seat 0..N-1, which becomes its ID.
+     *
+     * The seat is given once, when the player joins the game, and stays the same when the turn order changes.
+     * Since the IDs are dense, the board and the awards keep per-player state in arrays indexed by seat.
+     */
+    class PlayerRegistry
+    {
+        private:
+
+            Player* seats[MAX_SEATS];       // Seated players, by seat
+            size_t count;                   // Number of seated players
+
+        public:
+
+            PlayerRegistry();
+
+            PlayerRegistry(const PlayerRegistry&) = delete;
+            PlayerRegistry& operator=(const PlayerRegistry&) = delete;
+
+            /**
+             * @brief Seats a player at the next free seat and sets the player's ID to it.
+             * @return The seat of the player (the same seat if the player is already seated).
+             * @throws length_error if all seats are taken.
+             */
+            int add(Player& player);
+
+            /**
+             * @brief Returns the player at a seat, or nullptr for a free seat.
+             */
+            Player* at(size_t seat) const;
+
+            size_t size() const;
+
+            /**
+             * @brief Returns true if the ID can index per-seat tables.
+             */
+            static bool isSeat(int playerID);
+    };
+}
+
+#endif
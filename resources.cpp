@@ -1,6 +1,7 @@
 // Email: origoldbsc@gmail.com
 
 #include "resources.hpp"
+#include <cctype>
 
 /**
  * @brief Converts a ResourceType enum value to its corresponding string representation. 
@@ -21,4 +22,26 @@ string ariel::resourceTypeToString(ariel::ResourceType resource)
         case ariel::NONE:   return "DESERT";
         default:            return "UNKNOWN";
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Parses a resource name in any letter case ("wood", "BRICK", ...).
+ * @param name The name to parse.
+ * @return The resource type, or ResourceType::NONE if the name is not a resource.
+ */
+ariel::ResourceType ariel::resourceTypeFromString(const string& name)
+{
+    string upper;
+    for (char c : name)
+    {
+        upper += static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+    for (int type = ariel::WOOD; type <= ariel::ORE; ++type)
+    {
+        if (resourceTypeToString(static_cast<ariel::ResourceType>(type)) == upper)
+        {
+            return static_cast<ariel::ResourceType>(type);
+        }
+    }
+    return ariel::NONE;
+}
@@ -4,6 +4,9 @@
 #define RESOURCE_TYPE_HPP
 
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 using namespace std;
 namespace ariel {
@@ -15,6 +18,52 @@ namespace ariel {
     enum ResourceType { WOOD, BRICK, WOOL, GRAIN, ORE , NONE};
 
 
+    /**
+     * @brief Number of resource types a player can hold (WOOD to ORE).
+     */
+    constexpr size_t RESOURCE_TYPES = 5;
+
+
+    /**
+     * @brief Resource counts indexed by ResourceType, packed in one 32 byte register (eight 32-bit lanes).
+     * Lanes WOOD to ORE hold the counts, the remaining lanes are always zero. Arithmetic and comparisons
+     * apply to every lane at once, e.g. held - cost or held < cost.
+     */
+    typedef int32_t ResourceVector __attribute__((vector_size(32)));
+
+
+    /**
+     * @brief The things a player can pay for, used to index the cost table.
+     */
+    enum class Structure { ROAD, SETTLEMENT, CITY, DEVELOPMENT_CARD };
+
+    constexpr size_t STRUCTURE_TYPES = 4;
+
+
+    /**
+     * @brief Checks that every lane of the held resources covers the cost with a single vector compare.
+     * @param held The resources held.
+     * @param cost The resources needed.
+     * @return True if nothing is missing.
+     */
+    inline bool canAfford(const ResourceVector& held, const ResourceVector& cost)
+    {
+        ResourceVector missing = held < cost;       // All bits set in every lane that falls short
+        uint64_t words[4];
+        memcpy(words, &missing, sizeof(words));
+        return (words[0] | words[1] | words[2] | words[3]) == 0;
+    }
+
+
+    /**
+     * @brief Adds up the lanes of a resource vector.
+     */
+    inline int totalResources(const ResourceVector& resources)
+    {
+        return resources[WOOD] + resources[BRICK] + resources[WOOL] + resources[GRAIN] + resources[ORE];
+    }
+
+
     /**
      * @brief Converts a ResourceType enum value to its corresponding string representation. 
      * @param resource The resource type enum to convert.
@@ -24,6 +73,14 @@ namespace ariel {
      */
     string resourceTypeToString(ResourceType resource);
 
+
+    /**
+     * @brief Parses a resource name in any letter case ("wood", "BRICK", ...).
+     * @param name The name to parse.
+     * @return The resource type, or ResourceType::NONE if the name is not a resource.
+     */
+    ResourceType resourceTypeFromString(const string& name);
+
 };
 
 #endif
@@ -0,0 +1,159 @@
+// Email: origoldbsc@gmail.com
+
+#include "roadplan.hpp"
+#include "board.hpp"
+#include "registry.hpp"
+#include "topology.hpp"
+#include <algorithm>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        uint64_t bitOf(int intersectionID)
+        {
+            return uint64_t{1} << intersectionID;
+        }
+    }
+
+
+    RoadPlanner::RoadPlanner() : settleable(0)
+    {
+        const HexTopology& topology = HexTopology::standard();
+        fill(begin(distance), end(distance), static_cast<int8_t>(UNREACHABLE));
+        fill(begin(previous), end(previous), static_cast<int8_t>(0));
+        for (size_t index = 0; index < 3; ++index)
+        {
+            neighbors[0][index] = 0;
+            edges[0][index] = HexTopology::NO_INDEX;
+        }
+        closes[0] = 0;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            closes[id] = bitOf(id);
+            for (size_t index = 0; index < 3; ++index)
+            {
+                int neighbor = topology.neighbors(id)[index];
+                neighbors[id][index] = neighbor;
+                edges[id][index] = neighbor != 0 ? topology.edgeIndex(id, neighbor) : HexTopology::NO_INDEX;
+                closes[id] |= neighbor != 0 ? bitOf(neighbor) : 0;
+            }
+        }
+    }
+
+
+    /**
+     * @brief Reads the board and plans the routes of a player to every intersection.
+     * @param playerID The player's ID (its seat).
+     */
+    void RoadPlanner::update(const Board& board, int playerID)
+    {
+        // Buildings: all of them close spots, those of the other players also stop roads
+        uint64_t buildings = 0, others = 0;
+        for (size_t seat = 0; seat < MAX_SEATS; ++seat)
+        {
+            uint64_t built = board.getSettlementMask(static_cast<int>(seat)) | board.getCityMask(static_cast<int>(seat));
+            buildings |= built;
+            others |= static_cast<int>(seat) != playerID ? built : 0;
+        }
+        settleable = 0;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            settleable |= (buildings & closes[id]) == 0 ? bitOf(id) : 0;
+        }
+
+        // Edges with a road, of any player
+        const HexTopology& topology = HexTopology::standard();
+        uint64_t taken[2] = {0, 0};
+        int owned = 0;
+        for (const auto& [edge, owner] : board.getRoads())
+        {
+            int index = topology.edgeIndex(edge.getId1(), edge.getId2());
+            if (index >= 0)
+            {
+                taken[index / 64] |= uint64_t{1} << (index % 64);
+            }
+            owned += owner == playerID ? 1 : 0;
+        }
+        int roadsLeft = max(RoadRoute::MAX_LENGTH - owned, 0);
+
+        // Breadth-first from the whole network at once
+        uint64_t network = board.getSettlementMask(playerID) | board.getCityMask(playerID) | (board.getRoadEndMask(playerID) & ~others);
+        fill(begin(distance), end(distance), static_cast<int8_t>(UNREACHABLE));
+        int queue[INTERSECTIONS];
+        int head = 0, tail = 0;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            if ((network & bitOf(id)) != 0)
+            {
+                distance[id] = 0;
+                previous[id] = 0;
+                queue[tail++] = id;
+            }
+        }
+        while (head < tail)
+        {
+            int id = queue[head++];
+            if (distance[id] >= roadsLeft || (others & bitOf(id)) != 0)
+            {
+                continue;
+            }
+            for (size_t index = 0; index < 3; ++index)
+            {
+                int neighbor = neighbors[id][index];
+                int edge = edges[id][index];
+                if (neighbor == 0 || distance[neighbor] != UNREACHABLE || ((taken[edge / 64] >> (edge % 64)) & 1) != 0)
+                {
+                    continue;
+                }
+                distance[neighbor] = static_cast<int8_t>(distance[id] + 1);
+                previous[neighbor] = static_cast<int8_t>(id);
+                queue[tail++] = neighbor;
+            }
+        }
+    }
+
+
+    /**
+     * @brief Returns the fewest roads the player needs to settle at an intersection (0 if its network already
+     * reaches it), or UNREACHABLE if the spot is taken, too close to a building, or out of reach.
+     */
+    int RoadPlanner::roadsTo(int intersectionID) const
+    {
+        if (intersectionID < 1 || intersectionID > INTERSECTIONS || (settleable & bitOf(intersectionID)) == 0)
+        {
+            return UNREACHABLE;
+        }
+        return distance[intersectionID];
+    }
+
+
+    /**
+     * @brief Returns a cheapest route to settle at an intersection, with roads set to UNREACHABLE if there is none.
+     */
+    RoadRoute RoadPlanner::route(int intersectionID) const
+    {
+        RoadRoute route;
+        route.roads = roadsTo(intersectionID);
+        for (int step = route.roads, id = intersectionID; step >= 0; --step, id = previous[id])
+        {
+            route.path[step] = id;
+        }
+        return route;
+    }
+
+
+    /**
+     * @brief Writes roadsTo() of every intersection, the player's settlement reachability map.
+     * @param roads INTERSECTIONS + 1 entries, indexed by intersection ID (entry 0 is set to UNREACHABLE).
+     */
+    void RoadPlanner::reachability(int* roads) const
+    {
+        roads[0] = UNREACHABLE;
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            roads[id] = roadsTo(id);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef ROADPLAN_HPP
+#define ROADPLAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+namespace ariel {
+
+    class Board;
+
+    /**
+     * @brief The cheapest road route from a player's network to a target intersection.
+     */
+    struct RoadRoute
+    {
+        static constexpr int MAX_LENGTH = 15;   // Roads of a player
+
+        int roads;                              // Roads to build, RoadPlanner::UNREACHABLE if there is no route
+        int path[MAX_LENGTH + 1];               // Intersections from the network (path[0]) to the target (path[roads])
+    };
+
+
+    /**
+     * @brief Plans the roads of a player toward the spots where it could settle.
+     *
+     * update() reads the board once into bit masks and runs a breadth-first search from the whole network of the
+     * player at the same time (its settlements, cities and road ends), so the fewest roads to every intersection are
+     * known at once. The search only follows edges without a road and does not pass an intersection with another
+     * player's building. An intersection is a target when the distance rule of Board::canPlaceSettlement allows a
+     * settlement there, and a route is cut at the roads the player has left. Queries then read the arrays of the
+     * last update and never allocate.
+     *
+     * The adjacency is the standard board's, from HexTopology (the dense form of Board::adjacencyList).
+     */
+    class RoadPlanner
+    {
+        public:
+
+            static constexpr int INTERSECTIONS = 54;
+            static constexpr int UNREACHABLE = -1;
+
+        private:
+
+            int neighbors[INTERSECTIONS + 1][3];    // 0 where there is no neighbor
+            int edges[INTERSECTIONS + 1][3];        // HexTopology edge index of each neighbor
+            uint64_t closes[INTERSECTIONS + 1];     // An intersection and its neighbors, one bit per ID
+            int8_t distance[INTERSECTIONS + 1];     // Roads to reach each intersection, UNREACHABLE if none
+            int8_t previous[INTERSECTIONS + 1];     // The intersection before it on a cheapest route, 0 on the network
+            uint64_t settleable;                    // Intersections the distance rule leaves open
+
+        public:
+
+            RoadPlanner();
+
+            /**
+             * @brief Reads the board and plans the routes of a player to every intersection.
+             * @param playerID The player's ID (its seat).
+             */
+            void update(const Board& board, int playerID);
+
+            /**
+             * @brief Returns the fewest roads the player needs to settle at an intersection (0 if its network already
+             * reaches it), or UNREACHABLE if the spot is taken, too close to a building, or out of reach.
+             */
+            int roadsTo(int intersectionID) const;
+
+            /**
+             * @brief Returns a cheapest route to settle at an intersection, with roads set to UNREACHABLE if there is none.
+             */
+            RoadRoute route(int intersectionID) const;
+
+            /**
+             * @brief Writes roadsTo() of every intersection, the player's settlement reachability map.
+             * @param roads INTERSECTIONS + 1 entries, indexed by intersection ID (entry 0 is set to UNREACHABLE).
+             */
+            void reachability(int* roads) const;
+    };
+}
+
+#endif
@@ -0,0 +1,146 @@
+// Email: origoldbsc@gmail.com
+
+/*
+ * A sample agent plugin in plain C, built with 'make libsampleagent.so' and loaded with './Catan --agent ./libsampleagent.so'.
+ * It upgrades a settlement when it can, settles the first open spot its roads reach, builds a road on the
+ * first free edge leaving its network when no spot is open, buys development cards and otherwise ends its turn. A rejected
+ * command ends the turn.
+ */
+
+#include "agentabi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct SampleAgent
+{
+    CatanBoardView board;
+    uint32_t seat;
+    int rejected;               /* The game rejected the last command */
+} SampleAgent;
+
+
+static int lowestBit(uint64_t mask)
+{
+    return mask ? __builtin_ctzll(mask) : 0;
+}
+
+
+static int canPay(const CatanSeatView* me, int wood, int brick, int wool, int grain, int ore)
+{
+    return me->resources[0] >= wood && me->resources[1] >= brick && me->resources[2] >= wool && me->resources[3] >= grain && me->resources[4] >= ore;
+}
+
+
+/* Intersections with a building or next to one, where nobody may settle */
+static uint64_t closedSpots(const SampleAgent* agent, const CatanStateView* state)
+{
+    uint64_t closed = 0;
+    for (uint32_t seat = 0; seat < state->seatCount; ++seat)
+    {
+        for (uint64_t built = state->seats[seat].settlements | state->seats[seat].cities; built; built &= built - 1)
+        {
+            int id = lowestBit(built);
+            closed |= 1ull << id;
+            for (int index = 0; index < 3; ++index)
+            {
+                closed |= agent->board.neighbors[id][index] ? 1ull << agent->board.neighbors[id][index] : 0;
+            }
+        }
+    }
+    return closed;
+}
+
+
+static void* create(const CatanBoardView* board, uint32_t seat, const char* config)
+{
+    (void)config;
+    SampleAgent* agent = calloc(1, sizeof(SampleAgent));
+    if (agent)
+    {
+        agent->board = *board;
+        agent->seat = seat;
+    }
+    return agent;
+}
+
+
+static int32_t decide(void* handle, const CatanStateView* state, char* command, size_t capacity)
+{
+    SampleAgent* agent = handle;
+    const CatanSeatView* me = &state->seats[state->seat];
+    switch (state->decision)
+    {
+        case CATAN_DECISION_PRE_ROLL:
+            agent->rejected = 0;
+            return snprintf(command, capacity, "roll");
+        case CATAN_DECISION_DISCARD:
+            return snprintf(command, capacity, "discard auto build");
+        case CATAN_DECISION_ROBBER:
+            return snprintf(command, capacity, "robber");
+        default:
+            break;
+    }
+    if (agent->rejected)
+    {
+        return snprintf(command, capacity, "end");
+    }
+
+    uint64_t open = me->roadEnds & ~closedSpots(agent, state);
+    if (me->settlements && canPay(me, 0, 0, 0, 2, 3))
+    {
+        return snprintf(command, capacity, "city %d", lowestBit(me->settlements));
+    }
+    if (open && canPay(me, 1, 1, 1, 1, 0))
+    {
+        return snprintf(command, capacity, "settle %d", lowestBit(open));
+    }
+    if (!open && canPay(me, 1, 1, 0, 0, 0))
+    {
+        /* A free edge leaving the seat's network; roads do not pass other seats' buildings */
+        uint64_t taken = 0;
+        for (uint32_t seat = 0; seat < state->seatCount; ++seat)
+        {
+            taken |= seat == state->seat ? 0 : state->seats[seat].settlements | state->seats[seat].cities;
+        }
+        uint64_t network = (me->roadEnds & ~taken) | me->settlements | me->cities;
+        for (int edge = 0; edge < CATAN_EDGES; ++edge)
+        {
+            int from = agent->board.edges[edge][0], to = agent->board.edges[edge][1];
+            if (state->roadOwners[edge] >= 0 || !((network >> from | network >> to) & 1))
+            {
+                continue;
+            }
+            if (!(network >> from & 1))
+            {
+                from = to;
+                to = agent->board.edges[edge][0];
+            }
+            return snprintf(command, capacity, "road %d %d", from, to);
+        }
+    }
+    if (canPay(me, 0, 0, 1, 1, 1))
+    {
+        return snprintf(command, capacity, "buy");
+    }
+    return snprintf(command, capacity, "end");
+}
+
+
+static void notify(void* handle, const char* reply)
+{
+    ((SampleAgent*)handle)->rejected = strncmp(reply, "err", 3) == 0;
+}
+
+
+static void destroy(void* handle)
+{
+    free(handle);
+}
+
+
+const CatanAgentApi* catan_agent_api(void)
+{
+    static const CatanAgentApi api = {CATAN_AGENT_ABI_VERSION, "sample", create, decide, notify, destroy};
+    return &api;
+}
@@ -0,0 +1,725 @@
+// Email: origoldbsc@gmail.com
+
+#include "server.hpp"
+#include "exporter.hpp"
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        /**
+         * @brief Creates the players of a game, named "Seat A" onwards.
+         * @throws invalid_argument if the number of players is not MIN_SEATS to MAX_SEATS.
+         */
+        vector<unique_ptr<Player>> createPlayers(size_t seats)
+        {
+            if (seats < MIN_SEATS || seats > MAX_SEATS)
+            {
+                throw invalid_argument("A game has " + to_string(MIN_SEATS) + " to " + to_string(MAX_SEATS) + " players");
+            }
+            vector<unique_ptr<Player>> players;
+            for (size_t seat = 0; seat < seats; ++seat)
+            {
+                players.push_back(make_unique<Player>(string("Seat ") + static_cast<char>('A' + seat)));
+            }
+            return players;
+        }
+
+        vector<Player*> pointersTo(const vector<unique_ptr<Player>>& players)
+        {
+            vector<Player*> pointers;
+            for (const unique_ptr<Player>& player : players)
+            {
+                pointers.push_back(player.get());
+            }
+            return pointers;
+        }
+
+        vector<SeatAgent*> firstAgents(QueuedAgent* agents, size_t seats)
+        {
+            vector<SeatAgent*> seated;
+            for (size_t seat = 0; seat < seats; ++seat)
+            {
+                seated.push_back(&agents[seat]);
+            }
+            return seated;
+        }
+    }
+
+
+    //-------------------------------------//
+    //             GameSession             //
+    //-------------------------------------//
+
+    /**
+     * @brief Creates a game with the beginner setup on the session's own board and chooses the starting seat.
+     * @param id The session ID.
+     * @param seats The number of players, MIN_SEATS to MAX_SEATS.
+     * @throws invalid_argument for any other number of players.
+     */
+    GameSession::GameSession(int id, size_t seats) : id(id), board(), players(createPlayers(seats)), game(pointersTo(players), board),
+                                                     agents(), engine(game, firstAgents(agents, seats)),
+                                                     lastActivity(chrono::steady_clock::now())
+    {
+        fill(begin(seatFds), end(seatFds), -1);
+        tagEvents();
+        game.initializeGame();      // Places the beginner settlements and orders the seats by dice roll
+        engine.start();             // Runs until the starting seat has to roll
+    }
+
+
+    /**
+     * @brief Applies one command sent by the player on a seat.
+     * @param seat The seat index (0 is the starting player).
+     * @param command The command line without the trailing newline.
+     * @param broadcast Set to a line every seat should see (empty if none).
+     * @return The reply line for the sender, starting with "ok" or "err".
+     */
+    string GameSession::handleCommand(size_t seat, const string& command, string& broadcast)
+    {
+        lastActivity = chrono::steady_clock::now();
+        if (command == "state")
+        {
+            broadcast.clear();
+            return describeState();
+        }
+        tagEvents();
+        return engine.submit(seat, command, broadcast);
+    }
+
+
+    /**
+     * @brief Tags the events of the active exporter with this session's ID, since every hosted game
+     * shares the exporter and their lines interleave.
+     */
+    void GameSession::tagEvents()
+    {
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->setGame(id);
+        }
+    }
+
+
+    /**
+     * @brief Returns a single line describing the turn, the phase and every seat.
+     * Each seat is listed as: seat points wood,brick,wool,grain,ore
+     */
+    string GameSession::describeState()
+    {
+        static const char* const phases[] = {"preroll", "discard", "robber", "actions", "build", "finished"};
+        ostringstream out;
+        out << "ok game " << id << " turn " << engine.getTurn() << " phase " << phases[static_cast<int>(engine.getPhase())];
+        for (size_t seat = 0; seat < game.getPlayers().size(); ++seat)
+        {
+            const Player* player = game.getPlayers()[seat];
+            out << " | " << seat << " " << player->getPoints() << " "
+                << player->getResourceCount(WOOD) << "," << player->getResourceCount(BRICK) << ","
+                << player->getResourceCount(WOOL) << "," << player->getResourceCount(GRAIN) << ","
+                << player->getResourceCount(ORE);
+        }
+        return out.str();
+    }
+
+
+    /**
+     * @brief Replaces the die roller of the game's turn engine (see TurnEngine::setDice).
+     */
+    void GameSession::setDice(function<int()> roll)
+    {
+        engine.setDice(move(roll));
+    }
+
+
+    /**
+     * @brief Replaces the card draw of the game's robber (see TurnEngine::setCardDraw).
+     */
+    void GameSession::setCardDraw(function<int(int)> pick)
+    {
+        engine.setCardDraw(move(pick));
+    }
+
+
+    /**
+     * @brief Attaches a connection to a free seat.
+     * @return True if the seat was free.
+     */
+    bool GameSession::attach(size_t seat, int fd)
+    {
+        if (seat >= game.getPlayers().size() || seatFds[seat] != -1)
+        {
+            return false;
+        }
+        seatFds[seat] = fd;
+        lastActivity = chrono::steady_clock::now();
+        return true;
+    }
+
+
+    /**
+     * @brief Frees every seat held by a connection.
+     */
+    void GameSession::detach(int fd)
+    {
+        for (size_t seat = 0; seat < game.getPlayers().size(); ++seat)
+        {
+            if (seatFds[seat] == fd)
+            {
+                seatFds[seat] = -1;
+                lastActivity = chrono::steady_clock::now();
+            }
+        }
+    }
+
+
+    /**
+     * @brief Returns the connection attached to a seat, or -1 if the seat is free.
+     */
+    int GameSession::getSeatFd(size_t seat) const
+    {
+        return seat < players.size() ? seatFds[seat] : -1;
+    }
+
+
+    /**
+     * @brief Returns true if any seat has a connection attached.
+     */
+    bool GameSession::hasConnections() const
+    {
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            if (seatFds[seat] != -1)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    /**
+     * @brief Returns when the game last received a command, a join or a leave.
+     */
+    chrono::steady_clock::time_point GameSession::getLastActivity() const
+    {
+        return lastActivity;
+    }
+
+
+    int GameSession::getId() const
+    {
+        return id;
+    }
+
+    size_t GameSession::getSeatCount() const
+    {
+        return players.size();
+    }
+
+    size_t GameSession::getTurn() const
+    {
+        return engine.getTurn();
+    }
+
+    TurnPhase GameSession::getPhase() const
+    {
+        return engine.getPhase();
+    }
+
+    Player& GameSession::getSeat(size_t seat)
+    {
+        return *game.getPlayers().at(seat);
+    }
+
+    Board& GameSession::getBoard()
+    {
+        return board;
+    }
+
+
+    //-------------------------------------//
+    //             GameServer              //
+    //-------------------------------------//
+
+    /**
+     * @brief Prepares a server for the given socket path. Nothing is opened until start().
+     * @param socketPath Filesystem path of the Unix domain socket.
+     * @param maxSessions Upper bound on concurrently hosted games.
+     * @param seatlessGrace How long a game nobody is seated at is kept.
+     * @param idleTimeout How long a game without any command, join or leave is kept.
+     */
+    GameServer::GameServer(const string& socketPath, size_t maxSessions, chrono::milliseconds seatlessGrace, chrono::milliseconds idleTimeout)
+        : socketPath(socketPath), listenFd(-1), epollFd(-1), running(false), maxSessions(maxSessions), nextSessionID(1),
+          seatlessGrace(seatlessGrace), idleTimeout(idleTimeout), nextReap(chrono::steady_clock::now()) {}
+
+
+    /**
+     * @brief Closes every connection, the listening socket and removes the socket file.
+     */
+    GameServer::~GameServer()
+    {
+        for (auto& [fd, connection] : connections)
+        {
+            ::close(fd);
+        }
+        connections.clear();
+        if (listenFd >= 0)
+        {
+            ::close(listenFd);
+            ::unlink(socketPath.c_str());
+        }
+        if (epollFd >= 0)
+        {
+            ::close(epollFd);
+        }
+    }
+
+
+    /**
+     * @brief Binds and listens on the socket and creates the epoll instance.
+     * @throws runtime_error if any of the system calls fail.
+     */
+    void GameServer::start()
+    {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path))
+        {
+            throw runtime_error("Socket path too long: " + socketPath);
+        }
+        memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0)
+        {
+            throw runtime_error(string("socket: ") + strerror(errno));
+        }
+        ::unlink(socketPath.c_str());       // Remove a stale socket left by a previous run
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listenFd, SOMAXCONN) < 0)
+        {
+            throw runtime_error(string("bind/listen: ") + strerror(errno));
+        }
+
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0)
+        {
+            throw runtime_error(string("epoll_create1: ") + strerror(errno));
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0)
+        {
+            throw runtime_error(string("epoll_ctl: ") + strerror(errno));
+        }
+        running = true;
+    }
+
+
+    /**
+     * @brief Waits for events once and handles all of them, then reaps idle games when due.
+     * @param timeoutMs How long to wait for events (-1 waits forever).
+     * @return The number of handled events.
+     */
+    int GameServer::runOnce(int timeoutMs)
+    {
+        epoll_event events[128];
+        int count = ::epoll_wait(epollFd, events, 128, timeoutMs);
+        if (chrono::steady_clock::now() >= nextReap)
+        {
+            reapSessions();
+        }
+        if (count < 0)
+        {
+            return 0;       // Interrupted by a signal
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == listenFd)
+            {
+                acceptConnections();
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end())
+            {
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                readConnection(it->second);
+            }
+            it = connections.find(fd);      // Reading may have closed the connection
+            if (it != connections.end() && (events[i].events & EPOLLOUT))
+            {
+                flushConnection(it->second);
+            }
+        }
+        return count;
+    }
+
+
+    /**
+     * @brief Runs the event loop until stop() is called.
+     */
+    void GameServer::run()
+    {
+        while (running)
+        {
+            runOnce(1000);
+        }
+    }
+
+
+    /**
+     * @brief Makes run() return after the current iteration.
+     */
+    void GameServer::stop()
+    {
+        running = false;
+    }
+
+
+    /**
+     * @brief Accepts every pending connection and registers it with epoll.
+     */
+    void GameServer::acceptConnections()
+    {
+        while (true)
+        {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                return;     // EAGAIN: no more pending connections
+            }
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+            {
+                ::close(fd);
+                continue;
+            }
+            connections[fd] = Connection{fd, string(), string(), -1, 0, false, {}};
+        }
+    }
+
+
+    /**
+     * @brief Reads everything available on a connection and handles each complete line.
+     */
+    void GameServer::readConnection(Connection& connection)
+    {
+        int fd = connection.fd;
+        char chunk[4096];
+        while (true)
+        {
+            ssize_t size = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (size == 0 || (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                closeConnection(fd);        // The client hung up
+                return;
+            }
+            if (size < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            connection.input.append(chunk, static_cast<size_t>(size));
+
+            size_t start = 0;
+            size_t newline;
+            while ((newline = connection.input.find('\n', start)) != string::npos)
+            {
+                string line = connection.input.substr(start, newline - start);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                processLine(connection, line);
+                start = newline + 1;
+            }
+            connection.input.erase(0, start);
+            if (connection.input.size() > MAX_LINE)
+            {
+                queue(connection, "err line too long");
+                flushConnection(connection);
+                closeConnection(fd);
+                return;
+            }
+        }
+        flushConnection(connection);
+    }
+
+
+    /**
+     * @brief Handles one command line from a connection.
+     */
+    void GameServer::processLine(Connection& connection, const string& line)
+    {
+        istringstream in(line);
+        string verb;
+        in >> verb;
+        if (verb.empty())
+        {
+            return;
+        }
+
+        if (verb == "new")
+        {
+            if (sessions.size() >= maxSessions)
+            {
+                queue(connection, "err server full");
+                return;
+            }
+            size_t seats = MIN_SEATS;
+            if (!(in >> seats))
+            {
+                seats = MIN_SEATS;
+            }
+            if (seats < MIN_SEATS || seats > MAX_SEATS)
+            {
+                queue(connection, "err a game has " + to_string(MIN_SEATS) + " to " + to_string(MAX_SEATS) + " players");
+                return;
+            }
+            erase_if(connection.created, [this](int created) { return sessions.count(created) == 0; });
+            if (connection.created.size() >= MAX_CREATED)
+            {
+                queue(connection, "err too many games");
+                return;
+            }
+            int id = nextSessionID++;
+            sessions[id] = make_unique<GameSession>(id, seats);
+            connection.created.push_back(id);
+            queue(connection, "ok game " + to_string(id));
+            return;
+        }
+
+        if (verb == "join")
+        {
+            int id;
+            size_t seat;
+            if (!(in >> id >> seat))
+            {
+                queue(connection, "err usage: join <game> <seat>");
+                return;
+            }
+            auto it = sessions.find(id);
+            if (it == sessions.end())
+            {
+                queue(connection, "err no such game");
+                return;
+            }
+            GameSession& session = *it->second;
+            if (connection.sessionID == id && connection.seat == seat)
+            {
+                queue(connection, "ok joined " + to_string(id) + " " + to_string(seat));
+                return;
+            }
+            if (seat >= session.getSeatCount() || session.getSeatFd(seat) != -1)
+            {
+                queue(connection, "err seat taken");
+                return;
+            }
+            // A connection plays one seat: moving frees the seat it held, also within the same game
+            leaveSession(connection);
+            session.attach(seat, connection.fd);
+            connection.sessionID = id;
+            connection.seat = seat;
+            queue(connection, "ok joined " + to_string(id) + " " + to_string(seat));
+            return;
+        }
+
+        auto it = sessions.find(connection.sessionID);
+        if (it == sessions.end())
+        {
+            queue(connection, "err join a game first");
+            return;
+        }
+        GameSession& session = *it->second;
+
+        if (verb == "leave")
+        {
+            leaveSession(connection);
+            queue(connection, "ok");
+            return;
+        }
+
+        string event;
+        queue(connection, session.handleCommand(connection.seat, line, event));
+        if (!event.empty())
+        {
+            broadcast(session, event, connection.fd);
+            queue(connection, event);
+        }
+    }
+
+
+    /**
+     * @brief Frees the seat a connection holds, if any. A finished game left without connections is dropped.
+     */
+    void GameServer::leaveSession(Connection& connection)
+    {
+        auto it = sessions.find(connection.sessionID);
+        connection.sessionID = -1;
+        if (it == sessions.end())
+        {
+            return;
+        }
+        it->second->detach(connection.fd);
+        if (it->second->getPhase() == TurnPhase::Finished && !it->second->hasConnections())
+        {
+            sessions.erase(it);
+        }
+    }
+
+
+    /**
+     * @brief Drops the games nobody has been seated at for the grace period, and the games without any activity
+     * for the idle timeout. The seats of a closed game are told with "event closed <game> idle".
+     */
+    void GameServer::reapSessions()
+    {
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        nextReap = now + min<chrono::steady_clock::duration>(seatlessGrace, chrono::seconds(1));
+        for (auto it = sessions.begin(); it != sessions.end();)
+        {
+            GameSession& session = *it->second;
+            chrono::steady_clock::duration idle = now - session.getLastActivity();
+            if (session.hasConnections() ? idle < idleTimeout : idle < seatlessGrace)
+            {
+                ++it;
+                continue;
+            }
+            for (size_t seat = 0; seat < session.getSeatCount(); ++seat)
+            {
+                auto connection = connections.find(session.getSeatFd(seat));
+                if (connection != connections.end())
+                {
+                    connection->second.sessionID = -1;
+                    queue(connection->second, "event closed " + to_string(session.getId()) + " idle");
+                    flushConnection(connection->second);
+                }
+            }
+            it = sessions.erase(it);
+        }
+    }
+
+
+    /**
+     * @brief Appends a line to a connection's output. A reader that falls too far behind is disconnected.
+     */
+    void GameServer::queue(Connection& connection, const string& line)
+    {
+        if (connection.output.size() + line.size() + 1 > MAX_PENDING_OUTPUT)
+        {
+            connection.output.clear();
+            ::shutdown(connection.fd, SHUT_RDWR);       // Epoll reports the hangup and the connection is closed there
+            return;
+        }
+        connection.output += line;
+        connection.output += '\n';
+    }
+
+
+    /**
+     * @brief Writes as much pending output as the socket accepts, waiting for EPOLLOUT for the rest.
+     */
+    void GameServer::flushConnection(Connection& connection)
+    {
+        while (!connection.output.empty())
+        {
+            ssize_t size = ::send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (size < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    connection.output.clear();
+                    ::shutdown(connection.fd, SHUT_RDWR);
+                    return;
+                }
+                break;
+            }
+            connection.output.erase(0, static_cast<size_t>(size));
+        }
+
+        bool wantWrite = !connection.output.empty();
+        if (wantWrite != connection.writeArmed)
+        {
+            epoll_event event{};
+            event.events = wantWrite ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+            event.data.fd = connection.fd;
+            ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.writeArmed = wantWrite;
+        }
+    }
+
+
+    /**
+     * @brief Closes a connection and frees its seat. Finished games without connections are dropped.
+     */
+    void GameServer::closeConnection(int fd)
+    {
+        auto it = connections.find(fd);
+        if (it == connections.end())
+        {
+            return;
+        }
+        leaveSession(it->second);
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(it);
+    }
+
+
+    /**
+     * @brief Sends a line to every connection seated in a session except one.
+     */
+    void GameServer::broadcast(GameSession& session, const string& line, int exceptFd)
+    {
+        for (size_t seat = 0; seat < session.getSeatCount(); ++seat)
+        {
+            int fd = session.getSeatFd(seat);
+            if (fd == -1 || fd == exceptFd)
+            {
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it != connections.end())
+            {
+                queue(it->second, line);
+                flushConnection(it->second);
+            }
+        }
+    }
+
+
+    size_t GameServer::getSessionCount() const
+    {
+        return sessions.size();
+    }
+
+    size_t GameServer::getConnectionCount() const
+    {
+        return connections.size();
+    }
+}
@@ -0,0 +1,200 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include "catan.hpp"
+#include "board.hpp"
+#include "player.hpp"
+#include "turnengine.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief This class represents one game hosted by the server.
+     *
+     * A session owns its board, its 3 to 6 players and the Catan game that binds them. Its turns are run by a
+     * TurnEngine whose seats all wait for submitted commands, so a session never blocks: each command resumes
+     * the game until it needs the next decision and is answered with a single reply line.
+     */
+    class GameSession
+    {
+        private:
+
+            int id;                                 // Session ID, unique within the server
+            Board board;                            // The board of this game
+            vector<unique_ptr<Player>> players;     // The seated players
+            Catan game;                             // The game played on the board
+            QueuedAgent agents[MAX_SEATS];          // The seats, answered by submitted commands
+            TurnEngine engine;                      // Runs the turns of the game
+            int seatFds[MAX_SEATS];                 // Connection attached to each seat (-1 when free)
+            chrono::steady_clock::time_point lastActivity;  // Last command, join or leave
+
+            void tagEvents();
+
+        public:
+
+            /**
+             * @brief Creates a game with the beginner setup and chooses the starting seat.
+             * @param id The session ID.
+             * @param seats The number of players, MIN_SEATS to MAX_SEATS.
+             * @throws invalid_argument for any other number of players.
+             */
+            explicit GameSession(int id, size_t seats = MIN_SEATS);
+
+            GameSession(const GameSession&) = delete;
+            GameSession& operator=(const GameSession&) = delete;
+
+            /**
+             * @brief Applies one command sent by the player on a seat.
+             * @param seat The seat index (0 is the starting player).
+             * @param command The command line without the trailing newline.
+             * @param broadcast Set to a line every seat should see (empty if none).
+             * @return The reply line for the sender, starting with "ok" or "err".
+             */
+            string handleCommand(size_t seat, const string& command, string& broadcast);
+
+            /**
+             * @brief Returns a single line describing the turn, the phase and every seat.
+             */
+            string describeState();
+
+            /**
+             * @brief Replaces the die roller of the game's turn engine (see TurnEngine::setDice).
+             */
+            void setDice(function<int()> roll);
+
+            /**
+             * @brief Replaces the card draw of the game's robber (see TurnEngine::setCardDraw).
+             */
+            void setCardDraw(function<int(int)> pick);
+
+            // Seat management
+            bool attach(size_t seat, int fd);
+            void detach(int fd);
+            int getSeatFd(size_t seat) const;
+            bool hasConnections() const;
+            chrono::steady_clock::time_point getLastActivity() const;
+
+            // Getters
+            int getId() const;
+            size_t getSeatCount() const;
+            size_t getTurn() const;
+            TurnPhase getPhase() const;
+            Player& getSeat(size_t seat);
+            Board& getBoard();
+    };
+
+
+    /**
+     * @brief This class hosts many concurrent games behind a Unix domain socket.
+     *
+     * A single thread runs an epoll event loop over the listening socket and all client connections.
+     * Clients speak a line based protocol: "new [seats]" creates a game of 3 (by default) to 6 players,
+     * "join <game> <seat>" takes a seat,
+     * and the game commands are "state", "roll", "road <a> <b>", "settle <i>", "city <i>", "buy",
+     * "use vp", "discard <wood> <brick> <wool> <grain> <ore>", "end" and "leave".
+     *
+     * Idle games are reaped so memory stays bounded: a game nobody is seated at is dropped after a grace
+     * period, and a game without any activity for the idle timeout is closed for its seats too. Each
+     * connection may hold only a few games it created and that still exist.
+     */
+    class GameServer
+    {
+        private:
+
+            static const size_t MAX_LINE = 256;             // Longest accepted command line
+            static const size_t MAX_PENDING_OUTPUT = 64 * 1024;     // Output kept for a slow reader before dropping it
+            static const size_t MAX_CREATED = 4;            // Live games a connection may have created
+
+            /**
+             * @brief The state kept for each client connection.
+             */
+            struct Connection
+            {
+                int fd;                     // The connected socket
+                string input;               // Bytes received but not yet forming a full line
+                string output;              // Bytes waiting to be written
+                int sessionID;              // Joined session (-1 if none)
+                size_t seat;                // Joined seat
+                bool writeArmed;            // True while EPOLLOUT is registered
+                vector<int> created;        // IDs of the games this connection created
+            };
+
+            string socketPath;                                          // Path of the listening socket
+            int listenFd;                                               // Listening socket
+            int epollFd;                                                // The epoll instance
+            bool running;                                               // Cleared by stop()
+            size_t maxSessions;                                         // Upper bound on hosted games
+            int nextSessionID;                                          // ID of the next created game
+            chrono::milliseconds seatlessGrace;                         // Lifetime of a game nobody is seated at
+            chrono::milliseconds idleTimeout;                           // Lifetime of a game without activity
+            chrono::steady_clock::time_point nextReap;                  // When runOnce() looks for idle games again
+            unordered_map<int, unique_ptr<GameSession>> sessions;       // Hosted games by ID
+            unordered_map<int, Connection> connections;                 // Connections by descriptor
+
+            void acceptConnections();
+            void readConnection(Connection& connection);
+            void processLine(Connection& connection, const string& line);
+            void queue(Connection& connection, const string& line);
+            void flushConnection(Connection& connection);
+            void closeConnection(int fd);
+            void leaveSession(Connection& connection);
+            void reapSessions();
+            void broadcast(GameSession& session, const string& line, int exceptFd);
+
+        public:
+
+            /**
+             * @brief Prepares a server for the given socket path. Nothing is opened until start().
+             * @param socketPath Filesystem path of the Unix domain socket.
+             * @param maxSessions Upper bound on concurrently hosted games.
+             * @param seatlessGrace How long a game nobody is seated at is kept.
+             * @param idleTimeout How long a game without any command, join or leave is kept.
+             */
+            GameServer(const string& socketPath, size_t maxSessions = 10000, chrono::milliseconds seatlessGrace = chrono::minutes(2),
+                       chrono::milliseconds idleTimeout = chrono::minutes(30));
+
+            /**
+             * @brief Closes every connection, the listening socket and removes the socket file.
+             */
+            ~GameServer();
+
+            GameServer(const GameServer&) = delete;
+            GameServer& operator=(const GameServer&) = delete;
+
+            /**
+             * @brief Binds and listens on the socket and creates the epoll instance.
+             * @throws runtime_error if any of the system calls fail.
+             */
+            void start();
+
+            /**
+             * @brief Waits for events once and handles all of them, then reaps idle games when due.
+             * @param timeoutMs How long to wait for events (-1 waits forever).
+             * @return The number of handled events.
+             */
+            int runOnce(int timeoutMs);
+
+            /**
+             * @brief Runs the event loop until stop() is called.
+             */
+            void run();
+
+            /**
+             * @brief Makes run() return after the current iteration.
+             */
+            void stop();
+
+            size_t getSessionCount() const;
+            size_t getConnectionCount() const;
+    };
+}
+
+#endif
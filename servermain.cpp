@@ -0,0 +1,57 @@
+// Email: origoldbsc@gmail.com
+
+#include "server.hpp"
+#include "exporter.hpp"
+#include <iostream>
+#include <csignal>
+#include <memory>
+#include <string>
+
+using namespace ariel;
+using namespace std;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+int main(int argc, char* argv[]) {
+
+    // Usage: ./server [socket path] [max games] [--events <file or fifo>]
+    string socketPath = argc > 1 ? argv[1] : "/tmp/catan.sock";
+    size_t maxSessions = argc > 2 ? stoul(argv[2]) : 10000;
+
+    unique_ptr<EventExporter> exporter;
+    if (argc > 4 && string(argv[3]) == "--events")
+    {
+        exporter = make_unique<EventExporter>(string(argv[4]));
+        EventExporter::setActive(exporter.get());
+    }
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    signal(SIGPIPE, SIG_IGN);
+
+    // The game classes narrate every action on cout; thousands of hosted games keep it silent
+    streambuf* console = cout.rdbuf(nullptr);
+
+    GameServer server(socketPath, maxSessions);
+    try {
+        server.start();
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    cerr << "Catan server listening on " << socketPath << " (up to " << maxSessions << " games)" << endl;
+
+    while (!stopRequested)
+    {
+        server.runOnce(1000);
+    }
+
+    cout.rdbuf(console);
+    cerr << "Catan server stopped with " << server.getSessionCount() << " games open" << endl;
+    return 0;
+}
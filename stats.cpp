@@ -0,0 +1,276 @@
+// Email: origoldbsc@gmail.com
+
+#include "stats.hpp"
+#include "cards.hpp"
+#include <algorithm>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        thread_local StatBlock* current = nullptr;      // The block of the calling thread
+
+        /**
+         * @brief Calls a function on every pair of matching counters of two sets of fields, arrays included.
+         */
+        template <typename Function, typename First, typename Second>
+        void pairUp(First& first, Second& second, Function& function)
+        {
+            function(first, second);
+        }
+
+        template <typename Function, typename First, typename Second, size_t N>
+        void pairUp(First (&first)[N], Second (&second)[N], Function& function)
+        {
+            for (size_t index = 0; index < N; ++index)
+            {
+                pairUp(first[index], second[index], function);
+            }
+        }
+
+        template <typename First, typename Second, typename Function>
+        void forEachCounter(First& first, Second& second, Function function)
+        {
+            pairUp(first.games, second.games, function);
+            pairUp(first.turns, second.turns, function);
+            pairUp(first.turnHistogram, second.turnHistogram, function);
+            pairUp(first.rolls, second.rolls, function);
+            pairUp(first.tileProduction, second.tileProduction, function);
+            pairUp(first.gained, second.gained, function);
+            pairUp(first.bankTrades, second.bankTrades, function);
+            pairUp(first.playerTrades, second.playerTrades, function);
+            pairUp(first.cardTrades, second.cardTrades, function);
+            pairUp(first.discards, second.discards, function);
+            pairUp(first.discarded, second.discarded, function);
+            pairUp(first.cardsBought, second.cardsBought, function);
+            pairUp(first.cardsUsed, second.cardsUsed, function);
+            pairUp(first.winnerPoints, second.winnerPoints, function);
+        }
+
+        void writeArray(ostream& out, const uint64_t* values, size_t count)
+        {
+            out << '[';
+            for (size_t index = 0; index < count; ++index)
+            {
+                out << (index ? "," : "") << values[index];
+            }
+            out << ']';
+        }
+    }
+
+
+    //-------------------------------------//
+    //             StatTotals              //
+    //-------------------------------------//
+
+    StatTotals::StatTotals() : StatFields<uint64_t>{}
+    {
+    }
+
+
+    double StatTotals::meanTurns() const
+    {
+        return games ? static_cast<double>(turns) / static_cast<double>(games) : 0;
+    }
+
+
+    /**
+     * @brief Writes the totals as one JSON object.
+     */
+    void StatTotals::writeJson(ostream& out) const
+    {
+        static const char* const sources[GAIN_SOURCES] = {"setup", "roll", "bank", "trade", "robber"};
+        static const char* const cards[CARD_TYPES] = {"promotion", "knight", "victoryPoint"};
+        static const char* const points[POINT_SOURCES] = {"settlements", "cities", "cards", "awards"};
+
+        out << "{\"games\":" << games << ",\"turns\":" << turns << ",\"meanTurns\":" << meanTurns() << ",\"turnBucket\":" << TURN_BUCKET << ",\"turnHistogram\":";
+        writeArray(out, turnHistogram, TURN_BUCKETS);
+        out << ",\"rolls\":";
+        writeArray(out, rolls + 2, 11);
+        out << ",\"tileProduction\":";
+        writeArray(out, tileProduction, TILES);
+        out << ",\"gained\":{";
+        for (size_t source = 0; source < GAIN_SOURCES; ++source)
+        {
+            out << (source ? ",\"" : "\"") << sources[source] << "\":";
+            writeArray(out, gained[source], RESOURCE_TYPES);
+        }
+        out << "},\"bankTrades\":" << bankTrades << ",\"playerTrades\":" << playerTrades << ",\"cardTrades\":" << cardTrades
+            << ",\"discards\":" << discards << ",\"discarded\":" << discarded;
+        for (const auto& [name, counts] : {pair<const char*, const uint64_t*>{"cardsBought", cardsBought}, {"cardsUsed", cardsUsed}})
+        {
+            out << ",\"" << name << "\":{";
+            for (size_t type = 0; type < CARD_TYPES; ++type)
+            {
+                out << (type ? ",\"" : "\"") << cards[type] << "\":" << counts[type];
+            }
+            out << '}';
+        }
+        out << ",\"winnerPoints\":{";
+        for (size_t source = 0; source < POINT_SOURCES; ++source)
+        {
+            out << (source ? ",\"" : "\"") << points[source] << "\":" << winnerPoints[source];
+        }
+        out << "}}";
+    }
+
+
+    //-------------------------------------//
+    //              StatBlock              //
+    //-------------------------------------//
+
+    /**
+     * @brief Returns the block of the calling thread, or nullptr when the thread collects no statistics.
+     */
+    StatBlock* StatBlock::local()
+    {
+        return current;
+    }
+
+
+    void StatBlock::rolled(int total)
+    {
+        if (total >= 2 && total <= 12)
+        {
+            rolls[total].add(1);
+        }
+    }
+
+
+    void StatBlock::produced(size_t tile, int amount)
+    {
+        if (tile < TILES && amount > 0)
+        {
+            tileProduction[tile].add(static_cast<uint64_t>(amount));
+        }
+    }
+
+
+    void StatBlock::gain(GainSource source, ResourceType type, int amount)
+    {
+        if (type >= WOOD && type <= ORE && amount > 0)
+        {
+            gained[static_cast<size_t>(source)][type].add(static_cast<uint64_t>(amount));
+        }
+    }
+
+
+    void StatBlock::bankTrade()
+    {
+        bankTrades.add(1);
+    }
+
+
+    void StatBlock::playerTrade()
+    {
+        playerTrades.add(1);
+    }
+
+
+    void StatBlock::cardTrade()
+    {
+        cardTrades.add(1);
+    }
+
+
+    void StatBlock::discard(int amount)
+    {
+        if (amount > 0)
+        {
+            discards.add(1);
+            discarded.add(static_cast<uint64_t>(amount));
+        }
+    }
+
+
+    void StatBlock::cardBought(DevCardType type)
+    {
+        cardsBought[static_cast<size_t>(type)].add(1);
+    }
+
+
+    void StatBlock::cardUsed(DevCardType type)
+    {
+        cardsUsed[static_cast<size_t>(type)].add(1);
+    }
+
+
+    /**
+     * @brief Records a game won after a number of turns, with the winner's points by source.
+     */
+    void StatBlock::gameWon(size_t turnCount, const int points[POINT_SOURCES])
+    {
+        games.add(1);
+        turns.add(turnCount);
+        turnHistogram[min(turnCount / TURN_BUCKET, TURN_BUCKETS - 1)].add(1);
+        for (size_t source = 0; source < POINT_SOURCES; ++source)
+        {
+            winnerPoints[source].add(static_cast<uint64_t>(max(points[source], 0)));
+        }
+    }
+
+
+    //-------------------------------------//
+    //           StatsCollector            //
+    //-------------------------------------//
+
+    /**
+     * @brief Gives the calling thread a new block, where its events are counted from now on.
+     */
+    StatBlock& StatsCollector::attach()
+    {
+        lock_guard<mutex> guard(lock);
+        blocks.push_back(make_unique<StatBlock>());
+        current = blocks.back().get();
+        return *current;
+    }
+
+
+    /**
+     * @brief Stops counting the calling thread's events. Its block is kept.
+     */
+    void StatsCollector::detach()
+    {
+        current = nullptr;
+    }
+
+
+    /**
+     * @brief Adds up every block. Blocks still being written are read counter by counter, so a merge taken while
+     * games are played may split the counters of an event between this merge and the next.
+     */
+    StatTotals StatsCollector::merge() const
+    {
+        StatTotals totals;
+        lock_guard<mutex> guard(lock);
+        for (const unique_ptr<StatBlock>& block : blocks)
+        {
+            forEachCounter(totals, *block, [](uint64_t& total, const StatCounter& counter) { total += counter.get(); });
+        }
+        return totals;
+    }
+
+
+    size_t StatsCollector::getBlockCount() const
+    {
+        lock_guard<mutex> guard(lock);
+        return blocks.size();
+    }
+
+
+    //-------------------------------------//
+    //             StatsScope              //
+    //-------------------------------------//
+
+    StatsScope::StatsScope(StatsCollector& collector)
+    {
+        collector.attach();
+    }
+
+
+    StatsScope::~StatsScope()
+    {
+        StatsCollector::detach();
+    }
+}
@@ -0,0 +1,190 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    enum class DevCardType;
+
+    /**
+     * @brief Where gained resources come from.
+     */
+    enum class GainSource { SETUP, ROLL, BANK, TRADE, ROBBER };
+
+    constexpr size_t GAIN_SOURCES = 5;
+
+
+    /**
+     * @brief Where a winner's victory points come from.
+     */
+    enum class PointSource { SETTLEMENTS, CITIES, CARDS, AWARDS };
+
+    constexpr size_t POINT_SOURCES = 4;
+
+
+    /**
+     * @brief The counters of the statistics, one definition for the per-thread blocks and for their totals.
+     * @tparam Counter StatCounter in the blocks, uint64_t in the totals.
+     */
+    template <typename Counter>
+    struct StatFields
+    {
+        static constexpr size_t TILES = 19;             // Tiles of the standard board, by HexTopology index
+        static constexpr size_t CARD_TYPES = 3;         // DevCardType values
+        static constexpr size_t TURN_BUCKETS = 40;      // Games by turns to victory, TURN_BUCKET turns per bucket
+        static constexpr size_t TURN_BUCKET = 5;        // The last bucket also holds every longer game
+
+        Counter games;                                  // Games won
+        Counter turns;                                  // Turns of the games won, every seat's turn counted
+        Counter turnHistogram[TURN_BUCKETS];
+        Counter rolls[13];                              // Dice sums rolled, by sum
+        Counter tileProduction[TILES];                  // Resources produced by each tile
+        Counter gained[GAIN_SOURCES][RESOURCE_TYPES];   // Resources gained, by source and type
+        Counter bankTrades;
+        Counter playerTrades;                           // Resource trades between players
+        Counter cardTrades;                             // Development card trades between players
+        Counter discards;                               // Seats that discarded after a 7
+        Counter discarded;                              // Resources they discarded
+        Counter cardsBought[CARD_TYPES];                // By DevCardType
+        Counter cardsUsed[CARD_TYPES];
+        Counter winnerPoints[POINT_SOURCES];            // Winners' points, by source
+    };
+
+
+    /**
+     * @brief A counter written by a single thread and read by any. Adding is a plain load and store, not a
+     * read-modify-write, so a counter costs no more than an integer while merges may read it at any time.
+     */
+    class StatCounter
+    {
+        private:
+
+            atomic<uint64_t> value{0};
+
+        public:
+
+            void add(uint64_t amount)
+            {
+                value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+            }
+
+            uint64_t get() const
+            {
+                return value.load(memory_order_relaxed);
+            }
+    };
+
+
+    /**
+     * @brief The merged statistics of every block of a collector.
+     */
+    struct StatTotals : StatFields<uint64_t>
+    {
+        StatTotals();
+
+        double meanTurns() const;           // Turns to victory per game won, 0 without games
+
+        /**
+         * @brief Writes the totals as one JSON object.
+         */
+        void writeJson(ostream& out) const;
+    };
+
+
+    /**
+     * @brief The counters of one thread. The game's events are recorded into the block of the thread they happen on.
+     */
+    class alignas(64) StatBlock : public StatFields<StatCounter>
+    {
+        public:
+
+            /**
+             * @brief Returns the block of the calling thread, or nullptr when the thread collects no statistics.
+             */
+            static StatBlock* local();
+
+            void rolled(int total);
+            void produced(size_t tile, int amount);
+            void gain(GainSource source, ResourceType type, int amount);
+            void bankTrade();
+            void playerTrade();
+            void cardTrade();
+            void discard(int amount);
+            void cardBought(DevCardType type);
+            void cardUsed(DevCardType type);
+
+            /**
+             * @brief Records a game won after a number of turns, with the winner's points by source.
+             */
+            void gameWon(size_t turnCount, const int points[POINT_SOURCES]);
+    };
+
+
+    /**
+     * @brief Collects the statistics of simulations run on any number of threads.
+     *
+     * Each thread attaches its own block and the game's events are counted there, with no lock and no shared
+     * cache line between the threads. The blocks stay with the collector after their threads detach or end, and
+     * merge() adds them up, at the end or on demand while the threads still play. The collector must outlive the
+     * threads' attachments.
+     */
+    class StatsCollector
+    {
+        private:
+
+            mutable mutex lock;                         // Guards the list of blocks, taken to attach and to merge
+            vector<unique_ptr<StatBlock>> blocks;
+
+        public:
+
+            StatsCollector() = default;
+
+            StatsCollector(const StatsCollector&) = delete;
+            StatsCollector& operator=(const StatsCollector&) = delete;
+
+            /**
+             * @brief Gives the calling thread a new block, where its events are counted from now on.
+             */
+            StatBlock& attach();
+
+            /**
+             * @brief Stops counting the calling thread's events. Its block is kept.
+             */
+            static void detach();
+
+            /**
+             * @brief Adds up every block.
+             */
+            StatTotals merge() const;
+
+            size_t getBlockCount() const;
+    };
+
+
+    /**
+     * @brief Attaches the calling thread to a collector for the lifetime of the scope.
+     */
+    class StatsScope
+    {
+        public:
+
+            explicit StatsScope(StatsCollector& collector);
+            ~StatsScope();
+
+            StatsScope(const StatsScope&) = delete;
+            StatsScope& operator=(const StatsScope&) = delete;
+    };
+}
+
+#endif
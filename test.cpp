@@ -4,7 +4,33 @@
 #include "board.hpp"
 #include "player.hpp"
 #include "catan.hpp"
+#include "exporter.hpp"
+#include "server.hpp"
+#include "turnengine.hpp"
+#include "checkpoint.hpp"
+#include "trade.hpp"
+#include "discard.hpp"
+#include "boardgen.hpp"
+#include "topology.hpp"
+#include "bot.hpp"
+#include "opening.hpp"
+#include "winrate.hpp"
+#include "plugin.hpp"
+#include "ladder.hpp"
+#include "endgame.hpp"
+#include "stats.hpp"
+#include "tradevalue.hpp"
+#include "roadplan.hpp"
+#include "perft.hpp"
+#include <cmath>
+#include <csignal>
 #include <sstream>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 using namespace ariel;
 using namespace std;
@@ -111,6 +137,48 @@ TEST_CASE("Test canUpgradeSettlementToCity function") {
     CHECK(!board.canUpgradeSettlementToCity(2, 0));
 }
 
+TEST_CASE("Board checks ownership by seat") {
+    Board board;
+    Edge edge(Intersection::getIntersection(41), Intersection::getIntersection(42));
+    Edge next(Intersection::getIntersection(42), Intersection::getIntersection(43));
+    board.placeInitialSettlement(41, 0);
+    board.placeInitialRoad(edge, 0);
+
+    CHECK(board.canPlaceRoad(next, 0));
+    CHECK_FALSE(board.canPlaceRoad(next, 1));           // Another seat's road does not connect
+    CHECK(board.isIntersectionConnectedToPlayerRoad(42, 0));
+    CHECK_FALSE(board.isIntersectionConnectedToPlayerRoad(42, 1));
+    CHECK(board.canUpgradeSettlementToCity(41, 0));
+    CHECK_FALSE(board.canUpgradeSettlementToCity(41, 1));
+    CHECK_FALSE(board.canPlaceRoad(next, -1));          // Not a seat
+    CHECK_FALSE(board.canPlaceRoad(next, static_cast<int>(MAX_SEATS)));
+
+    board.upgradeSettlementToCity(41, 0);
+    CHECK_FALSE(board.canUpgradeSettlementToCity(41, 0));
+    CHECK(board.getCities().at(41) == 0);
+}
+
+TEST_CASE("Board placement rules count cities and other seats' buildings") {
+    Board board;
+    Edge first(Intersection::getIntersection(41), Intersection::getIntersection(42));
+    Edge second(Intersection::getIntersection(42), Intersection::getIntersection(43));
+    Edge third(Intersection::getIntersection(43), Intersection::getIntersection(44));
+    board.placeInitialSettlement(41, 0);
+    board.placeInitialRoad(first, 0);
+    board.upgradeSettlementToCity(41, 0);
+
+    // No settlement on a city or next to one
+    CHECK_FALSE(board.canPlaceSettlement(41, 0));
+    CHECK_FALSE(board.canPlaceSettlement(42, 0));
+
+    // A road reaches another seat's building but does not continue through it
+    board.placeInitialSettlement(43, 1);
+    CHECK(board.canPlaceRoad(second, 0));
+    board.placeRoad(second, 0);
+    CHECK_FALSE(board.canPlaceRoad(third, 0));
+    CHECK(board.canPlaceRoad(third, 1));
+}
+
 
 /*********************************************/
 ///             TESTS FOR BOARD             ///
@@ -226,6 +294,47 @@ TEST_CASE("Check resource sufficiency for building a road") {
     CHECK(player.canBuild("road"));
 }
 
+TEST_CASE("Affordability of every structure from the resource vector") {
+    Player player("Avi");
+    CHECK(player.affordableStructures() == 0);
+
+    player.addResource(ResourceType::WOOD, 1);
+    player.addResource(ResourceType::BRICK, 1);
+    player.addResource(ResourceType::NONE, 3);         // The desert adds nothing
+    CHECK(player.affordableStructures() == 1u << static_cast<int>(Structure::ROAD));
+    CHECK(player.getResources()[NONE] == 0);
+
+    player.addResource(ResourceType::WOOL, 1);
+    player.addResource(ResourceType::GRAIN, 2);
+    player.addResource(ResourceType::ORE, 3);
+    CHECK(player.canBuild(Structure::SETTLEMENT));
+    CHECK(player.canBuild(Structure::CITY));
+    CHECK(player.canBuild(Structure::DEVELOPMENT_CARD));
+    CHECK(player.affordableStructures() == 0xFu);
+    CHECK(player.countTotalResources() == 8);
+
+    CHECK(canAfford(Player::costOf(Structure::CITY), Player::costOf(Structure::CITY)));
+    CHECK_FALSE(canAfford(Player::costOf(Structure::ROAD), Player::costOf(Structure::SETTLEMENT)));
+    CHECK_THROWS_AS(player.canBuild("castle"), out_of_range);
+
+    // The packed compare agrees with the row by row checks for every hand of 0 to 3 of each resource
+    Player hand("Dana");
+    for (int code = 0; code < 1024; ++code)
+    {
+        unsigned expected = 0;
+        for (int type = WOOD; type <= ORE; ++type)
+        {
+            int count = (code >> (2 * type)) & 3;
+            hand.addResource(static_cast<ResourceType>(type), count - hand.getResourceCount(static_cast<ResourceType>(type)));
+        }
+        for (size_t structure = 0; structure < STRUCTURE_TYPES; ++structure)
+        {
+            expected |= static_cast<unsigned>(hand.canBuild(static_cast<Structure>(structure))) << structure;
+        }
+        CHECK(hand.affordableStructures() == expected);
+    }
+}
+
 TEST_CASE("Build road and check resource decrement") {
     Player player("Avi");
     Board& board = Board::getInstance();
@@ -362,10 +471,26 @@ TEST_CASE("Upgrade settlement to city and verify point increase") {
 }
 
 
-TEST_CASE("Player initialization assigns unique ID") {
-    Player player1("Eli");
-    Player player2("Dean");
+TEST_CASE("Player registry assigns dense seats") {
+    Player player1("Eli"), player2("Dean"), player3("Noa");
+    PlayerRegistry registry;
+    CHECK(registry.add(player2) == 0);
+    CHECK(registry.add(player1) == 1);
+    CHECK(registry.add(player2) == 0);      // Already seated
     CHECK(player1.getId() != player2.getId());
+    CHECK(player2.getId() == 0);
+    CHECK(registry.at(1) == &player1);
+    CHECK(registry.at(2) == nullptr);
+
+    vector<unique_ptr<Player>> guests;
+    while (registry.size() < MAX_SEATS) {
+        guests.push_back(make_unique<Player>("Guest"));
+        registry.add(*guests.back());
+    }
+    CHECK(guests.back()->getId() == static_cast<int>(MAX_SEATS) - 1);
+    CHECK_THROWS_AS(registry.add(player3), length_error);
+    CHECK_FALSE(PlayerRegistry::isSeat(-1));
+    CHECK_FALSE(PlayerRegistry::isSeat(static_cast<int>(MAX_SEATS)));
 }
 
 
@@ -439,6 +564,12 @@ TEST_CASE("Trading resources between players") {
 TEST_CASE("Player loses Largest Army card to someone else") {
     Player adi("Adi"), bil("Bil");
     vector<Player*> players = {&adi, &bil};
+    PlayerRegistry registry;
+    registry.add(adi);
+    registry.add(bil);
+    AwardTracker awards;
+    awards.enroll(adi);
+    awards.enroll(bil);
 
     // Adi buys 3 Knight cards
     adi.addResource(ResourceType::ORE, 3);
@@ -453,13 +584,10 @@ TEST_CASE("Player loses Largest Army card to someone else") {
         CHECK(adi.buyDevelopmentCardTEST(DevCardType::KNIGHT, players) == CardPurchaseError::Success);
     }
 
-    Player::largestArmyHolder = &adi;  // Assume Adi initially has the largest army
-    adi.addPoints(2);  // Assume she has 2 points for holding the largest army
-
     // Ensure Adi now has the Largest Army
     CHECK(adi.getDevelopmentCards().at(DevCardType::KNIGHT) == 3);
-    CHECK(Player::largestArmyHolder == &adi);
-    CHECK(adi.getPoints() == 4); // Points for largest army (2+2)
+    CHECK(adi.holdsAward(Award::LARGEST_ARMY));
+    CHECK(adi.getPoints() == 2); // Points for largest army
 
 
     bil.addResource(ResourceType::ORE, 6);
@@ -471,11 +599,11 @@ TEST_CASE("Player loses Largest Army card to someone else") {
         CHECK(bil.buyDevelopmentCardTEST(DevCardType::KNIGHT, players) == CardPurchaseError::Success);
     }
 
-    adi.checkForLargestArmy(players);
-
-    // Verify that Adi no longer holds the largest army if another player meets the criteria
-    CHECK(Player::largestArmyHolder != &adi);
-    CHECK(adi.getPoints() == 2); // Points lost due to losing largest army
+    // Verify that Adi no longer holds the largest army once Bil has more knights
+    CHECK_FALSE(adi.holdsAward(Award::LARGEST_ARMY));
+    CHECK(bil.holdsAward(Award::LARGEST_ARMY));
+    CHECK(adi.getPoints() == 0); // Points lost due to losing largest army
+    CHECK(bil.getPoints() == 2);
 }
 
 
@@ -609,6 +737,58 @@ TEST_CASE("No player has reached 10 points yet") {
 }
 
 
+TEST_CASE("Each game buys development cards from its own deck") {
+    Board board, otherBoard;
+    Player p1("Ella"), p2("Omer"), p3("Nir"), q1("Ella"), q2("Omer"), q3("Nir");
+    Catan game(p1, p2, p3, board);
+    Catan other(q1, q2, q3, otherBoard);
+    game.testInitialize();
+    other.testInitialize();
+    vector<Player*>& players = game.getPlayers();
+
+    // Buying the last knight of one game leaves the other game's stock alone
+    game.getDeck().setStock(0, 1);
+    p1.addResource(ResourceType::WOOL, 2);
+    p1.addResource(ResourceType::GRAIN, 2);
+    p1.addResource(ResourceType::ORE, 2);
+    CHECK(p1.buyDevelopmentCardTEST(DevCardType::KNIGHT, players) == CardPurchaseError::Success);
+    CHECK(game.getDeck().getQuantity(DevCardType::KNIGHT) == 0);
+    CHECK(p1.buyDevelopmentCardTEST(DevCardType::KNIGHT, players) == CardPurchaseError::CardUnavailable);
+    CHECK(other.getDeck().getQuantity(DevCardType::KNIGHT) == DevelopmentDeck::FULL[0]);
+
+    // Restoring a checkpoint into one game does not touch the other's deck
+    CheckpointData data;
+    GameCheckpoint::capture(other, data);
+    GameCheckpoint::restore(game, data);
+    CHECK(game.getDeck().getQuantity(DevCardType::KNIGHT) == DevelopmentDeck::FULL[0]);
+    other.getDeck().draw(DevCardType::PROMOTION);
+    GameCheckpoint::restore(game, data);
+    CHECK(other.getDeck().getQuantity(PromotionType::MONOPOLY) == DevelopmentDeck::FULL[2] - 1);
+    CHECK(game.getDeck().getQuantity(PromotionType::MONOPOLY) == DevelopmentDeck::FULL[2]);
+}
+
+
+TEST_CASE("Games seat 3 to 6 players") {
+    Board board;
+    Player p1("Ami"), p2("Avi"), p3("Ali"), p4("Ori");
+    Catan game(array<Player*, 4>{&p1, &p2, &p3, &p4}, board);
+    CHECK(game.getRegistry().size() == 4);
+    CHECK(p4.getId() == 3);
+    CHECK_FALSE(game.hasSpecialBuildPhase());
+
+    game.initializeGame();
+    for (Player* player : game.getPlayers()) {
+        CHECK(player->getSettlements().size() == 2);
+        CHECK(player->getPoints() == 2);
+        CHECK(player->countTotalResources() > 0);
+    }
+
+    Board otherBoard;
+    Player q1("Ami"), q2("Avi");
+    CHECK_THROWS_AS(Catan(vector<Player*>{&q1, &q2}, otherBoard), invalid_argument);
+}
+
+
 /*********************************************/
 ///             TESTS FOR CARDS             ///
 /*********************************************/
@@ -903,4 +1083,2104 @@ TEST_CASE("Vertex Output Stream Operator") {
     stringstream ss2;
     ss2 << v2;
     CHECK(ss2.str() == "(-1, -2)");
-}
\ No newline at end of file
+}
+
+/*********************************************/
+///           TESTS FOR EXPORTER            ///
+/*********************************************/
+
+TEST_CASE("Exporter writes one NDJSON line per placement") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    Board& board = Board::getInstance();
+    board.resetBoard();
+    {
+        EventExporter exporter(fds[1]);
+        EventExporter::setActive(&exporter);
+        board.placeInitialSettlement(41, 2);
+        board.placeInitialRoad(Edge{Intersection::getIntersection(41), Intersection::getIntersection(42)}, 2);
+        board.upgradeSettlementToCity(41, 2);
+        CHECK(exporter.getEventCount() == 3);
+    }   // The destructor flushes and detaches the exporter
+    CHECK(EventExporter::getActive() == nullptr);
+
+    char text[512] = {0};
+    ssize_t size = read(fds[0], text, sizeof(text) - 1);
+    close(fds[0]);
+    close(fds[1]);
+    REQUIRE(size > 0);
+    CHECK(string(text) == "{\"seq\":0,\"ev\":\"settlement\",\"p\":2,\"i\":41,\"init\":1}\n"
+                          "{\"seq\":1,\"ev\":\"road\",\"p\":2,\"a\":41,\"b\":42,\"init\":1}\n"
+                          "{\"seq\":2,\"ev\":\"city\",\"p\":2,\"i\":41}\n");
+    board.resetBoard();
+}
+
+TEST_CASE("Exporter formats negative deltas, trades and escaped names") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    {
+        EventExporter exporter(fds[1]);
+        const int give[5] = {3, 0, 0, 0, 0};
+        const int get[5] = {0, 0, 0, 0, 3};
+        exporter.resourceDelta(2, ResourceType::ORE, -12, "discard");
+        exporter.resourceTrade(1, 2, give, get);
+        exporter.cardEvent(1, "buy", "Say \"hi\"");
+    }
+    char text[512] = {0};
+    ssize_t size = read(fds[0], text, sizeof(text) - 1);
+    close(fds[0]);
+    close(fds[1]);
+    REQUIRE(size > 0);
+    CHECK(string(text) == "{\"seq\":0,\"ev\":\"res\",\"p\":2,\"r\":\"ORE\",\"d\":-12,\"src\":\"discard\"}\n"
+                          "{\"seq\":1,\"ev\":\"trade\",\"from\":1,\"to\":2,\"give\":[3,0,0,0,0],\"get\":[0,0,0,0,3]}\n"
+                          "{\"seq\":2,\"ev\":\"card\",\"p\":1,\"act\":\"buy\",\"card\":\"Say \\\"hi\\\"\"}\n");
+}
+
+TEST_CASE("Exporter tags the game of every line and flushes when a turn passes") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setDice([] { return 4; });          // Every roll is an 8
+    engine.start();
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    {
+        EventExporter exporter(fds[1]);
+        EventExporter::setActive(&exporter);
+        exporter.setGame(7);
+        string event;
+        REQUIRE(engine.submit(0, "roll", event) == "ok 8");
+        REQUIRE(engine.submit(0, "end", event) == "ok");
+
+        // The lines of the turn are readable while the exporter is still open
+        char text[4096] = {0};
+        ssize_t size = read(fds[0], text, sizeof(text) - 1);
+        REQUIRE(size > 0);
+        CHECK(string(text).rfind("{\"seq\":0,\"g\":7,\"ev\":\"roll\",", 0) == 0);
+        CHECK(text[size - 1] == '\n');
+        EventExporter::setActive(nullptr);
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE("Exporter detaches when the reader of its pipe exits") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    close(fds[0]);
+    void (*previous)(int) = signal(SIGPIPE, SIG_IGN);
+    {
+        EventExporter exporter(fds[1]);
+        EventExporter::setActive(&exporter);
+        exporter.diceRolled(1, 8);
+        exporter.flush();                           // EPIPE instead of SIGPIPE
+        CHECK(EventExporter::getActive() == nullptr);
+        exporter.diceRolled(1, 6);
+        CHECK_NOTHROW(exporter.flush());            // Detached: nothing is written any more
+    }
+    signal(SIGPIPE, previous);
+    close(fds[1]);
+}
+
+
+/*********************************************/
+///             TESTS FOR ROBBER            ///
+/*********************************************/
+
+TEST_CASE("The robber blocks the production of its tile") {
+    Board board;
+    Player p1("Amit"), p2("Yossi");
+    vector<Player*> players = {&p1, &p2};
+    p1.placeInitialSettlement(41, board);           // On the Ore(3) tile at (-1,-1)
+    CHECK(board.getRobberPosition() == make_pair(0, 0));
+    CHECK(board.getBlockedTiles() == 0);
+
+    board.distributeResourcesBasedOnDiceRoll(3, players);
+    CHECK(p1.getResourceCount(ResourceType::ORE) == 1);
+
+    CHECK(board.moveRobber({-1, -1}));
+    CHECK_FALSE(board.moveRobber({-1, -1}));        // Must move to another tile
+    CHECK_FALSE(board.moveRobber({5, 5}));
+    CHECK(board.getBlockedTiles() != 0);
+    board.distributeResourcesBasedOnDiceRoll(3, players);
+    CHECK(p1.getResourceCount(ResourceType::ORE) == 1);
+
+    board.resetBoard();
+    CHECK(board.getRobberPosition() == make_pair(0, 0));
+}
+
+TEST_CASE("Moving the robber steals from a player on the tile") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    vector<Player*> players = {&p1, &p2, &p3};
+    PlayerRegistry registry;
+    for (Player* player : players) {
+        registry.add(*player);
+    }
+    p2.placeInitialSettlement(43, board);           // On the Ore(3) tile at (-1,-1)
+    p2.addResource(ResourceType::BRICK, 1);
+    p3.addResource(ResourceType::WOOD, 4);
+
+    CHECK(board.getPlayersAroundTile(board.suggestRobberPosition(p1.getId())).count(p2.getId()) == 1);
+    CHECK(board.getPlayersAroundTile(board.suggestRobberPosition(p2.getId())).count(p2.getId()) == 0);
+    CHECK(board.getPlayersAroundTile({-1, -1}) == set<int>{p2.getId()});
+    CHECK_FALSE(p1.placeRobber({-1, -1}, players, board, &p3));       // Dana has nothing there
+    CHECK(p1.placeRobber({-1, -1}, players, board));
+    CHECK(p1.getResourceCount(ResourceType::BRICK) == 1);
+    CHECK(p2.countTotalResources() == 0);
+    CHECK(p1.stealRandomResource(p2) == NONE);
+
+    // The stolen card comes from the given draw, counting the victim's cards in resource order
+    p3.addResource(ResourceType::ORE, 2);
+    CHECK(p1.stealRandomResource(p3, [](int count) { return count - 1; }) == ResourceType::ORE);
+    CHECK(p1.stealRandomResource(p3, [](int) { return 0; }) == ResourceType::WOOD);
+    CHECK(p3.getResourceCount(ResourceType::WOOD) == 3);
+    CHECK(p3.getResourceCount(ResourceType::ORE) == 1);
+    CHECK_THROWS_AS(p1.stealRandomResource(p3, [](int count) { return count; }), out_of_range);
+    CHECK(p3.countTotalResources() == 4);
+    for (int i = 0; i < 100; ++i) {
+        int card = Player::drawCard(4);
+        REQUIRE((card >= 0 && card < 4));
+    }
+}
+
+TEST_CASE("TurnEngine plays a Knight before rolling") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.start();
+
+    string event;
+    Player* first = game.getPlayers()[0];
+    CHECK(engine.submit(0, "use knight", event) == "err not enough cards");
+    first->setDevelopmentCardCount(DevCardType::KNIGHT, 1);
+    CHECK(engine.submit(0, "use knight 9 9", event) == "err invalid robber move");
+    CHECK(engine.submit(0, "use knight 2 2", event) == "ok");
+    CHECK(event == "event robber 2 2");
+    CHECK(board.getRobberPosition() == make_pair(2, 2));
+    CHECK(first->getDevelopmentCards().at(DevCardType::KNIGHT) == 0);
+    CHECK(engine.getPhase() == TurnPhase::PreRoll);     // The turn goes on
+}
+
+
+/*********************************************/
+///        TESTS FOR DISCARD POLICIES       ///
+/*********************************************/
+
+TEST_CASE("Discard policies choose legal discards") {
+    ResourceVector hand = {5, 1, 0, 2, 1, 0, 0, 0};     // 9 resources, 4 to discard
+    ResourceVector discard;
+
+    KeepBalancedPolicy balanced;
+    balanced.choose(hand, 4, discard);
+    CHECK(discard[WOOD] >= 3);                          // Wood comes down to the grain pile, then one of them
+    CHECK(discard[WOOD] + discard[GRAIN] == 4);
+    CHECK(totalResources(discard) == 4);
+    balanced.choose(ResourceVector{2, 2, 2, 2, 0, 0, 0, 0}, 4, discard);
+    CHECK(discard[WOOD] == 1);
+    CHECK(discard[ORE] == 0);
+    CHECK(totalResources(discard) == 4);
+
+    // 2 grain and 3 ore are a city; everything else goes
+    KeepClosestBuildPolicy closestBuild;
+    closestBuild.choose(ResourceVector{3, 2, 1, 2, 3, 0, 0, 0}, 5, discard);
+    CHECK(discard[GRAIN] == 0);
+    CHECK(discard[ORE] == 0);
+    CHECK(totalResources(discard) == 5);
+
+    // The most produced resource goes first and the rarest is kept
+    Board board;
+    KeepRarestPolicy rarest(board);
+    ResourceVector production;
+    board.getProductionWeights(production);
+    rarest.choose(ResourceVector{2, 2, 2, 2, 2, 0, 0, 0}, 5, discard);
+    CHECK(totalResources(discard) == 5);
+    int mostProduced = WOOD, leastProduced = WOOD;
+    for (int type = WOOD; type <= ORE; ++type)
+    {
+        CHECK(discard[type] <= 2);
+        mostProduced = production[type] > production[mostProduced] ? type : mostProduced;
+        leastProduced = production[type] < production[leastProduced] ? type : leastProduced;
+    }
+    CHECK(discard[mostProduced] == 2);
+    CHECK(discard[leastProduced] == 0);
+
+    CHECK(DiscardPolicy::byName("build") != nullptr);
+    CHECK(DiscardPolicy::byName("chaos") == nullptr);
+    CHECK(DiscardPolicy::byName("rarest") == nullptr);         // Needs the board
+    const DiscardPolicy* named = DiscardPolicy::byName("rarest", board);
+    REQUIRE(named != nullptr);
+    CHECK(named->getName() == "rarest");
+    ResourceVector again;
+    named->choose(ResourceVector{2, 2, 2, 2, 2, 0, 0, 0}, 5, again);
+    for (int type = WOOD; type <= ORE; ++type)
+    {
+        CHECK(again[type] == discard[type]);
+    }
+    CHECK(DiscardPolicy::byName("build", board) == DiscardPolicy::byName("build"));
+}
+
+TEST_CASE("Player discards with a policy without prompting") {
+    Player player("Amit");
+    player.addResource(ResourceType::WOOD, 6);
+    player.addResource(ResourceType::ORE, 2);
+    player.discardResources(4, KeepBalancedPolicy());
+    CHECK(player.getResourceCount(ResourceType::WOOD) == 2);
+    CHECK(player.getResourceCount(ResourceType::ORE) == 2);
+}
+
+
+/*********************************************/
+///             TESTS FOR AWARDS            ///
+/*********************************************/
+
+TEST_CASE("Award tracker moves the Largest Army") {
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    PlayerRegistry registry;
+    registry.add(p1);
+    registry.add(p2);
+    registry.add(p3);
+    AwardTracker awards;
+    size_t s1 = awards.enroll(p1), s2 = awards.enroll(p2), s3 = awards.enroll(p3);
+    CHECK(awards.enroll(p2) == s2);     // Enrolling twice keeps the slot
+    CHECK(awards.size() == 3);
+
+    awards.countKnights(s1, 2);
+    CHECK(awards.getHolder(Award::LARGEST_ARMY) == -1);     // Below the minimum
+    awards.countKnights(s1);
+    CHECK(awards.getHolderPlayer(Award::LARGEST_ARMY) == &p1);
+    CHECK(p1.getPoints() == AwardTracker::AWARD_POINTS);
+
+    awards.countKnights(s2, 3);
+    CHECK(p1.holdsAward(Award::LARGEST_ARMY));              // A tie keeps the holder
+    awards.countKnights(s2);
+    CHECK(p2.holdsAward(Award::LARGEST_ARMY));
+    CHECK(p1.getPoints() == 0);
+    CHECK(p2.getPoints() == AwardTracker::AWARD_POINTS);
+
+    // The holder losing knights passes the award on, or gives it up when nobody qualifies
+    awards.countKnights(s3, 5);
+    awards.countKnights(s3, -3);
+    CHECK(awards.getKnights(s3) == 2);
+    CHECK(p2.holdsAward(Award::LARGEST_ARMY));
+    awards.countKnights(s2, -2);
+    CHECK(p1.holdsAward(Award::LARGEST_ARMY));
+    awards.countKnights(s1, -3);
+    CHECK(awards.getHolder(Award::LARGEST_ARMY) == -1);
+    CHECK(p1.getPoints() + p2.getPoints() + p3.getPoints() == 0);
+}
+
+TEST_CASE("Each game keeps its own Largest Army") {
+    Player p1("Amit"), p2("Yossi"), p3("Dana"), q1("Amit"), q2("Yossi"), q3("Dana");
+    Board board, otherBoard;
+    Catan game(p1, p2, p3, board);
+    Catan other(q1, q2, q3, otherBoard);
+
+    p1.countKnights(3);
+    q2.countKnights(3);
+    CHECK(game.getAwards().getHolderPlayer(Award::LARGEST_ARMY) == &p1);
+    CHECK(other.getAwards().getHolderPlayer(Award::LARGEST_ARMY) == &q2);
+    CHECK(p1.getPoints() == 2);
+    CHECK(q1.getPoints() == 0);
+    CHECK(p1.getAwardTracker() == &game.getAwards());
+}
+
+TEST_CASE("Players leave the award tracker with their game") {
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    {
+        Board board;
+        Catan game(p1, p2, p3, board);
+        p1.countKnights(3);
+        CHECK(p1.getPoints() == 2);
+    }
+    CHECK(p1.getAwardTracker() == nullptr);
+    CHECK(p1.getPoints() == 0);
+    p1.countKnights(1);                 // Not counted outside a game
+    CHECK_FALSE(p1.holdsAward(Award::LARGEST_ARMY));
+}
+
+
+/*********************************************/
+///         TESTS FOR BOARD GENERATOR       ///
+/*********************************************/
+
+TEST_CASE("Generated boards are legal and repeat for a seed") {
+    BoardGenerator generator(42), again(42);
+    BoardLayout layout, copy;
+    for (int board = 0; board < 1000; ++board)
+    {
+        generator.generate(layout);
+        again.generate(copy);
+        REQUIRE(layout.isLegal());
+        CHECK(equal(begin(layout.resources), end(layout.resources), begin(copy.resources)));
+        CHECK(equal(begin(layout.numbers), end(layout.numbers), begin(copy.numbers)));
+    }
+
+    // A 6 next to an 8 is not legal
+    Board board;
+    board.getLayout(layout);
+    CHECK(layout.isLegal());
+    CHECK((BoardLayout::neighbors(4) & (1u << 5)) != 0);     // (0,1) touches (1,1)
+    swap(layout.numbers[5], layout.numbers[11]);        // The 8 of (2,0) to (1,1), next to the 6 of (0,1)
+    CHECK_FALSE(layout.isLegal());
+}
+
+TEST_CASE("Boards are scored for fairness") {
+    Board board;
+    BoardLayout layout;
+    board.getLayout(layout);
+    BoardScore beginner = BoardGenerator::score(layout);
+    CHECK(beginner.clusteredPairs == 5);
+    CHECK(beginner.maxIntersectionPips == 11);
+    CHECK(beginner.total == doctest::Approx(beginner.pipImbalance + 5));
+
+    // Swapping the ore of (-1,-1) and the wood of (1,0) puts the ore next to ore and the wood next to two woods
+    BoardLayout clustered = layout;
+    swap(clustered.resources[13], clustered.resources[10]);
+    CHECK(BoardGenerator::score(clustered).clusteredPairs == beginner.clusteredPairs + 3);
+
+    // Applying a layout replaces the tiles and puts the robber on the new desert
+    BoardGenerator generator(7);
+    generator.generate(layout);
+    board.applyLayout(layout);
+    BoardLayout applied;
+    board.getLayout(applied);
+    CHECK(equal(begin(layout.resources), end(layout.resources), begin(applied.resources)));
+    CHECK(equal(begin(layout.numbers), end(layout.numbers), begin(applied.numbers)));
+    size_t desert = static_cast<size_t>(find(begin(layout.resources), end(layout.resources), NONE) - begin(layout.resources));
+    CHECK(board.getRobberPosition() == BoardLayout::POSITIONS[desert]);
+    CHECK(board.getTilesAroundIntersection(1).size() == 1);
+}
+
+TEST_CASE("Balanced boards are found by rejection sampling") {
+    BoardGenerator::Sample sample = BoardGenerator::findBalanced(3, 8.0, 4, 1000000);
+    REQUIRE(sample.found);
+    CHECK(sample.score.total <= 8.0);
+    CHECK(sample.layout.isLegal());
+    CHECK(BoardGenerator::score(sample.layout).total == doctest::Approx(sample.score.total));
+    CHECK(sample.generated >= 1);
+
+    // A single thread always finds the same board for a seed
+    BoardGenerator::Sample first = BoardGenerator::findBalanced(3, 8.0, 1, 1000000);
+    BoardGenerator::Sample second = BoardGenerator::findBalanced(3, 8.0, 1, 1000000);
+    CHECK(first.generated == second.generated);
+    CHECK(equal(begin(first.layout.numbers), end(first.layout.numbers), begin(second.layout.numbers)));
+
+    // No board scores below 0, so the whole budget is spent
+    BoardGenerator::Sample none = BoardGenerator::findBalanced(3, -1.0, 3, 1000);
+    CHECK_FALSE(none.found);
+    CHECK(none.generated == 1000);
+}
+
+
+/*********************************************/
+///            TESTS FOR TOPOLOGY           ///
+/*********************************************/
+
+TEST_CASE("Topology of the standard board matches its intersection IDs") {
+    const HexTopology& topology = HexTopology::standard();
+    CHECK(topology.tileCount() == 19);
+    CHECK(topology.intersectionCount() == 54);
+    CHECK(topology.edgeCount() == 72);
+
+    CHECK(topology.neighbors(1) == array<int, 3>{2, 9, 0});
+    CHECK(topology.neighbors(10) == array<int, 3>{9, 11, 20});
+    CHECK(topology.neighbors(54) == array<int, 3>{46, 53, 0});
+    CHECK(topology.tileCorners(static_cast<size_t>(topology.tileIndex({0, 0}))) == array<int, 6>{22, 23, 34, 33, 32, 21});
+    CHECK(topology.tileIndex({3, 0}) == HexTopology::NO_INDEX);
+
+    int coastal = 0;
+    Board board;
+    for (int id = 1; id <= 54; ++id)
+    {
+        coastal += topology.isCoastal(id);
+        CHECK(board.getTilesAroundIntersection(id).size() == static_cast<size_t>(3 - count(topology.intersectionTiles(id).begin(), topology.intersectionTiles(id).end(), HexTopology::NO_INDEX)));
+    }
+    CHECK(coastal == 30);
+    CHECK(topology.edgeIndex(1, 2) != HexTopology::NO_INDEX);
+    CHECK(topology.edgeIndex(2, 1) == topology.edgeIndex(1, 2));
+    CHECK(topology.edgeIndex(1, 3) == HexTopology::NO_INDEX);
+    CHECK(board.areIntersectionsAdjacent(10, 20));
+}
+
+TEST_CASE("Topology is derived for maps of any shape") {
+    // A hexagonal island of radius r has 6(r+1)^2 intersections and 9r^2+15r+6 edges
+    HexTopology large(HexTopology::hexagon(5));
+    CHECK(large.tileCount() == 91);
+    CHECK(large.intersectionCount() == 216);
+    CHECK(large.edgeCount() == 306);
+    for (size_t index = 0; index < large.edgeCount(); ++index)
+    {
+        auto [a, b] = large.edge(index);
+        REQUIRE(a < b);
+        CHECK(large.edgeIndex(a, b) == static_cast<int>(index));
+        CHECK(find(large.neighbors(b).begin(), large.neighbors(b).end(), a) != large.neighbors(b).end());
+    }
+    for (int id = 1; id <= static_cast<int>(large.intersectionCount()); ++id)
+    {
+        CHECK(large.degree(id) >= 2);
+        CHECK(large.intersectionTiles(id)[0] != HexTopology::NO_INDEX);
+    }
+
+    // Two tiles side by side share two intersections and one edge
+    HexTopology pair({{0, 0}, {1, 0}});
+    CHECK(pair.intersectionCount() == 10);
+    CHECK(pair.edgeCount() == 11);
+    set<int> left(pair.tileCorners(0).begin(), pair.tileCorners(0).end());
+    int shared = 0;
+    for (int id : pair.tileCorners(1))
+    {
+        shared += static_cast<int>(left.count(id));
+    }
+    CHECK(shared == 2);
+
+    CHECK_THROWS_AS(HexTopology({}), invalid_argument);
+    CHECK_THROWS_AS(HexTopology({{0, 0}, {1, 1}, {0, 0}}), invalid_argument);
+}
+
+
+/*********************************************/
+///       TESTS FOR OPENING OPTIMIZER       ///
+/*********************************************/
+
+TEST_CASE("Opening plans are legal and do not depend on the threads") {
+    Board board;
+    BoardGenerator generator(11);
+    BoardLayout layout;
+    generator.generate(layout);
+    board.applyLayout(layout);
+
+    OpeningOptimizer optimizer(board, 1);
+    OpeningOptimizer parallel(board, 4);
+    CHECK(parallel.getThreads() == 4);
+    const HexTopology& topology = HexTopology::standard();
+    for (size_t seats : {size_t(3), size_t(4), size_t(6)})
+    {
+        OpeningPlan plan = optimizer.optimize(seats);
+        OpeningPlan again = parallel.optimize(seats);
+        CHECK(optimizer.getPlayouts() > 0);
+        CHECK(optimizer.getCandidates() >= optimizer.getPlayouts());
+        CHECK(parallel.getPlayouts() == optimizer.getPlayouts());
+        REQUIRE(plan.seats == seats);
+
+        vector<int> placed;
+        for (size_t seat = 0; seat < seats; ++seat)
+        {
+            CHECK(plan.scores[seat] == doctest::Approx(optimizer.pairScore(plan.settlements[seat][0], plan.settlements[seat][1])));
+            for (size_t index = 0; index < 2; ++index)
+            {
+                int settlement = plan.settlements[seat][index];
+                CHECK(settlement == again.settlements[seat][index]);
+                CHECK(plan.roads[seat][index][1] == again.roads[seat][index][1]);
+                CHECK(plan.roads[seat][index][0] == settlement);
+                CHECK(topology.edgeIndex(plan.roads[seat][index][0], plan.roads[seat][index][1]) != HexTopology::NO_INDEX);
+                for (int other : placed)
+                {
+                    CHECK(other != settlement);
+                    CHECK(topology.edgeIndex(other, settlement) == HexTopology::NO_INDEX);     // Distance rule
+                }
+                placed.push_back(settlement);
+            }
+        }
+    }
+    CHECK_THROWS_AS(optimizer.optimize(2), invalid_argument);
+    CHECK_THROWS_AS(optimizer.optimize(7), invalid_argument);
+}
+
+TEST_CASE("Opening search plays out one of each set of symmetric candidates") {
+    // Every ring of tiles alike: all 6 turns and 6 reflections keep the board
+    BoardLayout layout;
+    for (size_t tile = 0; tile < BOARD_TILES; ++tile)
+    {
+        auto [x, y] = BoardLayout::POSITIONS[tile];
+        int ring = max({abs(x), abs(y), abs(x - y)});
+        layout.resources[tile] = ring == 0 ? ResourceType::NONE : ring == 1 ? ResourceType::WOOD : ResourceType::GRAIN;
+        layout.numbers[tile] = static_cast<int8_t>(ring == 0 ? 0 : ring == 1 ? 6 : 8);
+    }
+    Board symmetric;
+    symmetric.applyLayout(layout);
+    OpeningOptimizer optimizer(symmetric, 2);
+    CHECK(optimizer.getSymmetries() == 12);
+
+    // The spots and roads a turn or reflection of the settlements placed so far maps to a lower ID are skipped
+    OpeningPlan plan = optimizer.optimize(3);
+    CHECK(optimizer.getSymmetricCandidates() > 0);
+    CHECK(optimizer.getCandidates() > 0);
+    const HexTopology& topology = HexTopology::standard();
+    for (size_t seat = 0; seat < 3; ++seat)
+    {
+        for (size_t index = 0; index < 2; ++index)
+        {
+            CHECK(topology.edgeIndex(plan.roads[seat][index][0], plan.roads[seat][index][1]) != HexTopology::NO_INDEX);
+        }
+    }
+
+    // A generated board is kept by the identity alone
+    Board board;
+    BoardGenerator generator(11);
+    generator.generate(layout);
+    board.applyLayout(layout);
+    OpeningOptimizer plain(board);
+    CHECK(plain.getSymmetries() == 1);
+    plain.optimize(3);
+    CHECK(plain.getSymmetricCandidates() == 0);
+}
+
+TEST_CASE("Games start from an opening plan on the board's own tiles") {
+    Board board;
+    BoardGenerator generator(5);
+    BoardLayout layout;
+    generator.generate(layout);
+    board.applyLayout(layout);
+
+    Player p1("Blue"), p2("Red"), p3("Green"), p4("Orange");
+    Catan game(array<Player*, 4>{&p1, &p2, &p3, &p4}, board);
+    OpeningPlan plan = OpeningOptimizer(board).optimize(4);
+    CHECK_THROWS_AS(game.initializeGame(OpeningOptimizer(board).optimize(3)), invalid_argument);
+    game.initializeGame(plan);
+
+    BoardLayout kept;
+    board.getLayout(kept);
+    CHECK(equal(begin(layout.numbers), end(layout.numbers), begin(kept.numbers)));
+    for (Player* player : {&p1, &p2, &p3, &p4})
+    {
+        size_t seat = static_cast<size_t>(player->getId());
+        CHECK(player->getSettlements() == set<int>{plan.settlements[seat][0], plan.settlements[seat][1]});
+        CHECK(player->getRoads().size() == 2);
+    }
+}
+
+
+/*********************************************/
+///             TESTS FOR HARBORS           ///
+/*********************************************/
+
+TEST_CASE("Harbors lower the bank rates of the settling player") {
+    Board board;
+    Player player("Amit");
+    CHECK(Board::harborAt(41) == 0);
+    CHECK(Board::harborAt(4) == (1u << WOOL));
+    CHECK(Board::harborAt(38) == GENERIC_HARBOR);
+    CHECK(player.getBankRate(ResourceType::WOOD) == 4);
+
+    player.placeInitialSettlement(5, board);        // 2:1 wool harbor
+    CHECK(player.getBankRate(ResourceType::WOOL) == 2);
+    CHECK(player.getBankRate(ResourceType::ORE) == 4);
+    player.placeInitialSettlement(1, board);        // 3:1 harbor
+    CHECK(player.getHarbors() == ((1u << WOOL) | GENERIC_HARBOR));
+    CHECK(player.getBankRate(ResourceType::WOOL) == 2);
+    CHECK(player.getBankRate(ResourceType::ORE) == 3);
+
+    player.addResource(ResourceType::WOOL, 5);
+    CHECK(player.tradeWithBank(ResourceType::WOOL, ResourceType::ORE, 2));
+    CHECK(player.getResourceCount(ResourceType::WOOL) == 1);
+    CHECK(player.getResourceCount(ResourceType::ORE) == 2);
+    CHECK_FALSE(player.tradeWithBank(ResourceType::WOOL, ResourceType::ORE));
+    CHECK_FALSE(player.tradeWithBank(ResourceType::ORE, ResourceType::ORE));
+
+    // A count whose price overflows an int is refused and leaves the hand alone
+    CHECK_FALSE(player.tradeWithBank(ResourceType::WOOL, ResourceType::ORE, 1000000000));
+    CHECK_FALSE(player.tradeWithBank(ResourceType::WOOL, ResourceType::ORE, numeric_limits<int>::max()));
+    CHECK(player.getResourceCount(ResourceType::WOOL) == 1);
+    CHECK(player.getResourceCount(ResourceType::ORE) == 2);
+    CHECK(resourceTypeFromString("Grain") == GRAIN);
+    CHECK(resourceTypeFromString("gold") == NONE);
+}
+
+
+/*********************************************/
+///           TESTS FOR TRADE BOOK          ///
+/*********************************************/
+
+TEST_CASE("TradeBook matches compatible offers and executes them in one batch") {
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    vector<Player*> players = {&p1, &p2, &p3};
+    p1.addResource(ResourceType::WOOD, 3);
+    p2.addResource(ResourceType::ORE, 2);
+    p3.addResource(ResourceType::GRAIN, 1);
+
+    TradeBook book;
+    CHECK_THROWS_AS(book.post(0, ResourceVector{-1, 0, 0, 0, 0}, ResourceVector{0, 0, 0, 0, 1}), invalid_argument);
+    CHECK_THROWS_AS(book.post(0, ResourceVector{1, 0, 0, 0, 0}, ResourceVector{}), invalid_argument);
+
+    int woodForOre = book.post(0, ResourceVector{3, 0, 0, 0, 0}, ResourceVector{0, 0, 0, 0, 1});
+    int reserved = book.post(2, ResourceVector{0, 0, 0, 1, 0}, ResourceVector{1, 0, 0, 0, 0}, 1);     // Only for seat 1
+    int oreForWood = book.post(1, ResourceVector{0, 0, 0, 0, 2}, ResourceVector{2, 0, 0, 0, 0});
+    CHECK(book.size() == 3);
+    CHECK_FALSE(book.cancel(reserved, 0));      // Not seat 0's offer
+
+    // Seat 0 gives the 2 wood seat 1 asked for and gets the 1 ore it asked for
+    vector<TradeFill> fills = book.settle(players);
+    REQUIRE(fills.size() == 1);
+    CHECK(fills[0].firstOffer == woodForOre);
+    CHECK(fills[0].secondOffer == oreForWood);
+    CHECK(p1.getResourceCount(ResourceType::WOOD) == 1);
+    CHECK(p1.getResourceCount(ResourceType::ORE) == 1);
+    CHECK(p2.getResourceCount(ResourceType::WOOD) == 2);
+    CHECK(p2.getResourceCount(ResourceType::ORE) == 1);
+    CHECK(p3.getResourceCount(ResourceType::GRAIN) == 1);
+
+    // The reserved offer stays open; a matching offer of seat 1 that it cannot pay for does not trade
+    REQUIRE(book.size() == 1);
+    book.post(1, ResourceVector{5, 0, 0, 0, 0}, ResourceVector{0, 0, 0, 1, 0});
+    p2.useResources(ResourceType::WOOD, 2);
+    CHECK(book.settle(players).empty());
+    CHECK(p3.getResourceCount(ResourceType::GRAIN) == 1);
+    CHECK(book.cancel(reserved, 2));
+}
+
+TEST_CASE("TradeBook rejects offers past the cap of a seat and of the book") {
+    const ResourceVector wood{1, 0, 0, 0, 0}, ore{0, 0, 0, 0, 1};
+    TradeBook book;
+    for (size_t i = 0; i < TradeBook::MAX_OFFERS_PER_SEAT; ++i)
+    {
+        book.post(0, wood, ore);
+    }
+    CHECK_THROWS_AS(book.post(0, wood, ore), length_error);
+    CHECK(book.size() == TradeBook::MAX_OFFERS_PER_SEAT);
+
+    // Withdrawing an offer frees its place
+    REQUIRE(book.cancel(book.getOffers()[0].id, 0));
+    CHECK_NOTHROW(book.post(0, wood, ore));
+
+    // The other seats fill the book, after which no seat can post
+    for (size_t seat = 1; book.size() < TradeBook::MAX_OFFERS; seat = seat % (MAX_SEATS - 1) + 1)
+    {
+        book.post(seat, ore, wood);
+    }
+    CHECK_THROWS_AS(book.post(MAX_SEATS, ore, wood), length_error);
+    CHECK(book.size() == TradeBook::MAX_OFFERS);
+
+    // Through the engine the cap is an error reply
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setDice([] { return 4; });
+    engine.start();
+    string event;
+    for (size_t i = 0; i < TradeBook::MAX_OFFERS_PER_SEAT; ++i)
+    {
+        REQUIRE(engine.submit(1, "offer 0 0 0 0 1 for 1 0 0 0 0", event).rfind("ok", 0) == 0);
+    }
+    CHECK(engine.submit(1, "offer 0 0 0 0 1 for 1 0 0 0 0", event) == "err Too many open offers");
+    CHECK(game.getTradeBook().size() == TradeBook::MAX_OFFERS_PER_SEAT);
+}
+
+TEST_CASE("TurnEngine trades the offers of the seat on turn") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setDice([] { return 4; });          // Every roll is an 8
+    engine.start();
+
+    string event;
+    Player* first = game.getPlayers()[0];
+    Player* second = game.getPlayers()[1];
+    first->addResource(ResourceType::WOOD, 1);
+    second->addResource(ResourceType::ORE, 1);
+
+    CHECK(engine.submit(1, "offer 0 0 0 0 1 for 1 0 0 0 0", event) == "ok 1");     // Posted before seat 0 rolls
+    CHECK(event == "event offer 1 1");
+    CHECK(engine.submit(2, "offer 1 0 0 0 0", event).rfind("err usage", 0) == 0);
+    CHECK(engine.submit(2, "offer 1 0 0 0 0 for 0 0 0 0 1 to 2", event) == "err A seat cannot trade with itself");
+    REQUIRE(engine.submit(0, "roll", event) == "ok 8");
+    CHECK(engine.getPhase() == TurnPhase::Actions);
+    int wood = first->getResourceCount(ResourceType::WOOD);
+    int ore = first->getResourceCount(ResourceType::ORE);
+    CHECK(engine.submit(0, "offer 1 0 0 0 0 for 0 0 0 0 1", event) == "ok 2");
+    CHECK(engine.submit(0, "trades", event) == "ok 1");
+    CHECK(event == "event trades 0 1");
+    CHECK(first->getResourceCount(ResourceType::WOOD) == wood - 1);
+    CHECK(first->getResourceCount(ResourceType::ORE) == ore + 1);
+    CHECK(game.getTradeBook().size() == 0);
+    CHECK(engine.submit(0, "end", event) == "ok");
+}
+
+
+/*********************************************/
+///           TESTS FOR TURN ENGINE         ///
+/*********************************************/
+
+TEST_CASE("TurnEngine plays queued decisions and suspends when a seat has none") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+
+    QueuedAgent seat0, seat1, seat2;
+    seat0.push("road 41 42");           // Rejected before the roll
+    seat0.push("roll");
+    seat0.push("end");
+    seat1.push("roll");
+    seat1.push("fly");
+    seat1.push("end");
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setDice([] { return 4; });          // Every roll is an 8
+    engine.start();
+
+    CHECK(seat0.getLastReply() == "ok");
+    CHECK(seat1.getLastReply() == "ok");
+    CHECK(engine.getTurn() == 2);
+    CHECK(engine.getPhase() == TurnPhase::PreRoll);
+    CHECK_FALSE(engine.isFinished());
+
+    string event;
+    CHECK(engine.submit(0, "roll", event) == "err not your turn");
+    CHECK(engine.submit(2, "discard 1 0 0 0 0", event) == "err nothing to discard");
+    CHECK(engine.submit(2, "roll", event) == "ok 8");
+    CHECK(event == "event roll 2 8");
+    CHECK(engine.submit(2, "end", event) == "ok");
+    CHECK(event == "event turn 0");
+    CHECK(engine.getTurn() == 0);
+}
+
+TEST_CASE("TurnEngine waits for the discards after a 7") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setDice([face = 0]() mutable { return ++face % 2 == 1 ? 3 : 4; });     // Every roll is a 7
+    engine.start();
+
+    string event;
+    Player* second = game.getPlayers()[1];
+    Player* third = game.getPlayers()[2];
+    second->addResource(ResourceType::WOOD, 9);
+    third->addResource(ResourceType::ORE, 9);
+    int held = second->countTotalResources();
+    int thirdHeld = third->countTotalResources();
+    REQUIRE(engine.submit(0, "roll", event) == "ok 7");
+    CHECK(engine.getPhase() == TurnPhase::Discard);
+    CHECK(engine.getPendingDiscard(1) == held / 2);
+    CHECK(engine.submit(0, "end", event) == "err waiting for discards");
+    CHECK(engine.submit(1, "discard auto", event).rfind("ok", 0) == 0);
+    CHECK(second->countTotalResources() == held - held / 2);
+    CHECK(engine.submit(2, "discard auto chaos", event) == "err unknown discard policy");
+    CHECK(engine.submit(2, "discard auto rarest", event).rfind("ok", 0) == 0);
+    CHECK(third->countTotalResources() == thirdHeld - thirdHeld / 2);
+    CHECK(engine.getPhase() == TurnPhase::Robber);
+}
+
+TEST_CASE("TurnEngine runs the special build phase in games of 5 players") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana"), p4("Noa"), p5("Gal");
+    Catan game(array<Player*, 5>{&p1, &p2, &p3, &p4, &p5}, board);
+    game.initializeGame();
+    REQUIRE(game.hasSpecialBuildPhase());
+
+    QueuedAgent seats[5];
+    TurnEngine engine(game, {&seats[0], &seats[1], &seats[2], &seats[3], &seats[4]});
+    engine.setDice([face = 0]() mutable { return ++face % 2 == 1 ? 3 : 4; });     // Every roll is a 7
+    engine.start();
+
+    string event;
+    REQUIRE(engine.submit(0, "roll", event) == "ok 7");
+    CHECK(engine.getPhase() == TurnPhase::Robber);     // Nobody holds more than 7 resources after setup
+    CHECK(engine.submit(0, "robber", event).rfind("ok", 0) == 0);
+    CHECK(engine.getPhase() == TurnPhase::Actions);
+    CHECK(engine.submit(0, "end", event) == "ok");
+    CHECK(event == "event build 1");
+    CHECK(engine.getPhase() == TurnPhase::SpecialBuild);
+    CHECK(engine.getTurn() == 0);
+    CHECK(engine.getActor() == 1);
+
+    CHECK(engine.submit(1, "roll", event) == "err only building in the special build phase");
+    CHECK(engine.submit(2, "end", event) == "err not your turn");
+    CHECK(engine.submit(1, "end", event) == "ok");
+    for (size_t seat = 2; seat < 5; ++seat)
+    {
+        CHECK(engine.getActor() == seat);
+        CHECK(engine.submit(seat, "end", event) == "ok");
+    }
+    CHECK(event == "event turn 1");
+    CHECK(engine.getTurn() == 1);
+    CHECK(engine.getActor() == 1);
+    CHECK(engine.getPhase() == TurnPhase::PreRoll);
+}
+
+TEST_CASE("TurnEngine lets a seat claim a win from the special build phase only on its own turn") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana"), p4("Noa"), p5("Gal");
+    Catan game(array<Player*, 5>{&p1, &p2, &p3, &p4, &p5}, board);
+    game.initializeGame();
+
+    QueuedAgent seats[5];
+    TurnEngine engine(game, {&seats[0], &seats[1], &seats[2], &seats[3], &seats[4]});
+    engine.setDice([] { return 4; });          // Every roll is an 8
+    engine.start();
+
+    string event;
+    REQUIRE(engine.submit(0, "roll", event) == "ok 8");
+    REQUIRE(engine.submit(0, "end", event) == "ok");
+    REQUIRE(engine.getActor() == 1);
+
+    // Seat 1 builds its tenth point while seat 0's turn is still running
+    Player* builder = game.getPlayers()[1];
+    builder->addPoints(7);
+    builder->addResource(ResourceType::ORE, 3);
+    builder->addResource(ResourceType::GRAIN, 2);
+    int settlement = *builder->getSettlements().begin();
+    CHECK(engine.submit(1, "city " + to_string(settlement), event) == "ok");
+    CHECK(builder->getPoints() >= 10);
+    CHECK_FALSE(engine.isFinished());
+    CHECK(engine.getPhase() == TurnPhase::SpecialBuild);
+
+    for (size_t seat = 1; seat < 5; ++seat)
+    {
+        CHECK(engine.submit(seat, "end", event) == "ok");
+    }
+    CHECK(event == "event winner 1 " + to_string(builder->getPoints()));
+    CHECK(engine.getTurn() == 1);
+    CHECK(engine.isFinished());
+}
+
+TEST_CASE("TurnEngine finishes the game when a seat reaches 10 points") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setDice([] { return 4; });          // Every roll is an 8
+    engine.start();
+
+    string event;
+    Player* first = game.getPlayers()[0];
+    REQUIRE(engine.submit(0, "roll", event) == "ok 8");
+    first->addPoints(7);
+    first->addResource(ResourceType::ORE, 3);
+    first->addResource(ResourceType::GRAIN, 2);
+    int settlement = *first->getSettlements().begin();
+    CHECK(engine.submit(0, "city " + to_string(settlement), event) == "ok");
+    CHECK(event == "event winner 0 " + to_string(first->getPoints()));
+    CHECK(engine.isFinished());
+    CHECK(engine.submit(0, "end", event) == "err game over");
+}
+
+TEST_CASE("ConsoleAgent drives the turns from the numbered menus") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+
+    // Each seat rolls and ends its turn, then the input runs out
+    istringstream input("7\n1\n8\n1\n8\n1\n8\n");
+    ostringstream output;
+    ConsoleAgent console(game, input, output);
+    TurnEngine engine(game, {&console, &console, &console});
+    for (size_t seat = 0; seat < 3; ++seat) {
+        engine.setDiscardPolicy(seat, DiscardPolicy::byName("balanced"));     // A 7 must not read the menu choices
+    }
+    CHECK_THROWS_AS(engine.start(), runtime_error);
+    CHECK(engine.getTurn() == 0);
+    CHECK(output.str().find("ERROR: Invalid input") != string::npos);
+}
+
+/*********************************************/
+///              TESTS FOR BOTS             ///
+/*********************************************/
+
+TEST_CASE("Bot weights are read from a config file") {
+    istringstream config("# Tuned for expansion\nincome 10\n\nexpansion 6.5   # roads first\n");
+    BotWeights weights = BotWeights::fromStream(config);
+    CHECK(weights.income == 10.0);
+    CHECK(weights.expansion == 6.5);
+    CHECK(weights.points == BotWeights().points);
+
+    istringstream unknown("speed 3\n");
+    CHECK_THROWS_AS(BotWeights::fromStream(unknown), invalid_argument);
+    istringstream missing("cards lots\n");
+    CHECK_THROWS_AS(BotWeights::fromStream(missing), invalid_argument);
+    CHECK_THROWS_AS(BotWeights::fromFile("/nonexistent/bot.cfg"), runtime_error);
+}
+
+TEST_CASE("Bot evaluation weighs income, distance to a build and points") {
+    Board board;
+    BotEvaluator evaluator(board, BotWeights());
+
+    ResourceVector hand = {};
+    CHECK(BotEvaluator::distanceToBuild(hand) == 3);                                // A development card
+    CHECK(BotEvaluator::distanceToBuild(Player::costOf(Structure::SETTLEMENT)) == 0);
+
+    // Intersection 23 touches (0,0), (1,1) and (1,0): the desert, a 4 and a 3, so 5 chances in 36
+    CHECK(evaluator.siteValue(23) == doctest::Approx(5.0 / 36));
+
+    BotPosition empty = {};
+    BotPosition settled = empty;
+    evaluator.addProduction(settled, 23, 1);
+    ++settled.points;
+    CHECK(evaluator.evaluate(settled) > evaluator.evaluate(empty));
+    BotPosition city = settled;
+    evaluator.addProduction(city, 23, 1);
+    CHECK(city.income[WOOL] == doctest::Approx(2 * settled.income[WOOL]));
+}
+
+TEST_CASE("Bots build what they can afford and finish a game") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    BotAgent bot(game);
+
+    // With the cost of a city and nothing else, the bot upgrades one of its settlements
+    Player* player = game.getPlayers()[0];
+    for (int type = WOOD; type <= ORE; ++type)
+    {
+        player->useResources(static_cast<ResourceType>(type), player->getResourceCount(static_cast<ResourceType>(type)));
+    }
+    player->addResource(GRAIN, 2);
+    player->addResource(ORE, 3);
+    string command;
+    REQUIRE(bot.decide({DecisionType::Action, 0, 0}, command));
+    CHECK(command.rfind("city ", 0) == 0);
+    CHECK(player->getSettlements().count(stoi(command.substr(5))) == 1);
+
+    // With nothing in hand there is nothing to do
+    player->useResources(GRAIN, 2);
+    player->useResources(ORE, 3);
+    REQUIRE(bot.decide({DecisionType::Action, 0, 0}, command));
+    CHECK(command == "end");
+
+    // Three bots play a whole game
+    Board playedBoard;
+    Player b1("Blue"), b2("Red"), b3("Green");
+    Catan played(b1, b2, b3, playedBoard);
+    played.initializeGame();
+    BotAgent bots(played);
+    TurnEngine engine(played, {&bots, &bots, &bots});
+    engine.start();
+    REQUIRE(engine.isFinished());
+    int winners = 0;
+    for (Player* seat : played.getPlayers())
+    {
+        winners += seat->getPoints() >= 10;
+    }
+    CHECK(winners == 1);
+}
+
+
+/*********************************************/
+///         TESTS FOR WIN ESTIMATES         ///
+/*********************************************/
+
+TEST_CASE("Win estimates leave the game as it was and favor the leader") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    WinEstimator estimator(2);
+    CHECK(estimator.getThreads() == 2);
+
+    CheckpointData before, after;
+    GameCheckpoint::capture(game, before);
+    WinEstimate even = estimator.estimate(game);
+    GameCheckpoint::capture(game, after);
+    CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+
+    REQUIRE(even.seats == 3);
+    CHECK(even.rollouts > 0);
+    double total = even.unfinished;
+    for (size_t seat = 0; seat < even.seats; ++seat)
+    {
+        CHECK(even.lower[seat] <= even.probability[seat]);
+        CHECK(even.probability[seat] <= even.upper[seat]);
+        total += even.probability[seat];
+    }
+    CHECK(total == doctest::Approx(1.0));
+
+    // Eight points and the cost of two cities: the seat to play wins on its turn, unless a 7 makes it discard
+    Player* leader = game.getPlayers()[game.getCurrentPlayerIndex()];
+    leader->addPoints(static_cast<size_t>(8 - leader->getPoints()));
+    leader->addResource(GRAIN, 4);
+    leader->addResource(ORE, 6);
+    WinEstimate decided = estimator.estimate(game);
+    CHECK(decided.converged);
+    CHECK(decided.probability[game.getCurrentPlayerIndex()] > 0.8);
+}
+
+TEST_CASE("Win estimates stop at the first limit reached") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green"), p4("Orange");
+    Catan game(array<Player*, 4>{&p1, &p2, &p3, &p4}, board);
+    game.initializeGame();
+    WinEstimator estimator(3);
+
+    EstimateOptions loose;
+    loose.halfWidth = 0.2;
+    loose.minRollouts = 64;
+    loose.budget = chrono::seconds(30);
+    WinEstimate early = estimator.estimate(game, loose);
+    CHECK(early.converged);
+    CHECK(early.rollouts >= 64);
+    CHECK(early.rollouts < 64 + estimator.getThreads() * WinEstimator::BATCH);
+
+    EstimateOptions capped = loose;
+    capped.halfWidth = 0;
+    capped.maxRollouts = 96;
+    WinEstimate counted = estimator.estimate(game, capped);
+    CHECK_FALSE(counted.converged);
+    CHECK(counted.rollouts >= 96);
+    CHECK(counted.rollouts < 96 + estimator.getThreads() * WinEstimator::BATCH);
+
+    EstimateOptions timed = capped;
+    timed.maxRollouts = SIZE_MAX;
+    timed.budget = chrono::milliseconds(20);
+    WinEstimate stopped = estimator.estimate(game, timed);
+    CHECK_FALSE(stopped.converged);
+    CHECK(stopped.elapsed < chrono::milliseconds(500));     // The budget plus the last batches, with room for slow machines
+}
+
+
+/*********************************************/
+///         TESTS FOR AGENT PLUGINS         ///
+/*********************************************/
+
+TEST_CASE("Agent plugins are checked when they are loaded") {
+    CHECK_THROWS_AS(AgentPlugin::load("./no_such_agent.so"), runtime_error);
+    CHECK_THROWS_AS(AgentPlugin::load("libm.so.6"), runtime_error);        // A library without the entry point
+
+    shared_ptr<AgentPlugin> plugin = AgentPlugin::load("./libsampleagent.so");
+    CHECK(plugin->getName() == "sample");
+    CHECK(plugin->getApi().abiVersion == CATAN_AGENT_ABI_VERSION);
+}
+
+TEST_CASE("Agent plugins see the game through compact views and play it") {
+    weak_ptr<AgentPlugin> released;
+    {
+        Board board;
+        Player p1("Blue"), p2("Red"), p3("Green");
+        Catan game(p1, p2, p3, board);
+        game.initializeGame();
+        shared_ptr<AgentPlugin> plugin = AgentPlugin::load("./libsampleagent.so");
+        released = plugin;
+        vector<unique_ptr<PluginAgent>> agents;
+        vector<SeatAgent*> seats;
+        for (size_t seat = 0; seat < 3; ++seat)
+        {
+            agents.push_back(make_unique<PluginAgent>(game, plugin, seat));
+            seats.push_back(agents.back().get());
+        }
+        plugin.reset();         // The agents keep the library loaded
+
+        Player* first = game.getPlayers()[0];
+        agents[0]->refreshView({DecisionType::Discard, 0, 3});
+        const CatanStateView& view = agents[0]->getView();
+        CHECK(view.decision == CATAN_DECISION_DISCARD);
+        CHECK(view.amount == 3);
+        CHECK(view.seatCount == 3);
+        CHECK(view.seats[0].resources[GRAIN] == first->getResourceCount(GRAIN));
+        CHECK(view.seats[0].points == first->getPoints());
+        for (int settlement : first->getSettlements())
+        {
+            CHECK((view.seats[0].settlements >> settlement & 1) == 1);
+        }
+        size_t owned = 0;
+        for (int8_t owner : view.roadOwners)
+        {
+            owned += owner >= 0;
+        }
+        CHECK(owned == board.getRoads().size());
+        for (const Edge& road : first->getRoads())
+        {
+            CHECK(view.roadOwners[HexTopology::standard().edgeIndex(road.getId1(), road.getId2())] == 0);
+        }
+
+        string command;
+        REQUIRE(agents[0]->decide({DecisionType::PreRoll, 0, 0}, command));
+        CHECK(command == "roll");
+
+        TurnEngine engine(game, seats);
+        engine.start();
+        REQUIRE(engine.isFinished());
+        int winners = 0;
+        for (Player* seat : game.getPlayers())
+        {
+            winners += seat->getPoints() >= 10;
+        }
+        CHECK(winners == 1);
+        CHECK_FALSE(released.expired());
+    }
+
+    // With its agents gone the library is closed, and a new build can be loaded for the next tournament
+    CHECK(released.expired());
+    CHECK(AgentPlugin::load("./libsampleagent.so")->getName() == "sample");
+}
+
+
+/*********************************************/
+///          TESTS FOR RATING LADDER        ///
+/*********************************************/
+
+TEST_CASE("The result queue is bounded and first in, first out") {
+    ResultQueue queue(3);
+    CHECK(queue.getCapacity() == 4);
+    GameResult result = {};
+    for (int32_t game = 0; game < 4; ++game)
+    {
+        result.points[0] = game;
+        CHECK(queue.tryPush(result));
+    }
+    CHECK_FALSE(queue.tryPush(result));
+    for (int32_t game = 0; game < 4; ++game)
+    {
+        REQUIRE(queue.tryPop(result));
+        CHECK(result.points[0] == game);
+    }
+    CHECK_FALSE(queue.tryPop(result));
+}
+
+TEST_CASE("Multi-player results move Elo ratings by the points") {
+    RatingLadder ladder(16);
+    uint32_t alpha = ladder.addAgent("alpha"), beta = ladder.addAgent("beta"), gamma = ladder.addAgent("gamma");
+    CHECK(ladder.addAgent("beta") == beta);
+
+    CHECK(ladder.trySubmit({3, {alpha, beta, gamma}, {10, 7, 7}}));
+    CHECK(ladder.trySubmit({3, {alpha, beta, 9}, {10, 7, 7}}));        // Unknown agent
+    CHECK(ladder.trySubmit({1, {alpha}, {10}}));                        // Not a game
+    CHECK(ladder.drain() == 3);
+    CHECK(ladder.getProcessed() == 1);
+    CHECK(ladder.getRejected() == 2);
+
+    // Two duels won at even ratings: 2 * K/2 * (1 - 0.5); beta and gamma drew each other
+    vector<LadderEntry> standings = ladder.standings();
+    REQUIRE(standings.size() == 3);
+    CHECK(standings[0].name == "alpha");
+    CHECK(standings[0].rating == doctest::Approx(RatingLadder::INITIAL_RATING + 12));
+    CHECK(standings[1].rating == doctest::Approx(RatingLadder::INITIAL_RATING - 6));
+    CHECK(standings[2].rating == doctest::Approx(RatingLadder::INITIAL_RATING - 6));
+    CHECK(standings[0].wins == 1);
+    CHECK(standings[1].games == 1);
+
+    ostringstream snapshot;
+    ladder.writeSnapshot(snapshot);
+    CHECK(snapshot.str().find("1\talpha\t1512\t1\t1\n") != string::npos);
+
+    // Final points of a played game
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    game.getPlayers()[1]->addPoints(3);
+    GameResult played = GameResult::fromGame(game, {alpha, beta, gamma});
+    CHECK(played.seats == 3);
+    CHECK(played.points[1] == game.getPlayers()[1]->getPoints());
+    CHECK_THROWS_AS(GameResult::fromGame(game, {alpha, beta}), invalid_argument);
+}
+
+TEST_CASE("The ladder rates results streamed by parallel workers") {
+    string path = "/tmp/catan_ladder_" + to_string(getpid()) + ".tsv";
+    RatingLadder ladder(256, path, chrono::milliseconds(5));
+    vector<uint32_t> ids;
+    for (const char* name : {"greedy", "random", "sample", "cautious"})
+    {
+        ids.push_back(ladder.addAgent(name));
+    }
+    ladder.start();
+
+    // Every worker plays the same four agents; the first always wins, the others draw
+    const size_t workers = 4, games = 5000;
+    vector<thread> threads;
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        threads.emplace_back([&]() {
+            for (size_t game = 0; game < games; ++game)
+            {
+                ladder.submit({4, {ids[0], ids[1], ids[2], ids[3]}, {10, 6, 6, 6}});
+            }
+        });
+    }
+    for (thread& worker : threads)
+    {
+        worker.join();
+    }
+    ladder.stop();
+
+    CHECK(ladder.getProcessed() == workers * games);
+    vector<LadderEntry> standings = ladder.standings();
+    double total = 0;
+    for (const LadderEntry& entry : standings)
+    {
+        total += entry.rating;
+        CHECK(entry.games == workers * games);
+    }
+    CHECK(total == doctest::Approx(4 * RatingLadder::INITIAL_RATING));       // Elo moves points between agents
+    CHECK(standings[0].name == "greedy");
+    CHECK(standings[0].wins == workers * games);
+
+    ifstream saved(path);
+    string header, first;
+    getline(saved, header);
+    getline(saved, first);
+    CHECK(header.find("(20000 results)") != string::npos);
+    CHECK(first.rfind("1\tgreedy\t", 0) == 0);
+    remove(path.c_str());
+}
+
+
+/*********************************************/
+///         TESTS FOR ENDGAME SOLVER        ///
+/*********************************************/
+
+TEST_CASE("The endgame solver finds the winning move and leaves the game as it was") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    size_t seat = game.getCurrentPlayerIndex();
+    Player* leader = game.getPlayers()[seat];
+    for (int type = WOOD; type <= ORE; ++type)
+    {
+        leader->useResources(static_cast<ResourceType>(type), leader->getResourceCount(static_cast<ResourceType>(type)));
+    }
+    leader->addPoints(static_cast<size_t>(7 - leader->getPoints()));
+    CHECK_FALSE(EndgameSolver::isEndgame(game, seat));
+    leader->addPoints(1);
+    CHECK(EndgameSolver::isEndgame(game, seat));
+
+    // Eight points and nothing in hand: nothing wins on this turn
+    EndgameOptions single;
+    single.turns = 1;
+    EndgameSolver shallow(single);
+    EndgameMove idle = shallow.bestMove(game, seat);
+    CHECK(idle.command == "end");
+    CHECK(idle.probability == 0);
+
+    // Nine points and the cost of a city: the upgrade wins right away
+    leader->addPoints(1);
+    leader->addResource(GRAIN, 2);
+    leader->addResource(ORE, 3);
+    CheckpointData before, after;
+    GameCheckpoint::capture(game, before);
+    EndgameSolver solver;
+    EndgameMove winning = solver.bestMove(game, seat);
+    GameCheckpoint::capture(game, after);
+    CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+    REQUIRE(winning.command.rfind("city ", 0) == 0);
+    CHECK(leader->getSettlements().count(stoi(winning.command.substr(5))) == 1);
+    CHECK(winning.probability == doctest::Approx(1.0));
+
+    // A victory point card wins too, and the bot plays it before rolling
+    REQUIRE(game.getDeck().getQuantity(DevCardType::VICTORY_POINT) > 0);
+    leader->addResource(WOOL, 1);
+    leader->addResource(GRAIN, 1);
+    leader->addResource(ORE, 1);
+    vector<Player*>& players = game.getPlayers();
+    REQUIRE(leader->buyDevelopmentCardTEST(DevCardType::VICTORY_POINT, players) == CardPurchaseError::Success);
+    leader->useResources(GRAIN, 2);
+    leader->useResources(ORE, 3);
+    CHECK(solver.bestMove(game, seat).command == "use vp");
+    BotAgent bot(game);
+    string command;
+    REQUIRE(bot.decide({DecisionType::PreRoll, seat, 0}, command));
+    CHECK(command == "use vp");
+}
+
+TEST_CASE("Deeper endgame searches win at least as often and reuse cached positions") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    size_t seat = game.getCurrentPlayerIndex();
+    Player* leader = game.getPlayers()[seat];
+    leader->addPoints(static_cast<size_t>(8 - leader->getPoints()));
+    leader->addResource(WOOD, 2);
+    leader->addResource(GRAIN, 2);
+    leader->addResource(ORE, 2);
+
+    double previous = 0;
+    for (int turns = 1; turns <= 3; ++turns)
+    {
+        EndgameOptions options;
+        options.turns = turns;
+        options.otherRolls = false;
+        EndgameSolver solver(options);
+        double chance = solver.winChance(game, seat);
+        CHECK(chance >= previous - 1e-9);
+        CHECK(chance <= 1.0);
+        previous = chance;
+
+        EndgameMove move = solver.bestMove(game, seat);
+        CHECK(move.probability >= 0);
+        CHECK(move.nodes > 0);
+        if (turns > 1)
+        {
+            CHECK(move.cacheHits > 0);
+        }
+    }
+    CHECK(previous > 0);
+
+    // With the other seats' rolls the search branches over the hands they leave, and still answers
+    EndgameSolver counted;
+    REQUIRE(counted.getOptions().otherRolls);
+    double chance = counted.winChance(game, seat);
+    CHECK(chance > 0);
+    CHECK(chance <= 1.0);
+
+    // A small node budget stops the deepening early and answers from the last search that finished
+    EndgameOptions bounded;
+    bounded.turns = 3;
+    bounded.maxNodes = 200;
+    EndgameSolver limited(bounded);
+    EndgameMove move = limited.bestMove(game, seat);
+    CHECK(move.turns < 3);
+    CHECK(limited.winChance(game, seat) <= chance + 1e-9);
+}
+
+
+/*********************************************/
+///         TESTS FOR GAME STATISTICS       ///
+/*********************************************/
+
+TEST_CASE("Game statistics count the events of a bot game") {
+    StatsCollector collector;
+    CHECK(StatBlock::local() == nullptr);
+    Board board;
+    Player b1("Blue"), b2("Red"), b3("Green");
+    Catan game(b1, b2, b3, board);
+    size_t turnsPlayed = 0;
+    {
+        StatsScope scope(collector);
+        REQUIRE(StatBlock::local() != nullptr);
+        game.initializeGame();
+        BotAgent bots(game);
+        TurnEngine engine(game, {&bots, &bots, &bots});
+        engine.start();
+        REQUIRE(engine.isFinished());
+        turnsPlayed = engine.getTurnsPlayed();
+    }
+    CHECK(StatBlock::local() == nullptr);
+    CHECK(collector.getBlockCount() == 1);
+
+    StatTotals totals = collector.merge();
+    CHECK(totals.games == 1);
+    CHECK(totals.turns == turnsPlayed);
+    CHECK(totals.meanTurns() == doctest::Approx(static_cast<double>(turnsPlayed)));
+    uint64_t rolls = 0, produced = 0, fromRolls = 0, fromSetup = 0, winnerPoints = 0;
+    for (uint64_t count : totals.rolls)
+    {
+        rolls += count;
+    }
+    for (uint64_t count : totals.tileProduction)
+    {
+        produced += count;
+    }
+    for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+    {
+        fromRolls += totals.gained[static_cast<size_t>(GainSource::ROLL)][type];
+        fromSetup += totals.gained[static_cast<size_t>(GainSource::SETUP)][type];
+    }
+    for (uint64_t points : totals.winnerPoints)
+    {
+        winnerPoints += points;
+    }
+    CHECK(rolls > 0);
+    CHECK(rolls <= turnsPlayed);        // A winning card played before the roll ends the last turn without one
+    CHECK(produced == fromRolls);
+    CHECK(fromSetup > 0);
+    int best = 0;
+    for (Player* seat : game.getPlayers())
+    {
+        best = max(best, seat->getPoints());
+    }
+    CHECK(winnerPoints == static_cast<uint64_t>(best));
+    CHECK(totals.winnerPoints[static_cast<size_t>(PointSource::SETTLEMENTS)] + totals.winnerPoints[static_cast<size_t>(PointSource::CITIES)] >= 2);
+
+    ostringstream json;
+    totals.writeJson(json);
+    CHECK(json.str().rfind("{\"games\":1,", 0) == 0);
+    CHECK(json.str().find("\"winnerPoints\":{\"settlements\":") != string::npos);
+    CHECK(json.str().back() == '}');
+}
+
+TEST_CASE("Game statistics merge the blocks of many threads") {
+    StatsCollector collector;
+    const uint64_t perThread = 1000;
+    const int points[POINT_SOURCES] = {3, 4, 1, 2};
+    vector<thread> workers;
+    for (int worker = 0; worker < 4; ++worker)
+    {
+        workers.emplace_back([&]() {
+            StatsScope scope(collector);
+            StatBlock* stats = StatBlock::local();
+            for (uint64_t index = 0; index < perThread; ++index)
+            {
+                stats->rolled(7);
+                stats->gain(GainSource::BANK, ORE, 2);
+                stats->discard(static_cast<int>(index % 2));        // Only odd indexes discard anything
+            }
+            stats->gameWon(12, points);
+            stats->gameWon(1000, points);
+        });
+    }
+
+    // A merge taken while the threads count never runs ahead of them
+    StatTotals early = collector.merge();
+    CHECK(early.rolls[7] <= 4 * perThread);
+    for (thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    StatTotals totals = collector.merge();
+    CHECK(collector.getBlockCount() == 4);
+    CHECK(totals.rolls[7] == 4 * perThread);
+    CHECK(totals.gained[static_cast<size_t>(GainSource::BANK)][ORE] == 8 * perThread);
+    CHECK(totals.discards == 2 * perThread);
+    CHECK(totals.discarded == 2 * perThread);
+    CHECK(totals.games == 8);
+    CHECK(totals.turnHistogram[12 / StatTotals::TURN_BUCKET] == 4);
+    CHECK(totals.turnHistogram[StatTotals::TURN_BUCKETS - 1] == 4);
+    CHECK(totals.winnerPoints[static_cast<size_t>(PointSource::CITIES)] == 32);
+    CHECK(totals.meanTurns() == doctest::Approx(506.0));
+}
+
+
+/*********************************************/
+///        TESTS FOR TRADE VALUATION        ///
+/*********************************************/
+
+TEST_CASE("Trade values follow the time each side needs for its next builds") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    for (Player* player : {&p1, &p2})
+    {
+        for (int type = WOOD; type <= ORE; ++type)
+        {
+            player->useResources(static_cast<ResourceType>(type), player->getResourceCount(static_cast<ResourceType>(type)));
+        }
+    }
+
+    // One ore short of a city, with a spare wood
+    p1.addResource(WOOD, 3);
+    p1.addResource(GRAIN, 2);
+    p1.addResource(ORE, 2);
+    p2.addResource(ORE, 2);
+    p2.addResource(WOOL, 1);
+
+    TradeValuator valuator(board);
+    TradeSide blue = valuator.side(p1), red = valuator.side(p2);
+    CHECK((blue.builds & (1u << static_cast<unsigned>(Structure::CITY))) != 0);
+    CHECK(valuator.handCost(blue, blue.hand) > 0);
+    CHECK(valuator.handCost(red, red.hand) > valuator.handCost(red, red.hand + Player::costOf(Structure::CITY)));
+
+    map<ResourceType, int> offer = {{WOOD, 1}}, request = {{ORE, 1}};
+    TradeValue woodForOre = valuator.value(p1, p2, offer, request);
+    CHECK(woodForOre.proposer > 0);
+    CHECK(woodForOre.partner > -TradeValuator::HORIZON);
+
+    TradeValue oreForWood = valuator.value(p1, p2, request, offer);
+    CHECK(oreForWood.proposer < 0);
+    CHECK(std::isinf(oreForWood.partner));     // Red has no wood to give
+
+    // The proposal round-trips through the maps of Player::executeTrade
+    TradeProposal proposal = TradeValuator::fromOffer(offer, request);
+    map<ResourceType, int> offerBack, requestBack;
+    TradeValuator::toOffer(proposal, offerBack, requestBack);
+    CHECK(offerBack == offer);
+    CHECK(requestBack == request);
+}
+
+TEST_CASE("Trade candidates are scored in one batch") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    TradeValuator valuator(board);
+    TradeSide blue = valuator.side(p1), red = valuator.side(p2);
+    blue.hand = ResourceVector{2, 1, 0, 0, 0, 0, 0, 0};
+    red.hand = ResourceVector{0, 0, 1, 2, 0, 0, 0, 0};
+
+    // Blue gives wood (1 or 2) or brick (1), red gives wool (1) or grain (1 or 2)
+    vector<TradeProposal> proposals = TradeValuator::candidates(blue.hand, red.hand);
+    CHECK(proposals.size() == 8);
+    vector<TradeValue> values = valuator.score(blue, red, proposals);
+    REQUIRE(values.size() == proposals.size());
+    for (size_t index = 0; index < proposals.size(); ++index)
+    {
+        CHECK(canAfford(blue.hand, proposals[index].give));
+        CHECK(canAfford(red.hand, proposals[index].get));
+        TradeValue single = valuator.score(blue, red, {proposals[index]})[0];
+        CHECK(values[index].proposer == single.proposer);
+        CHECK(values[index].partner == single.partner);
+        CHECK(std::isfinite(values[index].proposer));
+        CHECK(std::isfinite(values[index].partner));
+    }
+    CHECK(TradeValuator::candidates(blue.hand, ResourceVector{}).empty());
+}
+
+
+/*********************************************/
+///          TESTS FOR ROAD PLANNER         ///
+/*********************************************/
+
+TEST_CASE("Planned road routes can be built and end where a settlement fits") {
+    Board board;
+    board.placeInitialSettlement(41, 0);
+    board.placeInitialRoad(Edge(Intersection::getIntersection(41), Intersection::getIntersection(42)), 0);
+    RoadPlanner planner;
+    planner.update(board, 0);
+
+    CHECK(planner.roadsTo(41) == RoadPlanner::UNREACHABLE);     // Taken
+    CHECK(planner.roadsTo(42) == RoadPlanner::UNREACHABLE);     // Next to the settlement
+    CHECK(planner.roadsTo(0) == RoadPlanner::UNREACHABLE);
+    CHECK(planner.roadsTo(55) == RoadPlanner::UNREACHABLE);
+    for (int neighbor : HexTopology::standard().neighbors(42))
+    {
+        if (neighbor != 0 && neighbor != 41)
+        {
+            CHECK(planner.roadsTo(neighbor) == 1);
+        }
+    }
+
+    // Every route follows free edges from the network, and building it makes the settlement legal
+    int farthest = 0;
+    for (int id = 1; id <= RoadPlanner::INTERSECTIONS; ++id)
+    {
+        RoadRoute route = planner.route(id);
+        CHECK(route.roads == planner.roadsTo(id));
+        if (route.roads == RoadPlanner::UNREACHABLE)
+        {
+            continue;
+        }
+        CHECK(board.isIntersectionConnectedToPlayerRoad(route.path[0], 0));
+        CHECK(route.path[route.roads] == id);
+        for (int step = 0; step < route.roads; ++step)
+        {
+            CHECK(board.areIntersectionsAdjacent(route.path[step], route.path[step + 1]));
+            CHECK_FALSE(board.isRoadPresent(route.path[step], route.path[step + 1]));
+        }
+        farthest = route.roads > planner.roadsTo(farthest) ? id : farthest;
+    }
+    RoadRoute longest = planner.route(farthest);
+    REQUIRE(longest.roads >= 3);
+    for (int step = 0; step < longest.roads; ++step)
+    {
+        Edge road(Intersection::getIntersection(longest.path[step]), Intersection::getIntersection(longest.path[step + 1]));
+        REQUIRE(board.canPlaceRoad(road, 0));
+        board.placeRoad(road, 0);
+    }
+    CHECK(board.canPlaceSettlement(farthest, 0));
+    planner.update(board, 0);
+    CHECK(planner.roadsTo(farthest) == 0);
+}
+
+TEST_CASE("The road planner does not pass the other seats' roads and buildings") {
+    Board board;
+    board.placeInitialSettlement(41, 0);
+    board.placeInitialRoad(Edge(Intersection::getIntersection(41), Intersection::getIntersection(42)), 0);
+    RoadPlanner planner;
+    planner.update(board, 0);
+    int reach[RoadPlanner::INTERSECTIONS + 1];
+    planner.reachability(reach);
+    CHECK(reach[0] == RoadPlanner::UNREACHABLE);
+
+    // Another seat settles next to the road's end and builds a road from it
+    int blocker = 0;
+    for (int neighbor : HexTopology::standard().neighbors(42))
+    {
+        blocker = neighbor != 0 && neighbor != 41 ? neighbor : blocker;
+    }
+    board.placeInitialSettlement(blocker, 1);
+    int beyond = 0;
+    for (int neighbor : HexTopology::standard().neighbors(blocker))
+    {
+        beyond = neighbor != 0 && neighbor != 42 ? neighbor : beyond;
+    }
+    REQUIRE(beyond != 0);
+    board.placeInitialRoad(Edge(Intersection::getIntersection(blocker), Intersection::getIntersection(beyond)), 1);
+
+    int blocked[RoadPlanner::INTERSECTIONS + 1];
+    planner.update(board, 0);
+    planner.reachability(blocked);
+    CHECK(blocked[blocker] == RoadPlanner::UNREACHABLE);
+    for (int id = 1; id <= RoadPlanner::INTERSECTIONS; ++id)
+    {
+        CHECK(blocked[id] == planner.roadsTo(id));
+        CHECK((blocked[id] == RoadPlanner::UNREACHABLE || reach[id] != RoadPlanner::UNREACHABLE));
+        CHECK((blocked[id] == RoadPlanner::UNREACHABLE || blocked[id] >= reach[id]));
+        RoadRoute route = planner.route(id);
+        for (int step = 0; step <= route.roads; ++step)
+        {
+            CHECK(route.path[step] != blocker);
+        }
+    }
+
+    // A seat without a network reaches nothing
+    planner.update(board, 2);
+    planner.reachability(blocked);
+    CHECK(count(blocked, blocked + RoadPlanner::INTERSECTIONS + 1, RoadPlanner::UNREACHABLE) == RoadPlanner::INTERSECTIONS + 1);
+}
+
+
+/*********************************************/
+///              TESTS FOR PERFT            ///
+/*********************************************/
+
+TEST_CASE("Perft counts the known action sequences of the beginner setup") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    vector<Player*>& players = game.getPlayers();
+    sort(players.begin(), players.end(), [](const Player* a, const Player* b) { return a->getId() < b->getId(); });
+    game.setCurrentPlayerIndex(0);
+
+    PerftOptions options;
+    options.verify = true;
+    PerftCounter counter(game, options);
+    CheckpointData before, after;
+    GameCheckpoint::capture(game, before);
+
+    // Eight roads or the end of the turn, then the eleven sums of the next roll
+    const uint64_t known[] = {1, 19, 297, 4917};
+    for (int depth = 0; depth <= 3; ++depth)
+    {
+        PerftResult result = counter.run(depth);
+        CHECK(result.leaves == known[depth]);
+        CHECK(result.mismatches == 0);
+    }
+    GameCheckpoint::capture(game, after);
+    CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+
+    uint64_t total = 0;
+    vector<pair<string, uint64_t>> counts = counter.divide(2);
+    for (const auto& [action, count] : counts)
+    {
+        total += count;
+    }
+    CHECK(counts.size() == 9);
+    CHECK(counts.back().first == "end");
+    CHECK(counts.back().second == 11 * 19);
+    CHECK(total == known[2]);
+
+    CHECK_THROWS_AS(counter.run(-1), invalid_argument);
+    CHECK_THROWS_AS(counter.divide(0), invalid_argument);
+}
+
+TEST_CASE("Perft follows the placement rules around other seats' buildings") {
+    Board board;
+    Player p1("Blue"), p2("Red"), p3("Green");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    size_t seat = game.getCurrentPlayerIndex();
+    Player* player = game.getPlayers()[seat];
+    for (int type = WOOD; type <= ORE; ++type)
+    {
+        player->addResource(static_cast<ResourceType>(type), 5);
+    }
+
+    // A road ending at another seat's settlement does not lead past it
+    int id = player->getId();
+    int other = game.getPlayers()[(seat + 1) % 3]->getId();
+    RoadPlanner planner;
+    planner.update(board, id);
+    RoadRoute route;
+    route.roads = RoadPlanner::UNREACHABLE;
+    for (int target = 1; target <= RoadPlanner::INTERSECTIONS && route.roads != 2; ++target)
+    {
+        route = planner.route(target);
+    }
+    REQUIRE(route.roads == 2);
+    board.placeRoad(Edge(Intersection::getIntersection(route.path[0]), Intersection::getIntersection(route.path[1])), id);
+    board.placeInitialSettlement(route.path[1], other);
+    CHECK_FALSE(board.canPlaceRoad(Edge(Intersection::getIntersection(route.path[1]), Intersection::getIntersection(route.path[2])), id));
+    CHECK_FALSE(board.canPlaceSettlement(route.path[1], id));
+
+    // A settlement of the seat, reached by its road, is not a spot for another one
+    int home = *player->getSettlements().begin();
+    CHECK(board.isIntersectionConnectedToPlayerRoad(home, id));
+    CHECK_FALSE(board.canPlaceSettlement(home, id));
+
+    // With a full hand every kind of action shows up, and the rules agree with the occupancy masks
+    PerftOptions options;
+    options.verify = true;
+    PerftCounter counter(game, options);
+    map<string, int> kinds;
+    for (const auto& [action, count] : counter.divide(1))
+    {
+        ++kinds[action.substr(0, action.find(' '))];
+        CHECK(count == (action == "end" ? 11u : 1u));
+    }
+    CHECK(kinds["road"] > 0);
+    CHECK(kinds["city"] == 2);
+    CHECK(kinds["bank"] == 20);
+    CHECK(kinds["end"] == 1);
+    PerftResult result = counter.run(2);
+    CHECK(result.mismatches == 0);
+    CHECK(result.leaves > 0);
+
+    PerftOptions quiet;
+    quiet.trades = false;
+    PerftCounter withoutTrades(game, quiet);
+    CHECK(withoutTrades.run(1).leaves + 20 == counter.run(1).leaves);
+}
+
+
+/*********************************************/
+///           TESTS FOR CHECKPOINTS         ///
+/*********************************************/
+
+TEST_CASE("GameCheckpoint restores a saved game into new players") {
+    string path = "/tmp/catan_checkpoint_" + to_string(getpid()) + ".bin";
+
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    game.getDeck().draw(DevCardType::KNIGHT);
+    Player* first = game.getPlayers()[0];
+    int city = *first->getSettlements().begin();
+    first->addResource(ResourceType::ORE, 3);
+    first->addResource(ResourceType::GRAIN, 3);
+    first->upgradeToCity(city, board);
+    first->setDevelopmentCardCount(DevCardType::KNIGHT, 2);
+    game.getPlayers()[2]->setPromotionCardCount(PromotionType::MONOPOLY, 1);
+    game.setCurrentPlayerIndex(1);
+    GameCheckpoint::save(game, path);
+
+    Board restoredBoard;
+    Player q1("Amit"), q2("Yossi"), q3("Dana");
+    Catan restored(q1, q2, q3, restoredBoard);
+    restored.testInitialize();
+    GameCheckpoint::load(restored, path);
+
+    CHECK(restored.getCurrentPlayerIndex() == 1);
+    CHECK(restored.getPlayers()[0]->getName() == first->getName());     // Seated in the saved order
+    CHECK(restored.getDeck().getQuantity(DevCardType::KNIGHT) == DevelopmentDeck::FULL[0] - 1);
+    CHECK(game.getDeck().getQuantity(DevCardType::KNIGHT) == DevelopmentDeck::FULL[0] - 1);
+    Player* restoredFirst = restored.getPlayers()[0];
+    CHECK(restoredBoard.getCities().at(city) == restoredFirst->getId());
+    CHECK(restoredBoard.hasSettlement(45) == board.hasSettlement(45));
+    CHECK(restoredBoard.isRoadPresent(13, 14));
+    CHECK(restoredFirst->getCities().count(city) == 1);
+    CHECK(restoredFirst->getPoints() == first->getPoints());
+    CHECK(restoredFirst->getResourceCount(ResourceType::GRAIN) == first->getResourceCount(ResourceType::GRAIN));
+    CHECK(restoredFirst->getDevelopmentCards().at(DevCardType::KNIGHT) == 2);
+    CHECK(restored.getPlayers()[2]->getPromotionCardCount(PromotionType::MONOPOLY) == 1);
+    CHECK(restored.getPlayers()[1]->getRoads().size() == game.getPlayers()[1]->getRoads().size());
+
+    // A damaged file is rejected
+    FILE* file = fopen(path.c_str(), "r+b");
+    REQUIRE(file != nullptr);
+    fputc('X', file);
+    fclose(file);
+    CHECK_THROWS_AS(GameCheckpoint::load(restored, path), runtime_error);
+    unlink(path.c_str());
+}
+
+TEST_CASE("GameCheckpoint keeps a generated board") {
+    BoardGenerator generator(7);
+    BoardLayout layout;
+    generator.generate(layout);
+
+    Board board;
+    board.applyLayout(layout);
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame(OpeningPlan::beginner(3));      // Keeps the tiles of the board
+    CheckpointData before, after;
+    GameCheckpoint::capture(game, before);
+
+    Board restoredBoard;
+    Player q1("Amit"), q2("Yossi"), q3("Dana");
+    Catan restored(q1, q2, q3, restoredBoard);
+    restored.testInitialize();
+    GameCheckpoint::restore(restored, before);
+    BoardLayout restoredLayout;
+    restoredBoard.getLayout(restoredLayout);
+    CHECK(equal(begin(layout.resources), end(layout.resources), begin(restoredLayout.resources)));
+    CHECK(equal(begin(layout.numbers), end(layout.numbers), begin(restoredLayout.numbers)));
+    CHECK(restoredBoard.getRobberPosition() == board.getRobberPosition());
+
+    // Perft undoes its actions through checkpoints, so it also leaves the generated tiles in place
+    PerftCounter counter(game);
+    CHECK(counter.run(2).leaves > 0);
+    GameCheckpoint::capture(game, after);
+    CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+
+    // A tile with an impossible number token is rejected
+    before.layout.numbers[0] = 7;
+    CHECK_THROWS_AS(GameCheckpoint::restore(restored, before), runtime_error);
+}
+
+TEST_CASE("GameCheckpoint rejects an invalid checkpoint and leaves the game as it was") {
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    CheckpointData valid, after;
+    GameCheckpoint::capture(game, valid);
+    int settlement = -1;
+    for (int id = 1; id < static_cast<int>(CheckpointData::INTERSECTIONS) && settlement < 0; ++id)
+    {
+        settlement = valid.settlementSeat[id] >= 0 ? id : -1;
+    }
+    REQUIRE(settlement > 0);
+    int neighbor = HexTopology::standard().neighbors(settlement)[0];
+
+    vector<function<void(CheckpointData&)>> damages = {
+        [](CheckpointData& data) { data.roads[0].id1 = 1; data.roads[0].id2 = 54; },            // Not an edge
+        [](CheckpointData& data) { data.roads[0].id1 = 0; },                                    // Not an intersection
+        [](CheckpointData& data) { data.roads[data.roadCount - 1].seat = -1; },                  // The last road, after the others
+        [](CheckpointData& data) { data.roads[1] = data.roads[0]; },                            // Twice on one edge
+        [&](CheckpointData& data) { data.settlementSeat[settlement] = 3; },                     // No such seat
+        [&](CheckpointData& data) { data.citySeat[settlement] = 0; },                           // A settlement and a city
+        [&](CheckpointData& data) { data.settlementSeat[neighbor] = 1; },                       // Distance rule
+        [](CheckpointData& data) { data.robber[0] = 5; },
+        [](CheckpointData& data) { data.largestArmySeat = 3; },
+        [](CheckpointData& data) { data.players[2].resources[ORE] = -1; },
+        [](CheckpointData& data) { data.deck[0] = -1; },
+    };
+    for (const auto& damage : damages)
+    {
+        CheckpointData data = valid;
+        damage(data);
+        CHECK_THROWS_AS(GameCheckpoint::restore(game, data), runtime_error);
+        GameCheckpoint::capture(game, after);
+        CHECK(memcmp(&valid, &after, sizeof(valid)) == 0);
+    }
+    CHECK_NOTHROW(GameCheckpoint::restore(game, valid));
+}
+
+TEST_CASE("TurnEngine saves a checkpoint when a turn passes") {
+    string path = "/tmp/catan_turn_checkpoint_" + to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+
+    Board board;
+    Player p1("Amit"), p2("Yossi"), p3("Dana");
+    Catan game(p1, p2, p3, board);
+    game.initializeGame();
+    QueuedAgent seat0, seat1, seat2;
+    TurnEngine engine(game, {&seat0, &seat1, &seat2});
+    engine.setCheckpointPath(path);
+    engine.setDice([] { return 4; });          // Every roll is an 8
+    engine.start();
+
+    string event;
+    REQUIRE(engine.submit(0, "roll", event) == "ok 8");
+    CHECK(engine.submit(0, "end", event) == "ok");
+
+    Board restoredBoard;
+    Player q1("Amit"), q2("Yossi"), q3("Dana");
+    Catan restored(q1, q2, q3, restoredBoard);
+    restored.testInitialize();
+    GameCheckpoint::load(restored, path);
+    CHECK(restored.getCurrentPlayerIndex() == 1);
+    CHECK(restored.getPlayers()[1]->getResourceCount(ResourceType::WOOD) == game.getPlayers()[1]->getResourceCount(ResourceType::WOOD));
+    unlink(path.c_str());
+}
+
+/*********************************************/
+///             TESTS FOR SERVER            ///
+/*********************************************/
+
+TEST_CASE("GameSession enforces turn order without blocking") {
+    GameSession session(1);
+    session.setDice([face = 0]() mutable { return ++face % 2 == 1 ? 3 : 4; });    // Every roll is a 7
+    string event;
+
+    CHECK(session.handleCommand(0, "state", event).rfind("ok game 1 turn 0 phase preroll", 0) == 0);
+    CHECK(session.handleCommand(0, "road 41 42", event) == "err roll first");
+    CHECK(session.handleCommand(1, "roll", event) == "err not your turn");
+
+    CHECK(session.handleCommand(0, "roll", event) == "ok 7");
+    CHECK(event == "event roll 0 7");
+    CHECK(session.getPhase() == TurnPhase::Robber);         // Nobody holds more than 7 resources after setup
+    CHECK(session.handleCommand(0, "robber", event) == "ok");
+    CHECK(event.rfind("event robber ", 0) == 0);
+    CHECK(session.getPhase() == TurnPhase::Actions);
+    CHECK(session.handleCommand(0, "roll", event) == "err already rolled");
+    CHECK(session.handleCommand(0, "fly", event) == "err unknown command");
+
+    CHECK(session.handleCommand(0, "end", event) == "ok");
+    CHECK(event == "event turn 1");
+    CHECK(session.getTurn() == 1);
+    CHECK(session.getPhase() == TurnPhase::PreRoll);
+}
+
+TEST_CASE("GameSession sessions have independent boards") {
+    GameSession first(1), second(2);
+    CHECK(&first.getBoard() != &second.getBoard());
+    CHECK(first.getBoard().hasSettlement(41));
+    CHECK(second.getBoard().hasSettlement(41));
+
+    // A settlement upgraded in one game does not exist in the other
+    Player& seat = first.getSeat(0);
+    int intersectionID = *seat.getSettlements().begin();
+    seat.addResource(ResourceType::ORE, 3);
+    seat.addResource(ResourceType::GRAIN, 2);
+    seat.upgradeToCity(intersectionID, first.getBoard());
+    CHECK(first.getBoard().getCities().count(intersectionID) == 1);
+    CHECK(second.getBoard().getCities().empty());
+}
+
+TEST_CASE("GameServer answers commands over a Unix domain socket") {
+    string path = "/tmp/catan_test_" + to_string(getpid()) + ".sock";
+    GameServer server(path, 2);
+    server.start();
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(client >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+
+    auto exchange = [&](const string& line) {
+        string request = line + "\n";
+        REQUIRE(write(client, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+        string reply;
+        char c;
+        while (reply.empty() || reply.back() != '\n')
+        {
+            server.runOnce(10);
+            while (recv(client, &c, 1, MSG_DONTWAIT) == 1)
+            {
+                reply += c;
+                if (c == '\n') break;
+            }
+        }
+        reply.pop_back();
+        return reply;
+    };
+
+    CHECK(exchange("roll") == "err join a game first");
+    CHECK(exchange("new") == "ok game 1");
+    CHECK(exchange("new") == "ok game 2");
+    CHECK(exchange("new") == "err server full");
+    CHECK(exchange("join 1 0") == "ok joined 1 0");
+    CHECK(exchange("join 1 1") == "ok joined 1 1");         // Moving to another seat frees seat 0...
+    CHECK(exchange("join 1 0") == "ok joined 1 0");         // ...so it can be taken again, and seat 1 is freed
+    CHECK(exchange("join 1 0") == "ok joined 1 0");
+    CHECK(exchange("state").rfind("ok game 1 turn 0", 0) == 0);
+    CHECK(server.getSessionCount() == 2);
+    CHECK(server.getConnectionCount() == 1);
+
+    close(client);
+    server.runOnce(10);
+    CHECK(server.getConnectionCount() == 0);
+}
+
+TEST_CASE("GameServer creates games of 3 to 6 seats") {
+    string path = "/tmp/catan_seats_" + to_string(getpid()) + ".sock";
+    GameServer server(path);
+    server.start();
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(client >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+
+    auto exchange = [&](const string& line) {
+        string request = line + "\n";
+        REQUIRE(write(client, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+        string reply;
+        char c;
+        while (reply.empty() || reply.back() != '\n')
+        {
+            server.runOnce(10);
+            while (recv(client, &c, 1, MSG_DONTWAIT) == 1)
+            {
+                reply += c;
+                if (c == '\n') break;
+            }
+        }
+        reply.pop_back();
+        return reply;
+    };
+
+    CHECK(exchange("new 2") == "err a game has 3 to 6 players");
+    CHECK(exchange("new 7") == "err a game has 3 to 6 players");
+    CHECK(exchange("new 5") == "ok game 1");
+    CHECK(exchange("new") == "ok game 2");
+    CHECK(exchange("join 2 3") == "err seat taken");        // The default game has 3 seats
+    CHECK(exchange("join 1 5") == "err seat taken");
+    CHECK(exchange("join 1 4") == "ok joined 1 4");
+    string state = exchange("state");
+    CHECK(count(state.begin(), state.end(), '|') == 5);
+    CHECK(state.find("| 4 ") != string::npos);
+
+    close(client);
+    server.runOnce(10);
+    CHECK(server.getConnectionCount() == 0);
+}
+
+TEST_CASE("GameServer reaps idle games and caps the games a connection creates") {
+    string path = "/tmp/catan_reap_" + to_string(getpid()) + ".sock";
+    GameServer server(path, 100, chrono::milliseconds(100), chrono::milliseconds(400));
+    server.start();
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(client >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+
+    auto readLine = [&]() {
+        string reply;
+        char c;
+        while (reply.empty() || reply.back() != '\n')
+        {
+            server.runOnce(10);
+            while (recv(client, &c, 1, MSG_DONTWAIT) == 1)
+            {
+                reply += c;
+                if (c == '\n') break;
+            }
+        }
+        reply.pop_back();
+        return reply;
+    };
+    auto exchange = [&](const string& line) {
+        string request = line + "\n";
+        REQUIRE(write(client, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+        return readLine();
+    };
+
+    CHECK(exchange("new") == "ok game 1");
+    CHECK(exchange("new") == "ok game 2");
+    CHECK(exchange("new") == "ok game 3");
+    CHECK(exchange("new") == "ok game 4");
+    CHECK(exchange("new") == "err too many games");
+    CHECK(exchange("join 1 0") == "ok joined 1 0");
+
+    // Nobody sits at games 2 to 4: they are dropped after the grace period, which frees the creator's quota
+    this_thread::sleep_for(chrono::milliseconds(150));
+    server.runOnce(0);
+    CHECK(server.getSessionCount() == 1);
+    CHECK(exchange("new") == "ok game 5");
+
+    // Game 1 has a seat but no activity: it is closed after the idle timeout and its seat is told
+    this_thread::sleep_for(chrono::milliseconds(450));
+    CHECK(readLine() == "event closed 1 idle");
+    CHECK(server.getSessionCount() == 0);
+    CHECK(exchange("state") == "err join a game first");
+
+    close(client);
+    server.runOnce(10);
+    CHECK(server.getConnectionCount() == 0);
+}
@@ -95,9 +95,9 @@ namespace ariel {
      * @brief Retrieves the set of intersection IDs associated with the tile.
      * @return The set of intersection IDs.
      */
-    set<int> Tile::getIntersectionIDs() const 
+    const set<int>& Tile::getIntersectionIDs() const 
     {
-        return set<int>(intersectionIDs.begin(), intersectionIDs.end());
+        return intersectionIDs;
     }
 
 
@@ -3,6 +3,7 @@
 #ifndef TILE_HPP
 #define TILE_HPP
 
+#include <vector>
 #include "resources.hpp"
 #include "intersection.hpp"
 #include "edge.hpp"
@@ -102,7 +103,7 @@ namespace ariel {
              * @brief Retrieves the set of intersection IDs associated with the tile.
              * @return The set of intersection IDs.
              */
-            set<int> getIntersectionIDs() const;
+            const set<int>& getIntersectionIDs() const;
 
             
             //---------------------------//
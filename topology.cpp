@@ -0,0 +1,248 @@
+// Email: origoldbsc@gmail.com
+
+#include "topology.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        /**
+         * @brief A corner in board units: tiles are 2 units wide and rows are 3 units apart, so every corner
+         * has integer coordinates. Rows of intersections are the zigzags between two rows of tiles.
+         */
+        struct Corner
+        {
+            int h, v;
+
+            int row() const
+            {
+                return (v - 1) >= 0 ? (v - 1) / 3 : -((3 - v) / 3);     // floor((v - 1) / 3)
+            }
+
+            bool operator<(const Corner& other) const
+            {
+                return row() != other.row() ? row() > other.row() : h < other.h;     // Top row first, left to right
+            }
+
+            bool operator==(const Corner& other) const
+            {
+                return h == other.h && v == other.v;
+            }
+        };
+
+        /**
+         * @brief The corners of a tile, clockwise from the top.
+         */
+        array<Corner, 6> cornersOf(const pair<int, int>& position)
+        {
+            int h = 2 * position.first - position.second;
+            int v = 3 * position.second;
+            return {{{h, v + 2}, {h + 1, v + 1}, {h + 1, v - 1}, {h, v - 2}, {h - 1, v - 1}, {h - 1, v + 1}}};
+        }
+
+        /**
+         * @brief Puts a value in the first free slot of a padded entry.
+         */
+        void append(array<int, 3>& entry, int value, int empty)
+        {
+            *find(entry.begin(), entry.end(), empty) = value;
+        }
+    }
+
+
+    /**
+     * @brief Derives the topology of a map.
+     * @param tiles The coordinates of the tiles, in the order of the tile indices.
+     * @throws invalid_argument if there are no tiles or a tile is listed twice.
+     */
+    HexTopology::HexTopology(const vector<pair<int, int>>& tiles) : positions(tiles)
+    {
+        vector<pair<int, int>> sorted = tiles;
+        sort(sorted.begin(), sorted.end());
+        if (sorted.empty() || adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+        {
+            throw invalid_argument("A map needs at least one tile and no tile twice");
+        }
+
+        // Number the corners of all tiles, top row first
+        vector<Corner> keys;
+        keys.reserve(6 * tiles.size());
+        for (const pair<int, int>& position : tiles)
+        {
+            array<Corner, 6> tileCorners = cornersOf(position);
+            keys.insert(keys.end(), tileCorners.begin(), tileCorners.end());
+        }
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+        const array<int, 3> noIDs = {0, 0, 0};
+        const array<int, 3> noIndices = {NO_INDEX, NO_INDEX, NO_INDEX};
+        tilesAround.assign(keys.size() + 1, noIndices);
+        adjacent.assign(keys.size() + 1, noIDs);
+        incidentEdges.assign(keys.size() + 1, noIndices);
+
+        corners.resize(tiles.size());
+        for (size_t tile = 0; tile < tiles.size(); ++tile)
+        {
+            array<Corner, 6> tileCorners = cornersOf(tiles[tile]);
+            for (size_t corner = 0; corner < 6; ++corner)
+            {
+                int id = static_cast<int>(lower_bound(keys.begin(), keys.end(), tileCorners[corner]) - keys.begin()) + 1;
+                corners[tile][corner] = id;
+                append(tilesAround[static_cast<size_t>(id)], static_cast<int>(tile), NO_INDEX);
+            }
+            for (size_t corner = 0; corner < 6; ++corner)
+            {
+                int a = corners[tile][corner], b = corners[tile][(corner + 1) % 6];
+                edges.emplace_back(min(a, b), max(a, b));
+            }
+        }
+
+        // Neighboring tiles share edges, keep each once
+        sort(edges.begin(), edges.end());
+        edges.erase(unique(edges.begin(), edges.end()), edges.end());
+        for (size_t index = 0; index < edges.size(); ++index)
+        {
+            auto [a, b] = edges[index];
+            append(adjacent[static_cast<size_t>(a)], b, 0);
+            append(adjacent[static_cast<size_t>(b)], a, 0);
+            append(incidentEdges[static_cast<size_t>(a)], static_cast<int>(index), NO_INDEX);
+            append(incidentEdges[static_cast<size_t>(b)], static_cast<int>(index), NO_INDEX);
+        }
+    }
+
+
+    /**
+     * @brief Returns the tiles of a hexagonal island: 1 + 3r(r+1) tiles, e.g. 19 for radius 2 and 91 for radius 5.
+     * The tiles are listed row by row from the top, like Board::setupTiles.
+     */
+    vector<pair<int, int>> HexTopology::hexagon(int radius)
+    {
+        vector<pair<int, int>> tiles;
+        for (int y = radius; y >= -radius; --y)
+        {
+            for (int x = max(-radius, y - radius); x <= min(radius, y + radius); ++x)
+            {
+                tiles.emplace_back(x, y);
+            }
+        }
+        return tiles;
+    }
+
+
+    /**
+     * @brief Returns the topology of the standard 19-tile board, built once.
+     */
+    const HexTopology& HexTopology::standard()
+    {
+        static const HexTopology topology(hexagon(2));
+        return topology;
+    }
+
+
+    size_t HexTopology::tileCount() const
+    {
+        return positions.size();
+    }
+
+
+    size_t HexTopology::intersectionCount() const
+    {
+        return adjacent.size() - 1;
+    }
+
+
+    size_t HexTopology::edgeCount() const
+    {
+        return edges.size();
+    }
+
+
+    /**
+     * @brief Returns the index of the tile at a position, or NO_INDEX.
+     */
+    int HexTopology::tileIndex(const pair<int, int>& position) const
+    {
+        auto tile = find(positions.begin(), positions.end(), position);
+        return tile == positions.end() ? NO_INDEX : static_cast<int>(tile - positions.begin());
+    }
+
+
+    const pair<int, int>& HexTopology::tilePosition(size_t tile) const
+    {
+        return positions.at(tile);
+    }
+
+
+    const array<int, 6>& HexTopology::tileCorners(size_t tile) const
+    {
+        return corners.at(tile);
+    }
+
+
+    const pair<int, int>& HexTopology::edge(size_t index) const
+    {
+        return edges.at(index);
+    }
+
+
+    const array<int, 3>& HexTopology::intersectionTiles(int intersectionID) const
+    {
+        return tilesAround.at(static_cast<size_t>(intersectionID));
+    }
+
+
+    const array<int, 3>& HexTopology::neighbors(int intersectionID) const
+    {
+        return adjacent.at(static_cast<size_t>(intersectionID));
+    }
+
+
+    const array<int, 3>& HexTopology::intersectionEdges(int intersectionID) const
+    {
+        return incidentEdges.at(static_cast<size_t>(intersectionID));
+    }
+
+
+    /**
+     * @brief Returns the number of neighbors of an intersection: 2 or 3.
+     */
+    int HexTopology::degree(int intersectionID) const
+    {
+        const array<int, 3>& entry = neighbors(intersectionID);
+        return static_cast<int>(count_if(entry.begin(), entry.end(), [](int id) { return id != 0; }));
+    }
+
+
+    /**
+     * @brief Returns the index of the edge between two intersections, or NO_INDEX if they are not adjacent.
+     */
+    int HexTopology::edgeIndex(int id1, int id2) const
+    {
+        if (id1 <= 0 || static_cast<size_t>(id1) >= incidentEdges.size())
+        {
+            return NO_INDEX;
+        }
+        for (int index : incidentEdges[static_cast<size_t>(id1)])
+        {
+            if (index != NO_INDEX && edges[static_cast<size_t>(index)] == make_pair(min(id1, id2), max(id1, id2)))
+            {
+                return index;
+            }
+        }
+        return NO_INDEX;
+    }
+
+
+    /**
+     * @brief Returns true if an intersection touches fewer than three tiles.
+     */
+    bool HexTopology::isCoastal(int intersectionID) const
+    {
+        return intersectionTiles(intersectionID)[2] == NO_INDEX;
+    }
+}
@@ -0,0 +1,93 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief The intersections, edges and adjacency of a map, derived from the axial coordinates of its tiles.
+     *
+     * Tiles use the board's coordinates: (x, y) touches (x±1, y), (x, y±1), (x+1, y+1) and (x-1, y-1), and rows
+     * run from y at the top down. Intersections are numbered from 1, row by row from the top and left to right
+     * within a row, so the standard 19-tile map gets the same IDs as the board. Any set of tiles can be used.
+     *
+     * Every table is a dense array of fixed-size entries. The tables by intersection are indexed by ID directly
+     * (entry 0 is unused) and padded with 0 (no intersection) or NO_INDEX (no tile or edge).
+     */
+    class HexTopology
+    {
+        public:
+
+            static constexpr int NO_INDEX = -1;
+
+        private:
+
+            vector<pair<int, int>> positions;           // Tile coordinates, by tile index
+            vector<array<int, 6>> corners;              // Intersections of each tile, clockwise from the top
+            vector<pair<int, int>> edges;               // Ends of each edge, lower ID first, sorted
+            vector<array<int, 3>> tilesAround;          // Tile indices around each intersection (by ID)
+            vector<array<int, 3>> adjacent;             // Neighboring intersections of each intersection (by ID)
+            vector<array<int, 3>> incidentEdges;        // Edge indices at each intersection (by ID)
+
+        public:
+
+            /**
+             * @brief Derives the topology of a map.
+             * @param tiles The coordinates of the tiles, in the order of the tile indices.
+             * @throws invalid_argument if there are no tiles or a tile is listed twice.
+             */
+            explicit HexTopology(const vector<pair<int, int>>& tiles);
+
+            /**
+             * @brief Returns the tiles of a hexagonal island: 1 + 3r(r+1) tiles, e.g. 19 for radius 2 and 91 for radius 5.
+             * The tiles are listed row by row from the top, like Board::setupTiles.
+             */
+            static vector<pair<int, int>> hexagon(int radius);
+
+            /**
+             * @brief Returns the topology of the standard 19-tile board, built once.
+             */
+            static const HexTopology& standard();
+
+            size_t tileCount() const;
+            size_t intersectionCount() const;
+            size_t edgeCount() const;
+
+            /**
+             * @brief Returns the index of the tile at a position, or NO_INDEX.
+             */
+            int tileIndex(const pair<int, int>& position) const;
+
+            const pair<int, int>& tilePosition(size_t tile) const;
+            const array<int, 6>& tileCorners(size_t tile) const;
+            const pair<int, int>& edge(size_t index) const;
+
+            const array<int, 3>& intersectionTiles(int intersectionID) const;
+            const array<int, 3>& neighbors(int intersectionID) const;
+            const array<int, 3>& intersectionEdges(int intersectionID) const;
+
+            /**
+             * @brief Returns the number of neighbors of an intersection: 2 or 3.
+             */
+            int degree(int intersectionID) const;
+
+            /**
+             * @brief Returns the index of the edge between two intersections, or NO_INDEX if they are not adjacent.
+             */
+            int edgeIndex(int id1, int id2) const;
+
+            /**
+             * @brief Returns true if an intersection touches fewer than three tiles.
+             */
+            bool isCoastal(int intersectionID) const;
+    };
+}
+
+#endif
@@ -0,0 +1,218 @@
+// Email: origoldbsc@gmail.com
+
+#include "trade.hpp"
+#include "exporter.hpp"
+#include "stats.hpp"
+#include <stdexcept>
+
+using namespace std;
+namespace ariel {
+
+    TradeBook::TradeBook() : nextOfferID(1) {}
+
+
+    /**
+     * @brief Posts an offer.
+     * @param seat The seat posting the offer.
+     * @param give Most the seat is willing to give.
+     * @param want What the seat wants in return.
+     * @param target Only this seat may take the offer (-1 for anyone).
+     * @return The ID of the offer.
+     * @throws invalid_argument if an amount is negative or the offer gives or wants nothing.
+     * @throws length_error if the seat, or the book, already has the most open offers allowed.
+     */
+    int TradeBook::post(size_t seat, const ResourceVector& give, const ResourceVector& want, int target)
+    {
+        const ResourceVector none = {};
+        if (!canAfford(give, none) || !canAfford(want, none))
+        {
+            throw invalid_argument("Trade amounts cannot be negative");
+        }
+        if (totalResources(give) == 0 || totalResources(want) == 0)
+        {
+            throw invalid_argument("A trade must give and want something");
+        }
+        if (target >= 0 && static_cast<size_t>(target) == seat)
+        {
+            throw invalid_argument("A seat cannot trade with itself");
+        }
+        if (offers.size() >= MAX_OFFERS)
+        {
+            throw length_error("The trade book is full");
+        }
+        size_t open = 0;
+        for (const TradeOffer& other : offers)
+        {
+            open += other.seat == seat;
+        }
+        if (open >= MAX_OFFERS_PER_SEAT)
+        {
+            throw length_error("Too many open offers");
+        }
+
+        // Only the resource lanes may be set, so the spare lanes of the hands stay zero
+        TradeOffer offer{nextOfferID++, seat, none, none, target};
+        for (size_t type = WOOD; type <= ORE; ++type)
+        {
+            offer.give[type] = give[type];
+            offer.want[type] = want[type];
+        }
+        offers.push_back(offer);
+        return offer.id;
+    }
+
+
+    /**
+     * @brief Withdraws an open offer of a seat.
+     * @return True if the offer was open and belonged to the seat.
+     */
+    bool TradeBook::cancel(int offerID, size_t seat)
+    {
+        for (auto it = offers.begin(); it != offers.end(); ++it)
+        {
+            if (it->id == offerID && it->seat == seat)
+            {
+                offers.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    /**
+     * @brief Two offers match when they come from different seats, neither is reserved for a third seat,
+     * and each one gives at least what the other wants.
+     */
+    bool TradeBook::compatible(const TradeOffer& a, const TradeOffer& b)
+    {
+        if (a.seat == b.seat)
+        {
+            return false;
+        }
+        if ((a.target >= 0 && static_cast<size_t>(a.target) != b.seat) || (b.target >= 0 && static_cast<size_t>(b.target) != a.seat))
+        {
+            return false;
+        }
+        return canAfford(a.give, b.want) && canAfford(b.give, a.want);
+    }
+
+
+    /**
+     * @brief Matches compatible offers and executes the matched trades in one batch.
+     * Offers that cannot be matched, or whose seat can no longer pay, stay in the book.
+     * @param players The players of the game, indexed by seat.
+     * @param turnSeat Only trades with this seat are matched, as in the rules (-1 for any two seats).
+     * @return The executed trades, in execution order.
+     */
+    vector<TradeFill> TradeBook::settle(vector<Player*>& players, int turnSeat)
+    {
+        vector<TradeFill> fills;
+
+        // Hands as they will be after the trades matched so far; the players are only written at the end
+        vector<ResourceVector> hands(players.size());
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            hands[seat] = players[seat]->resources;
+        }
+
+        vector<bool> matched(offers.size(), false);
+        for (size_t i = 0; i < offers.size(); ++i)
+        {
+            const TradeOffer& first = offers[i];
+            if (matched[i] || first.seat >= players.size())
+            {
+                continue;
+            }
+            for (size_t j = i + 1; j < offers.size(); ++j)
+            {
+                const TradeOffer& second = offers[j];
+                if (matched[j] || second.seat >= players.size() || !compatible(first, second))
+                {
+                    continue;
+                }
+                if (turnSeat >= 0 && first.seat != static_cast<size_t>(turnSeat) && second.seat != static_cast<size_t>(turnSeat))
+                {
+                    continue;
+                }
+
+                // Each seat pays exactly what the other one asked for
+                if (!canAfford(hands[first.seat], second.want) || !canAfford(hands[second.seat], first.want))
+                {
+                    continue;
+                }
+                hands[first.seat] += first.want - second.want;
+                hands[second.seat] += second.want - first.want;
+                matched[i] = matched[j] = true;
+                fills.push_back({first.id, second.id, first.seat, second.seat, second.want, first.want});
+                break;
+            }
+        }
+
+        if (fills.empty())
+        {
+            return fills;
+        }
+        for (size_t seat = 0; seat < players.size(); ++seat)
+        {
+            players[seat]->resources = hands[seat];
+        }
+
+        vector<TradeOffer> open;
+        for (size_t i = 0; i < offers.size(); ++i)
+        {
+            if (!matched[i])
+            {
+                open.push_back(offers[i]);
+            }
+        }
+        offers.swap(open);
+
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            for (const TradeFill& fill : fills)
+            {
+                int offer[5], request[5];
+                for (size_t type = WOOD; type <= ORE; ++type)
+                {
+                    offer[type] = fill.firstGives[type];
+                    request[type] = fill.secondGives[type];
+                }
+                exporter->resourceTrade(players[fill.firstSeat]->getId(), players[fill.secondSeat]->getId(), offer, request);
+            }
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            for (const TradeFill& fill : fills)
+            {
+                stats->playerTrade();
+                for (size_t type = WOOD; type <= ORE; ++type)
+                {
+                    stats->gain(GainSource::TRADE, static_cast<ResourceType>(type), fill.firstGives[type] + fill.secondGives[type]);
+                }
+            }
+        }
+        return fills;
+    }
+
+
+    /**
+     * @brief Removes every open offer, called when a turn passes.
+     */
+    void TradeBook::clear()
+    {
+        offers.clear();
+    }
+
+
+    const vector<TradeOffer>& TradeBook::getOffers() const
+    {
+        return offers;
+    }
+
+
+    size_t TradeBook::size() const
+    {
+        return offers.size();
+    }
+}
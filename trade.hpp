@@ -0,0 +1,101 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef TRADE_HPP
+#define TRADE_HPP
+
+#include <vector>
+#include "resources.hpp"
+#include "player.hpp"
+#include "registry.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief A standing offer in the trade book: the seat gives up to "give" in exchange for exactly "want".
+     */
+    struct TradeOffer
+    {
+        int id;                     // Unique within the book, increasing in posting order
+        size_t seat;                // The seat that posted the offer
+        ResourceVector give;        // Most the seat is willing to give
+        ResourceVector want;        // What the seat wants in return
+        int target;                 // Only this seat may take the offer (-1 for anyone)
+    };
+
+
+    /**
+     * @brief A trade executed by the book: two offers matched against each other.
+     */
+    struct TradeFill
+    {
+        int firstOffer, secondOffer;        // IDs of the matched offers, the older one first
+        size_t firstSeat, secondSeat;       // Seats that posted them
+        ResourceVector firstGives;          // Moved from the first seat to the second (what the second wanted)
+        ResourceVector secondGives;         // Moved from the second seat to the first (what the first wanted)
+    };
+
+
+    /**
+     * @brief An in-game order book of resource trades between players.
+     *
+     * Seats post offers at any time; settle() matches compatible offers in posting order and executes all
+     * matched trades as one batch. Two offers are compatible when each one gives at least what the other
+     * wants and neither is reserved for a third seat. Every trade is checked against the hands as they are
+     * after the trades before it in the batch, and the hands are written once at the end. A seat may have at
+     * most MAX_OFFERS_PER_SEAT open offers, so the book never holds more than MAX_OFFERS and settle() stays
+     * cheap however often a seat posts.
+     */
+    class TradeBook
+    {
+        private:
+
+            vector<TradeOffer> offers;      // Open offers in posting order
+            int nextOfferID;                // ID of the next posted offer
+
+            static bool compatible(const TradeOffer& a, const TradeOffer& b);
+
+        public:
+
+            static constexpr size_t MAX_OFFERS_PER_SEAT = 8;                       // Open offers one seat may have
+            static constexpr size_t MAX_OFFERS = MAX_OFFERS_PER_SEAT * MAX_SEATS;  // Open offers in the whole book
+
+            TradeBook();
+
+            /**
+             * @brief Posts an offer.
+             * @param seat The seat posting the offer.
+             * @param give Most the seat is willing to give.
+             * @param want What the seat wants in return.
+             * @param target Only this seat may take the offer (-1 for anyone).
+             * @return The ID of the offer.
+             * @throws invalid_argument if an amount is negative or the offer gives or wants nothing.
+             * @throws length_error if the seat, or the book, already has the most open offers allowed.
+             */
+            int post(size_t seat, const ResourceVector& give, const ResourceVector& want, int target = -1);
+
+            /**
+             * @brief Withdraws an open offer of a seat.
+             * @return True if the offer was open and belonged to the seat.
+             */
+            bool cancel(int offerID, size_t seat);
+
+            /**
+             * @brief Matches compatible offers and executes the matched trades in one batch.
+             * Offers that cannot be matched, or whose seat can no longer pay, stay in the book.
+             * @param players The players of the game, indexed by seat.
+             * @param turnSeat Only trades with this seat are matched, as in the rules (-1 for any two seats).
+             * @return The executed trades, in execution order.
+             */
+            vector<TradeFill> settle(vector<Player*>& players, int turnSeat = -1);
+
+            // Removes every open offer, called when a turn passes
+            void clear();
+
+            // Getters
+            const vector<TradeOffer>& getOffers() const;
+            size_t size() const;
+    };
+}
+
+#endif
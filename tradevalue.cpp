@@ -0,0 +1,190 @@
+// Email: origoldbsc@gmail.com
+
+#include "tradevalue.hpp"
+#include "board.hpp"
+#include "player.hpp"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+namespace ariel {
+
+    TradeValuator::TradeValuator(const Board& board) : production()
+    {
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            for (const Tile& tile : board.getTilesAroundIntersection(id))
+            {
+                int number = tile.getNumber();
+                if (tile.getResourceType() != ResourceType::NONE && number >= 2 && number <= 12)
+                {
+                    production[id][tile.getResourceType()] += static_cast<float>(6 - abs(7 - number)) / 36.0f;
+                }
+            }
+        }
+    }
+
+
+    /**
+     * @brief Reads the hand, income, bank rates and possible builds of a player.
+     */
+    TradeSide TradeValuator::side(const Player& player) const
+    {
+        TradeSide side = {player.getResources(), RateVector{}, 0};
+        for (int settlement : player.getSettlements())
+        {
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                side.income[type] += production[settlement][type];
+            }
+        }
+        for (int city : player.getCities())
+        {
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                side.income[type] += 2 * production[city][type];
+            }
+        }
+
+        // A resource the side does not produce (enough of) still comes from the bank, at the rate of what it produces
+        float traded = 0;
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            traded += side.income[type] / static_cast<float>(player.getBankRate(static_cast<ResourceType>(type)));
+        }
+        for (size_t type = 0; type < 8; ++type)
+        {
+            // Lanes past ORE are never missing; a floor keeps an empty income from dividing zero by zero
+            side.income[type] = type < RESOURCE_TYPES ? max({side.income[type], traded, 1e-6f}) : 1.0f;
+        }
+
+        side.builds = 1u << static_cast<unsigned>(Structure::ROAD) | 1u << static_cast<unsigned>(Structure::SETTLEMENT)
+                      | 1u << static_cast<unsigned>(Structure::DEVELOPMENT_CARD);
+        if (!player.getSettlements().empty())
+        {
+            side.builds |= 1u << static_cast<unsigned>(Structure::CITY);
+        }
+        return side;
+    }
+
+
+    /**
+     * @brief Returns the weighted rolls a side needs to afford its builds with a given hand.
+     */
+    float TradeValuator::handCost(const TradeSide& side, const ResourceVector& hand) const
+    {
+        const RateVector horizon = {HORIZON, HORIZON, HORIZON, HORIZON, HORIZON, HORIZON, HORIZON, HORIZON};
+        float cost = 0;
+        for (size_t structure = 0; structure < STRUCTURE_TYPES; ++structure)
+        {
+            if ((side.builds & 1u << structure) == 0)
+            {
+                continue;
+            }
+            ResourceVector missing = Player::costOf(static_cast<Structure>(structure)) - hand;
+            missing &= missing > 0;         // Lanes already covered count as 0
+            RateVector rolls = __builtin_convertvector(missing, RateVector) / side.income;
+            rolls = rolls < horizon ? rolls : horizon;
+            cost += buildWeights[structure] * max({rolls[WOOD], rolls[BRICK], rolls[WOOL], rolls[GRAIN], rolls[ORE]});
+        }
+        return cost;
+    }
+
+
+    /**
+     * @brief Values a batch of proposals for both sides. The costs of the hands before the trades are computed once.
+     * @return One value per proposal, in the same order.
+     */
+    vector<TradeValue> TradeValuator::score(const TradeSide& proposer, const TradeSide& partner, const vector<TradeProposal>& proposals) const
+    {
+        const float unpaid = -numeric_limits<float>::infinity();
+        float proposerBefore = handCost(proposer, proposer.hand);
+        float partnerBefore = handCost(partner, partner.hand);
+        vector<TradeValue> values(proposals.size());
+        for (size_t index = 0; index < proposals.size(); ++index)
+        {
+            const TradeProposal& proposal = proposals[index];
+            values[index].proposer = canAfford(proposer.hand, proposal.give)
+                                     ? proposerBefore - handCost(proposer, proposer.hand - proposal.give + proposal.get) : unpaid;
+            values[index].partner = canAfford(partner.hand, proposal.get)
+                                    ? partnerBefore - handCost(partner, partner.hand - proposal.get + proposal.give) : unpaid;
+        }
+        return values;
+    }
+
+
+    /**
+     * @brief Lists every 1-for-1, 2-for-1 and 1-for-2 exchange of two different resources that both hands can pay.
+     */
+    vector<TradeProposal> TradeValuator::candidates(const ResourceVector& proposerHand, const ResourceVector& partnerHand)
+    {
+        static const int amounts[3][2] = {{1, 1}, {2, 1}, {1, 2}};     // Given, received
+        vector<TradeProposal> proposals;
+        for (size_t give = 0; give < RESOURCE_TYPES; ++give)
+        {
+            for (size_t get = 0; get < RESOURCE_TYPES; ++get)
+            {
+                for (const int* amount : amounts)
+                {
+                    if (give != get && proposerHand[give] >= amount[0] && partnerHand[get] >= amount[1])
+                    {
+                        TradeProposal proposal = {ResourceVector{}, ResourceVector{}};
+                        proposal.give[give] = amount[0];
+                        proposal.get[get] = amount[1];
+                        proposals.push_back(proposal);
+                    }
+                }
+            }
+        }
+        return proposals;
+    }
+
+
+    /**
+     * @brief Values a trade given as the offer and request maps of Player::prepareTradeDetails().
+     */
+    TradeValue TradeValuator::value(const Player& offerer, const Player& recipient, const map<ResourceType, int>& offerResources,
+                                    const map<ResourceType, int>& requestResources) const
+    {
+        return score(side(offerer), side(recipient), {fromOffer(offerResources, requestResources)})[0];
+    }
+
+
+    TradeProposal TradeValuator::fromOffer(const map<ResourceType, int>& offerResources, const map<ResourceType, int>& requestResources)
+    {
+        TradeProposal proposal = {ResourceVector{}, ResourceVector{}};
+        for (const auto& [type, count] : offerResources)
+        {
+            if (type >= WOOD && type <= ORE)
+            {
+                proposal.give[type] += count;
+            }
+        }
+        for (const auto& [type, count] : requestResources)
+        {
+            if (type >= WOOD && type <= ORE)
+            {
+                proposal.get[type] += count;
+            }
+        }
+        return proposal;
+    }
+
+
+    void TradeValuator::toOffer(const TradeProposal& proposal, map<ResourceType, int>& offerResources, map<ResourceType, int>& requestResources)
+    {
+        offerResources.clear();
+        requestResources.clear();
+        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            if (proposal.give[type] > 0)
+            {
+                offerResources[static_cast<ResourceType>(type)] = proposal.give[type];
+            }
+            if (proposal.get[type] > 0)
+            {
+                requestResources[static_cast<ResourceType>(type)] = proposal.get[type];
+            }
+        }
+    }
+}
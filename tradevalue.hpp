@@ -0,0 +1,123 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef TRADEVALUE_HPP
+#define TRADEVALUE_HPP
+
+#include <map>
+#include <vector>
+#include "resources.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Board;
+    class Player;
+
+    /**
+     * @brief Resources expected per roll, one float lane per ResourceType, laid out like ResourceVector.
+     */
+    typedef float RateVector __attribute__((vector_size(32)));
+
+
+    /**
+     * @brief A proposed exchange between two seats, seen from the proposer.
+     */
+    struct TradeProposal
+    {
+        ResourceVector give;        // From the proposer to the partner
+        ResourceVector get;         // From the partner to the proposer
+    };
+
+
+    /**
+     * @brief The marginal value of a proposal for each side: the weighted rolls it saves on the way to the side's
+     * next builds. Positive when the trade brings the side's builds closer, -infinity when the side cannot pay.
+     */
+    struct TradeValue
+    {
+        float proposer;
+        float partner;
+    };
+
+
+    /**
+     * @brief What TradeValuator knows of one side: its hand, its income and the builds it is saving for.
+     */
+    struct TradeSide
+    {
+        ResourceVector hand;
+        RateVector income;          // Per roll from the side's buildings, raised to what bank trades of its income give
+        unsigned builds;            // Bit (1 << Structure) set for every build the side can still use
+    };
+
+
+    /**
+     * @brief Values trades by how much sooner each side can afford its next builds.
+     *
+     * The time to a build is the most rolls any of its missing resources takes at the side's expected income, where
+     * a resource the side does not produce still arrives through bank trades of what it does produce. A hand costs
+     * the weighted sum of the times to the side's builds (a road, a settlement, a city while the side has a
+     * settlement to upgrade, and a development card), each capped at HORIZON rolls, and a trade is worth the cost
+     * it takes off the hand. Every lane of a proposal is computed at once on the vector types, and score() values a
+     * whole batch of proposals for both sides in one call.
+     *
+     * The production of every intersection is read from the board once, when the valuator is created. The robber
+     * is not taken into account.
+     */
+    class TradeValuator
+    {
+        public:
+
+            static constexpr int INTERSECTIONS = 54;
+            static constexpr float HORIZON = 72.0f;                     // Rolls a build may take at most
+            static constexpr float buildWeights[STRUCTURE_TYPES] = {    // Indexed by Structure
+                0.25f,      // ROAD
+                1.0f,       // SETTLEMENT
+                1.0f,       // CITY
+                0.5f        // DEVELOPMENT_CARD
+            };
+
+        private:
+
+            float production[INTERSECTIONS + 1][RESOURCE_TYPES];       // Resources expected per roll at each intersection
+
+        public:
+
+            explicit TradeValuator(const Board& board);
+
+            /**
+             * @brief Reads the hand, income, bank rates and possible builds of a player.
+             */
+            TradeSide side(const Player& player) const;
+
+            /**
+             * @brief Returns the weighted rolls a side needs to afford its builds with a given hand.
+             */
+            float handCost(const TradeSide& side, const ResourceVector& hand) const;
+
+            /**
+             * @brief Values a batch of proposals for both sides.
+             * @return One value per proposal, in the same order.
+             */
+            vector<TradeValue> score(const TradeSide& proposer, const TradeSide& partner, const vector<TradeProposal>& proposals) const;
+
+            /**
+             * @brief Lists every 1-for-1, 2-for-1 and 1-for-2 exchange of two different resources that both hands can pay.
+             */
+            static vector<TradeProposal> candidates(const ResourceVector& proposerHand, const ResourceVector& partnerHand);
+
+            /**
+             * @brief Values a trade given as the offer and request maps of Player::prepareTradeDetails().
+             */
+            TradeValue value(const Player& offerer, const Player& recipient, const map<ResourceType, int>& offerResources,
+                             const map<ResourceType, int>& requestResources) const;
+
+            /**
+             * @brief Converts between a proposal and the offer and request maps of Player::executeTrade().
+             */
+            static TradeProposal fromOffer(const map<ResourceType, int>& offerResources, const map<ResourceType, int>& requestResources);
+            static void toOffer(const TradeProposal& proposal, map<ResourceType, int>& offerResources, map<ResourceType, int>& requestResources);
+    };
+}
+
+#endif
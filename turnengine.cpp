@@ -0,0 +1,1271 @@
+// Email: origoldbsc@gmail.com
+
+#include "turnengine.hpp"
+#include "exporter.hpp"
+#include "stats.hpp"
+#include "checkpoint.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+
+using namespace std;
+namespace ariel {
+
+    //-------------------------------------//
+    //              SeatAgent              //
+    //-------------------------------------//
+
+    /**
+     * @brief Ignores the reply by default.
+     */
+    void SeatAgent::notify(const string&) {}
+
+
+    /**
+     * @brief Agents are not interactive by default.
+     */
+    bool SeatAgent::isInteractive() const
+    {
+        return false;
+    }
+
+
+    //-------------------------------------//
+    //            ConsoleAgent             //
+    //-------------------------------------//
+
+    /**
+     * @brief Constructor for a console player.
+     * @param game The game, used to print the game state and player details.
+     * @param in Where choices are read from.
+     * @param out Where menus are printed to.
+     */
+    ConsoleAgent::ConsoleAgent(Catan& game, istream& in, ostream& out) : game(game), in(in), out(out) {}
+
+
+    /**
+     * @brief Reads one number, clearing the line after invalid input.
+     * @return The number, or -1 if the input was not a number.
+     * @throws runtime_error if the input was closed.
+     */
+    int ConsoleAgent::readNumber()
+    {
+        int value;
+        if (in >> value)
+        {
+            return value;
+        }
+        if (in.eof())
+        {
+            throw runtime_error("Console input closed");
+        }
+        in.clear();                                             // Clear error flag
+        in.ignore(numeric_limits<streamsize>::max(), '\n');     // Ignore incorrect input
+        return -1;
+    }
+
+
+    /**
+     * @brief Asks which development card to use.
+     * @return The "use" command of the chosen card, or an empty string for an invalid choice.
+     */
+    string ConsoleAgent::chooseCard()
+    {
+        out << "\nSelect the type of Development Card to use:\n1. Victory Point\n2. Promotion\n3. Knight\nEnter your choice: ";
+        switch (readNumber())
+        {
+            case 1:
+                return "use vp";
+            case 2:
+                return "use promo";
+            case 3:
+                return "use knight";
+            default:
+                out << "\nSTATUS:Invalid card type selected!\n";
+                return "";
+        }
+    }
+
+
+    /**
+     * @brief Prompts the player with the menu of the decision and translates the choice into a command.
+     */
+    bool ConsoleAgent::decide(const DecisionRequest& request, string& command)
+    {
+        Player* player = game.getPlayers()[request.seat];
+        command.clear();
+        while (command.empty())
+        {
+            if (request.type == DecisionType::PreRoll)
+            {
+                out << "Do you want to (1) Roll Dice or (2) Use Development Card? ";
+                int choice = readNumber();
+                if (choice == 1)
+                {
+                    command = "roll";
+                }
+                else if (choice == 2)
+                {
+                    command = chooseCard();
+                }
+                else
+                {
+                    out << "\nERROR: Invalid input. Please enter '1' for Roll Dice or '2' for Use Development Card!\n\n";
+                }
+            }
+            else if (request.type == DecisionType::Discard)
+            {
+                out << player->getName() << " has more than 7 resources and must discard " << request.amount << " of them." << endl;
+                out << "Current resources: WOOD: " << player->getResourceCount(WOOD) << ", BRICK: " << player->getResourceCount(BRICK)
+                    << ", WOOL: " << player->getResourceCount(WOOL) << ", GRAIN: " << player->getResourceCount(GRAIN)
+                    << ", ORE: " << player->getResourceCount(ORE) << endl;
+                out << "Type the number of each resource to discard separated by space (WOOD BRICK WOOL GRAIN ORE): ";
+                ostringstream discard;
+                discard << "discard";
+                for (int type = WOOD; type <= ORE; ++type)
+                {
+                    discard << " " << readNumber();
+                }
+                command = discard.str();
+            }
+            else if (request.type == DecisionType::Robber)
+            {
+                // The robber goes where it hurts the opponents most, so the menus keep their order after a 7
+                out << "\n" << player->getName() << " moves the robber." << endl;
+                command = "robber";
+            }
+            else
+            {
+                if (request.type == DecisionType::SpecialBuild)
+                {
+                    out << "\n" << player->getName() << " may build before the next turn (special build phase)." << endl;
+                }
+                out << "\nChoose an action:\n";
+                out << "0. View game state\n";
+                out << "1. View your full player details\n";
+                out << "2. Trade resources or cards\n";
+                out << "3. Build a road\n";
+                out << "4. Build a settlement\n";
+                out << "5. Upgrade to city\n";
+                out << "6. Buy development card\n";
+                out << "7. Use development card\n";
+                out << "8. End turn\n";
+                out << "Enter your choice: ";
+
+                switch (readNumber())
+                {
+                    case 0:
+                        game.printGameState();
+                        break;
+                    case 1:
+                        out << player->printPlayer();
+                        break;
+                    case 2:
+                        command = "trade";
+                        break;
+                    case 3:
+                    {
+                        out << "Enter the intersection IDs to place a road (e.g., 4 5): ";
+                        int id1 = readNumber();
+                        int id2 = readNumber();
+                        command = "road " + to_string(id1) + " " + to_string(id2);
+                        break;
+                    }
+                    case 4:
+                        out << "Enter the intersection ID to place a settlement: ";
+                        command = "settle " + to_string(readNumber());
+                        break;
+                    case 5:
+                        out << "\nEnter the intersection ID to upgrade to a city: ";
+                        command = "city " + to_string(readNumber());
+                        break;
+                    case 6:
+                        command = "buy";
+                        break;
+                    case 7:
+                        command = chooseCard();
+                        break;
+                    case 8:
+                        command = "end";
+                        break;
+                    default:
+                        out << "\nERROR: Invalid choice, please choose a number between 0 and 8!\n";
+                        break;
+                }
+            }
+        }
+        return true;
+    }
+
+
+    /**
+     * @brief Prints rejected commands. Successful ones are already narrated by the game.
+     */
+    void ConsoleAgent::notify(const string& reply)
+    {
+        if (reply.rfind("err ", 0) == 0)
+        {
+            out << "\nERROR: " << reply.substr(4) << endl;
+        }
+    }
+
+
+    /**
+     * @brief The console player may use the interactive trade and promotion card prompts.
+     */
+    bool ConsoleAgent::isInteractive() const
+    {
+        return true;
+    }
+
+
+    //-------------------------------------//
+    //             QueuedAgent             //
+    //-------------------------------------//
+
+    /**
+     * @brief Adds a command to be consumed by the next decision.
+     */
+    void QueuedAgent::push(const string& command)
+    {
+        commands.push_back(command);
+    }
+
+
+    /**
+     * @brief Answers with the next queued command, or returns false to wait for a submitted one.
+     */
+    bool QueuedAgent::decide(const DecisionRequest&, string& command)
+    {
+        if (commands.empty())
+        {
+            return false;
+        }
+        command = commands.front();
+        commands.pop_front();
+        return true;
+    }
+
+
+    /**
+     * @brief Keeps the reply to the last command.
+     */
+    void QueuedAgent::notify(const string& reply)
+    {
+        lastReply = reply;
+    }
+
+
+    const string& QueuedAgent::getLastReply() const
+    {
+        return lastReply;
+    }
+
+
+    //-------------------------------------//
+    //              TurnTask               //
+    //-------------------------------------//
+
+    TurnTask TurnTask::promise_type::get_return_object()
+    {
+        return TurnTask(coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    suspend_always TurnTask::promise_type::initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    suspend_always TurnTask::promise_type::final_suspend() noexcept
+    {
+        return {};
+    }
+
+    void TurnTask::promise_type::return_void() {}
+
+    void TurnTask::promise_type::unhandled_exception()
+    {
+        error = current_exception();
+    }
+
+    TurnTask::TurnTask(coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    TurnTask::TurnTask(TurnTask&& other) noexcept : handle(other.handle)
+    {
+        other.handle = nullptr;
+    }
+
+    TurnTask& TurnTask::operator=(TurnTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+
+    TurnTask::~TurnTask()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    coroutine_handle<TurnTask::promise_type> TurnTask::getHandle() const
+    {
+        return handle;
+    }
+
+
+    //-------------------------------------//
+    //             TurnEngine              //
+    //-------------------------------------//
+
+    /**
+     * @brief Prepares the turn loop. The game must already be initialized.
+     * @param game The game to play.
+     * @param agents The agent of each seat, in the order of game.getPlayers().
+     */
+    TurnEngine::TurnEngine(Catan& game, const vector<SeatAgent*>& agents)
+        : game(game), agents(agents), task(), waiting(nullptr), turn(game.getCurrentPlayerIndex()), actor(turn), turnsPlayed(0), phase(TurnPhase::PreRoll), turnEnded(false),
+          pendingDiscards(agents.size(), 0), discardPolicies(agents.size(), nullptr), answer{0, ""}, die(Player::rollDice),
+          draw(Player::drawCard)
+    {
+        if (agents.size() != game.getPlayers().size())
+        {
+            throw invalid_argument("Every seat needs an agent");
+        }
+    }
+
+
+    /**
+     * @brief Runs the game until it ends or needs a decision that was not answered right away.
+     * @throws Any exception thrown while playing (e.g. the console input was closed).
+     */
+    void TurnEngine::start()
+    {
+        task = play();
+        task.getHandle().resume();
+        if (task.getHandle().promise().error)
+        {
+            rethrow_exception(task.getHandle().promise().error);
+        }
+    }
+
+
+    /**
+     * @brief Delivers a decision for a seat and runs the game until it needs the next one.
+     * @param seat The seat sending the command.
+     * @param command The command line.
+     * @param broadcast Set to a line every seat should see (empty if none).
+     * @return The reply line, starting with "ok" or "err".
+     */
+    string TurnEngine::submit(size_t seat, const string& command, string& broadcast)
+    {
+        broadcast.clear();
+        if (seat >= agents.size())
+        {
+            return "err invalid seat";
+        }
+        if (phase == TurnPhase::Finished)
+        {
+            return "err game over";
+        }
+        if (!waiting)
+        {
+            return "err game not running";
+        }
+        // Any seat may post and withdraw trade offers while the game runs, without waiting for its turn
+        if (command.rfind("offer", 0) == 0 || command.rfind("cancel", 0) == 0)
+        {
+            istringstream arguments(command);
+            string verb;
+            arguments >> verb;
+            string result = verb == "offer" ? handleOffer(seat, arguments) : handleCancel(seat, arguments);
+            broadcast = event;
+            event.clear();
+            return result;
+        }
+        if (command.rfind("discard", 0) == 0)
+        {
+            if (phase != TurnPhase::Discard || pendingDiscards[seat] == 0)
+            {
+                return "err nothing to discard";
+            }
+        }
+        else if (seat != actor)
+        {
+            return "err not your turn";
+        }
+        else if (phase == TurnPhase::Discard)
+        {
+            return "err waiting for discards";
+        }
+
+        answer = {seat, command};
+        reply.clear();
+        event.clear();
+        coroutine_handle<> handle = waiting;
+        waiting = nullptr;
+        handle.resume();
+        if (task.getHandle().promise().error)
+        {
+            rethrow_exception(task.getHandle().promise().error);
+        }
+        broadcast = event;
+        return reply;
+    }
+
+
+    /**
+     * @brief The turn loop: every turn waits for a roll (or a card), then for discards after a 7,
+     * then for actions until the seat ends its turn. Returns when a player reaches 10 points.
+     */
+    TurnTask TurnEngine::play()
+    {
+        vector<Player*>& players = game.getPlayers();
+        while (true)
+        {
+            cout << "\nIt's " << players[turn]->getName() << "'s turn." << endl;
+            actor = turn;
+            phase = TurnPhase::PreRoll;
+            turnEnded = false;
+            ++turnsPlayed;
+
+            // Points built in another seat's special build phase are only claimed at the start of the own turn
+            if (checkWinner())
+            {
+                co_return;
+            }
+
+            // Roll the dice, or play a card instead
+            while (phase == TurnPhase::PreRoll && !turnEnded)
+            {
+                Decision decision = co_await ask(DecisionType::PreRoll);
+                istringstream arguments(decision.command);
+                string verb;
+                arguments >> verb;
+                if (verb == "roll")
+                {
+                    respond(handleRoll());
+                }
+                else if (verb == "use")
+                {
+                    respond(handleUseCard(arguments));
+                }
+                else
+                {
+                    respond("err roll first");
+                }
+            }
+
+            // Every seat holding more than 7 resources discards half of them, then the robber moves
+            while (phase == TurnPhase::Discard)
+            {
+                Decision decision = co_await ask(DecisionType::Discard);
+                istringstream arguments(decision.command);
+                string verb;
+                arguments >> verb;
+                if (verb == "discard")
+                {
+                    respond(handleDiscard(decision.seat, arguments));
+                }
+                else
+                {
+                    respond("err must discard " + to_string(pendingDiscards[decision.seat]));
+                }
+            }
+
+            // A seat that goes on with its turn instead of moving the robber leaves it on the suggested tile
+            Decision decision;
+            bool replay = false;
+            while (phase == TurnPhase::Robber)
+            {
+                decision = co_await ask(DecisionType::Robber);
+                istringstream arguments(decision.command);
+                string verb;
+                arguments >> verb;
+                if (verb == "robber")
+                {
+                    respond(handleRobber(arguments));
+                }
+                else
+                {
+                    istringstream suggested;
+                    handleRobber(suggested);
+                    replay = true;
+                }
+            }
+
+            if (phase == TurnPhase::Actions)
+            {
+                cout << "\nProceeding to action selection..." << endl;
+            }
+            while (phase == TurnPhase::Actions && !turnEnded)
+            {
+                if (!replay)
+                {
+                    decision = co_await ask(DecisionType::Action);
+                }
+                replay = false;
+                istringstream arguments(decision.command);
+                string verb;
+                arguments >> verb;
+                if (verb == "road")
+                {
+                    respond(handleRoad(arguments));
+                }
+                else if (verb == "settle")
+                {
+                    respond(handleSettlement(arguments));
+                }
+                else if (verb == "city")
+                {
+                    respond(handleCity(arguments));
+                }
+                else if (verb == "buy")
+                {
+                    respond(handleBuy());
+                }
+                else if (verb == "use")
+                {
+                    respond(handleUseCard(arguments));
+                }
+                else if (verb == "trade")
+                {
+                    respond(handleTrade());
+                }
+                else if (verb == "offer")
+                {
+                    respond(handleOffer(decision.seat, arguments));
+                }
+                else if (verb == "cancel")
+                {
+                    respond(handleCancel(decision.seat, arguments));
+                }
+                else if (verb == "trades")
+                {
+                    respond(handleSettle());
+                }
+                else if (verb == "bank")
+                {
+                    respond(handleBank(arguments));
+                }
+                else if (verb == "end")
+                {
+                    handleSettle();     // Offers matched by the last posts of the turn still trade
+                    turnEnded = true;
+                    respond("ok");
+                }
+                else if (verb == "roll")
+                {
+                    respond("err already rolled");
+                }
+                else
+                {
+                    respond("err unknown command");
+                }
+            }
+
+            // With 5 and 6 players every other seat may build, in turn order, before the dice pass on
+            for (size_t offset = 1; offset < agents.size() && phase != TurnPhase::Finished && game.hasSpecialBuildPhase(); ++offset)
+            {
+                actor = (turn + offset) % agents.size();
+                phase = TurnPhase::SpecialBuild;
+                event = "event build " + to_string(actor);
+                while (phase == TurnPhase::SpecialBuild)
+                {
+                    Decision build = co_await ask(DecisionType::SpecialBuild);
+                    istringstream arguments(build.command);
+                    string verb;
+                    arguments >> verb;
+                    if (verb == "road")
+                    {
+                        respond(handleRoad(arguments));
+                    }
+                    else if (verb == "settle")
+                    {
+                        respond(handleSettlement(arguments));
+                    }
+                    else if (verb == "city")
+                    {
+                        respond(handleCity(arguments));
+                    }
+                    else if (verb == "buy")
+                    {
+                        respond(handleBuy());
+                    }
+                    else if (verb == "end")
+                    {
+                        phase = TurnPhase::Actions;
+                        respond("ok");
+                    }
+                    else
+                    {
+                        respond("err only building in the special build phase");
+                    }
+                }
+            }
+            actor = turn;
+
+            if (phase == TurnPhase::Finished)
+            {
+                co_return;
+            }
+            passTurn();
+        }
+    }
+
+
+    /**
+     * @brief Returns the awaitable for the next decision of the given type.
+     */
+    TurnEngine::DecisionAwaiter TurnEngine::ask(DecisionType type)
+    {
+        return DecisionAwaiter{*this, type};
+    }
+
+
+    bool TurnEngine::DecisionAwaiter::await_ready() const noexcept
+    {
+        return false;
+    }
+
+
+    bool TurnEngine::DecisionAwaiter::await_suspend(coroutine_handle<> handle)
+    {
+        return engine.requestDecision(type, handle);
+    }
+
+
+    Decision TurnEngine::DecisionAwaiter::await_resume()
+    {
+        return engine.answer;
+    }
+
+
+    /**
+     * @brief Asks the agents of the expected seats for a decision.
+     * Discards are asked from every seat that still owes resources, any other decision from the seat on turn.
+     * @param type The decision to make.
+     * @param handle The suspended turn loop.
+     * @return True to stay suspended until submit(), false if an agent answered right away.
+     */
+    bool TurnEngine::requestDecision(DecisionType type, coroutine_handle<> handle)
+    {
+        for (size_t seat = 0; seat < agents.size(); ++seat)
+        {
+            bool expected = type == DecisionType::Discard ? pendingDiscards[seat] > 0 : seat == actor;
+            if (!expected)
+            {
+                continue;
+            }
+            DecisionRequest request{type, seat, type == DecisionType::Discard ? pendingDiscards[seat] : 0};
+            string command;
+            if (agents[seat]->decide(request, command))
+            {
+                answer = {seat, command};
+                return false;
+            }
+        }
+        waiting = handle;
+        return true;
+    }
+
+
+    /**
+     * @brief Sets the reply to the decision being handled and passes it to the agent who sent it.
+     */
+    void TurnEngine::respond(const string& text)
+    {
+        reply = text;
+        agents[answer.seat]->notify(text);
+    }
+
+
+    /**
+     * @brief Rolls the dice, distributing resources or starting the discard phase on a 7.
+     */
+    string TurnEngine::handleRoll()
+    {
+        vector<Player*>& players = game.getPlayers();
+        int dice1 = die();
+        int dice2 = die();
+        int total = dice1 + dice2;
+        cout << "\nPlayer " << players[turn]->getName() << " rolls " << dice1 << " + " << dice2 << " = " << total << "." << endl;
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->diceRolled(players[turn]->getId(), total);
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->rolled(total);
+        }
+
+        phase = TurnPhase::Actions;
+        if (total == 7)
+        {
+            cout << "\nA 7 was rolled. Players with more than 7 resources must discard half of them." << endl;
+            phase = TurnPhase::Robber;
+            for (size_t seat = 0; seat < players.size(); ++seat)
+            {
+                int held = players[seat]->countTotalResources();
+                pendingDiscards[seat] = held > 7 ? held / 2 : 0;
+                if (pendingDiscards[seat] > 0 && discardPolicies[seat])
+                {
+                    players[seat]->discardResources(pendingDiscards[seat], *discardPolicies[seat]);
+                    pendingDiscards[seat] = 0;
+                }
+                if (pendingDiscards[seat] > 0)
+                {
+                    phase = TurnPhase::Discard;
+                }
+            }
+        }
+        else
+        {
+            game.getBoard().distributeResourcesBasedOnDiceRoll(total, players);
+            cout << "\nSTATUS: Resources distributed based on dice roll." << endl;
+        }
+        event = "event roll " + to_string(turn) + " " + to_string(total);
+        return "ok " + to_string(total);
+    }
+
+
+    /**
+     * @brief Builds a road between two intersections ("road <a> <b>").
+     */
+    string TurnEngine::handleRoad(istream& arguments)
+    {
+        int id1, id2;
+        if (!(arguments >> id1 >> id2))
+        {
+            return "err usage: road <a> <b>";
+        }
+        Player* player = game.getPlayers()[actor];
+        Board& board = game.getBoard();
+        try {
+            Edge edge(Intersection::getIntersection(id1), Intersection::getIntersection(id2));
+            if (!player->canBuild(Structure::ROAD))
+            {
+                return "err insufficient resources";
+            }
+            if (!board.canPlaceRoad(edge, player->getId()))
+            {
+                return "err invalid road";
+            }
+            player->buildRoad(edge, board);
+            return "ok";
+        }
+        catch (const out_of_range&)
+        {
+            return "err invalid intersection";
+        }
+    }
+
+
+    /**
+     * @brief Builds a settlement at an intersection ("settle <i>").
+     */
+    string TurnEngine::handleSettlement(istream& arguments)
+    {
+        int intersectionID;
+        if (!(arguments >> intersectionID))
+        {
+            return "err usage: settle <intersection>";
+        }
+        Player* player = game.getPlayers()[actor];
+        if (!player->canBuild(Structure::SETTLEMENT))
+        {
+            return "err insufficient resources";
+        }
+        if (!game.getBoard().canPlaceSettlement(intersectionID, player->getId()))
+        {
+            return "err invalid settlement";
+        }
+        player->buildSettlement(intersectionID, game.getBoard());
+        checkWinner();
+        return "ok";
+    }
+
+
+    /**
+     * @brief Upgrades one of the seat's settlements to a city ("city <i>").
+     */
+    string TurnEngine::handleCity(istream& arguments)
+    {
+        int intersectionID;
+        if (!(arguments >> intersectionID))
+        {
+            return "err usage: city <intersection>";
+        }
+        Player* player = game.getPlayers()[actor];
+        if (!player->canBuild(Structure::CITY))
+        {
+            return "err insufficient resources";
+        }
+        if (!game.getBoard().canUpgradeSettlementToCity(intersectionID, player->getId()))
+        {
+            return "err no settlement to upgrade";
+        }
+        player->upgradeToCity(intersectionID, game.getBoard());
+        checkWinner();
+        return "ok";
+    }
+
+
+    /**
+     * @brief Buys a random development card.
+     */
+    string TurnEngine::handleBuy()
+    {
+        switch (game.getPlayers()[actor]->buyDevelopmentCard(game.getPlayers()))
+        {
+            case CardPurchaseError::Success:
+                checkWinner();          // A victory point or a knight bringing the Largest Army
+                return "ok";
+            case CardPurchaseError::InsufficientResources:
+                return "err insufficient resources";
+            default:
+                return "err no cards available";
+        }
+    }
+
+
+    /**
+     * @brief Plays a development card ("use vp" or "use promo"). As in the original game, using a card ends the turn.
+     * Promotion cards prompt for their choices on the console, so only interactive seats may play them.
+     */
+    string TurnEngine::handleUseCard(istream& arguments)
+    {
+        string card;
+        arguments >> card;
+        DevCardType cardType;
+        if (card == "knight")
+        {
+            return handleKnight(arguments);
+        }
+        if (card == "vp")
+        {
+            cardType = DevCardType::VICTORY_POINT;
+        }
+        else if (card == "promo" && agents[turn]->isInteractive())
+        {
+            cardType = DevCardType::PROMOTION;
+        }
+        else
+        {
+            return agents[turn]->isInteractive() ? "err usage: use vp|knight|promo" : "err usage: use vp|knight";
+        }
+
+        Player* player = game.getPlayers()[turn];
+        bool shouldEndTurn = false;
+        CardUseError result = player->useDevelopmentCard(cardType, player, game.getPlayers(), game.getBoard(), shouldEndTurn);
+        if (result == CardUseError::InsufficientCards)
+        {
+            return "err not enough cards";
+        }
+        if (result != CardUseError::Success)
+        {
+            return "err card not used";
+        }
+        cout << "\nSTATUS: Development card used successfully!" << endl;
+        if (!checkWinner())
+        {
+            turnEnded = true;
+        }
+        return "ok";
+    }
+
+
+    /**
+     * @brief Plays a Knight: moves the robber like after a 7 without ending the turn ("use knight [<x> <y> [<seat>]]").
+     */
+    string TurnEngine::handleKnight(istream& arguments)
+    {
+        Player* player = game.getPlayers()[turn];
+        const map<DevCardType, int>& cards = player->getDevelopmentCards();
+        auto knights = cards.find(DevCardType::KNIGHT);
+        if (knights == cards.end() || knights->second <= 0)
+        {
+            return "err not enough cards";
+        }
+        string result = handleRobber(arguments);
+        if (result == "ok")
+        {
+            player->setDevelopmentCardCount(DevCardType::KNIGHT, knights->second - 1);
+            if (EventExporter* exporter = EventExporter::getActive())
+            {
+                exporter->cardEvent(player->getId(), "use", "Knight");
+            }
+            if (StatBlock* stats = StatBlock::local())
+            {
+                stats->cardUsed(DevCardType::KNIGHT);
+            }
+        }
+        return result;
+    }
+
+
+    /**
+     * @brief Moves the robber for the seat on turn ("robber [<x> <y> [<seat>]]").
+     * Without a tile the robber goes to the suggested one; without a seat the richest player there is robbed.
+     */
+    string TurnEngine::handleRobber(istream& arguments)
+    {
+        vector<Player*>& players = game.getPlayers();
+        Board& board = game.getBoard();
+        Player* player = players[turn];
+        pair<int, int> position = board.suggestRobberPosition(player->getId());
+        Player* victim = nullptr;
+        int x, y;
+        if (arguments >> x >> y)
+        {
+            position = {x, y};
+            size_t victimSeat;
+            if (arguments >> victimSeat)
+            {
+                if (victimSeat >= players.size())
+                {
+                    return "err invalid seat";
+                }
+                victim = players[victimSeat];
+            }
+        }
+        if (!player->placeRobber(position, players, board, victim, draw))
+        {
+            return "err invalid robber move";
+        }
+        if (phase == TurnPhase::Robber)
+        {
+            phase = TurnPhase::Actions;
+        }
+        event = "event robber " + to_string(position.first) + " " + to_string(position.second);
+        return "ok";
+    }
+
+
+    /**
+     * @brief Opens the interactive trade prompts, available to console seats only.
+     */
+    string TurnEngine::handleTrade()
+    {
+        if (!agents[turn]->isInteractive())
+        {
+            return "err trading needs the console";
+        }
+        game.getPlayers()[turn]->trade(game.getPlayers());
+        return "ok";
+    }
+
+
+    /**
+     * @brief Posts a trade offer to the book ("offer <5 amounts given> for <5 amounts wanted> [to <seat>]").
+     * @param seat The posting seat.
+     */
+    string TurnEngine::handleOffer(size_t seat, istream& arguments)
+    {
+        ResourceVector give = {}, want = {};
+        string separator;
+        for (size_t type = WOOD; type <= ORE; ++type)
+        {
+            arguments >> give[type];
+        }
+        arguments >> separator;
+        for (size_t type = WOOD; type <= ORE; ++type)
+        {
+            arguments >> want[type];
+        }
+        if (!arguments || separator != "for")
+        {
+            return "err usage: offer <wood> <brick> <wool> <grain> <ore> for <wood> <brick> <wool> <grain> <ore> [to <seat>]";
+        }
+        int target = -1;
+        string to;
+        if (arguments >> to)
+        {
+            if (to != "to" || !(arguments >> target) || target < 0 || static_cast<size_t>(target) >= agents.size())
+            {
+                return "err invalid trade partner";
+            }
+        }
+        try
+        {
+            int offerID = game.getTradeBook().post(seat, give, want, target);
+            event = "event offer " + to_string(offerID) + " " + to_string(seat);
+            return "ok " + to_string(offerID);
+        }
+        catch (const logic_error& error)      // An invalid offer, or one past the cap of the book
+        {
+            return string("err ") + error.what();
+        }
+    }
+
+
+    /**
+     * @brief Withdraws one of the seat's open offers ("cancel <offer>").
+     * @param seat The seat that posted the offer.
+     */
+    string TurnEngine::handleCancel(size_t seat, istream& arguments)
+    {
+        int offerID;
+        if (!(arguments >> offerID))
+        {
+            return "err usage: cancel <offer>";
+        }
+        return game.getTradeBook().cancel(offerID, seat) ? "ok" : "err no such offer";
+    }
+
+
+    /**
+     * @brief Executes every trade of the seat on turn that the book can match ("trades").
+     */
+    string TurnEngine::handleSettle()
+    {
+        vector<TradeFill> fills = game.getTradeBook().settle(game.getPlayers(), static_cast<int>(turn));
+        for (const TradeFill& fill : fills)
+        {
+            cout << "\nSTATUS: " << game.getPlayers()[fill.firstSeat]->getName() << " traded with "
+                 << game.getPlayers()[fill.secondSeat]->getName() << "." << endl;
+        }
+        if (!fills.empty())
+        {
+            event = "event trades " + to_string(turn) + " " + to_string(fills.size());
+        }
+        return "ok " + to_string(fills.size());
+    }
+
+
+    /**
+     * @brief Trades with the bank at the best rate of the seat's harbors ("bank <give> <get> [count]").
+     */
+    string TurnEngine::handleBank(istream& arguments)
+    {
+        string giveName, getName;
+        int count = 1;
+        if (!(arguments >> giveName >> getName))
+        {
+            return "err usage: bank <give> <get> [count]";
+        }
+        if (!(arguments >> count))
+        {
+            count = 1;
+        }
+        ResourceType give = resourceTypeFromString(giveName);
+        ResourceType get = resourceTypeFromString(getName);
+        if (give == NONE || get == NONE || give == get || count <= 0)
+        {
+            return "err invalid bank trade";
+        }
+        Player* player = game.getPlayers()[turn];
+        if (!player->tradeWithBank(give, get, count))
+        {
+            return "err need " + to_string(static_cast<long long>(player->getBankRate(give)) * count) + " " + giveName;
+        }
+        return "ok " + to_string(player->getBankRate(give));
+    }
+
+
+    /**
+     * @brief Discards resources for a seat that holds too many after a 7 ("discard <wood> <brick> <wool> <grain> <ore>").
+     * @param seat The discarding seat.
+     */
+    string TurnEngine::handleDiscard(size_t seat, istream& arguments)
+    {
+        int amounts[5];
+        string first;
+        arguments >> first;
+        if (first == "auto")
+        {
+            string name;
+            arguments >> name;
+            const DiscardPolicy* policy = DiscardPolicy::byName(name, game.getBoard());
+            if (!policy)
+            {
+                return "err unknown discard policy";
+            }
+            ResourceVector chosen;
+            policy->choose(game.getPlayers()[seat]->getResources(), pendingDiscards[seat], chosen);
+            for (size_t type = WOOD; type <= ORE; ++type)
+            {
+                amounts[type] = chosen[type];
+            }
+        }
+        else if (!(istringstream(first) >> amounts[0]) || !(arguments >> amounts[1] >> amounts[2] >> amounts[3] >> amounts[4]))
+        {
+            return "err usage: discard <wood> <brick> <wool> <grain> <ore> | discard auto [balanced|build|rarest]";
+        }
+        Player* player = game.getPlayers()[seat];
+        int total = 0;
+        for (int type = WOOD; type <= ORE; ++type)
+        {
+            if (amounts[type] < 0 || amounts[type] > player->getResourceCount(static_cast<ResourceType>(type)))
+            {
+                return "err invalid discard";
+            }
+            total += amounts[type];
+        }
+        if (total != pendingDiscards[seat])
+        {
+            return "err must discard " + to_string(pendingDiscards[seat]);
+        }
+        for (int type = WOOD; type <= ORE; ++type)
+        {
+            if (amounts[type] > 0)
+            {
+                player->useResources(static_cast<ResourceType>(type), amounts[type]);
+                if (EventExporter* exporter = EventExporter::getActive())
+                {
+                    exporter->resourceDelta(player->getId(), static_cast<ResourceType>(type), -amounts[type], "discard");
+                }
+            }
+        }
+        if (StatBlock* stats = StatBlock::local())
+        {
+            stats->discard(total);
+        }
+        pendingDiscards[seat] = 0;
+
+        // The robber moves once every seat has discarded
+        phase = TurnPhase::Robber;
+        for (int pending : pendingDiscards)
+        {
+            if (pending > 0)
+            {
+                phase = TurnPhase::Discard;
+            }
+        }
+        return "ok";
+    }
+
+
+    /**
+     * @brief Makes a seat discard automatically after a 7, so the game does not wait for it.
+     */
+    void TurnEngine::setDiscardPolicy(size_t seat, const DiscardPolicy* policy)
+    {
+        if (seat < discardPolicies.size())
+        {
+            discardPolicies[seat] = policy;
+        }
+    }
+
+
+    /**
+     * @brief Replaces the die roller, e.g. with a seeded or scripted one so a test plays known rolls.
+     */
+    void TurnEngine::setDice(function<int()> roll)
+    {
+        die = move(roll);
+    }
+
+
+    /**
+     * @brief Replaces the card draw of the robber, e.g. with a seeded one so a test steals known cards.
+     */
+    void TurnEngine::setCardDraw(function<int(int)> pick)
+    {
+        draw = move(pick);
+    }
+
+
+    /**
+     * @brief Ends the turn and passes the dice to the next seat.
+     */
+    void TurnEngine::passTurn()
+    {
+        game.getPlayers()[turn]->endTurn();
+        game.nextTurn();
+        game.getTradeBook().clear();        // Offers only stand for the turn they were posted in
+        turn = (turn + 1) % agents.size();
+        event = "event turn " + to_string(turn);
+        if (EventExporter* exporter = EventExporter::getActive())
+        {
+            exporter->flush();      // A live reader of the feed gets every turn as it ends
+        }
+        if (!checkpointPath.empty())
+        {
+            GameCheckpoint::save(game, checkpointPath);
+        }
+    }
+
+
+    /**
+     * @brief Finishes the game if the deciding seat reached 10 points. A seat cannot win in the special build
+     * phase of another seat's turn; it is checked again when its own turn starts.
+     * @return True if the seat won.
+     */
+    bool TurnEngine::checkWinner()
+    {
+        Player* player = game.getPlayers()[actor];
+        if (phase == TurnPhase::SpecialBuild || player->getPoints() < 10)
+        {
+            return false;
+        }
+        cout << "Player " << player->getName() << " wins with " << player->getPoints() << " points!" << endl;
+        phase = TurnPhase::Finished;
+        event = "event winner " + to_string(actor) + " " + to_string(player->getPoints());
+        if (StatBlock* stats = StatBlock::local())
+        {
+            // Played victory point cards are the points left after the buildings and the awards
+            int settlements = static_cast<int>(player->getSettlements().size());
+            int cities = 2 * static_cast<int>(player->getCities().size());
+            int awards = game.getAwards().getPoints(static_cast<size_t>(player->getId()));
+            int points[POINT_SOURCES] = {settlements, cities, player->getPoints() - settlements - cities - awards, awards};
+            stats->gameWon(turnsPlayed, points);
+        }
+        return true;
+    }
+
+
+    /**
+     * @brief Saves the game to a checkpoint file whenever a turn passes, so it can be resumed elsewhere.
+     * @param path Path of the checkpoint file (empty disables saving).
+     */
+    void TurnEngine::setCheckpointPath(const string& path)
+    {
+        checkpointPath = path;
+    }
+
+
+    size_t TurnEngine::getTurn() const
+    {
+        return turn;
+    }
+
+
+    size_t TurnEngine::getTurnsPlayed() const
+    {
+        return turnsPlayed;
+    }
+
+
+    /**
+     * @brief Returns the seat expected to decide: the seat on turn, or the builder in the special build phase.
+     */
+    size_t TurnEngine::getActor() const
+    {
+        return actor;
+    }
+
+    TurnPhase TurnEngine::getPhase() const
+    {
+        return phase;
+    }
+
+    bool TurnEngine::isFinished() const
+    {
+        return phase == TurnPhase::Finished;
+    }
+
+    int TurnEngine::getPendingDiscard(size_t seat) const
+    {
+        return seat < pendingDiscards.size() ? pendingDiscards[seat] : 0;
+    }
+}
@@ -0,0 +1,307 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef TURNENGINE_HPP
+#define TURNENGINE_HPP
+
+#include <coroutine>
+#include <exception>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "catan.hpp"
+
+using namespace std;
+namespace ariel {
+
+    /**
+     * @brief The stage of the turn the engine is waiting in.
+     */
+    enum class TurnPhase { PreRoll, Discard, Robber, Actions, SpecialBuild, Finished };
+
+
+    /**
+     * @brief The kind of decision a seat is asked to make.
+     */
+    enum class DecisionType {
+        PreRoll,            // "roll" or "use <card>"
+        Action,             // A build, buy, trade or card command, or "end"
+        Discard,            // "discard <wood> <brick> <wool> <grain> <ore>" or "discard auto [balanced|build|rarest]" after a 7
+        Robber,             // "robber [<x> <y> [<seat>]]" after a 7; any other command places it on the suggested tile
+        SpecialBuild        // "road", "settle", "city" or "buy" between the turns of a 5 or 6 player game, or "end"
+    };
+
+
+    /**
+     * @brief A question the engine asks the agent of one seat.
+     */
+    struct DecisionRequest
+    {
+        DecisionType type;          // What is being decided
+        size_t seat;                // The seat asked to decide
+        int amount;                 // Number of resources to discard (Discard only)
+    };
+
+
+    /**
+     * @brief A command sent by the agent of a seat.
+     */
+    struct Decision
+    {
+        size_t seat;                // The seat that decided
+        string command;             // The command line
+    };
+
+
+    //-------------------------------------//
+    //         SeatAgent - Interface       //
+    //-------------------------------------//
+
+    /**
+     * @brief Whoever makes the decisions of a seat: a human at the console, a bot or a remote client.
+     *
+     * Decisions are command lines such as "roll", "road 4 5", "settle 12", "city 12", "buy", "use vp",
+     * "discard 1 0 2 0 0", "offer 1 0 0 0 0 for 0 0 0 1 0", "trades", "bank wool ore", "robber 1 0 2", "use knight" and "end". An agent either answers a request right away, or returns false and
+     * the answer is delivered later through TurnEngine::submit().
+     */
+    class SeatAgent
+    {
+        public:
+
+            virtual ~SeatAgent() = default;
+
+            /**
+             * @brief Asks the agent for a decision.
+             * @param request The decision to make.
+             * @param command Set to the command when the agent answers right away.
+             * @return True if the command was set, false if the answer will be submitted later.
+             */
+            virtual bool decide(const DecisionRequest& request, string& command) = 0;
+
+            /**
+             * @brief Receives the reply to the agent's last command, starting with "ok" or "err".
+             */
+            virtual void notify(const string& reply);
+
+            /**
+             * @brief True for agents reading the console, which may use the interactive trade and promotion card prompts.
+             */
+            virtual bool isInteractive() const;
+    };
+
+
+    /**
+     * @brief A human player at the console, choosing from the numbered menus of the original game.
+     */
+    class ConsoleAgent : public SeatAgent
+    {
+        private:
+
+            Catan& game;            // The game, used to print the game state and player details
+            istream& in;            // Where choices are read from
+            ostream& out;           // Where menus are printed to
+
+            int readNumber();
+            string chooseCard();
+
+        public:
+
+            ConsoleAgent(Catan& game, istream& in = cin, ostream& out = cout);
+
+            bool decide(const DecisionRequest& request, string& command) override;
+            void notify(const string& reply) override;
+            bool isInteractive() const override;
+    };
+
+
+    /**
+     * @brief A seat answered from a queue of commands: pushed by a network client, a script or a test.
+     * When the queue is empty the engine suspends until the command is submitted.
+     */
+    class QueuedAgent : public SeatAgent
+    {
+        private:
+
+            deque<string> commands;     // Commands not yet consumed
+            string lastReply;           // Reply to the last consumed command
+
+        public:
+
+            void push(const string& command);
+            bool decide(const DecisionRequest& request, string& command) override;
+            void notify(const string& reply) override;
+            const string& getLastReply() const;
+    };
+
+
+    //-------------------------------------//
+    //              TurnTask               //
+    //-------------------------------------//
+
+    /**
+     * @brief Coroutine type of the turn loop. Starts suspended and stays suspended at the end until destroyed.
+     */
+    class TurnTask
+    {
+        public:
+
+            struct promise_type
+            {
+                exception_ptr error;        // Exception that escaped the turn loop
+
+                TurnTask get_return_object();
+                suspend_always initial_suspend() noexcept;
+                suspend_always final_suspend() noexcept;
+                void return_void();
+                void unhandled_exception();
+            };
+
+            explicit TurnTask(coroutine_handle<promise_type> handle = nullptr);
+            TurnTask(TurnTask&& other) noexcept;
+            TurnTask& operator=(TurnTask&& other) noexcept;
+            ~TurnTask();
+
+            TurnTask(const TurnTask&) = delete;
+            TurnTask& operator=(const TurnTask&) = delete;
+
+            coroutine_handle<promise_type> getHandle() const;
+
+        private:
+
+            coroutine_handle<promise_type> handle;
+    };
+
+
+    //-------------------------------------//
+    //             TurnEngine              //
+    //-------------------------------------//
+
+    /**
+     * @brief Runs the turns of a game as a coroutine that co_awaits every decision from the agent of the seat.
+     *
+     * Agents that answer right away (console, bots) play the whole game inside start(). Agents that answer
+     * later (remote clients) leave the coroutine suspended, so any number of games can be multiplexed on one
+     * thread: each call to submit() resumes the game until it needs the next decision.
+     */
+    class TurnEngine
+    {
+        private:
+
+            /**
+             * @brief Awaitable that asks the expected seats for a decision and suspends if none answers right away.
+             */
+            struct DecisionAwaiter
+            {
+                TurnEngine& engine;
+                DecisionType type;
+
+                bool await_ready() const noexcept;
+                bool await_suspend(coroutine_handle<> handle);
+                Decision await_resume();
+            };
+
+            Catan& game;                        // The game whose turns are played
+            vector<SeatAgent*> agents;          // The agent of each seat
+            TurnTask task;                      // The turn loop
+            coroutine_handle<> waiting;         // The suspended turn loop waiting for a submitted decision
+            size_t turn;                        // Seat whose turn it is
+            size_t actor;                       // Seat deciding: the seat on turn, or the builder in the special build phase
+            size_t turnsPlayed;                 // Turns started since the engine was created
+            TurnPhase phase;                    // What the engine is waiting for
+            bool turnEnded;                     // Set when the current turn is over
+            vector<int> pendingDiscards;        // Resources each seat still has to discard after a 7
+            vector<const DiscardPolicy*> discardPolicies;   // Seats that discard without being asked (nullptr to ask)
+            Decision answer;                    // The decision being handled
+            string reply;                       // Reply to the decision being handled
+            string event;                       // Line every seat should see after the decision (empty if none)
+            string checkpointPath;              // Where the game is saved at every turn boundary (empty to disable)
+            function<int()> die;                // Rolls one die, Player::rollDice unless replaced
+            function<int(int)> draw;            // Picks the card the robber steals, Player::drawCard unless replaced
+
+            TurnTask play();
+            DecisionAwaiter ask(DecisionType type);
+            bool requestDecision(DecisionType type, coroutine_handle<> handle);
+            void respond(const string& text);
+
+            // Command handlers, each returns the reply line
+            string handleRoll();
+            string handleRoad(istream& arguments);
+            string handleSettlement(istream& arguments);
+            string handleCity(istream& arguments);
+            string handleBuy();
+            string handleUseCard(istream& arguments);
+            string handleKnight(istream& arguments);
+            string handleRobber(istream& arguments);
+            string handleTrade();
+            string handleOffer(size_t seat, istream& arguments);
+            string handleCancel(size_t seat, istream& arguments);
+            string handleSettle();
+            string handleBank(istream& arguments);
+            string handleDiscard(size_t seat, istream& arguments);
+            void passTurn();
+            bool checkWinner();
+
+        public:
+
+            /**
+             * @brief Prepares the turn loop. The game must already be initialized.
+             * @param game The game to play.
+             * @param agents The agent of each seat, in the order of game.getPlayers().
+             */
+            TurnEngine(Catan& game, const vector<SeatAgent*>& agents);
+
+            TurnEngine(const TurnEngine&) = delete;
+            TurnEngine& operator=(const TurnEngine&) = delete;
+
+            /**
+             * @brief Runs the game until it ends or needs a decision that was not answered right away.
+             * @throws Any exception thrown while playing (e.g. the console input was closed).
+             */
+            void start();
+
+            /**
+             * @brief Delivers a decision for a seat and runs the game until it needs the next one.
+             * @param seat The seat sending the command.
+             * @param command The command line.
+             * @param broadcast Set to a line every seat should see (empty if none).
+             * @return The reply line, starting with "ok" or "err".
+             */
+            string submit(size_t seat, const string& command, string& broadcast);
+
+            /**
+             * @brief Saves the game to a checkpoint file whenever a turn passes, so it can be resumed elsewhere.
+             * @param path Path of the checkpoint file (empty disables saving).
+             */
+            void setCheckpointPath(const string& path);
+
+            /**
+             * @brief Makes a seat discard automatically after a 7, so the game does not wait for it.
+             * @param seat The seat.
+             * @param policy Chooses the discarded resources (nullptr to ask the agent again). Must outlive the engine.
+             */
+            void setDiscardPolicy(size_t seat, const DiscardPolicy* policy);
+
+            /**
+             * @brief Replaces the die roller, e.g. with a seeded or scripted one so a test plays known rolls.
+             * @param roll Returns the face of one die (1 to 6); called twice per roll.
+             */
+            void setDice(function<int()> roll);
+
+            /**
+             * @brief Replaces the card draw of the robber, e.g. with a seeded one so a test steals known cards.
+             * @param pick Returns the index of the stolen card, below the number of cards it is given.
+             */
+            void setCardDraw(function<int(int)> pick);
+
+            // Getters
+            size_t getTurn() const;
+            size_t getTurnsPlayed() const;
+            size_t getActor() const;
+            TurnPhase getPhase() const;
+            bool isFinished() const;
+            int getPendingDiscard(size_t seat) const;
+    };
+}
+
+#endif
@@ -0,0 +1,570 @@
+// Email: origoldbsc@gmail.com
+
+#include "winrate.hpp"
+#include "checkpoint.hpp"
+#include "topology.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+
+using namespace std;
+namespace ariel {
+
+    namespace {
+
+        constexpr int INTERSECTIONS = 54;
+        constexpr int WIN_POINTS = 10;
+        constexpr int MAX_SETTLEMENTS = 5;
+        constexpr int MAX_CITIES = 4;
+        constexpr int MAX_ROADS = 15;
+        constexpr int MAX_BUILDS = 24;      // Builds and trades in one turn at most, ends a turn that would loop
+
+        uint64_t bitOf(int intersectionID)
+        {
+            return uint64_t{1} << intersectionID;
+        }
+
+        /**
+         * @brief splitmix64, spreads a seed over all the bits of a state.
+         */
+        uint64_t mix(uint64_t value)
+        {
+            value += 0x9E3779B97F4A7C15ull;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+        /**
+         * @brief A xorshift64* random source, one per worker.
+         */
+        struct Random
+        {
+            uint64_t state;
+
+            explicit Random(uint64_t seed) : state(mix(seed) | 1) {}
+
+            uint32_t below(uint32_t bound)
+            {
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                uint64_t high = (state * 0x2545F4914F6CDD1Dull) >> 32;
+                return static_cast<uint32_t>((high * bound) >> 32);
+            }
+        };
+
+        /**
+         * @brief Everything a rollout changes. Plain arrays, copied once per rollout.
+         */
+        struct RolloutState
+        {
+            int points[MAX_SEATS];
+            int hand[MAX_SEATS][RESOURCE_TYPES];
+            int settlements[MAX_SEATS];
+            int cities[MAX_SEATS];
+            int roads[MAX_SEATS];
+            uint64_t reach[MAX_SEATS];              // Intersections the seat's roads and buildings touch
+            uint64_t closed;                        // Intersections with a building or next to one
+            int8_t owner[INTERSECTIONS + 1];        // Seat of the building on each intersection, -1 if none
+            uint8_t level[INTERSECTIONS + 1];       // 1 for a settlement, 2 for a city
+            int cardsLeft;                          // Development cards in the stock
+            int pointCardsLeft;                     // Victory point cards among them
+        };
+
+        /**
+         * @brief What one produced resource goes to: an intersection next to a tile of some number.
+         */
+        struct Yield
+        {
+            int intersection;
+            size_t type;
+        };
+    }
+
+
+    /**
+     * @brief The snapshot of a game, shared read-only by the workers, and the tallies they add to.
+     */
+    struct WinEstimator::Job
+    {
+        size_t seats;
+        size_t turn;                                    // Seat that plays first
+        RolloutState start;
+        int bankRates[MAX_SEATS][RESOURCE_TYPES];
+        int costs[STRUCTURE_TYPES][RESOURCE_TYPES];     // Player::costOf, as plain integers
+        Yield yields[13][12];                           // Yields of each dice number: two tiles of six corners at most
+        size_t yieldCount[13];
+        float value[INTERSECTIONS + 1];                 // Chances in 36 that an intersection produces, for choosing spots
+        uint64_t closes[INTERSECTIONS + 1];             // An intersection and its neighbors
+        int neighbors[INTERSECTIONS + 1][3];            // 0 where there is no neighbor
+        EstimateOptions options;
+        chrono::steady_clock::time_point deadline;
+        uint64_t seed;
+
+        atomic<bool> done{false};
+        mutex tally;                                    // Guards the fields below
+        size_t wins[MAX_SEATS] = {};
+        size_t unfinished = 0;
+        size_t rollouts = 0;
+        bool converged = false;
+
+        /**
+         * @brief Returns the Wilson score interval of a share: its center and half width.
+         */
+        pair<double, double> interval(size_t count) const
+        {
+            double n = static_cast<double>(rollouts), z = options.z;
+            if (rollouts == 0)
+            {
+                return {0.5, 0.5};
+            }
+            double p = static_cast<double>(count) / n;
+            double scale = 1 + z * z / n;
+            return {(p + z * z / (2 * n)) / scale, z * sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / scale};
+        }
+
+        bool canPay(const RolloutState& state, size_t seat, Structure structure) const
+        {
+            const int* cost = costs[static_cast<size_t>(structure)];
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                if (state.hand[seat][type] < cost[type])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void pay(RolloutState& state, size_t seat, Structure structure) const
+        {
+            const int* cost = costs[static_cast<size_t>(structure)];
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                state.hand[seat][type] -= cost[type];
+            }
+        }
+
+        /**
+         * @brief Returns the best open spot the seat reaches, or 0.
+         */
+        int bestSpot(const RolloutState& state, size_t seat) const
+        {
+            int best = 0;
+            for (uint64_t open = state.reach[seat] & ~state.closed; open != 0; open &= open - 1)
+            {
+                int id = countr_zero(open);
+                best = best == 0 || value[id] > value[best] ? id : best;
+            }
+            return best;
+        }
+
+        /**
+         * @brief Returns the free intersection one road away that leads to the best open spot, or 0.
+         */
+        int bestRoad(const RolloutState& state, size_t seat) const
+        {
+            int best = 0;
+            float bestValue = -1;
+            for (uint64_t ends = state.reach[seat]; ends != 0; ends &= ends - 1)
+            {
+                for (int next : neighbors[countr_zero(ends)])
+                {
+                    if (next == 0 || (state.reach[seat] & bitOf(next)) != 0 || state.owner[next] >= 0)
+                    {
+                        continue;
+                    }
+                    float reached = (state.closed & bitOf(next)) == 0 ? value[next] : 0;
+                    for (int beyond : neighbors[next])
+                    {
+                        reached = beyond != 0 && (state.closed & bitOf(beyond)) == 0 ? max(reached, value[beyond] / 2) : reached;
+                    }
+                    if (reached > bestValue)
+                    {
+                        best = next;
+                        bestValue = reached;
+                    }
+                }
+            }
+            return best;
+        }
+
+        /**
+         * @brief Trades one resource with the bank toward a build, returns false if no trade helps.
+         */
+        bool tradeToward(RolloutState& state, size_t seat, Structure structure) const
+        {
+            const int* cost = costs[static_cast<size_t>(structure)];
+            size_t missing = RESOURCE_TYPES;
+            for (size_t type = 0; type < RESOURCE_TYPES && missing == RESOURCE_TYPES; ++type)
+            {
+                missing = state.hand[seat][type] < cost[type] ? type : missing;
+            }
+            if (missing == RESOURCE_TYPES)
+            {
+                return false;
+            }
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                if (state.hand[seat][type] - cost[type] >= bankRates[seat][type])
+                {
+                    state.hand[seat][type] -= bankRates[seat][type];
+                    ++state.hand[seat][missing];
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Builds and trades greedily until nothing more can be done. Returns true if the seat won.
+         */
+        bool build(RolloutState& state, size_t seat, Random& random) const
+        {
+            for (int step = 0; step < MAX_BUILDS && state.points[seat] < WIN_POINTS; ++step)
+            {
+                int spot = state.settlements[seat] < MAX_SETTLEMENTS ? bestSpot(state, seat) : 0;
+                bool canUpgrade = state.settlements[seat] > 0 && state.cities[seat] < MAX_CITIES;
+                if (canUpgrade && canPay(state, seat, Structure::CITY))
+                {
+                    int best = 0;
+                    for (int id = 1; id <= INTERSECTIONS; ++id)
+                    {
+                        bool mine = state.owner[id] == static_cast<int8_t>(seat) && state.level[id] == 1;
+                        best = mine && (best == 0 || value[id] > value[best]) ? id : best;
+                    }
+                    pay(state, seat, Structure::CITY);
+                    state.level[best] = 2;
+                    --state.settlements[seat];
+                    ++state.cities[seat];
+                    ++state.points[seat];
+                }
+                else if (spot != 0 && canPay(state, seat, Structure::SETTLEMENT))
+                {
+                    pay(state, seat, Structure::SETTLEMENT);
+                    state.owner[spot] = static_cast<int8_t>(seat);
+                    state.level[spot] = 1;
+                    state.closed |= closes[spot];
+                    ++state.settlements[seat];
+                    ++state.points[seat];
+                }
+                else if (spot == 0 && state.roads[seat] < MAX_ROADS && canPay(state, seat, Structure::ROAD))
+                {
+                    int next = bestRoad(state, seat);
+                    if (next == 0)
+                    {
+                        break;
+                    }
+                    pay(state, seat, Structure::ROAD);
+                    state.reach[seat] |= bitOf(next);
+                    ++state.roads[seat];
+                }
+                else if (state.cardsLeft > 0 && canPay(state, seat, Structure::DEVELOPMENT_CARD))
+                {
+                    pay(state, seat, Structure::DEVELOPMENT_CARD);
+                    if (random.below(static_cast<uint32_t>(state.cardsLeft)) < static_cast<uint32_t>(state.pointCardsLeft))
+                    {
+                        --state.pointCardsLeft;
+                        ++state.points[seat];
+                    }
+                    --state.cardsLeft;
+                }
+                else
+                {
+                    Structure goal = spot != 0 ? Structure::SETTLEMENT : canUpgrade ? Structure::CITY : Structure::ROAD;
+                    if (!tradeToward(state, seat, goal))
+                    {
+                        break;
+                    }
+                }
+            }
+            return state.points[seat] >= WIN_POINTS;
+        }
+
+        /**
+         * @brief Plays a game out from the snapshot. Returns the winning seat, or -1 if nobody won in MAX_TURNS.
+         */
+        int rollout(Random& random) const
+        {
+            RolloutState state = start;
+            for (size_t seat = 0; seat < seats; ++seat)
+            {
+                if (state.points[seat] >= WIN_POINTS)
+                {
+                    return static_cast<int>(seat);
+                }
+            }
+
+            for (int turn = 0; turn < MAX_TURNS; ++turn)
+            {
+                size_t seat = (this->turn + static_cast<size_t>(turn)) % seats;
+                size_t roll = 2 + random.below(6) + random.below(6);
+                if (roll == 7)
+                {
+                    for (size_t other = 0; other < seats; ++other)
+                    {
+                        int* hand = state.hand[other];
+                        int held = 0;
+                        for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+                        {
+                            held += hand[type];
+                        }
+                        for (int discard = held > 7 ? held / 2 : 0; discard > 0; --discard)
+                        {
+                            --*max_element(hand, hand + RESOURCE_TYPES);
+                        }
+                    }
+                }
+                for (size_t index = 0; index < yieldCount[roll]; ++index)
+                {
+                    const Yield& yield = yields[roll][index];
+                    int8_t owner = state.owner[yield.intersection];
+                    if (owner >= 0)
+                    {
+                        state.hand[owner][yield.type] += state.level[yield.intersection];
+                    }
+                }
+                if (build(state, seat, random))
+                {
+                    return static_cast<int>(seat);
+                }
+            }
+            return -1;
+        }
+    };
+
+
+    /**
+     * @brief Starts the pool.
+     * @param threads Threads to run the rollouts on, including the calling thread (at least 1).
+     */
+    WinEstimator::WinEstimator(size_t threads) : job(nullptr), generation(0), busy(0), stopping(false)
+    {
+        for (size_t worker = 1; worker < max<size_t>(threads, 1); ++worker)
+        {
+            workers.emplace_back(&WinEstimator::work, this, worker);
+        }
+    }
+
+
+    WinEstimator::~WinEstimator()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+
+    /**
+     * @brief The loop of a pool thread: runs every job posted until the estimator is destroyed.
+     */
+    void WinEstimator::work(size_t worker)
+    {
+        uint64_t seen = 0;
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            Job* current = job;
+            guard.unlock();
+            run(*current, worker);
+            guard.lock();
+            if (--busy == 0)
+            {
+                finished.notify_all();
+            }
+        }
+    }
+
+
+    /**
+     * @brief Plays batches of rollouts until a limit is reached, adding each batch to the tallies.
+     */
+    void WinEstimator::run(Job& current, size_t worker)
+    {
+        Random random(current.seed ^ mix(worker));
+        while (!current.done.load(memory_order_relaxed))
+        {
+            size_t wins[MAX_SEATS] = {}, unfinished = 0;
+            for (size_t index = 0; index < BATCH; ++index)
+            {
+                int winner = current.rollout(random);
+                winner >= 0 ? ++wins[winner] : ++unfinished;
+            }
+
+            lock_guard<mutex> guard(current.tally);
+            if (current.done.load(memory_order_relaxed))
+            {
+                break;      // Another worker already answered, this batch comes too late
+            }
+            for (size_t seat = 0; seat < current.seats; ++seat)
+            {
+                current.wins[seat] += wins[seat];
+            }
+            current.unfinished += unfinished;
+            current.rollouts += BATCH;
+
+            bool tight = current.rollouts >= current.options.minRollouts;
+            for (size_t seat = 0; seat < current.seats && tight; ++seat)
+            {
+                tight = current.interval(current.wins[seat]).second <= current.options.halfWidth;
+            }
+            if (tight || current.rollouts >= current.options.maxRollouts || chrono::steady_clock::now() >= current.deadline)
+            {
+                current.converged = tight;
+                current.done.store(true, memory_order_relaxed);
+            }
+        }
+    }
+
+
+    /**
+     * @brief Estimates each seat's chance to win the game from its current state.
+     * Calls from several threads are run one after the other.
+     * @param game The game, read but not changed.
+     * @param options When to stop.
+     */
+    WinEstimate WinEstimator::estimate(Catan& game, const EstimateOptions& options)
+    {
+        lock_guard<mutex> serial(calls);
+        auto started = chrono::steady_clock::now();
+
+        // The snapshot: occupancy, hands and stock from a checkpoint, production from the tiles
+        CheckpointData data;
+        GameCheckpoint::capture(game, data);
+        Job current;
+        current.seats = data.seatCount;
+        current.turn = data.turn;
+        current.options = options;
+        current.deadline = started + options.budget;
+        current.seed = mix(options.seed);
+
+        const HexTopology& topology = HexTopology::standard();
+        RolloutState& state = current.start;
+        state = RolloutState{};
+        fill(begin(state.owner), end(state.owner), -1);
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            current.closes[id] = bitOf(id);
+            for (size_t index = 0; index < 3; ++index)
+            {
+                int neighbor = topology.neighbors(id)[index];
+                current.neighbors[id][index] = neighbor;
+                current.closes[id] |= neighbor != 0 ? bitOf(neighbor) : 0;
+            }
+        }
+        for (size_t seat = 0; seat < current.seats; ++seat)
+        {
+            const CheckpointPlayer& record = data.players[seat];
+            state.points[seat] = record.points + record.developmentCards[static_cast<int>(DevCardType::VICTORY_POINT)];
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                state.hand[seat][type] = record.resources[type];
+                current.bankRates[seat][type] = game.getPlayers()[seat]->getBankRate(static_cast<ResourceType>(type));
+            }
+        }
+        for (int id = 1; id <= INTERSECTIONS; ++id)
+        {
+            int8_t seat = data.citySeat[id] >= 0 ? data.citySeat[id] : data.settlementSeat[id];
+            if (seat >= 0 && static_cast<size_t>(seat) < current.seats)
+            {
+                bool city = data.citySeat[id] >= 0;
+                state.owner[id] = seat;
+                state.level[id] = city ? 2 : 1;
+                ++(city ? state.cities : state.settlements)[seat];
+                state.reach[seat] |= bitOf(id);
+                state.closed |= current.closes[id];
+            }
+        }
+        for (uint32_t index = 0; index < data.roadCount; ++index)
+        {
+            const CheckpointRoad& road = data.roads[index];
+            if (road.seat >= 0 && static_cast<size_t>(road.seat) < current.seats)
+            {
+                state.reach[road.seat] |= bitOf(road.id1) | bitOf(road.id2);
+                ++state.roads[road.seat];
+            }
+        }
+        for (size_t structure = 0; structure < STRUCTURE_TYPES; ++structure)
+        {
+            for (size_t type = 0; type < RESOURCE_TYPES; ++type)
+            {
+                current.costs[structure][type] = Player::costOf(static_cast<Structure>(structure))[type];
+            }
+        }
+        for (int count : data.deck)
+        {
+            state.cardsLeft += count;
+        }
+        state.pointCardsLeft = data.deck[1];
+
+        Board& board = game.getBoard();
+        pair<int, int> robber(data.robber[0], data.robber[1]);
+        fill(begin(current.yieldCount), end(current.yieldCount), 0);
+        fill(begin(current.value), end(current.value), 0.0f);
+        for (size_t tile = 0; tile < topology.tileCount(); ++tile)
+        {
+            const Tile& placed = board.getTile(topology.tilePosition(tile));
+            int number = placed.getNumber();
+            if (placed.getResourceType() == ResourceType::NONE || number < 2 || number > 12 || number == 7 || topology.tilePosition(tile) == robber)
+            {
+                continue;
+            }
+            size_t roll = static_cast<size_t>(number);
+            for (int corner : topology.tileCorners(tile))
+            {
+                current.yields[roll][current.yieldCount[roll]++] = {corner, static_cast<size_t>(placed.getResourceType())};
+                current.value[corner] += static_cast<float>(6 - abs(7 - number));
+            }
+        }
+
+        // Post the job to the pool and work on it from this thread too
+        {
+            lock_guard<mutex> guard(lock);
+            job = &current;
+            busy = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        run(current, 0);
+        {
+            unique_lock<mutex> guard(lock);
+            finished.wait(guard, [&]() { return busy == 0; });
+            job = nullptr;
+        }
+
+        WinEstimate estimate = {};
+        estimate.seats = current.seats;
+        estimate.rollouts = current.rollouts;
+        estimate.converged = current.converged;
+        for (size_t seat = 0; seat < current.seats; ++seat)
+        {
+            auto [center, halfWidth] = current.interval(current.wins[seat]);
+            estimate.probability[seat] = current.rollouts ? static_cast<double>(current.wins[seat]) / static_cast<double>(current.rollouts) : 0;
+            estimate.lower[seat] = max(0.0, center - halfWidth);
+            estimate.upper[seat] = min(1.0, center + halfWidth);
+        }
+        estimate.unfinished = current.rollouts ? static_cast<double>(current.unfinished) / static_cast<double>(current.rollouts) : 0;
+        estimate.elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started);
+        return estimate;
+    }
+
+
+    size_t WinEstimator::getThreads() const
+    {
+        return workers.size() + 1;
+    }
+}
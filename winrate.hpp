@@ -0,0 +1,113 @@
+// Email: origoldbsc@gmail.com
+
+#ifndef WINRATE_HPP
+#define WINRATE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "registry.hpp"
+
+using namespace std;
+namespace ariel {
+
+    class Catan;
+
+    /**
+     * @brief When WinEstimator::estimate() stops: whichever of the limits below is reached first.
+     */
+    struct EstimateOptions
+    {
+        double halfWidth = 0.03;                        // Stop once every seat's interval is within this of its estimate
+        double z = 1.96;                                // Width of the intervals in standard deviations (1.96 for 95%)
+        size_t minRollouts = 256;                       // Rollouts before the intervals are trusted
+        size_t maxRollouts = 200000;                    // Rollouts at most
+        chrono::milliseconds budget{50};                // Time at most, from the call to the answer
+        uint64_t seed = 1;                              // Seed of the rollouts' random sources
+    };
+
+
+    /**
+     * @brief Each seat's chance to win, with a Wilson score interval.
+     */
+    struct WinEstimate
+    {
+        size_t seats;                       // Seats of the game
+        double probability[MAX_SEATS];      // Share of the rollouts each seat won
+        double lower[MAX_SEATS];            // Lower end of each seat's interval
+        double upper[MAX_SEATS];            // Upper end of each seat's interval
+        double unfinished;                  // Share of the rollouts nobody won within WinEstimator::MAX_TURNS
+        size_t rollouts;                    // Rollouts played
+        bool converged;                     // True if the intervals got tight enough, false if a limit stopped the rollouts
+        chrono::microseconds elapsed;       // Time taken by the call
+    };
+
+
+    /**
+     * @brief Estimates the chance of each seat to win a game in progress by playing it out many times.
+     *
+     * The game is copied into a compact snapshot on the calling thread (see GameCheckpoint::capture), and the
+     * rollouts only ever touch copies of the snapshot, so the live game, its board and the card stock are left
+     * as they were. A rollout is a simplified game: dice are rolled, the tiles produce (the robber stays where
+     * it is), players holding more than 7 cards discard their largest piles, and each player in turn builds the
+     * best city, then the best settlement its roads reach, then a road toward the best spot, then a development
+     * card, trading with the bank at its rates to complete a build. Victory point cards count as soon as they are
+     * held; the Longest Road and further Largest Army changes are not played. The current player starts a fresh
+     * turn.
+     *
+     * The rollouts run on a pool of threads kept for the life of the estimator. Workers play batches of BATCH
+     * rollouts and add them to shared tallies, and the first to see a limit reached stops the others.
+     */
+    class WinEstimator
+    {
+        public:
+
+            static constexpr size_t BATCH = 32;             // Rollouts between two checks of the limits
+            static constexpr int MAX_TURNS = 400;           // A rollout nobody has won by then is unfinished
+
+        private:
+
+            struct Job;
+
+            vector<thread> workers;                 // The pool, the calling thread is one more worker
+            mutex calls;                            // Lets one estimate() run at a time
+            mutex lock;                             // Guards the fields below
+            condition_variable wake;                // Signals a new job (or stopping) to the workers
+            condition_variable finished;            // Signals that the last worker left the job
+            Job* job;                               // The job being run
+            uint64_t generation;                    // Number of jobs posted so far
+            size_t busy;                            // Workers still on the current job
+            bool stopping;                          // Set by the destructor
+
+            void work(size_t worker);
+            static void run(Job& current, size_t worker);
+
+        public:
+
+            /**
+             * @brief Starts the pool.
+             * @param threads Threads to run the rollouts on, including the calling thread (at least 1).
+             */
+            explicit WinEstimator(size_t threads);
+            ~WinEstimator();
+
+            WinEstimator(const WinEstimator&) = delete;
+            WinEstimator& operator=(const WinEstimator&) = delete;
+
+            /**
+             * @brief Estimates each seat's chance to win the game from its current state.
+             * Calls from several threads are run one after the other.
+             * @param game The game, read but not changed.
+             * @param options When to stop.
+             */
+            WinEstimate estimate(Catan& game, const EstimateOptions& options = EstimateOptions());
+
+            size_t getThreads() const;
+    };
+}
+
+#endif